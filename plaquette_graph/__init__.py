@@ -1,7 +1,32 @@
 """Top level plaquette_graph module."""
+from plaquette_graph_bindings import EdgeToEdgeMode
 from plaquette_graph_bindings import SparseGraphRow
+from plaquette_graph_bindings import ImplicitEdgeRow
 from plaquette_graph_bindings import SparseGraph
 from plaquette_graph_bindings import DecodingGraph
+from plaquette_graph_bindings import SparseGraphRow32
+from plaquette_graph_bindings import ImplicitEdgeRow32
+from plaquette_graph_bindings import SparseGraph32
+from plaquette_graph_bindings import DecodingGraph32
+from plaquette_graph_bindings import CompressedGraphRow
+from plaquette_graph_bindings import CompressedSparseGraph
+from plaquette_graph_bindings import CompressedGraphRow32
+from plaquette_graph_bindings import CompressedSparseGraph32
+from plaquette_graph_bindings import ShortestPaths
+from plaquette_graph_bindings import ShortestPaths32
+from plaquette_graph_bindings import ClusterGrowth
+from plaquette_graph_bindings import ClusterGrowth32
+from plaquette_graph_bindings import SyndromeLayout
+from plaquette_graph_bindings import SyndromeBatch
+from plaquette_graph_bindings import SyndromeBatch32
+from plaquette_graph_bindings import WindowedDecodingGraph
+from plaquette_graph_bindings import WindowedDecodingGraph32
 from plaquette_graph_bindings import MultiGraph
+from plaquette_graph_bindings import HyperedgeDecomposition
+from plaquette_graph_bindings import Hypergraph
+from plaquette_graph_bindings import Hypergraph32
+from plaquette_graph_bindings import VertexOrder
+from plaquette_graph_bindings import load_graph
+from plaquette_graph_bindings import query_counters_enabled
 
 __version__ = "0.0.1-alpha.1"
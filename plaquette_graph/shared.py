@@ -0,0 +1,116 @@
+"""Share graphs between processes through shared memory."""
+import os
+import sys
+import weakref
+from multiprocessing import resource_tracker, shared_memory
+
+import numpy as np
+
+# Offsets of the arrays in the shared memory block are aligned to cache lines
+_ALIGNMENT = 64
+
+# Graphs attached in this process, by name of their shared memory block
+_attached = weakref.WeakValueDictionary()
+
+
+def _align(offset):
+    return (offset + _ALIGNMENT - 1) // _ALIGNMENT * _ALIGNMENT
+
+
+class SharedGraph:
+    """A graph whose arrays are stored in a shared memory block.
+
+    A ``SharedGraph`` is created from a ``SparseGraph``, ``DecodingGraph`` (or their 32-bit
+    variants) or ``MultiGraph`` by copying the arrays of the graph into a new shared memory block.
+    It pickles as the name and layout of the block only, so it can be passed to worker processes,
+    e.g. with the ``initializer`` of a ``multiprocessing.Pool``. Unpickling attaches the graph to
+    the block without copying or constructing anything, so all the processes share a single
+    physical copy of the graph. The graph is available as the ``graph`` attribute.
+
+    The hash index from pairs of vertices to edges is not shared: graphs that have one rebuild it
+    in every process. The process that created the block must call :meth:`unlink` once every
+    worker has attached the graph, or use the ``SharedGraph`` as a context manager. The memory is
+    freed once every process has released its graph.
+
+    Attaching processes do not track the block: before Python 3.13, where ``SharedMemory`` has no
+    ``track`` argument, the block is unregistered from the ``resource_tracker`` after attaching,
+    so that workers exiting before the creator neither unlink it nor warn about a leak.
+    """
+
+    def __init__(self, graph, name=None):
+        _, num_vertices, sorted_rows, edge_index, arrays = graph.__getstate__()
+        layout = []
+        size = 0
+        for key, array in arrays.items():
+            offset = _align(size)
+            layout.append((key, offset, array.dtype.str, array.shape))
+            size = offset + array.nbytes
+        shm = shared_memory.SharedMemory(name=name, create=True, size=max(size, 1))
+        for key, offset, dtype, shape in layout:
+            np.ndarray(shape, dtype, buffer=shm.buf, offset=offset)[...] = arrays[key]
+
+        self._header = (type(graph), num_vertices, sorted_rows, edge_index)
+        self._layout = layout
+        self._created_shm = shm
+        self._attach(shm)
+
+    @property
+    def name(self):
+        """The name of the shared memory block."""
+        return self._name
+
+    def unlink(self):
+        """Remove the shared memory block once every process has released its graph.
+
+        Graphs attached to the block remain valid. Only the process that created the block may
+        unlink it.
+        """
+        if self._created_shm is None:
+            raise RuntimeError("only the process that created a SharedGraph can unlink it")
+        self._created_shm.unlink()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.unlink()
+
+    def __reduce__(self):
+        return _attach, (self._name, self._header, self._layout)
+
+    def _attach(self, shm):
+        """Assemble the graph from views of the arrays in a shared memory block."""
+        cls, num_vertices, sorted_rows, edge_index = self._header
+        arrays = {}
+        for key, offset, dtype, shape in self._layout:
+            array = np.ndarray(shape, dtype, buffer=shm.buf, offset=offset)
+            array.flags.writeable = False
+            arrays[key] = array
+        # The graph keeps the block mapped, and the views are released before the block when the
+        # graph is destroyed
+        self.graph = cls.from_arrays(
+            num_vertices, arrays, sorted_rows=sorted_rows, edge_index=edge_index, owner=shm
+        )
+        self._name = shm.name
+        _attached[self._name] = self
+
+
+def _attach(name, header, layout):
+    """Attach a ``SharedGraph`` to the shared memory block created by another process."""
+    shared = _attached.get(name)
+    if shared is not None:
+        return shared
+    if sys.version_info >= (3, 13):
+        # Only the process that created the block must unlink it
+        shm = shared_memory.SharedMemory(name=name, track=False)
+    else:
+        shm = shared_memory.SharedMemory(name=name)
+        if os.name == "posix":
+            # Undo the registration done by SharedMemory, as track=False would
+            resource_tracker.unregister(shm._name, "shared_memory")
+    shared = SharedGraph.__new__(SharedGraph)
+    shared._header = header
+    shared._layout = layout
+    shared._created_shm = None
+    shared._attach(shm)
+    return shared
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Plaquette {
+
+/**
+ * @brief An immutable array that either owns its elements or views memory
+ * owned by another object.
+ *
+ * The graph classes store their arrays as `ArrayBuffer` objects, so that the
+ * arrays can either be built in memory at construction or be used in place
+ * from external memory, such as a memory-mapped file. External memory is kept
+ * alive by a shared owner handle, so copies of an `ArrayBuffer` (and of the
+ * graph holding it) share the external memory instead of duplicating it.
+ *
+ * Owned elements are stored in a `std::pmr::vector`, so that they can be
+ * allocated from a caller-provided memory resource such as an arena. Copies
+ * of an `ArrayBuffer` allocate their elements from the default resource.
+ *
+ * @tparam T Type of the elements.
+ */
+template <typename T> class ArrayBuffer {
+  public:
+    ArrayBuffer() = default;
+
+    // Take ownership of the elements of a vector
+    ArrayBuffer(std::pmr::vector<T> &&data) : owned_(std::move(data)) {
+        Reset_();
+    }
+
+    // Copy the elements of a vector
+    ArrayBuffer(const std::vector<T> &data)
+        : owned_(data.begin(), data.end()) {
+        Reset_();
+    }
+
+    // View external memory, which `owner` keeps alive
+    ArrayBuffer(const T *data, size_t size, std::shared_ptr<const void> owner)
+        : owner_(std::move(owner)), external_(true), data_(data),
+          size_(size) {}
+
+    ArrayBuffer(const ArrayBuffer &other) { *this = other; }
+
+    ArrayBuffer(ArrayBuffer &&other) noexcept
+        : owned_(std::move(other.owned_)) {
+        Adopt_(other);
+    }
+
+    ArrayBuffer &operator=(const ArrayBuffer &other) {
+        if (this != &other) {
+            // Copy assignment would keep the memory resource of our vector,
+            // so the copy is constructed from the default resource instead.
+            // It is made before our vector is destroyed, so that a throwing
+            // copy leaves this array unchanged.
+            std::pmr::vector<T> copy(other.owned_);
+            std::destroy_at(&owned_);
+            std::construct_at(&owned_, std::move(copy));
+            owner_ = other.owner_;
+            external_ = other.external_;
+            data_ = other.data_;
+            size_ = other.size_;
+            if (!external_) {
+                Reset_();
+            }
+        }
+        return *this;
+    }
+
+    ArrayBuffer &operator=(ArrayBuffer &&other) noexcept {
+        if (this != &other) {
+            // Move assignment would copy the elements if the vectors use
+            // different memory resources, so the vector is rebuilt instead
+            std::destroy_at(&owned_);
+            std::construct_at(&owned_, std::move(other.owned_));
+            Adopt_(other);
+        }
+        return *this;
+    }
+
+    // Get the number of elements in the array
+    size_t size() const { return size_; }
+
+    // Check whether the array is empty
+    bool empty() const { return size_ == 0; }
+
+    // Get a pointer to the first element of the array
+    const T *data() const { return data_; }
+
+    // Get the element at a specific index in the array
+    const T &operator[](size_t index) const { return data_[index]; }
+
+    // Get the last element of the array
+    const T &back() const { return data_[size_ - 1]; }
+
+    // Iterators over the elements of the array
+    const T *begin() const { return data_; }
+    const T *end() const { return data_ + size_; }
+
+    // View the elements of the array as a span
+    operator std::span<const T>() const { return {data_, size_}; }
+
+    // Check whether the elements are owned by another object
+    bool IsExternal() const { return external_; }
+
+    // Get the number of bytes allocated for the owned elements, including
+    // spare capacity, or zero for external memory
+    size_t GetOwnedBytes() const { return owned_.capacity() * sizeof(T); }
+
+    // Get the memory resource of the owned elements
+    std::pmr::memory_resource *GetMemoryResource() const {
+        return owned_.get_allocator().resource();
+    }
+
+    /**
+     * @brief Empty the array and return its storage for reuse.
+     *
+     * The returned vector is empty but keeps the capacity of the owned
+     * elements if they were allocated from `resource`. Otherwise, e.g. for
+     * external memory, a new empty vector using `resource` is returned.
+     *
+     * @param resource The memory resource the storage must use.
+     * @return The storage of the array.
+     */
+    std::pmr::vector<T> Release(std::pmr::memory_resource *resource) {
+        std::pmr::vector<T> storage(resource);
+        if (!external_ && *owned_.get_allocator().resource() == *resource) {
+            storage = std::move(owned_);
+            storage.clear();
+        }
+        *this = ArrayBuffer(std::pmr::vector<T>(resource));
+        return storage;
+    }
+
+  private:
+    // Point the view at the owned vector
+    void Reset_() {
+        data_ = owned_.data();
+        size_ = owned_.size();
+    }
+
+    // Take the view of `other`, whose owned vector was moved into ours
+    void Adopt_(ArrayBuffer &other) {
+        owner_ = std::move(other.owner_);
+        external_ = other.external_;
+        data_ = other.data_;
+        size_ = other.size_;
+        if (!external_) {
+            Reset_();
+        }
+        other.owned_.clear();
+        other.external_ = false;
+        other.Reset_();
+    }
+
+    std::pmr::vector<T> owned_;
+    std::shared_ptr<const void> owner_;
+    bool external_ = false;
+    const T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}; // namespace Plaquette
@@ -1,55 +1,2131 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/stl/filesystem.h>
 
+#include "ClusterGrowth.hpp"
+#include "CompressedSparseGraph.hpp"
 #include "DecodingGraph.hpp"
+#include "DetectorErrorModel.hpp"
+#include "Generators.hpp"
+#include "Hypergraph.hpp"
+#include "Instrumentation.hpp"
 #include "MultiGraph.hpp"
+#include "Reordering.hpp"
+#include "Serialization.hpp"
+#include "ShortestPaths.hpp"
 #include "SparseGraph.hpp"
+#include "SyndromeBatch.hpp"
+#include "WindowedDecodingGraph.hpp"
 
 namespace {
 using namespace Plaquette;
 namespace py = pybind11;
 
+/**
+ * @brief Wrap an array owned by a graph in a read-only NumPy array.
+ *
+ * The NumPy array does not copy the data and holds a reference to `owner`,
+ * so the graph outlives every view of its arrays.
+ *
+ * @param data Pointer to the first element of the C-contiguous array.
+ * @param shape The shape of the array.
+ * @param owner The Python object owning the data.
+ * @return The read-only NumPy array.
+ */
+template <typename T>
+py::array_t<T> MakeReadOnlyArray(const T *data,
+                                 std::vector<py::ssize_t> shape,
+                                 py::handle owner) {
+    py::array_t<T> array(std::move(shape), data, owner);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+/**
+ * @brief Move a vector into a NumPy array that takes ownership of it.
+ *
+ * @param data The vector to move.
+ * @param shape The shape of the array.
+ * @return The NumPy array, which frees the vector once garbage collected.
+ */
+template <typename T>
+py::array_t<T> MoveToArray(std::vector<T> &&data,
+                           std::vector<py::ssize_t> shape) {
+    auto *owned = new std::vector<T>(std::move(data));
+    py::capsule free_when_done(owned, [](void *ptr) {
+        delete static_cast<std::vector<T> *>(ptr);
+    });
+    return py::array_t<T>(std::move(shape), owned->data(), free_when_done);
+}
+
+/**
+ * @brief View the elements of a C-contiguous NumPy array as a span.
+ */
+template <typename T, int ExtraFlags>
+std::span<const T> AsSpan(const py::array_t<T, ExtraFlags> &array) {
+    return {array.data(), static_cast<size_t>(array.size())};
+}
+
+/**
+ * @brief Convert the results of a batch of row queries to a tuple of
+ * `(offsets, values)` NumPy arrays without copying them.
+ */
+template <typename IndexT>
+py::tuple RaggedRowsToTuple(RaggedRows<IndexT> rows) {
+    auto num_offsets = static_cast<py::ssize_t>(rows.offsets.size());
+    auto num_values = static_cast<py::ssize_t>(rows.values.size());
+    return py::make_tuple(MoveToArray(std::move(rows.offsets), {num_offsets}),
+                          MoveToArray(std::move(rows.values), {num_values}));
+}
+
+/**
+ * @brief Call `fn` with a FlatEdgeList viewing an `(E, 2)` integer array.
+ *
+ * C-contiguous arrays of 32- or 64-bit integers are read in place, without
+ * any conversion. Other integer arrays are first converted to int64.
+ *
+ * @param edges The NumPy array of edges.
+ * @param fn The callable to invoke with the edge list.
+ * @return The result of `fn`.
+ */
+template <typename Fn> auto WithFlatEdgeList(const py::array &edges, Fn &&fn) {
+    if (edges.ndim() != 2 || edges.shape(1) != 2) {
+        throw py::value_error("edges must be an array of shape (E, 2)");
+    }
+    const char kind = edges.dtype().kind();
+    if (kind != 'i' && kind != 'u') {
+        throw py::type_error("edges must be an array of integers");
+    }
+
+    auto visit = [&](auto tag) {
+        using T = decltype(tag);
+        auto array =
+            py::array_t<T, py::array::c_style | py::array::forcecast>::ensure(
+                edges);
+        if (!array) {
+            throw py::error_already_set();
+        }
+        return fn(FlatEdgeList<T>(array.data(),
+                                  static_cast<size_t>(array.shape(0))));
+    };
+
+    const auto itemsize = edges.dtype().itemsize();
+    if (kind == 'u' && itemsize == 4) {
+        return visit(uint32_t{});
+    }
+    if (kind == 'u' && itemsize == 8) {
+        return visit(uint64_t{});
+    }
+    if (kind == 'i' && itemsize == 4) {
+        return visit(int32_t{});
+    }
+    return visit(int64_t{});
+}
+
+template <typename IndexT>
+using IndexArray =
+    py::array_t<IndexT, py::array::c_style | py::array::forcecast>;
+
+/**
+ * @brief Convert the indices of a batch query to a C-contiguous array of
+ * `IndexT`.
+ *
+ * A plain cast would wrap negative indices, and indices too large for a
+ * 32-bit index type, around to indices that may be valid. Indices of another
+ * type are therefore read as int64 first, and those that `IndexT` cannot
+ * represent become its largest value, which is never a valid index, so that
+ * the query treats them as any other out-of-range index. Arrays of `IndexT`
+ * are used in place.
+ *
+ * @param indices An array or sequence of indices.
+ * @return The indices as an array of `IndexT`.
+ */
+template <typename IndexT>
+IndexArray<IndexT> ToIndexArray(const py::object &indices) {
+    if (py::isinstance<IndexArray<IndexT>>(indices)) {
+        return py::reinterpret_borrow<IndexArray<IndexT>>(indices);
+    }
+    auto wide = IndexArray<int64_t>::ensure(indices);
+    if (!wide) {
+        throw py::type_error("indices must be an array of integers");
+    }
+    IndexArray<IndexT> narrow(std::vector<py::ssize_t>(
+        wide.shape(), wide.shape() + wide.ndim()));
+    constexpr auto kLargest = std::numeric_limits<IndexT>::max();
+    std::transform(wide.data(), wide.data() + wide.size(),
+                   narrow.mutable_data(), [](int64_t index) {
+                       return index < 0 ||
+                                      static_cast<uint64_t>(index) > kLargest
+                                  ? kLargest
+                                  : static_cast<IndexT>(index);
+                   });
+    return narrow;
+}
+
+using WeightArray =
+    py::array_t<EdgeWeight, py::array::c_style | py::array::forcecast>;
+
+/**
+ * @brief View optional edge weights as a span, empty if there are none.
+ */
+std::span<const EdgeWeight>
+AsWeightSpan(const std::optional<WeightArray> &weights) {
+    if (!weights) {
+        return {};
+    }
+    return AsSpan(*weights);
+}
+
+/**
+ * @brief Make the construction options of a sparse graph.
+ */
+SparseGraphOptions MakeSparseGraphOptions(bool assume_unique_edges,
+                                          EdgeToEdgeMode edge_to_edge,
+                                          size_t num_threads, bool sort_rows,
+                                          bool edge_index) {
+    SparseGraphOptions options;
+    options.assume_unique_edges = assume_unique_edges;
+    options.edge_to_edge = edge_to_edge;
+    options.num_threads = num_threads;
+    options.sort_rows = sort_rows;
+    options.edge_index = edge_index;
+    return options;
+}
+
+/**
+ * @brief Make the options of a decoding graph built from a detector error
+ * model.
+ */
+DetectorErrorModel::LoadOptions
+MakeDemOptions(double weight_scale, HyperedgeDecomposition decomposition,
+               size_t num_threads, bool sort_rows, bool edge_index) {
+    DetectorErrorModel::LoadOptions options;
+    options.weight_scale = weight_scale;
+    options.decomposition = decomposition;
+    options.graph = MakeSparseGraphOptions(false, EdgeToEdgeMode::Lazy,
+                                           num_threads, sort_rows, edge_index);
+    return options;
+}
+
+using CoordinateArray =
+    py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+/**
+ * @brief Reorder the vertices and edges of a graph.
+ *
+ * @param graph The graph to reorder.
+ * @param order The order of the vertices.
+ * @param coordinates The optional `(V, D)` coordinates of the vertices.
+ * @return A `(graph, (vertex_forward, vertex_inverse), (edge_forward,
+ * edge_inverse))` tuple of the reordered graph and its permutations.
+ */
+template <typename GraphT>
+py::tuple ReorderGraph(const GraphT &graph, Reordering::VertexOrder order,
+                       const std::optional<CoordinateArray> &coordinates) {
+    std::span<const double> points;
+    size_t dimension = 0;
+    if (coordinates) {
+        if (coordinates->ndim() != 2) {
+            throw py::value_error(
+                "coordinates must be an array of shape (V, D)");
+        }
+        points = AsSpan(*coordinates);
+        dimension = static_cast<size_t>(coordinates->shape(1));
+    }
+    Reordering::ReorderedGraph<GraphT> reordered;
+    {
+        py::gil_scoped_release release;
+        reordered = Reordering::Reorder(graph, order, points, dimension);
+    }
+    auto permutation_to_tuple = [](auto &permutation) {
+        auto size = static_cast<py::ssize_t>(permutation.size());
+        return py::make_tuple(
+            MoveToArray(std::move(permutation.forward), {size}),
+            MoveToArray(std::move(permutation.inverse), {size}));
+    };
+    return py::make_tuple(std::move(reordered.graph),
+                          permutation_to_tuple(reordered.vertices),
+                          permutation_to_tuple(reordered.edges));
+}
+
+/**
+ * @brief Convert construction timings to a dict of seconds per phase.
+ */
+py::dict TimingsToDict(const ConstructionTimings &timings) {
+    py::dict dict;
+    dict["deduplicate_edges"] = timings.deduplicate_edges;
+    dict["vertex_to_vertex"] = timings.vertex_to_vertex;
+    dict["edge_index"] = timings.edge_index;
+    dict["edge_to_edge"] = timings.edge_to_edge;
+    dict["local_edge_maps"] = timings.local_edge_maps;
+    return dict;
+}
+
+/**
+ * @brief Convert a memory footprint to a dict mapping the name of every array
+ * to a dict of its `bytes`, `capacity_bytes` and `external` flag.
+ */
+py::dict FootprintToDict(const MemoryFootprint &footprint) {
+    py::dict dict;
+    for (const auto &array : footprint.arrays) {
+        py::dict entry;
+        entry["bytes"] = array.bytes;
+        entry["capacity_bytes"] = array.capacity_bytes;
+        entry["external"] = array.external;
+        dict[py::str(array.name)] = entry;
+    }
+    return dict;
+}
+
+/**
+ * @brief Convert query counts to a dict of counts per kind of query.
+ */
+py::dict CountsToDict(const QueryCounts &counts) {
+    py::dict dict;
+    dict["vertex_rows"] = counts.vertex_rows;
+    dict["edge_rows"] = counts.edge_rows;
+    dict["edge_endpoints"] = counts.edge_endpoints;
+    dict["vertex_pairs"] = counts.vertex_pairs;
+    dict["vertex_pair_misses"] = counts.vertex_pair_misses;
+    return dict;
+}
+
+/**
+ * @brief Wrap a query on a vertex, edge or local edge, which is not
+ * range-checked in C++, with a range check.
+ *
+ * @tparam Object The class answering the query, const for const queries.
+ * @param query The member function answering the query.
+ * @param count The member function, or function of the object, returning the
+ * number of valid indices.
+ * @param what The kind of index, used in the error message.
+ * @return A function of the object and index raising IndexError for an
+ * index out of range.
+ */
+template <typename Object, typename Query, typename Count>
+auto CheckedQuery(Query query, Count count, const char *what) {
+    return [query, count, what](Object &object, size_t index) {
+        if (index >= std::invoke(count, object)) {
+            throw std::out_of_range(std::string(what) + " out of range");
+        }
+        return std::invoke(query, object, index);
+    };
+}
+
+/**
+ * @brief Version of the state returned by `__getstate__`, which is a
+ * `(version, num_vertices, sorted_rows, edge_index, arrays)` tuple.
+ */
+constexpr int kPickleVersion = 1;
+
+/**
+ * @brief Check the version and size of a pickled graph state.
+ */
+void CheckPickleState(const py::tuple &state) {
+    if (state.size() != 5 || state[0].cast<int>() != kPickleVersion) {
+        throw py::value_error("unsupported pickled graph state");
+    }
+}
+
+/**
+ * @brief Adopt NumPy arrays as `ArrayBuffer`s without copying them.
+ *
+ * Arrays of the element type in C order are used in place and others are
+ * converted first. The arrays, and an optional owner such as the shared
+ * memory block they view, are kept alive until the last `ArrayBuffer`
+ * adopting them is destroyed, which may happen without holding the GIL.
+ */
+class ArrayAdopter {
+  public:
+    ArrayAdopter(py::dict arrays, py::object owner)
+        : arrays_(std::move(arrays)),
+          held_(new py::list(), [](py::list *held) {
+              py::gil_scoped_acquire acquire;
+              delete held;
+          }) {
+        held_->append(std::move(owner));
+    }
+
+    /**
+     * @brief Adopt a one-dimensional array.
+     *
+     * @param name The key of the array.
+     * @param required Throw if the array is missing instead of returning an
+     * empty array.
+     * @return The adopted array.
+     * @throws py::value_error if the array is missing or is not
+     * one-dimensional.
+     */
+    template <typename T>
+    ArrayBuffer<T> Adopt(const char *name, bool required = true) {
+        return Adopt_<T, T>(name, 1, required);
+    }
+
+    // Adopt an (N, 2) array as an array of N pairs
+    template <typename IndexT>
+    ArrayBuffer<std::pair<IndexT, IndexT>> AdoptPairs(const char *name) {
+        return Adopt_<std::pair<IndexT, IndexT>, IndexT>(name, 2, true);
+    }
+
+  private:
+    template <typename T, typename Element>
+    ArrayBuffer<T> Adopt_(const char *name, py::ssize_t columns,
+                          bool required) {
+        if (!arrays_.contains(name)) {
+            if (required) {
+                throw py::value_error(std::string("missing array ") + name);
+            }
+            return {};
+        }
+        py::object value = arrays_[name];
+        auto array = py::array_t<Element, py::array::c_style |
+                                              py::array::forcecast>::
+            ensure(value);
+        if (!array) {
+            throw py::type_error(std::string("array ") + name +
+                                 " cannot be converted to the element type");
+        }
+        if (columns == 1 ? array.ndim() != 1
+                         : array.ndim() != 2 || array.shape(1) != columns) {
+            throw py::value_error(std::string("array ") + name +
+                                  " has the wrong shape");
+        }
+        held_->append(array);
+        return ArrayBuffer<T>(reinterpret_cast<const T *>(array.data()),
+                              static_cast<size_t>(array.size() / columns),
+                              held_);
+    }
+
+    py::dict arrays_;
+    std::shared_ptr<py::list> held_;
+};
+
+/**
+ * @brief Register the SparseGraphRow, SparseGraph and DecodingGraph classes
+ * for a given index type.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param m The module to register the classes in.
+ * @param row_name Python name of the row class.
+ * @param implicit_row_name Python name of the implicit edge row class.
+ * @param graph_name Python name of the sparse graph class.
+ * @param decoding_graph_name Python name of the decoding graph class.
+ * @param shortest_paths_name Python name of the shortest-path engine class.
+ * @param cluster_growth_name Python name of the cluster growth class.
+ * @param syndrome_batch_name Python name of the syndrome batch class.
+ * @param windowed_graph_name Python name of the sliding-window decoding
+ * graph class.
+ */
+template <typename IndexT>
+void RegisterSparseGraphs(py::module_ &m, const char *row_name,
+                          const char *implicit_row_name,
+                          const char *graph_name,
+                          const char *decoding_graph_name,
+                          const char *shortest_paths_name,
+                          const char *cluster_growth_name,
+                          const char *syndrome_batch_name,
+                          const char *windowed_graph_name) {
+    using Row = SparseGraphRow<IndexT>;
+    using ImplicitRow = ImplicitEdgeRow<IndexT>;
+    using Graph = SparseGraph<IndexT>;
+    using DGraph = DecodingGraph<IndexT>;
+    using Edge = typename Graph::edge_type;
+
+    static_assert(sizeof(Edge) == 2 * sizeof(IndexT) &&
+                      std::is_standard_layout_v<Edge>,
+                  "edge pairs must be viewable as an (E, 2) array");
+
+    // Batch query returning the concatenated rows of a batch of vertices
+    auto vertex_rows = [](RaggedRows<IndexT> (Graph::*query)(
+                              std::span<const IndexT>) const) {
+        return [query](const Graph &graph, const py::object &indices) {
+            const auto vertices = ToIndexArray<IndexT>(indices);
+            RaggedRows<IndexT> rows;
+            {
+                py::gil_scoped_release release;
+                rows = (graph.*query)(AsSpan(vertices));
+            }
+            return RaggedRowsToTuple(std::move(rows));
+        };
+    };
+
+    // Property getter returning a read-only NumPy view of a graph array
+    auto array_view = [](std::span<const IndexT> (Graph::*getter)() const) {
+        return [getter](py::object self) {
+            const auto &graph = self.cast<const Graph &>();
+            std::span<const IndexT> data;
+            {
+                // The edge-edge arrays may be constructed on first access
+                py::gil_scoped_release release;
+                data = (graph.*getter)();
+            }
+            return MakeReadOnlyArray(
+                data.data(), {static_cast<py::ssize_t>(data.size())}, self);
+        };
+    };
+
+    // Read-only views of the arrays of a graph, keyed by name. The edge-edge
+    // arrays are included only if the matrix is constructed.
+    auto graph_arrays = [](py::object self) {
+        const auto &graph = self.cast<const Graph &>();
+        py::dict arrays;
+        auto add = [&](const char *name, auto data) {
+            arrays[name] = MakeReadOnlyArray(
+                data.data(), {static_cast<py::ssize_t>(data.size())}, self);
+        };
+        add("v_to_v_row_ptr", graph.GetVertexToVertexRowPtr());
+        add("v_to_v_col", graph.GetVertexToVertexCol());
+        add("v_to_v_edges", graph.GetVertexToVertexEdges());
+        auto e_to_v = graph.GetEdgeToVertex();
+        arrays["e_to_v"] = MakeReadOnlyArray(
+            reinterpret_cast<const IndexT *>(e_to_v.data()),
+            {static_cast<py::ssize_t>(e_to_v.size()), 2}, self);
+        if (graph.HasEdgeWeights()) {
+            add("edge_weights", graph.GetEdgeWeights());
+        }
+        if (graph.IsEdgeToEdgeMatrixConstructed()) {
+            add("e_to_e_row_ptr", graph.GetEdgeToEdgeRowPtr());
+            add("e_to_e_col", graph.GetEdgeToEdgeCol());
+        }
+        return arrays;
+    };
+
+    // Adopt the arrays returned by graph_arrays
+    auto adopt_graph_arrays = [](ArrayAdopter &adopter, bool sorted_rows) {
+        SparseGraphArrays<IndexT> arrays;
+        arrays.v_to_v_row_ptr = adopter.Adopt<IndexT>("v_to_v_row_ptr");
+        arrays.v_to_v_col = adopter.Adopt<IndexT>("v_to_v_col");
+        arrays.v_to_v_edges = adopter.Adopt<IndexT>("v_to_v_edges");
+        arrays.e_to_v = adopter.AdoptPairs<IndexT>("e_to_v");
+        arrays.e_to_e_row_ptr = adopter.Adopt<IndexT>("e_to_e_row_ptr", false);
+        arrays.e_to_e_col = adopter.Adopt<IndexT>("e_to_e_col", false);
+        arrays.edge_weights = adopter.Adopt<EdgeWeight>("edge_weights", false);
+        arrays.sorted_rows = sorted_rows;
+        return arrays;
+    };
+
+    auto graph_from_arrays = [adopt_graph_arrays](
+                                 size_t num_vertices, py::dict arrays,
+                                 bool sorted_rows, bool edge_index,
+                                 py::object owner) {
+        ArrayAdopter adopter(std::move(arrays), std::move(owner));
+        auto graph = Graph::FromArrays(
+            num_vertices, adopt_graph_arrays(adopter, sorted_rows));
+        if (edge_index) {
+            py::gil_scoped_release release;
+            graph.BuildEdgeIndex();
+        }
+        return graph;
+    };
+
+    // The state of a pickled graph, whose arrays are pickled as NumPy views
+    // and therefore as out-of-band buffers with pickle protocol 5
+    auto graph_state = [](py::object self, py::dict arrays) {
+        const auto &graph = self.cast<const Graph &>();
+        return py::make_tuple(kPickleVersion, graph.GetNumVertices(),
+                              graph.AreRowsSorted(), graph.HasEdgeIndex(),
+                              std::move(arrays));
+    };
+
+    pybind11::class_<Row>(m, row_name,
+                          "A lightweight container for a row of the "
+                          "SparseGraph Adjacency matrix. Rows support the "
+                          "buffer protocol, so numpy.asarray(row) is a "
+                          "read-only view of the row.",
+                          py::buffer_protocol())
+        .def_buffer([](Row &row) -> py::buffer_info {
+            return py::buffer_info(const_cast<IndexT *>(row.begin()),
+                                   static_cast<py::ssize_t>(row.size()),
+                                   /*readonly=*/true);
+        })
+        .def("size", &Row::size, "Return the number of entries in the row.")
+        .def(
+            "__getitem__",
+            [](const Row &obj, int index) {
+                if (index < 0 || static_cast<size_t>(index) >= obj.size()) {
+                    throw pybind11::index_error();
+                }
+                return obj[index];
+            },
+            "Get the value at the given index in the row.")
+        .def("__len__", &Row::size,
+             "Return the number of entries in the row.");
+
+    pybind11::class_<ImplicitRow>(m, implicit_row_name,
+                                  "A row of the SparseGraph edge-edge "
+                                  "adjacency matrix computed on the fly.")
+        .def("size", &ImplicitRow::size,
+             "Return the number of entries in the row.")
+        .def(
+            "__getitem__",
+            [](const ImplicitRow &obj, int index) {
+                if (index < 0 || static_cast<size_t>(index) >= obj.size()) {
+                    throw pybind11::index_error();
+                }
+                return obj[index];
+            },
+            "Get the value at the given index in the row.")
+        .def(
+            "__iter__",
+            [](const ImplicitRow &obj) {
+                return py::make_iterator(obj.begin(), obj.end());
+            },
+            py::keep_alive<0, 1>(), "Iterate over the entries in the row.")
+        .def("__len__", &ImplicitRow::size,
+             "Return the number of entries in the row.");
+
+    pybind11::class_<Graph>(m, graph_name,
+                            "A sparse graph represented by an adjacency list.")
+        .def(py::init([](size_t num_vertices, const py::array &edges,
+                         const std::optional<WeightArray> &weights,
+                         bool assume_unique_edges, EdgeToEdgeMode edge_to_edge,
+                         size_t num_threads, bool sort_rows, bool edge_index) {
+                 auto options = MakeSparseGraphOptions(
+                     assume_unique_edges, edge_to_edge, num_threads, sort_rows,
+                     edge_index);
+                 auto weight_span = AsWeightSpan(weights);
+                 return WithFlatEdgeList(edges, [&](const auto &edge_list) {
+                     py::gil_scoped_release release;
+                     return Graph(num_vertices, edge_list, weight_span,
+                                  options);
+                 });
+             }),
+             "Construct a sparse graph from an (E, 2) NumPy array of edges. "
+             "Arrays of 32- or 64-bit integers in C order are read without "
+             "being copied.",
+             py::arg("num_vertices"), py::arg("edges"), py::kw_only(),
+             py::arg("weights") = py::none(),
+             py::arg("assume_unique_edges") = false,
+             py::arg("edge_to_edge") = EdgeToEdgeMode::Lazy,
+             py::arg("num_threads") = 1, py::arg("sort_rows") = false,
+             py::arg("edge_index") = false)
+        .def(py::init([](size_t num_vertices,
+                         const std::vector<std::pair<size_t, size_t>> &edges,
+                         const std::optional<WeightArray> &weights,
+                         bool assume_unique_edges, EdgeToEdgeMode edge_to_edge,
+                         size_t num_threads, bool sort_rows, bool edge_index) {
+                 auto weight_span = AsWeightSpan(weights);
+                 py::gil_scoped_release release;
+                 return Graph(num_vertices, edges, weight_span,
+                              MakeSparseGraphOptions(
+                                  assume_unique_edges, edge_to_edge,
+                                  num_threads, sort_rows, edge_index));
+             }),
+             "Construct a sparse graph with the given number of vertices and "
+             "edges. The edges are represented as a list of pairs of vertex "
+             "indices, optionally with one integer weight per edge. Duplicate "
+             "edges are removed, keeping the weight of their first "
+             "occurrence, unless assume_unique_edges is True. The edge-edge "
+             "adjacency matrix is constructed on first use unless "
+             "edge_to_edge is EdgeToEdgeMode.Eager. The adjacency matrix is "
+             "built with num_threads threads (0 for one per hardware thread). "
+             "With sort_rows=True, each row of the adjacency matrix is sorted "
+             "by neighbouring vertex and searched by binary search, and with "
+             "edge_index=True, a hash index from pairs of vertices to edges "
+             "is built.",
+             py::arg("num_vertices"), py::arg("edges"), py::kw_only(),
+             py::arg("weights") = py::none(),
+             py::arg("assume_unique_edges") = false,
+             py::arg("edge_to_edge") = EdgeToEdgeMode::Lazy,
+             py::arg("num_threads") = 1, py::arg("sort_rows") = false,
+             py::arg("edge_index") = false)
+        .def("get_num_vertices", &Graph::GetNumVertices,
+             "Return the number of vertices in the graph.")
+        .def("get_num_edges", &Graph::GetNumEdges,
+             "Return the number of edges in the graph.")
+        .def("has_edge_weights", &Graph::HasEdgeWeights,
+             "Return True if the graph was constructed with edge weights.")
+        .def("get_edge_weight", &Graph::GetEdgeWeight,
+             "Return the weight of the edge with the given index, which is 1 "
+             "for every edge of an unweighted graph.",
+             py::arg("edge_index"))
+        .def("get_edges_touching_vertex", &Graph::GetEdgesTouchingVertex,
+             "Return a list of the indices of edges touching the vertex with "
+             "the given index.",
+             py::arg("vertex_index"), py::keep_alive<0, 1>())
+        .def("get_vertices_touching_vertex", &Graph::GetVerticesTouchingVertex,
+             "Return a list of the indices of vertices connected to the vertex "
+             "with the given index.",
+             py::arg("vertex_index"), py::keep_alive<0, 1>())
+        .def("get_edges_touching_edge", &Graph::GetEdgesTouchingEdge,
+             "Return a list of the indices of edges touching the edge with the "
+             "given index. The first call may construct the edge-edge "
+             "adjacency matrix, which is done without holding the GIL.",
+             py::arg("edge_index"), py::keep_alive<0, 1>(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_edges_touching_edge_implicit",
+             &Graph::GetEdgesTouchingEdgeImplicit,
+             "Return the indices of edges touching the edge with the given "
+             "index, computed on the fly without the edge-edge adjacency "
+             "matrix.",
+             py::arg("edge_index"), py::keep_alive<0, 1>())
+        .def("are_rows_sorted", &Graph::AreRowsSorted,
+             "Return True if each row of the vertex-vertex adjacency matrix "
+             "is sorted by neighbouring vertex.")
+        .def("has_edge_index", &Graph::HasEdgeIndex,
+             "Return True if the graph has a hash index from pairs of "
+             "vertices to edges.")
+        .def("build_edge_index", &Graph::BuildEdgeIndex,
+             "Build a hash index from pairs of vertices to edges, which "
+             "answers get_edges_from_vertex_pairs in constant time per pair.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("is_edge_to_edge_matrix_constructed",
+             &Graph::IsEdgeToEdgeMatrixConstructed,
+             "Return True if the edge-edge adjacency matrix has been "
+             "constructed.")
+        .def("get_vertices_connected_by_edge",
+             &Graph::GetVerticesConnectedByEdge,
+             "Return a list of the indices of vertices connected by the edge "
+             "with the given index.",
+             py::arg("edge_index"))
+        .def("get_edges_touching_vertices",
+             vertex_rows(&Graph::GetEdgesTouchingVertices),
+             "Return the edges touching each vertex of an array of vertex "
+             "indices, as a tuple of (offsets, values) arrays: the edges of "
+             "vertices[i] are values[offsets[i]:offsets[i + 1]].",
+             py::arg("vertices"))
+        .def("get_vertices_touching_vertices",
+             vertex_rows(&Graph::GetVerticesTouchingVertices),
+             "Return the vertices connected to each vertex of an array of "
+             "vertex indices, as a tuple of (offsets, values) arrays: the "
+             "neighbours of vertices[i] are values[offsets[i]:offsets[i + 1]].",
+             py::arg("vertices"))
+        .def(
+            "get_vertices_connected_by_edges",
+            [](const Graph &graph, const py::object &indices) {
+                const auto edges = ToIndexArray<IndexT>(indices);
+                py::array_t<IndexT> out({edges.size(), py::ssize_t{2}});
+                std::span<IndexT> result(out.mutable_data(), out.size());
+                {
+                    py::gil_scoped_release release;
+                    graph.GetVerticesConnectedByEdges(AsSpan(edges), result);
+                }
+                return out;
+            },
+            "Return an (N, 2) array of the vertices connected by each edge of "
+            "an array of edge indices.",
+            py::arg("edges"))
+        .def(
+            "get_edges_from_vertex_pairs",
+            [](const Graph &graph, const py::object &indices) {
+                const auto vertex_pairs = ToIndexArray<IndexT>(indices);
+                if (vertex_pairs.ndim() != 2 || vertex_pairs.shape(1) != 2) {
+                    throw py::value_error(
+                        "vertex_pairs must be an array of shape (N, 2)");
+                }
+                py::array_t<IndexT> out(vertex_pairs.shape(0));
+                std::span<IndexT> result(out.mutable_data(), out.size());
+                {
+                    py::gil_scoped_release release;
+                    graph.GetEdgesFromVertexPairs(AsSpan(vertex_pairs), result);
+                }
+                return out;
+            },
+            "Return the index of the edge connecting each pair of an (N, 2) "
+            "array of vertex pairs. Pairs that are not connected by an edge "
+            "map to the largest value of the index type.",
+            py::arg("vertex_pairs"))
+        .def_property_readonly(
+            "v_to_v_row_ptr", array_view(&Graph::GetVertexToVertexRowPtr),
+            "Read-only view of the row pointers of the vertex-vertex "
+            "adjacency matrix (CSR format).")
+        .def_property_readonly(
+            "v_to_v_col", array_view(&Graph::GetVertexToVertexCol),
+            "Read-only view of the neighbouring vertex of every entry of the "
+            "vertex-vertex adjacency matrix.")
+        .def_property_readonly(
+            "v_to_v_edges", array_view(&Graph::GetVertexToVertexEdges),
+            "Read-only view of the edge index of every entry of the "
+            "vertex-vertex adjacency matrix.")
+        .def_property_readonly(
+            "e_to_v",
+            [](py::object self) {
+                auto data = self.cast<const Graph &>().GetEdgeToVertex();
+                return MakeReadOnlyArray(
+                    reinterpret_cast<const IndexT *>(data.data()),
+                    {static_cast<py::ssize_t>(data.size()), 2}, self);
+            },
+            "Read-only (E, 2) view of the endpoints of every edge.")
+        .def_property_readonly(
+            "edge_weights",
+            [](py::object self) -> py::object {
+                auto data = self.cast<const Graph &>().GetEdgeWeights();
+                if (data.empty()) {
+                    return py::none();
+                }
+                return MakeReadOnlyArray(
+                    data.data(), {static_cast<py::ssize_t>(data.size())}, self);
+            },
+            "Read-only view of the weight of every edge, or None if the graph "
+            "is unweighted.")
+        .def_property_readonly(
+            "e_to_e_row_ptr", array_view(&Graph::GetEdgeToEdgeRowPtr),
+            "Read-only view of the row pointers of the edge-edge adjacency "
+            "matrix, which is constructed on first use.")
+        .def_property_readonly(
+            "e_to_e_col", array_view(&Graph::GetEdgeToEdgeCol),
+            "Read-only view of the neighbouring edges of every edge in the "
+            "edge-edge adjacency matrix, which is constructed on first use.")
+        .def(
+            "save",
+            [](const Graph &graph, const std::filesystem::path &path) {
+                py::gil_scoped_release release;
+                Serialization::SaveGraph(graph, path.string());
+            },
+            "Save the graph to a binary file, which can be loaded with "
+            "load_graph. The edge-edge adjacency matrix is saved if it has "
+            "been constructed.",
+            py::arg("path"))
+        .def(
+            "reordered",
+            [](const Graph &graph, Reordering::VertexOrder order,
+               const std::optional<CoordinateArray> &coordinates) {
+                return ReorderGraph(graph, order, coordinates);
+            },
+            "Return a copy of the graph whose vertices are renumbered in the "
+            "given order and whose edges are renumbered in the order they "
+            "are met in the new rows, which keeps neighbouring vertices and "
+            "edges close in memory. The Morton order needs the (V, D) "
+            "coordinates of the vertices, with D from 1 to 3. Return a "
+            "(graph, vertices, edges) tuple, where vertices and edges are "
+            "(forward, inverse) pairs of arrays mapping old IDs to new ones "
+            "and new IDs to old ones.",
+            py::arg("order") = Reordering::VertexOrder::ReverseCuthillMcKee,
+            py::kw_only(), py::arg("coordinates") = py::none())
+        .def(
+            "get_construction_timings",
+            [](const Graph &graph) {
+                return TimingsToDict(graph.GetConstructionTimings());
+            },
+            "Return a dict of the seconds spent in each phase of the "
+            "construction of the graph: deduplicate_edges, vertex_to_vertex, "
+            "edge_index, edge_to_edge and local_edge_maps. Phases that did "
+            "not run take zero seconds.")
+        .def(
+            "get_memory_footprint",
+            [](const Graph &graph) {
+                return FootprintToDict(graph.GetMemoryFootprint());
+            },
+            "Return a dict mapping the name of every array of the graph to a "
+            "dict of its size in bytes, the bytes allocated for it "
+            "(capacity_bytes, zero for memory-mapped arrays) and whether it "
+            "is external. The edge-edge arrays are listed once constructed.")
+        .def(
+            "get_query_counts",
+            [](const Graph &graph) {
+                return CountsToDict(graph.GetQueryCounts());
+            },
+            "Return a dict of the number of queries answered by the graph, "
+            "by kind. The counts are all zero unless the library is built "
+            "with PLAQUETTE_GRAPH_ENABLE_COUNTERS (see "
+            "query_counters_enabled).")
+        .def("reset_query_counts", &Graph::ResetQueryCounts,
+             "Set the query counts to zero.")
+        .def("get_arrays", graph_arrays,
+             "Return a dict of read-only NumPy views of the arrays of the "
+             "graph, which can be passed to from_arrays. The edge-edge arrays "
+             "are included once constructed, and the edge weights for a "
+             "weighted graph.")
+        .def_static("from_arrays", graph_from_arrays,
+                    "Assemble a graph from arrays returned by get_arrays "
+                    "without copying them or doing any construction work. "
+                    "Arrays of the index type in C order are used in place, "
+                    "e.g. views of a multiprocessing.shared_memory block, and "
+                    "are kept alive by the graph together with owner. One "
+                    "linear pass checks that the sizes of the arrays agree, "
+                    "that the row pointers never decrease and that every "
+                    "vertex and edge index is in range, and raises "
+                    "ValueError otherwise. With edge_index=True, the hash "
+                    "index from pairs of vertices to edges is rebuilt.",
+                    py::arg("num_vertices"), py::arg("arrays"), py::kw_only(),
+                    py::arg("sorted_rows") = false,
+                    py::arg("edge_index") = false,
+                    py::arg("owner") = py::none())
+        .def(py::pickle(
+            [graph_arrays, graph_state](py::object self) {
+                return graph_state(self, graph_arrays(self));
+            },
+            [graph_from_arrays](const py::tuple &state) {
+                CheckPickleState(state);
+                return graph_from_arrays(
+                    state[1].cast<size_t>(), state[4].cast<py::dict>(),
+                    state[2].cast<bool>(), state[3].cast<bool>(), py::none());
+            }));
+
+    // Static factory of the space-time graph of a code family
+    auto code_graph = [](Generators::SpaceTimeLayout (*layout)(size_t)) {
+        return [layout](size_t distance, size_t rounds, bool diagonal_edges,
+                        EdgeWeight space_weight, EdgeWeight time_weight,
+                        EdgeWeight diagonal_weight) {
+            py::gil_scoped_release release;
+            return Generators::SpaceTimeGraph<IndexT>(
+                layout(distance),
+                {rounds, diagonal_edges, space_weight, time_weight,
+                 diagonal_weight});
+        };
+    };
+
+    // The arrays of a decoding graph, including those of its base graph
+    auto decoding_graph_arrays = [graph_arrays](py::object self) {
+        const auto &graph = self.cast<const DGraph &>();
+        py::dict arrays = graph_arrays(self);
+        auto add = [&](const char *name, auto data) {
+            arrays[name] = MakeReadOnlyArray(
+                data.data(), {static_cast<py::ssize_t>(data.size())}, self);
+        };
+        add("vertex_boundary_type", graph.GetVertexBoundaryTypes());
+        add("local_edge_strides", graph.GetLocalEdgeStrides());
+        add("local_to_global_edge_map", graph.GetLocalToGlobalEdgeMap());
+        add("global_to_local_edge_map", graph.GetGlobalToLocalEdgeMap());
+        return arrays;
+    };
+
+    auto decoding_graph_from_arrays =
+        [adopt_graph_arrays](size_t num_vertices, py::dict arrays,
+                             bool sorted_rows, bool edge_index,
+                             py::object owner) {
+            ArrayAdopter adopter(std::move(arrays), std::move(owner));
+            auto sparse_arrays = adopt_graph_arrays(adopter, sorted_rows);
+            DecodingGraphArrays<IndexT> decoding_arrays;
+            decoding_arrays.vertex_boundary_type =
+                adopter.Adopt<uint8_t>("vertex_boundary_type");
+            decoding_arrays.local_edge_strides =
+                adopter.Adopt<IndexT>("local_edge_strides");
+            decoding_arrays.local_to_global_edge_map =
+                adopter.Adopt<IndexT>("local_to_global_edge_map");
+            decoding_arrays.global_to_local_edge_map =
+                adopter.Adopt<IndexT>("global_to_local_edge_map");
+            auto graph = DGraph::FromArrays(num_vertices,
+                                            std::move(sparse_arrays),
+                                            std::move(decoding_arrays));
+            if (edge_index) {
+                py::gil_scoped_release release;
+                graph.BuildEdgeIndex();
+            }
+            return graph;
+        };
+
+    pybind11::class_<DGraph, Graph>(
+        m, decoding_graph_name,
+        "A decoding graph represented by an adjacency list.")
+        .def(py::init([](size_t num_vertices, const py::array &edges,
+                         const std::vector<bool> &boundary_vertices,
+                         const std::optional<WeightArray> &weights,
+                         bool assume_unique_edges, EdgeToEdgeMode edge_to_edge,
+                         size_t num_threads, bool sort_rows, bool edge_index) {
+                 auto options = MakeSparseGraphOptions(
+                     assume_unique_edges, edge_to_edge, num_threads, sort_rows,
+                     edge_index);
+                 auto weight_span = AsWeightSpan(weights);
+                 return WithFlatEdgeList(edges, [&](const auto &edge_list) {
+                     py::gil_scoped_release release;
+                     return DGraph(num_vertices, edge_list, weight_span,
+                                   boundary_vertices, options);
+                 });
+             }),
+             "Construct a decoding graph from an (E, 2) NumPy array of edges. "
+             "Arrays of 32- or 64-bit integers in C order are read without "
+             "being copied.",
+             py::arg("num_vertices"), py::arg("edges"),
+             py::arg("boundary_vertices"), py::kw_only(),
+             py::arg("weights") = py::none(),
+             py::arg("assume_unique_edges") = false,
+             py::arg("edge_to_edge") = EdgeToEdgeMode::Lazy,
+             py::arg("num_threads") = 1, py::arg("sort_rows") = false,
+             py::arg("edge_index") = false)
+        .def(py::init([](size_t num_vertices,
+                         const std::vector<std::pair<size_t, size_t>> &edges,
+                         const std::vector<bool> &boundary_vertices,
+                         const std::optional<WeightArray> &weights,
+                         bool assume_unique_edges, EdgeToEdgeMode edge_to_edge,
+                         size_t num_threads, bool sort_rows, bool edge_index) {
+                 auto weight_span = AsWeightSpan(weights);
+                 py::gil_scoped_release release;
+                 return DGraph(num_vertices, edges, weight_span,
+                               boundary_vertices,
+                               MakeSparseGraphOptions(
+                                   assume_unique_edges, edge_to_edge,
+                                   num_threads, sort_rows, edge_index));
+             }),
+             "Construct a decoding graph with the given number of vertices, "
+             "edges, and boundary vertices. The edges are represented as a "
+             "list of pairs of vertex indices, optionally with one integer "
+             "weight per edge. The boundary vertices are represented as a "
+             "list of booleans, with True indicating a boundary vertex. "
+             "Duplicate edges are removed, keeping the weight of their first "
+             "occurrence, unless assume_unique_edges is True. The edge-edge "
+             "adjacency matrix is constructed on first use unless "
+             "edge_to_edge is EdgeToEdgeMode.Eager. The adjacency matrix is "
+             "built with num_threads threads (0 for one per hardware thread). "
+             "With sort_rows=True, each row of the adjacency matrix is sorted "
+             "by neighbouring vertex and searched by binary search, and with "
+             "edge_index=True, a hash index from pairs of vertices to edges "
+             "is built.",
+             py::arg("num_vertices"), py::arg("edges"),
+             py::arg("boundary_vertices"), py::kw_only(),
+             py::arg("weights") = py::none(),
+             py::arg("assume_unique_edges") = false,
+             py::arg("edge_to_edge") = EdgeToEdgeMode::Lazy,
+             py::arg("num_threads") = 1, py::arg("sort_rows") = false,
+             py::arg("edge_index") = false)
+        .def_static(
+            "space_time",
+            [](size_t detectors_per_round,
+               std::vector<std::pair<size_t, size_t>> space_edges,
+               size_t rounds, bool diagonal_edges, EdgeWeight space_weight,
+               EdgeWeight time_weight, EdgeWeight diagonal_weight) {
+                py::gil_scoped_release release;
+                return Generators::SpaceTimeGraph<IndexT>(
+                    {detectors_per_round, std::move(space_edges)},
+                    {rounds, diagonal_edges, space_weight, time_weight,
+                     diagonal_weight});
+            },
+            "Build the decoding graph of a code measured over several rounds "
+            "from the space edges of one round, where detectors_per_round "
+            "stands for the boundary vertex. Detector d of round r is vertex "
+            "r * detectors_per_round + d and the boundary vertex is the last "
+            "vertex. Consecutive rounds are connected by a time-like edge per "
+            "detector and, with diagonal_edges=True, by an edge from u to v "
+            "in the next round for every space edge (u, v) between two "
+            "detectors. The adjacency matrix and local edge maps are written "
+            "directly, without an intermediate edge list.",
+            py::arg("detectors_per_round"), py::arg("space_edges"),
+            py::arg("rounds") = 1, py::kw_only(),
+            py::arg("diagonal_edges") = false, py::arg("space_weight") = 1,
+            py::arg("time_weight") = 1, py::arg("diagonal_weight") = 1)
+        .def_static("repetition_code",
+                    code_graph(&Generators::RepetitionCodeLayout),
+                    "Build the space-time decoding graph of a repetition "
+                    "code measured for the given number of rounds. The "
+                    "detectors of a round form a chain whose ends are "
+                    "connected to the boundary. See space_time for the "
+                    "numbering of vertices and edges.",
+                    py::arg("distance"), py::arg("rounds") = 1,
+                    py::kw_only(), py::arg("diagonal_edges") = false,
+                    py::arg("space_weight") = 1, py::arg("time_weight") = 1,
+                    py::arg("diagonal_weight") = 1)
+        .def_static("surface_code",
+                    code_graph(&Generators::SurfaceCodeLayout),
+                    "Build the space-time decoding graph of one stabilizer "
+                    "type of a planar surface code measured for the given "
+                    "number of rounds. The detectors of a round form a "
+                    "distance x (distance - 1) grid whose rows end on the "
+                    "boundary. See space_time for the numbering of vertices "
+                    "and edges.",
+                    py::arg("distance"), py::arg("rounds") = 1,
+                    py::kw_only(), py::arg("diagonal_edges") = false,
+                    py::arg("space_weight") = 1, py::arg("time_weight") = 1,
+                    py::arg("diagonal_weight") = 1)
+        .def_static("rotated_surface_code",
+                    code_graph(&Generators::RotatedSurfaceCodeLayout),
+                    "Build the space-time decoding graph of the Z-type "
+                    "stabilizers of a rotated surface code measured for the "
+                    "given number of rounds. The qubits of the top and "
+                    "bottom rows are connected to the boundary. See "
+                    "space_time for the numbering of vertices and edges.",
+                    py::arg("distance"), py::arg("rounds") = 1,
+                    py::kw_only(), py::arg("diagonal_edges") = false,
+                    py::arg("space_weight") = 1, py::arg("time_weight") = 1,
+                    py::arg("diagonal_weight") = 1)
+        .def_static(
+            "from_dem",
+            [](const std::string &text, double weight_scale,
+               HyperedgeDecomposition decomposition, size_t num_threads,
+               bool sort_rows, bool edge_index) {
+                py::gil_scoped_release release;
+                return DetectorErrorModel::ParseDecodingGraph<IndexT>(
+                    text, MakeDemOptions(weight_scale, decomposition,
+                                         num_threads, sort_rows, edge_index));
+            },
+            "Build the decoding graph of a detector error model given in the "
+            "text format of Stim. Detector d is vertex d and the boundary "
+            "vertex is the last vertex. Every component of an error "
+            "mechanism, separated by ^, becomes an edge between the two "
+            "detectors it flips or between the detector it flips and the "
+            "boundary, and components flipping more detectors are split as "
+            "set by decomposition. Mechanisms flipping the same detectors "
+            "are merged, and every edge of probability p has the weight "
+            "round(weight_scale * ln((1 - p) / p)), or 0 if p >= 1/2. "
+            "repeat blocks and shift_detectors are applied without unrolling "
+            "the model; coordinates, tags and logical observables are "
+            "ignored.",
+            py::arg("text"), py::kw_only(), py::arg("weight_scale") = 1000.0,
+            py::arg("decomposition") = HyperedgeDecomposition::Pairs,
+            py::arg("num_threads") = 1, py::arg("sort_rows") = false,
+            py::arg("edge_index") = false)
+        .def_static(
+            "load_dem",
+            [](const std::filesystem::path &path, double weight_scale,
+               HyperedgeDecomposition decomposition, bool mmap,
+               size_t num_threads, bool sort_rows, bool edge_index) {
+                py::gil_scoped_release release;
+                return DetectorErrorModel::LoadDecodingGraph<IndexT>(
+                    path.string(),
+                    MakeDemOptions(weight_scale, decomposition, num_threads,
+                                   sort_rows, edge_index),
+                    mmap);
+            },
+            "Build the decoding graph of a detector error model file, as for "
+            "from_dem. With mmap=True, the file is memory-mapped and parsed "
+            "in place in a single pass, without holding the GIL.",
+            py::arg("path"), py::kw_only(), py::arg("weight_scale") = 1000.0,
+            py::arg("decomposition") = HyperedgeDecomposition::Pairs,
+            py::arg("mmap") = true, py::arg("num_threads") = 1,
+            py::arg("sort_rows") = false, py::arg("edge_index") = false)
+        .def("get_num_vertices", &Graph::GetNumVertices,
+             "Return the number of vertices in the graph.")
+        .def("get_num_edges", &Graph::GetNumEdges,
+             "Return the number of edges in the graph.")
+        .def("get_edges_touching_vertex", &Graph::GetEdgesTouchingVertex,
+             "Return a list of the indices of edges touching the vertex with "
+             "the given index.",
+             py::arg("vertex_index"), py::keep_alive<0, 1>())
+        .def("get_vertices_touching_vertex", &Graph::GetVerticesTouchingVertex,
+             "Return a list of the indices of vertices connected to the vertex "
+             "with the given index.",
+             py::arg("vertex_index"), py::keep_alive<0, 1>())
+        .def("get_edges_touching_edge", &Graph::GetEdgesTouchingEdge,
+             "Return a list of the indices of edges touching the edge with the "
+             "given index. The first call may construct the edge-edge "
+             "adjacency matrix, which is done without holding the GIL.",
+             py::arg("edge_index"), py::keep_alive<0, 1>(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_vertices_connected_by_edge",
+             &Graph::GetVerticesConnectedByEdge,
+             "Return a list of the indices of vertices connected by the edge "
+             "with the given index.",
+             py::arg("edge_index"))
+        .def("is_vertex_on_boundary", &DGraph::IsVertexOnBoundary,
+             "Return True if the vertex with the given index is a boundary "
+             "vertex, and False otherwise.",
+             py::arg("vertex_index"))
+        .def(
+            "are_vertices_on_boundary",
+            [](const DGraph &graph, const py::object &indices) {
+                const auto vertices = ToIndexArray<IndexT>(indices);
+                py::array_t<bool> out(vertices.size());
+                std::span<bool> result(out.mutable_data(), out.size());
+                {
+                    py::gil_scoped_release release;
+                    graph.AreVerticesOnBoundary(AsSpan(vertices), result);
+                }
+                return out;
+            },
+            "Return a boolean array indicating which vertices of an array of "
+            "vertex indices are boundary vertices.",
+            py::arg("vertices"))
+        .def(
+            "save",
+            [](const DGraph &graph, const std::filesystem::path &path) {
+                py::gil_scoped_release release;
+                Serialization::SaveGraph(graph, path.string());
+            },
+            "Save the decoding graph to a binary file, which can be loaded "
+            "with load_graph.",
+            py::arg("path"))
+        .def(
+            "reordered",
+            [](const DGraph &graph, Reordering::VertexOrder order,
+               const std::optional<CoordinateArray> &coordinates) {
+                return ReorderGraph(graph, order, coordinates);
+            },
+            "Return a copy of the decoding graph whose vertices are "
+            "renumbered in the given order and whose edges are renumbered in "
+            "the order they are met in the new rows, which keeps neighbouring "
+            "vertices and edges close in memory. The boundary vertices and "
+            "local edge maps follow the new IDs. The Morton order needs the "
+            "(V, D) coordinates of the vertices, with D from 1 to 3. Return a "
+            "(graph, vertices, edges) tuple, where vertices and edges are "
+            "(forward, inverse) pairs of arrays mapping old IDs to new ones "
+            "and new IDs to old ones.",
+            py::arg("order") = Reordering::VertexOrder::ReverseCuthillMcKee,
+            py::kw_only(), py::arg("coordinates") = py::none())
+        .def(
+            "get_construction_timings",
+            [](const DGraph &graph) {
+                return TimingsToDict(graph.GetConstructionTimings());
+            },
+            "Return a dict of the seconds spent in each phase of the "
+            "construction of the decoding graph, including its local edge "
+            "maps.")
+        .def(
+            "get_memory_footprint",
+            [](const DGraph &graph) {
+                return FootprintToDict(graph.GetMemoryFootprint());
+            },
+            "Return a dict of the memory held by every array of the decoding "
+            "graph, including its boundary flags and local edge maps.")
+        .def("get_arrays", decoding_graph_arrays,
+             "Return a dict of read-only NumPy views of the arrays of the "
+             "decoding graph, including its boundary flags and local edge "
+             "maps, which can be passed to from_arrays.")
+        .def_static("from_arrays", decoding_graph_from_arrays,
+                    "Assemble a decoding graph from arrays returned by "
+                    "get_arrays without copying them, as for "
+                    "SparseGraph.from_arrays. The local edge strides and "
+                    "maps are also checked against the vertex rows.",
+                    py::arg("num_vertices"), py::arg("arrays"), py::kw_only(),
+                    py::arg("sorted_rows") = false,
+                    py::arg("edge_index") = false,
+                    py::arg("owner") = py::none())
+        .def(py::pickle(
+            [decoding_graph_arrays, graph_state](py::object self) {
+                return graph_state(self, decoding_graph_arrays(self));
+            },
+            [decoding_graph_from_arrays](const py::tuple &state) {
+                CheckPickleState(state);
+                return decoding_graph_from_arrays(
+                    state[1].cast<size_t>(), state[4].cast<py::dict>(),
+                    state[2].cast<bool>(), state[3].cast<bool>(), py::none());
+            }));
+
+    using Paths = ShortestPaths<DGraph>;
+    using Path = typename Paths::Path;
+
+    // Convert a path to a (distance, target, edges) tuple
+    auto path_to_tuple = [](Path path) {
+        auto num_edges = static_cast<py::ssize_t>(path.edges.size());
+        return py::make_tuple(path.distance, path.target,
+                              MoveToArray(std::move(path.edges), {num_edges}));
+    };
+
+    pybind11::class_<Paths>(
+        m, shortest_paths_name,
+        "Shortest paths between the vertices of a decoding graph, computed "
+        "with Dijkstra's algorithm on its integer edge weights (1 for every "
+        "edge of an unweighted graph). Searches stop as soon as their targets "
+        "are reached. The results of single-target queries are kept in a "
+        "cache of at most cache_capacity paths. Unreachable vertices are at "
+        "distance INFINITY.")
+        .def(py::init<const DGraph &, size_t>(), py::arg("graph"),
+             py::arg("cache_capacity") = 0, py::keep_alive<1, 2>())
+        .def_readonly_static("INFINITY", &Paths::kInfinity)
+        .def(
+            "get_distance",
+            [](const Paths &paths, size_t source, size_t target) {
+                py::gil_scoped_release release;
+                return paths.GetDistance(source, target);
+            },
+            "Return the length of a shortest path between two vertices.",
+            py::arg("source"), py::arg("target"))
+        .def(
+            "get_distances",
+            [](const Paths &paths, size_t source, const py::object &indices) {
+                const auto targets = ToIndexArray<IndexT>(indices);
+                py::array_t<uint64_t> out(targets.size());
+                std::span<uint64_t> result(out.mutable_data(), out.size());
+                {
+                    py::gil_scoped_release release;
+                    paths.GetDistances(source, AsSpan(targets), result);
+                }
+                return out;
+            },
+            "Return the lengths of shortest paths from a vertex to each vertex "
+            "of an array of targets, computed with a single search.",
+            py::arg("source"), py::arg("targets"))
+        .def(
+            "get_path",
+            [path_to_tuple](const Paths &paths, size_t source, size_t target) {
+                Path path;
+                {
+                    py::gil_scoped_release release;
+                    path = paths.GetPath(source, target);
+                }
+                return path_to_tuple(std::move(path));
+            },
+            "Return a shortest path between two vertices as a (distance, "
+            "target, edges) tuple, where edges lists the edges of the path "
+            "from the source to the target.",
+            py::arg("source"), py::arg("target"))
+        .def(
+            "get_distance_to_boundary",
+            [](const Paths &paths, size_t source) {
+                py::gil_scoped_release release;
+                return paths.GetDistanceToBoundary(source);
+            },
+            "Return the distance from a vertex to the nearest boundary vertex "
+            "and the index of that vertex, as a (distance, vertex) tuple.",
+            py::arg("source"))
+        .def(
+            "get_path_to_boundary",
+            [path_to_tuple](const Paths &paths, size_t source) {
+                Path path;
+                {
+                    py::gil_scoped_release release;
+                    path = paths.GetPathToBoundary(source);
+                }
+                return path_to_tuple(std::move(path));
+            },
+            "Return a shortest path from a vertex to the nearest boundary "
+            "vertex as a (distance, boundary vertex, edges) tuple.",
+            py::arg("source"))
+        .def("get_cache_size", &Paths::GetCacheSize,
+             "Return the number of cached paths.")
+        .def("clear_cache", &Paths::ClearCache, "Remove all cached paths.");
+
+    using Growth = ClusterGrowth<IndexT>;
+
+    // Range-check a query on a vertex, local edge or edge against the graph
+    // of a cluster growth
+    auto checked = [](auto query, auto count, const char *what) {
+        return CheckedQuery<Growth>(
+            query,
+            [count](const Growth &growth) {
+                return (growth.GetGraph().*count)();
+            },
+            what);
+    };
+    constexpr auto num_vertices = &DGraph::GetNumVertices;
+    constexpr auto num_local_edges = &DGraph::GetNumLocalEdges;
+    constexpr auto num_edges = &DGraph::GetNumEdges;
+
+    // Copy a span of indices to a NumPy array
+    auto to_array = [](std::span<const IndexT> data) {
+        return py::array_t<IndexT>(static_cast<py::ssize_t>(data.size()),
+                                   data.data());
+    };
+
+    pybind11::class_<Growth>(
+        m, cluster_growth_name,
+        "Cluster growth and merging for union-find decoding on a decoding "
+        "graph. Odd clusters that do not touch the boundary grow by half an "
+        "edge per round, and edges are fully grown once their two halves add "
+        "up to twice their weight. Only the state touched by a shot is reset "
+        "before the next one.")
+        .def(py::init<const DGraph &>(), py::arg("graph"),
+             py::keep_alive<1, 2>(), py::call_guard<py::gil_scoped_release>())
+        .def(
+            "load_defects",
+            [](Growth &growth, const py::object &indices) {
+                const auto defects = ToIndexArray<IndexT>(indices);
+                py::gil_scoped_release release;
+                growth.LoadDefects(AsSpan(defects));
+            },
+            "Clear the previous shot and start one cluster per defect vertex.",
+            py::arg("defects"))
+        .def("reset", &Growth::Reset,
+             "Clear the clusters of the previous shot.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("grow", &Growth::Grow,
+             "Grow every active cluster by half an edge and merge the clusters "
+             "connected by fully grown edges. Return False if nothing grew.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("grow_until_neutral", &Growth::GrowUntilNeutral,
+             "Grow the clusters until none is active. Return False if some odd "
+             "clusters cannot reach another defect or the boundary.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("find_root",
+             checked(&Growth::FindRoot, num_vertices, "vertex"),
+             "Return the root of the cluster of a vertex.", py::arg("vertex"))
+        .def("is_vertex_in_cluster",
+             checked(&Growth::IsVertexInCluster, num_vertices, "vertex"),
+             "Return True if the vertex belongs to a cluster.",
+             py::arg("vertex"))
+        .def("is_cluster_odd",
+             checked(&Growth::IsClusterOdd, num_vertices, "root"),
+             "Return True if the cluster with the given root holds an odd "
+             "number of defects.",
+             py::arg("root"))
+        .def("is_cluster_on_boundary",
+             checked(&Growth::IsClusterOnBoundary, num_vertices, "root"),
+             "Return True if the cluster with the given root contains a "
+             "boundary vertex.",
+             py::arg("root"))
+        .def("get_cluster_size",
+             checked(&Growth::GetClusterSize, num_vertices, "root"),
+             "Return the number of vertices of the cluster with the given "
+             "root.",
+             py::arg("root"))
+        .def("get_half_edge_growth",
+             checked(&Growth::GetHalfEdgeGrowth, num_local_edges,
+                     "local edge"),
+             "Return the growth of the half-edge with the given local edge "
+             "ID, in half units of edge weight.",
+             py::arg("local_edge"))
+        .def("is_edge_grown", checked(&Growth::IsEdgeGrown, num_edges, "edge"),
+             "Return True if the edge is fully grown.", py::arg("edge"))
+        .def(
+            "get_active_clusters",
+            [to_array](const Growth &growth) {
+                return to_array(growth.GetActiveClusters());
+            },
+            "Return an array of the roots of the active clusters.")
+        .def(
+            "get_grown_edges",
+            [to_array](const Growth &growth) {
+                return to_array(growth.GetGrownEdges());
+            },
+            "Return an array of the fully grown edges, in the order in which "
+            "they were grown.");
+
+    using Batch = SyndromeBatch<IndexT>;
+    using ByteArray =
+        py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+
+    pybind11::class_<Batch>(
+        m, syndrome_batch_name,
+        "The syndromes of a batch of shots on a decoding graph, stored as one "
+        "bit per shot and vertex in rows of 64-bit words. Rows hold one shot "
+        "each in the ShotMajor layout and one vertex each in the "
+        "DetectorMajor layout. The words and bytes properties are writable "
+        "NumPy views of the bits, in the bit-packed little-endian format of "
+        "common samplers.")
+        .def(py::init<const DGraph &, size_t, SyndromeLayout>(),
+             py::arg("graph"), py::arg("num_shots"),
+             py::arg("layout") = SyndromeLayout::ShotMajor,
+             py::call_guard<py::gil_scoped_release>())
+        .def_static(
+            "from_packed",
+            [](const DGraph &graph, const ByteArray &data,
+               SyndromeLayout layout, std::optional<size_t> num_shots) {
+                if (data.ndim() != 2) {
+                    throw py::value_error("data must be a 2D uint8 array");
+                }
+                const auto rows = static_cast<size_t>(data.shape(0));
+                const auto bytes_per_row = static_cast<size_t>(data.shape(1));
+                const bool shot_major = layout == SyndromeLayout::ShotMajor;
+                const size_t shots = num_shots.value_or(
+                    shot_major ? rows : 8 * bytes_per_row);
+                if (rows != (shot_major ? shots : graph.GetNumVertices())) {
+                    throw py::value_error(
+                        "data must have one row per shot in the ShotMajor "
+                        "layout and one row per vertex in the DetectorMajor "
+                        "layout");
+                }
+                const uint8_t *bytes = data.data();
+                py::gil_scoped_release release;
+                return Batch(graph, shots, bytes, bytes_per_row, layout);
+            },
+            "Copy bit-packed syndromes from a 2D uint8 array with one row per "
+            "shot (ShotMajor) or per vertex (DetectorMajor), where bit i of a "
+            "row is bit i % 8 of byte i // 8. The number of shots defaults to "
+            "the number of rows, or to 8 bits per byte in the DetectorMajor "
+            "layout.",
+            py::arg("graph"), py::arg("data"),
+            py::arg("layout") = SyndromeLayout::ShotMajor,
+            py::arg("num_shots") = py::none())
+        .def_property_readonly("num_shots", &Batch::GetNumShots)
+        .def_property_readonly("num_detectors", &Batch::GetNumDetectors)
+        .def_property_readonly("layout", &Batch::GetLayout)
+        .def_property_readonly(
+            "words",
+            [](py::object self) {
+                auto &batch = self.cast<Batch &>();
+                return py::array_t<uint64_t>(
+                    {static_cast<py::ssize_t>(batch.GetNumRows()),
+                     static_cast<py::ssize_t>(batch.GetWordsPerRow())},
+                    batch.GetWords().data(), self);
+            },
+            "Writable (rows, words per row) uint64 view of the bits.")
+        .def_property_readonly(
+            "bytes",
+            [](py::object self) {
+                auto &batch = self.cast<Batch &>();
+                return py::array_t<uint8_t>(
+                    {static_cast<py::ssize_t>(batch.GetNumRows()),
+                     static_cast<py::ssize_t>(8 * batch.GetWordsPerRow())},
+                    reinterpret_cast<uint8_t *>(batch.GetWords().data()),
+                    self);
+            },
+            "Writable (rows, bytes per row) uint8 view of the bits.")
+        .def("get_detector", &Batch::GetDetector,
+             "Return the bit of a vertex in a shot.", py::arg("shot"),
+             py::arg("detector"))
+        .def("set_detector", &Batch::SetDetector,
+             "Set the bit of a vertex in a shot.", py::arg("shot"),
+             py::arg("detector"), py::arg("value") = true)
+        .def(
+            "count_defects",
+            [](const Batch &batch, bool exclude_boundary) {
+                std::vector<size_t> counts(batch.GetNumShots());
+                {
+                    py::gil_scoped_release release;
+                    batch.CountDefects(counts, exclude_boundary);
+                }
+                auto size = static_cast<py::ssize_t>(counts.size());
+                return MoveToArray(std::move(counts), {size});
+            },
+            "Return an array of the number of defects of every shot.",
+            py::arg("exclude_boundary") = true)
+        .def(
+            "get_defects",
+            [](const Batch &batch, size_t shot, bool exclude_boundary) {
+                std::vector<IndexT> defects;
+                batch.GetDefects(shot, defects, exclude_boundary);
+                auto size = static_cast<py::ssize_t>(defects.size());
+                return MoveToArray(std::move(defects), {size});
+            },
+            "Return an array of the defect vertices of a shot.",
+            py::arg("shot"), py::arg("exclude_boundary") = true)
+        .def(
+            "extract_defects",
+            [](const Batch &batch, bool exclude_boundary) {
+                RaggedRows<IndexT> defects;
+                {
+                    py::gil_scoped_release release;
+                    defects = batch.ExtractDefects(exclude_boundary);
+                }
+                return RaggedRowsToTuple(std::move(defects));
+            },
+            "Return the defect vertices of every shot as a tuple of "
+            "(offsets, values) arrays, where the defects of shot s are "
+            "values[offsets[s]:offsets[s + 1]].",
+            py::arg("exclude_boundary") = true);
+
+    using Window = WindowedDecodingGraph<IndexT>;
+
+    // Range-check a query on a vertex or edge ID, so that a wrong ID raises
+    // IndexError instead of reading past the window
+    auto checked = [](auto query, auto count, const char *what) {
+        return CheckedQuery<const Window>(query, count, what);
+    };
+    constexpr auto num_vertices = &Window::GetNumVertices;
+    constexpr auto num_edges = &Window::GetNumEdges;
+
+    pybind11::class_<Window>(
+        m, windowed_graph_name,
+        "A decoding graph over a sliding window of time layers with the same "
+        "number of vertices. Layers are appended at the end of the window and "
+        "retired from its start, and the vertex and edge IDs of retired "
+        "layers are reused by new layers. All storage is allocated at "
+        "construction and updated in place.")
+        .def(py::init<size_t, size_t, size_t, size_t>(),
+             "Construct an empty window of at most num_layers layers of "
+             "vertices_per_layer vertices, with at most max_edges_per_layer "
+             "edges appended with each layer and max_degree edges touching "
+             "each vertex.",
+             py::arg("vertices_per_layer"), py::arg("num_layers"),
+             py::arg("max_edges_per_layer"), py::arg("max_degree"),
+             py::call_guard<py::gil_scoped_release>())
+        .def(
+            "append_layer",
+            [](Window &window, const py::array &edges,
+               const std::vector<bool> &boundary_vertices,
+               const std::optional<WeightArray> &weights) {
+                auto weight_span = AsWeightSpan(weights);
+                return WithFlatEdgeList(edges, [&](const auto &edge_list) {
+                    py::gil_scoped_release release;
+                    return window.AppendLayer(edge_list, weight_span,
+                                              boundary_vertices);
+                });
+            },
+            "Append a layer from an (E, 2) NumPy array of edges, where vertex "
+            "i < vertices_per_layer is vertex i of the previous layer and "
+            "vertices_per_layer + i is vertex i of the new layer, and return "
+            "its absolute index. Every edge must touch the new layer.",
+            py::arg("edges"), py::arg("boundary_vertices"), py::kw_only(),
+            py::arg("weights") = py::none())
+        .def(
+            "append_layer",
+            [](Window &window,
+               const std::vector<std::pair<size_t, size_t>> &edges,
+               const std::vector<bool> &boundary_vertices,
+               const std::optional<WeightArray> &weights) {
+                auto weight_span = AsWeightSpan(weights);
+                py::gil_scoped_release release;
+                return window.AppendLayer(edges, weight_span,
+                                          boundary_vertices);
+            },
+            "Append a layer from a list of pairs of vertices, numbered as in "
+            "the NumPy overload, and return its absolute index.",
+            py::arg("edges"), py::arg("boundary_vertices"), py::kw_only(),
+            py::arg("weights") = py::none())
+        .def("retire_layer", &Window::RetireLayer,
+             "Retire the oldest layer of the window.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("is_full", &Window::IsFull,
+             "Return True if a layer must be retired before the next one is "
+             "appended.")
+        .def_property_readonly("num_layers", &Window::GetNumLayers)
+        .def_property_readonly("layer_capacity", &Window::GetLayerCapacity)
+        .def_property_readonly("first_layer", &Window::GetFirstLayer)
+        .def_property_readonly("vertices_per_layer",
+                               &Window::GetVerticesPerLayer)
+        .def("get_vertex", &Window::GetVertex,
+             "Return the ID of a vertex of a layer in the window.",
+             py::arg("layer"), py::arg("index"))
+        .def(
+            "get_layer_of_vertex",
+            [](const Window &window, size_t vertex) -> std::optional<size_t> {
+                const size_t layer = window.GetLayerOfVertex(vertex);
+                if (layer == Window::kNoLayer) {
+                    return std::nullopt;
+                }
+                return layer;
+            },
+            "Return the absolute index of the layer of a vertex, or None if "
+            "the vertex is not in the window.",
+            py::arg("vertex"))
+        .def("is_vertex_active", &Window::IsVertexActive,
+             "Return True if the vertex belongs to a layer in the window.",
+             py::arg("vertex_index"))
+        .def("is_edge_active", &Window::IsEdgeActive,
+             "Return True if the edge connects two vertices of the window.",
+             py::arg("edge_index"))
+        .def("get_num_vertices", &Window::GetNumVertices,
+             "Return the number of vertex IDs, including inactive ones.")
+        .def("get_num_edges", &Window::GetNumEdges,
+             "Return the number of edge IDs, including inactive ones.")
+        .def("get_edges_touching_vertex",
+             checked(&Window::GetEdgesTouchingVertex, num_vertices, "vertex"),
+             "Return the edges touching a vertex.", py::arg("vertex_index"),
+             py::keep_alive<0, 1>())
+        .def("get_vertices_touching_vertex",
+             checked(&Window::GetVerticesTouchingVertex, num_vertices,
+                     "vertex"),
+             "Return the vertices connected to a vertex.",
+             py::arg("vertex_index"), py::keep_alive<0, 1>())
+        .def("get_vertices_connected_by_edge",
+             checked(&Window::GetVerticesConnectedByEdge, num_edges, "edge"),
+             "Return the pair of vertices connected by an edge.",
+             py::arg("edge_index"))
+        .def(
+            "get_edge_from_vertex_pair",
+            [](const Window &window, std::pair<size_t, size_t> vertex_pair)
+                -> std::optional<size_t> {
+                const IndexT e = window.GetEdgeFromVertexPair(vertex_pair);
+                if (e == Window::kInvalidIndex) {
+                    return std::nullopt;
+                }
+                return e;
+            },
+            "Return the edge connecting two vertices, or None if there is "
+            "none.",
+            py::arg("vertex_pair"))
+        .def("get_edge_weight",
+             checked(&Window::GetEdgeWeight, num_edges, "edge"),
+             "Return the weight of an edge.", py::arg("edge_index"))
+        .def("is_vertex_on_boundary",
+             checked(&Window::IsVertexOnBoundary, num_vertices, "vertex"),
+             "Return True if the vertex is a boundary vertex of a layer in "
+             "the window.",
+             py::arg("vertex_index"));
+}
+
+/**
+ * @brief Register the CompressedGraphRow and CompressedSparseGraph classes for
+ * a given index type.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param m The module to register the classes in.
+ * @param row_name Python name of the compressed row class.
+ * @param graph_name Python name of the compressed graph class.
+ */
+template <typename IndexT>
+void RegisterCompressedGraphs(py::module_ &m, const char *row_name,
+                              const char *graph_name) {
+    using Row = CompressedGraphRow<IndexT>;
+    using Graph = SparseGraph<IndexT>;
+    using Compressed = CompressedSparseGraph<IndexT>;
+
+    // Range-check a query on a vertex or edge, whose row would otherwise be
+    // decoded from an offset past the compressed matrix
+    auto checked = [](auto query, auto count, const char *what) {
+        return CheckedQuery<const Compressed>(query, count, what);
+    };
+    constexpr auto num_vertices = &Compressed::GetNumVertices;
+    constexpr auto num_edges = &Compressed::GetNumEdges;
+
+    // Batch query returning the concatenated rows of a batch of vertices
+    auto vertex_rows = [](RaggedRows<IndexT> (Compressed::*query)(
+                              std::span<const IndexT>) const) {
+        return [query](const Compressed &graph, const py::object &indices) {
+            const auto vertices = ToIndexArray<IndexT>(indices);
+            RaggedRows<IndexT> rows;
+            {
+                py::gil_scoped_release release;
+                rows = (graph.*query)(AsSpan(vertices));
+            }
+            return RaggedRowsToTuple(std::move(rows));
+        };
+    };
+
+    pybind11::class_<Row>(m, row_name,
+                          "A row of a CompressedSparseGraph adjacency matrix, "
+                          "decoded as it is iterated.")
+        .def("size", &Row::size, "Return the number of entries in the row.")
+        .def(
+            "__getitem__",
+            [](const Row &obj, int index) {
+                if (index < 0 || static_cast<size_t>(index) >= obj.size()) {
+                    throw pybind11::index_error();
+                }
+                return obj[index];
+            },
+            "Get the value at the given index in the row.")
+        .def(
+            "__iter__",
+            [](const Row &obj) {
+                return py::make_iterator(obj.begin(), obj.end());
+            },
+            py::keep_alive<0, 1>(), "Iterate over the entries in the row.")
+        .def("__len__", &Row::size,
+             "Return the number of entries in the row.");
+
+    pybind11::class_<Compressed>(
+        m, graph_name,
+        "A sparse graph whose adjacency matrices are stored compressed.")
+        .def(py::init([](const Graph &graph, EdgeToEdgeMode edge_to_edge) {
+                 py::gil_scoped_release release;
+                 return Compressed(graph, edge_to_edge);
+             }),
+             "Compress a sparse graph. Each row of the adjacency matrices is "
+             "sorted, delta-encoded and bit-packed, and decoded as it is "
+             "iterated. The compressed edge-edge adjacency matrix is built "
+             "from the compressed rows on first use unless edge_to_edge is "
+             "EdgeToEdgeMode.Eager.",
+             py::arg("graph"), py::kw_only(),
+             py::arg("edge_to_edge") = EdgeToEdgeMode::Lazy)
+        .def(py::init([](size_t num_vertices, const py::array &edges,
+                         const std::optional<WeightArray> &weights,
+                         bool assume_unique_edges, EdgeToEdgeMode edge_to_edge,
+                         size_t num_threads) {
+                 auto options = MakeSparseGraphOptions(
+                     assume_unique_edges, EdgeToEdgeMode::Lazy, num_threads,
+                     true, false);
+                 auto weight_span = AsWeightSpan(weights);
+                 return WithFlatEdgeList(edges, [&](const auto &edge_list) {
+                     py::gil_scoped_release release;
+                     Graph graph(num_vertices, edge_list, weight_span, options);
+                     return Compressed(graph, edge_to_edge);
+                 });
+             }),
+             "Construct a compressed graph from an (E, 2) NumPy array of "
+             "edges, as for SparseGraph. The graph is built uncompressed "
+             "first.",
+             py::arg("num_vertices"), py::arg("edges"), py::kw_only(),
+             py::arg("weights") = py::none(),
+             py::arg("assume_unique_edges") = false,
+             py::arg("edge_to_edge") = EdgeToEdgeMode::Lazy,
+             py::arg("num_threads") = 1)
+        .def("get_num_vertices", &Compressed::GetNumVertices,
+             "Return the number of vertices in the graph.")
+        .def("get_num_edges", &Compressed::GetNumEdges,
+             "Return the number of edges in the graph.")
+        .def("has_edge_weights", &Compressed::HasEdgeWeights,
+             "Return True if the edges of the graph carry weights.")
+        .def("get_edge_weight",
+             checked(&Compressed::GetEdgeWeight, num_edges, "edge"),
+             "Return the weight of an edge, or 1 if the graph is unweighted.",
+             py::arg("edge_index"))
+        .def("get_edges_touching_vertex",
+             checked(&Compressed::GetEdgesTouchingVertex, num_vertices,
+                     "vertex"),
+             "Return the edges touching the vertex with the given index, in "
+             "the order of its neighbouring vertices.",
+             py::arg("vertex_index"), py::keep_alive<0, 1>())
+        .def("get_vertices_touching_vertex",
+             checked(&Compressed::GetVerticesTouchingVertex, num_vertices,
+                     "vertex"),
+             "Return the vertices connected to the vertex with the given "
+             "index, in increasing order.",
+             py::arg("vertex_index"), py::keep_alive<0, 1>())
+        .def("get_edges_touching_edge",
+             checked(&Compressed::GetEdgesTouchingEdge, num_edges, "edge"),
+             "Return the edges touching the edge with the given index, in "
+             "increasing order. The compressed edge-edge adjacency matrix is "
+             "built on first use, without holding the GIL.",
+             py::arg("edge_index"), py::keep_alive<0, 1>(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_vertices_connected_by_edge",
+             checked(&Compressed::GetVerticesConnectedByEdge, num_edges,
+                     "edge"),
+             "Return the indices of the vertices connected by the edge with "
+             "the given index.",
+             py::arg("edge_index"))
+        .def("is_edge_to_edge_matrix_constructed",
+             &Compressed::IsEdgeToEdgeMatrixConstructed,
+             "Return True if the compressed edge-edge adjacency matrix has "
+             "been constructed.")
+        .def("get_compressed_bytes", &Compressed::GetCompressedBytes,
+             "Return the number of bytes of the compressed adjacency "
+             "matrices, including their row offsets.")
+        .def(
+            "get_memory_footprint",
+            [](const Compressed &graph) {
+                return FootprintToDict(graph.GetMemoryFootprint());
+            },
+            "Return a dict mapping the name of every array of the graph to a "
+            "dict of its size in bytes, the bytes allocated for it and "
+            "whether it is external.")
+        .def("get_edges_touching_vertices",
+             vertex_rows(&Compressed::GetEdgesTouchingVertices),
+             "Return the edges touching each vertex of an array of vertex "
+             "indices, as a tuple of (offsets, values) arrays.",
+             py::arg("vertices"))
+        .def("get_vertices_touching_vertices",
+             vertex_rows(&Compressed::GetVerticesTouchingVertices),
+             "Return the vertices connected to each vertex of an array of "
+             "vertex indices, as a tuple of (offsets, values) arrays.",
+             py::arg("vertices"))
+        .def(
+            "get_vertices_connected_by_edges",
+            [](const Compressed &graph, const py::object &indices) {
+                const auto edges = ToIndexArray<IndexT>(indices);
+                py::array_t<IndexT> out({edges.size(), py::ssize_t{2}});
+                std::span<IndexT> result(out.mutable_data(), out.size());
+                {
+                    py::gil_scoped_release release;
+                    graph.GetVerticesConnectedByEdges(AsSpan(edges), result);
+                }
+                return out;
+            },
+            "Return an (N, 2) array of the vertices connected by each edge of "
+            "an array of edge indices.",
+            py::arg("edges"))
+        .def(
+            "get_edges_from_vertex_pairs",
+            [](const Compressed &graph, const py::object &indices) {
+                const auto vertex_pairs = ToIndexArray<IndexT>(indices);
+                if (vertex_pairs.ndim() != 2 || vertex_pairs.shape(1) != 2) {
+                    throw py::value_error(
+                        "vertex_pairs must be an array of shape (N, 2)");
+                }
+                py::array_t<IndexT> out(vertex_pairs.shape(0));
+                std::span<IndexT> result(out.mutable_data(), out.size());
+                {
+                    py::gil_scoped_release release;
+                    graph.GetEdgesFromVertexPairs(AsSpan(vertex_pairs), result);
+                }
+                return out;
+            },
+            "Return the index of the edge connecting each pair of an (N, 2) "
+            "array of vertex pairs. Pairs that are not connected by an edge "
+            "map to the largest value of the index type.",
+            py::arg("vertex_pairs"))
+        .def(
+            "decompress",
+            [](const Compressed &graph) {
+                py::gil_scoped_release release;
+                return graph.Decompress();
+            },
+            "Return the equivalent SparseGraph, with sorted rows.");
+}
+
+/**
+ * @brief Register the Hypergraph class for a given index type.
+ *
+ * The rows of the incidence matrices are returned as the `SparseGraphRow`
+ * class of the same index type, which must be registered first.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param m The module to register the class in.
+ * @param hypergraph_name Python name of the hypergraph class.
+ */
+template <typename IndexT>
+void RegisterHypergraph(py::module_ &m, const char *hypergraph_name) {
+    using Hyper = Hypergraph<IndexT>;
+    using IncidenceArray =
+        py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+    using ProbabilityArray =
+        py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+    // Property getter returning a read-only NumPy view of a hypergraph array
+    auto array_view = [](std::span<const IndexT> (Hyper::*getter)() const) {
+        return [getter](py::object self) {
+            auto data = (self.cast<const Hyper &>().*getter)();
+            return MakeReadOnlyArray(
+                data.data(), {static_cast<py::ssize_t>(data.size())}, self);
+        };
+    };
+
+    pybind11::class_<Hyper>(m, hypergraph_name,
+                            "A hypergraph whose hyperedges, such as the error "
+                            "mechanisms of a detector error model, connect "
+                            "any number of vertices.")
+        .def(py::init([](size_t num_vertices,
+                         const std::vector<std::vector<size_t>> &hyperedges,
+                         const std::optional<WeightArray> &weights) {
+                 auto weight_span = AsWeightSpan(weights);
+                 py::gil_scoped_release release;
+                 return Hyper(num_vertices, hyperedges, weight_span);
+             }),
+             "Construct a hypergraph from a list of the vertices of every "
+             "hyperedge, optionally with one integer weight per hyperedge. "
+             "Hyperedges may be empty, but may not repeat a vertex.",
+             py::arg("num_vertices"), py::arg("hyperedges"), py::kw_only(),
+             py::arg("weights") = py::none())
+        .def(py::init([](size_t num_vertices, const IncidenceArray &offsets,
+                         const IncidenceArray &vertices,
+                         const std::optional<WeightArray> &weights) {
+                 auto weight_span = AsWeightSpan(weights);
+                 py::gil_scoped_release release;
+                 return Hyper(num_vertices, AsSpan(offsets), AsSpan(vertices),
+                              weight_span);
+             }),
+             "Construct a hypergraph from a flat incidence list: the vertices "
+             "of hyperedge e are vertices[offsets[e]:offsets[e + 1]].",
+             py::arg("num_vertices"), py::arg("offsets"), py::arg("vertices"),
+             py::kw_only(), py::arg("weights") = py::none())
+        .def("get_num_vertices", &Hyper::GetNumVertices,
+             "Return the number of vertices in the hypergraph.")
+        .def("get_num_hyperedges", &Hyper::GetNumHyperedges,
+             "Return the number of hyperedges in the hypergraph.")
+        .def("get_num_incidences", &Hyper::GetNumIncidences,
+             "Return the sum of the sizes of the hyperedges.")
+        .def("has_hyperedge_weights", &Hyper::HasHyperedgeWeights,
+             "Return True if the hyperedges carry weights.")
+        .def(
+            "get_hyperedge_weight",
+            [](const Hyper &hypergraph, size_t hyperedge) {
+                if (hyperedge >= hypergraph.GetNumHyperedges()) {
+                    throw py::index_error("hyperedge out of range");
+                }
+                return hypergraph.GetHyperedgeWeight(hyperedge);
+            },
+            "Return the weight of a hyperedge, or 1 if the hypergraph is "
+            "unweighted.",
+            py::arg("hyperedge"))
+        .def(
+            "get_vertices_of_hyperedge",
+            [](const Hyper &hypergraph, size_t hyperedge) {
+                if (hyperedge >= hypergraph.GetNumHyperedges()) {
+                    throw py::index_error("hyperedge out of range");
+                }
+                return hypergraph.GetVerticesOfHyperedge(hyperedge);
+            },
+            "Return the vertices of the hyperedge with the given index, in "
+            "increasing order.",
+            py::arg("hyperedge"), py::keep_alive<0, 1>())
+        .def(
+            "get_hyperedges_touching_vertex",
+            [](const Hyper &hypergraph, size_t vertex) {
+                if (vertex >= hypergraph.GetNumVertices()) {
+                    throw py::index_error("vertex out of range");
+                }
+                return hypergraph.GetHyperedgesTouchingVertex(vertex);
+            },
+            "Return the hyperedges touching the vertex with the given index, "
+            "in increasing order.",
+            py::arg("vertex"), py::keep_alive<0, 1>())
+        .def_property_readonly(
+            "e_to_v_row_ptr", array_view(&Hyper::GetHyperedgeToVertexRowPtr),
+            "Read-only view of the row pointers of the hyperedge-vertex "
+            "incidence matrix (CSR format).")
+        .def_property_readonly(
+            "e_to_v_col", array_view(&Hyper::GetHyperedgeToVertexCol),
+            "Read-only view of the vertices of every hyperedge, concatenated.")
+        .def_property_readonly(
+            "v_to_e_row_ptr", array_view(&Hyper::GetVertexToHyperedgeRowPtr),
+            "Read-only view of the row pointers of the vertex-hyperedge "
+            "incidence matrix (CSR format).")
+        .def_property_readonly(
+            "v_to_e_col", array_view(&Hyper::GetVertexToHyperedgeCol),
+            "Read-only view of the hyperedges touching every vertex, "
+            "concatenated.")
+        .def_property_readonly(
+            "hyperedge_weights",
+            [](py::object self) -> py::object {
+                auto data = self.cast<const Hyper &>().GetHyperedgeWeights();
+                if (data.empty()) {
+                    return py::none();
+                }
+                return MakeReadOnlyArray(
+                    data.data(), {static_cast<py::ssize_t>(data.size())}, self);
+            },
+            "Read-only view of the weight of every hyperedge, or None if the "
+            "hypergraph is unweighted.")
+        .def(
+            "to_decoding_graph",
+            [](const Hyper &hypergraph, HyperedgeDecomposition decomposition,
+               const std::optional<ProbabilityArray> &probabilities,
+               double weight_scale, size_t num_threads, bool sort_rows,
+               bool edge_index) {
+                if (probabilities) {
+                    auto probability_span = AsSpan(*probabilities);
+                    py::gil_scoped_release release;
+                    return DetectorErrorModel::BuildDecodingGraph(
+                        hypergraph, probability_span,
+                        MakeDemOptions(weight_scale, decomposition,
+                                       num_threads, sort_rows, edge_index));
+                }
+                py::gil_scoped_release release;
+                return hypergraph.ToDecodingGraph(
+                    decomposition,
+                    MakeSparseGraphOptions(false, EdgeToEdgeMode::Lazy,
+                                           num_threads, sort_rows,
+                                           edge_index));
+            },
+            "Decompose the hyperedges into the edges of a decoding graph with "
+            "one more vertex, the boundary vertex get_num_vertices(), which "
+            "takes the vertex left over by odd hyperedges. Every edge takes "
+            "the weight of its hyperedge, and an edge produced by several "
+            "hyperedges keeps the weight of the first one. If the probability "
+            "of every hyperedge is given, the weights are ignored and the "
+            "graph is built as DecodingGraph.from_dem builds it from the "
+            "equivalent model: "
+            "edges produced by several hyperedges are merged as independent "
+            "errors and weighted round(weight_scale * ln((1 - p) / p)).",
+            py::arg("decomposition") = HyperedgeDecomposition::Pairs,
+            py::kw_only(), py::arg("probabilities") = py::none(),
+            py::arg("weight_scale") = 1000.0, py::arg("num_threads") = 1,
+            py::arg("sort_rows") = false, py::arg("edge_index") = false)
+        .def(
+            "get_memory_footprint",
+            [](const Hyper &hypergraph) {
+                return FootprintToDict(hypergraph.GetMemoryFootprint());
+            },
+            "Return a dict mapping the name of every array of the hypergraph "
+            "to a dict of its size in bytes, the bytes allocated for it and "
+            "whether it is external.");
+}
+
+/**
+ * @brief Load a graph saved with `Serialization::SaveGraph`, returning an
+ * instance of the Python class matching the type and index size stored in
+ * the file.
+ *
+ * @param path The path of the file.
+ * @param memory_map Map the file instead of reading it.
+ * @return The loaded graph.
+ */
+py::object LoadGraph(const std::filesystem::path &path, bool memory_map) {
+    const auto header = Serialization::ReadHeader(path.string());
+    const bool decoding =
+        header.kind ==
+        static_cast<uint32_t>(Serialization::GraphKind::Decoding);
+
+    auto load = [&](auto tag) -> py::object {
+        using IndexT = decltype(tag);
+        if (decoding) {
+            DecodingGraph<IndexT> graph;
+            {
+                py::gil_scoped_release release;
+                graph = Serialization::LoadDecodingGraph<IndexT>(path.string(),
+                                                                 memory_map);
+            }
+            return py::cast(std::move(graph));
+        }
+        SparseGraph<IndexT> graph;
+        {
+            py::gil_scoped_release release;
+            graph = Serialization::LoadSparseGraph<IndexT>(path.string(),
+                                                           memory_map);
+        }
+        return py::cast(std::move(graph));
+    };
+
+    if (header.index_size == sizeof(uint32_t)) {
+        return load(uint32_t{});
+    }
+    if (header.index_size == sizeof(size_t)) {
+        return load(size_t{});
+    }
+    throw std::runtime_error("Serialization: unsupported index size " +
+                             std::to_string(header.index_size));
+}
+
+/**
+ * @brief Get read-only NumPy views of the arrays of a multi-graph, keyed by
+ * name.
+ */
+py::dict GetMultiGraphArrays(py::object self) {
+    const auto &graph = self.cast<const MultiGraph &>();
+    py::dict arrays;
+    auto add = [&](const char *name, std::span<const size_t> data) {
+        arrays[name] = MakeReadOnlyArray(
+            data.data(), {static_cast<py::ssize_t>(data.size())}, self);
+    };
+    add("v_to_v_row_ptr", graph.GetVertexToVertexRowPtr());
+    add("v_to_v_col", graph.GetVertexToVertexCol());
+    add("v_to_v_edges", graph.GetVertexToVertexEdges());
+    add("weights", graph.GetWeights());
+    auto edges = graph.GetEdges();
+    arrays["edges"] =
+        MakeReadOnlyArray(reinterpret_cast<const size_t *>(edges.data()),
+                          {static_cast<py::ssize_t>(edges.size()), 2}, self);
+    return arrays;
+}
+
+/**
+ * @brief Assemble a multi-graph from the arrays of `GetMultiGraphArrays`
+ * without copying them.
+ */
+MultiGraph MultiGraphFromArrays(size_t num_vertices, py::dict arrays,
+                                bool sorted_rows, bool edge_index,
+                                py::object owner) {
+    ArrayAdopter adopter(std::move(arrays), std::move(owner));
+    MultiGraphArrays graph_arrays;
+    graph_arrays.v_to_v_row_ptr = adopter.Adopt<size_t>("v_to_v_row_ptr");
+    graph_arrays.v_to_v_col = adopter.Adopt<size_t>("v_to_v_col");
+    graph_arrays.v_to_v_edges = adopter.Adopt<size_t>("v_to_v_edges");
+    graph_arrays.edges = adopter.AdoptPairs<size_t>("edges");
+    graph_arrays.weights = adopter.Adopt<size_t>("weights");
+    graph_arrays.sorted_rows = sorted_rows;
+    auto graph = MultiGraph::FromArrays(std::move(graph_arrays));
+    if (graph.GetNumVertices() != num_vertices) {
+        throw py::value_error("MultiGraph: inconsistent number of vertices");
+    }
+    if (edge_index) {
+        py::gil_scoped_release release;
+        graph.BuildEdgeIndex();
+    }
+    return graph;
+}
+
 PYBIND11_MODULE(plaquette_graph_bindings, m) {
 
     py::class_<MultiGraph>(m, "MultiGraph",
                            R"pbdoc(
         Undirected multi-graph class.
 
-        An instance of this class represents an undirected multi-graph, which is a graph
-        where multiple edges can exist between two vertices. Edges are identified by
-        their indices, which correspond to their position in the list of edges provided
-        when the graph is constructed.
+        An instance of this class represents an undirected multi-graph, which
+        is a graph where multiple edges can exist between two vertices. Edges
+        are identified by their indices, which correspond to their position in
+        the list of edges provided when the graph is constructed.
     )pbdoc")
         .def(py::init<const std::vector<std::pair<size_t, size_t>> &,
-                      const std::vector<size_t> &>(),
-             py::arg("edges"), py::arg("weights"),
+                      const std::vector<size_t> &, bool>(),
+             py::arg("edges"), py::arg("weights"), py::kw_only(),
+             py::arg("sort_rows") = false,
+             py::call_guard<py::gil_scoped_release>(),
              R"pbdoc(
              Construct an undirected multi-graph.
 
              Args:
-                 edges: A list of pairs of integers representing the edges of the graph.
-                        Each pair represents the indices of the two vertices that the
-                        edge connects.
-                 weights: A list of integers representing the weights of each edge.
-                          The length of this list must be equal to the number of edges
-                          in the graph.
+                 edges: A list of pairs of integers representing the edges of
+                        the graph. Each pair represents the indices of the two
+                        vertices that the edge connects.
+                 weights: A list of integers representing the weights of each
+                          edge. The length of this list must be equal to the
+                          number of edges in the graph.
+                 sort_rows: Sort the edges touching each vertex by neighbouring
+                            vertex, so that get_edge_connecting_vertices uses
+                            binary search.
 
              Raises:
-                 ValueError: If the length of the `weights` list does not match the
-                             number of edges in the graph.
+                 ValueError: If the length of the `weights` list does not match
+                             the number of edges in the graph.
              )pbdoc")
-        .def("get_edges_touching_vertex", &MultiGraph::GetEdgesTouchingVertex,
-             py::arg("vertex"),
-             R"pbdoc(
+        .def(
+            "get_edges_touching_vertex",
+            [](const MultiGraph &graph, size_t vertex) {
+                auto row = graph.GetEdgesTouchingVertex(vertex);
+                return std::vector<size_t>(row.begin(), row.end());
+            },
+            py::arg("vertex"),
+            R"pbdoc(
              Get the indices of the edges that touch a given vertex.
 
              Args:
                  vertex: An integer representing the index of the vertex.
 
              Returns:
-                 A list of integers representing the indices of the edges that touch the
-                 vertex.
+                 A list of integers representing the indices of the edges that
+                 touch the vertex.
              )pbdoc")
         .def("get_weight", &MultiGraph::GetWeight, py::arg("edge_id"),
              R"pbdoc(
@@ -71,14 +2147,25 @@ PYBIND11_MODULE(plaquette_graph_bindings, m) {
              Args:
                  vertex1: An integer representing the index
                  of the first vertex.
-                 vertex2: An integer representing the index of the second vertex.
+                 vertex2: An integer representing the index of the second
+                 vertex.
 
              Returns:
-                 The index of the edge connecting the two vertices. If no such edge
-                 exists, returns the number of edges in the graph.
+                 The smallest index of the edges connecting the two vertices. If
+                 no such edge exists, returns the number of edges in the graph.
              )pbdoc")
+        .def("build_edge_index", &MultiGraph::BuildEdgeIndex,
+             "Build a hash index from pairs of vertices to edges, which "
+             "answers get_edge_connecting_vertices in constant time.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("has_edge_index", &MultiGraph::HasEdgeIndex,
+             "Return True if the hash index from pairs of vertices to edges "
+             "was built.")
+        .def("are_rows_sorted", &MultiGraph::AreRowsSorted,
+             "Return True if the edges touching each vertex are sorted by "
+             "neighbouring vertex.")
         .def("get_edges_touching_edge", &MultiGraph::GetEdgesTouchingEdge,
-             py::arg("edge"),
+             py::arg("edge"), py::call_guard<py::gil_scoped_release>(),
              R"pbdoc(
              Get the indices of the edges that touch a given edge.
 
@@ -86,20 +2173,41 @@ PYBIND11_MODULE(plaquette_graph_bindings, m) {
                  edge: An integer representing the index of the edge.
 
              Returns:
-                 A list of integers representing the indices of the edges that touch the
-                 edge.
+                 A list of integers representing the indices of the edges that
+                 touch the edge.
              )pbdoc")
-        .def("get_vertices_touching_vertex",
-             &MultiGraph::GetVerticesTouchingVertex, py::arg("vertex"),
+        .def("get_edges_touching_edge_row",
+             &MultiGraph::GetEdgesTouchingEdgeRow, py::arg("edge"),
+             py::keep_alive<0, 1>(),
+             py::call_guard<py::gil_scoped_release>(),
              R"pbdoc(
+             Get the indices of the edges that touch a given edge from the
+             precomputed edge-edge adjacency matrix, which is constructed on
+             the first call.
+
+             Args:
+                 edge: An integer representing the index of the edge.
+
+             Returns:
+                 A SparseGraphRow of the indices of the edges that touch the
+                 edge, in increasing order.
+             )pbdoc")
+        .def(
+            "get_vertices_touching_vertex",
+            [](const MultiGraph &graph, size_t vertex) {
+                auto row = graph.GetVerticesTouchingVertex(vertex);
+                return std::vector<size_t>(row.begin(), row.end());
+            },
+            py::arg("vertex"),
+            R"pbdoc(
              Get the indices of the vertices that touch a given vertex.
 
              Args:
                  vertex: An integer representing the index of the vertex.
 
              Returns:
-                 A list of integers representing the indices of the vertexs that touch the
-                 vertex.
+                 A list of integers representing the indices of the vertices
+                 that touch the vertex.
              )pbdoc")
         .def("get_num_vertices", &MultiGraph::GetNumVertices,
              R"pbdoc(
@@ -114,95 +2222,117 @@ PYBIND11_MODULE(plaquette_graph_bindings, m) {
 
              Returns:
                  An integer representing the number of edges in the graph.
-             )pbdoc");
+             )pbdoc")
+        .def("get_arrays", &GetMultiGraphArrays,
+             R"pbdoc(
+             Get read-only views of the arrays of the graph.
 
-    pybind11::class_<SparseGraphRow>(m, "SparseGraphRow",
-                                     "A lightweight container for a row of the "
-                                     "SparseGraph Adjacency matrix.")
-        .def("size", &SparseGraphRow::size,
-             "Return the number of entries in the row.")
-        .def(
-            "__getitem__",
-            [](const SparseGraphRow &obj, int index) {
-                if (index < 0 || index >= obj.size()) {
-                    throw pybind11::index_error();
-                }
-                return obj[index];
+             Returns:
+                 A dict of NumPy arrays, which can be passed to from_arrays.
+             )pbdoc")
+        .def_static("from_arrays", &MultiGraphFromArrays,
+                    py::arg("num_vertices"), py::arg("arrays"), py::kw_only(),
+                    py::arg("sorted_rows") = false,
+                    py::arg("edge_index") = false,
+                    py::arg("owner") = py::none(),
+                    R"pbdoc(
+             Assemble a multi-graph from its arrays without copying them.
+
+             Args:
+                 num_vertices: The number of vertices in the graph.
+                 arrays: A dict of arrays returned by get_arrays. Arrays of
+                         uint64 in C order, e.g. views of a
+                         multiprocessing.shared_memory block, are used in
+                         place.
+                 sorted_rows: Whether the arrays come from a graph with sorted
+                              rows.
+                 edge_index: Rebuild the hash index from pairs of vertices to
+                             edges.
+                 owner: An object kept alive as long as the graph, e.g. the
+                        shared memory block viewed by the arrays.
+
+             Raises:
+                 ValueError: If the sizes of the arrays disagree, a row
+                             pointer decreases or a vertex or edge index is
+                             out of range.
+             )pbdoc")
+        .def(py::pickle(
+            [](py::object self) {
+                const auto &graph = self.cast<const MultiGraph &>();
+                return py::make_tuple(
+                    kPickleVersion, graph.GetNumVertices(),
+                    graph.AreRowsSorted(), graph.HasEdgeIndex(),
+                    GetMultiGraphArrays(self));
             },
-            "Get the value at the given index in the row.")
-        .def("__len__", &SparseGraphRow::size,
-             "Return the number of entries in the row.");
+            [](const py::tuple &state) {
+                CheckPickleState(state);
+                return MultiGraphFromArrays(state[1].cast<size_t>(),
+                                            state[4].cast<py::dict>(),
+                                            state[2].cast<bool>(),
+                                            state[3].cast<bool>(), py::none());
+            }));
 
-    pybind11::class_<SparseGraph>(
-        m, "SparseGraph", "A sparse graph represented by an adjacency list.")
-        .def(pybind11::init<size_t,
-                            const std::vector<std::pair<size_t, size_t>> &>(),
-             "Construct a sparse graph with the given number of vertices and "
-             "edges. The edges are represented as a list of pairs of vertex "
-             "indices.",
-             py::arg("num_vertices"), py::arg("edges"))
-        .def("get_num_vertices", &SparseGraph::GetNumVertices,
-             "Return the number of vertices in the graph.")
-        .def("get_num_edges", &SparseGraph::GetNumEdges,
-             "Return the number of edges in the graph.")
-        .def("get_edges_touching_vertex", &SparseGraph::GetEdgesTouchingVertex,
-             "Return a list of the indices of edges touching the vertex with "
-             "the given index.",
-             py::arg("vertex_index"))
-        .def("get_vertices_touching_vertex",
-             &SparseGraph::GetVerticesTouchingVertex,
-             "Return a list of the indices of vertices connected to the vertex "
-             "with the given index.",
-             py::arg("vertex_index"))
-        .def("get_edges_touching_edge", &SparseGraph::GetEdgesTouchingEdge,
-             "Return a list of the indices of edges touching the edge with the "
-             "given index.",
-             py::arg("edge_index"))
-        .def("get_vertices_connected_by_edge",
-             &SparseGraph::GetVerticesConnectedByEdge,
-             "Return a list of the indices of vertices connected by the edge "
-             "with the given index.",
-             py::arg("edge_index"));
+    py::enum_<EdgeToEdgeMode>(m, "EdgeToEdgeMode",
+                              "When the edge-edge adjacency matrix of a graph "
+                              "is constructed.")
+        .value("Eager", EdgeToEdgeMode::Eager,
+               "Construct the matrix together with the graph.")
+        .value("Lazy", EdgeToEdgeMode::Lazy,
+               "Construct the matrix on first use.");
 
-    pybind11::class_<DecodingGraph, SparseGraph>(
-        m, "DecodingGraph",
-        "A decoding graph represented by an adjacency list.")
-        .def(
-            pybind11::init<size_t,
-                           const std::vector<std::pair<size_t, size_t>> &,
-                           const std::vector<bool> &>(),
-            "Construct a decoding graph with the given number of vertices, "
-            "edges, and boundary vertices. The edges are represented as a list "
-            "of pairs of vertex indices. The boundary vertices are represented "
-            "as a list of booleans, with True indicating a boundary vertex.",
-            py::arg("num_vertices"), py::arg("edges"),
-            py::arg("boundary_vertices"))
-        .def("get_num_vertices", &SparseGraph::GetNumVertices,
-             "Return the number of vertices in the graph.")
-        .def("get_num_edges", &SparseGraph::GetNumEdges,
-             "Return the number of edges in the graph.")
-        .def("get_edges_touching_vertex", &SparseGraph::GetEdgesTouchingVertex,
-             "Return a list of the indices of edges touching the vertex with "
-             "the given index.",
-             py::arg("vertex_index"))
-        .def("get_vertices_touching_vertex",
-             &SparseGraph::GetVerticesTouchingVertex,
-             "Return a list of the indices of vertices connected to the vertex "
-             "with the given index.",
-             py::arg("vertex_index"))
-        .def("get_edges_touching_edge", &SparseGraph::GetEdgesTouchingEdge,
-             "Return a list of the indices of edges touching the edge with the "
-             "given index.",
-             py::arg("edge_index"))
-        .def("get_vertices_connected_by_edge",
-             &SparseGraph::GetVerticesConnectedByEdge,
-             "Return a list of the indices of vertices connected by the edge "
-             "with the given index.",
-             py::arg("edge_index"))
-        .def("is_vertex_on_boundary", &DecodingGraph::IsVertexOnBoundary,
-             "Return True if the vertex with the given index is a boundary "
-             "vertex, and False otherwise.",
-             py::arg("vertex_index"));
+    py::enum_<HyperedgeDecomposition>(
+        m, "HyperedgeDecomposition",
+        "How the hyperedges of a hypergraph are split into edges.")
+        .value("Pairs", HyperedgeDecomposition::Pairs,
+               "Pair consecutive vertices of each hyperedge and connect the "
+               "last vertex of an odd hyperedge to the boundary, which flips "
+               "the same vertices as the hyperedge.")
+        .value("Clique", HyperedgeDecomposition::Clique,
+               "Connect every pair of vertices of each hyperedge.");
+
+    py::enum_<SyndromeLayout>(m, "SyndromeLayout",
+                              "How the bits of a syndrome batch are laid out.")
+        .value("ShotMajor", SyndromeLayout::ShotMajor,
+               "One row of bits per shot.")
+        .value("DetectorMajor", SyndromeLayout::DetectorMajor,
+               "One row of bits per detector.");
+
+    py::enum_<Reordering::VertexOrder>(m, "VertexOrder",
+                                       "An order of the vertices of a graph.")
+        .value("ReverseCuthillMcKee",
+               Reordering::VertexOrder::ReverseCuthillMcKee,
+               "Reverse Cuthill-McKee order, which reduces the bandwidth of "
+               "the adjacency matrix.")
+        .value("BreadthFirst", Reordering::VertexOrder::BreadthFirst,
+               "Breadth-first search order.")
+        .value("Morton", Reordering::VertexOrder::Morton,
+               "Z-order curve through the coordinates of the vertices.");
+
+    m.attr("query_counters_enabled") = kQueryCountersEnabled;
+
+    RegisterSparseGraphs<size_t>(m, "SparseGraphRow", "ImplicitEdgeRow",
+                                 "SparseGraph", "DecodingGraph",
+                                 "ShortestPaths", "ClusterGrowth",
+                                 "SyndromeBatch", "WindowedDecodingGraph");
+    RegisterSparseGraphs<uint32_t>(m, "SparseGraphRow32", "ImplicitEdgeRow32",
+                                   "SparseGraph32", "DecodingGraph32",
+                                   "ShortestPaths32", "ClusterGrowth32",
+                                   "SyndromeBatch32",
+                                   "WindowedDecodingGraph32");
+    RegisterCompressedGraphs<size_t>(m, "CompressedGraphRow",
+                                     "CompressedSparseGraph");
+    RegisterCompressedGraphs<uint32_t>(m, "CompressedGraphRow32",
+                                       "CompressedSparseGraph32");
+    RegisterHypergraph<size_t>(m, "Hypergraph");
+    RegisterHypergraph<uint32_t>(m, "Hypergraph32");
+
+    m.def("load_graph", &LoadGraph,
+          "Load a graph saved with the save method of a SparseGraph or "
+          "DecodingGraph. The class of the returned graph matches the saved "
+          "graph. With mmap=True, the file is memory-mapped and its arrays "
+          "are used in place, so that processes loading the same file share "
+          "its pages. Otherwise the file is read into memory.",
+          py::arg("path"), py::arg("mmap") = true);
 }
 
 } // namespace
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "DecodingGraph.hpp"
+
+namespace Plaquette {
+
+/**
+ * @class ClusterGrowth
+ * @brief Cluster growth and merging for union-find decoding.
+ *
+ * Starting from a set of defect vertices, every cluster with an odd number of
+ * defects that does not touch a boundary vertex (an active cluster) grows by
+ * half an edge per round along the edges leaving its boundary vertices. The
+ * growth of each half-edge is counted separately, indexed by the local edge
+ * IDs of the `DecodingGraph`, and an edge of weight `w` is fully grown once
+ * its two halves add up to `2 w`. The endpoints of fully grown edges are
+ * merged into one cluster.
+ *
+ * Clusters are kept in a forest with path compression and union by size.
+ * Each root stores the parity of its defects, whether the cluster touches the
+ * boundary, and the list of its vertices that still have edges to grow, which
+ * is pruned incrementally instead of being recomputed every round.
+ *
+ * All per-vertex and per-edge arrays are allocated once, and the vertices,
+ * half-edges and edges touched by a shot are recorded so that `Reset` only
+ * restores those. The cost of a shot is therefore proportional to the size of
+ * its clusters rather than to the size of the graph.
+ *
+ * @tparam IndexT Unsigned integer type of the indices of the graph.
+ */
+template <typename IndexT = size_t> class ClusterGrowth {
+  public:
+    using graph_type = DecodingGraph<IndexT>;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param graph The decoding graph, which must outlive this object.
+     */
+    explicit ClusterGrowth(const graph_type &graph)
+        : graph_(graph), parent_(graph.GetNumVertices()),
+          size_(graph.GetNumVertices(), 1),
+          flags_(graph.GetNumVertices(), 0),
+          boundary_(graph.GetNumVertices()),
+          growth_(graph.GetNumLocalEdges(), 0),
+          edge_grown_(graph.GetNumEdges(), 0) {
+        for (size_t v = 0; v < parent_.size(); v++) {
+            parent_[v] = static_cast<IndexT>(v);
+        }
+    }
+
+    /**
+     * @brief Clear the clusters of the previous shot.
+     *
+     * Only the state touched since the last reset is restored.
+     */
+    void Reset() {
+        for (IndexT v : touched_vertices_) {
+            parent_[v] = v;
+            size_[v] = 1;
+            flags_[v] = 0;
+            boundary_[v].clear();
+        }
+        for (IndexT local : touched_half_edges_) {
+            growth_[local] = 0;
+        }
+        for (IndexT e : grown_edges_) {
+            edge_grown_[e] = 0;
+        }
+        touched_vertices_.clear();
+        touched_half_edges_.clear();
+        grown_edges_.clear();
+        active_.clear();
+    }
+
+    /**
+     * @brief Reset the clusters and start one cluster per defect.
+     *
+     * A vertex listed an even number of times is not a defect.
+     *
+     * @param defects The indices of the defect vertices.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    void LoadDefects(std::span<const IndexT> defects) {
+        Reset();
+        for (IndexT v : defects) {
+            if (v >= parent_.size()) {
+                throw std::out_of_range(
+                    "ClusterGrowth: vertex index out of range");
+            }
+            AddVertex_(v);
+            flags_[v] ^= kOdd;
+        }
+        for (IndexT v : defects) {
+            Activate_(v);
+        }
+        FinishActivation_();
+    }
+
+    /**
+     * @brief Grow every active cluster by half an edge and merge the clusters
+     * connected by fully grown edges.
+     *
+     * @return false if no half-edge could grow, which happens when there are
+     * no active clusters or when the active clusters have no edges left to
+     * grow, and true otherwise.
+     */
+    bool Grow() {
+        bool grew = false;
+        fusion_edges_.clear();
+        for (IndexT root : active_) {
+            for (IndexT v : boundary_[root]) {
+                const size_t stride = graph_.GetLocalEdgeStride(v);
+                const auto &edges = graph_.GetEdgesTouchingVertex(v);
+                for (size_t k = 0; k < edges.size(); k++) {
+                    grew |= GrowHalfEdge_(edges[k], stride + k);
+                }
+            }
+        }
+
+        for (IndexT e : fusion_edges_) {
+            const auto &vertices = graph_.GetVerticesConnectedByEdge(e);
+            Union_(vertices.first, vertices.second);
+        }
+
+        previous_active_.swap(active_);
+        active_.clear();
+        for (IndexT root : previous_active_) {
+            Activate_(FindRoot(root));
+        }
+        FinishActivation_();
+        for (IndexT root : active_) {
+            PruneBoundary_(root);
+        }
+        return grew;
+    }
+
+    /**
+     * @brief Grow the clusters until none of them is active.
+     *
+     * @return true if every cluster is neutral, and false if some odd
+     * clusters cannot reach another defect or the boundary.
+     */
+    bool GrowUntilNeutral() {
+        while (!active_.empty()) {
+            if (!Grow()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Find the root of the cluster of a vertex, compressing the path
+     * to it.
+     *
+     * @param vertex The index of the vertex.
+     * @return The index of the root, which is `vertex` itself for vertices
+     * outside every cluster.
+     */
+    IndexT FindRoot(size_t vertex) {
+        IndexT root = static_cast<IndexT>(vertex);
+        while (parent_[root] != root) {
+            root = parent_[root];
+        }
+        for (IndexT v = static_cast<IndexT>(vertex); parent_[v] != root;) {
+            IndexT next = parent_[v];
+            parent_[v] = root;
+            v = next;
+        }
+        return root;
+    }
+
+    /**
+     * @brief Check whether a vertex belongs to a cluster.
+     */
+    bool IsVertexInCluster(size_t vertex) const {
+        return (flags_[vertex] & kInCluster) != 0;
+    }
+
+    /**
+     * @brief Check whether a cluster holds an odd number of defects.
+     *
+     * @param root The root of the cluster, as returned by `FindRoot`.
+     */
+    bool IsClusterOdd(size_t root) const { return (flags_[root] & kOdd) != 0; }
+
+    /**
+     * @brief Check whether a cluster contains a boundary vertex.
+     *
+     * @param root The root of the cluster, as returned by `FindRoot`.
+     */
+    bool IsClusterOnBoundary(size_t root) const {
+        return (flags_[root] & kBoundary) != 0;
+    }
+
+    /**
+     * @brief Get the number of vertices in a cluster.
+     *
+     * @param root The root of the cluster, as returned by `FindRoot`.
+     */
+    size_t GetClusterSize(size_t root) const { return size_[root]; }
+
+    /**
+     * @brief Get the vertices of a cluster that still have edges to grow.
+     *
+     * The list is only pruned for active clusters, so the boundary of an
+     * inactive cluster may contain vertices whose edges are all grown.
+     *
+     * @param root The root of the cluster, as returned by `FindRoot`.
+     */
+    std::span<const IndexT> GetClusterBoundary(size_t root) const {
+        return boundary_[root];
+    }
+
+    /**
+     * @brief Get the roots of the active clusters.
+     */
+    std::span<const IndexT> GetActiveClusters() const { return active_; }
+
+    /**
+     * @brief Get the growth of a half-edge, in half units of edge weight.
+     *
+     * @param local_edge The local edge ID of the half-edge.
+     */
+    uint64_t GetHalfEdgeGrowth(size_t local_edge) const {
+        return growth_[local_edge];
+    }
+
+    /**
+     * @brief Check whether an edge is fully grown.
+     */
+    bool IsEdgeGrown(size_t edge) const { return edge_grown_[edge] != 0; }
+
+    /**
+     * @brief Get the fully grown edges, in the order in which they were grown.
+     *
+     * Together with the defects, these edges form the input of the peeling
+     * step of a union-find decoder.
+     */
+    std::span<const IndexT> GetGrownEdges() const { return grown_edges_; }
+
+    /**
+     * @brief Get the number of vertices touched since the last reset.
+     */
+    size_t GetNumTouchedVertices() const { return touched_vertices_.size(); }
+
+    /**
+     * @brief Get the decoding graph on which the clusters grow.
+     */
+    const graph_type &GetGraph() const { return graph_; }
+
+  private:
+    // Flags of the vertices, of which kOdd and kBoundary are only meaningful
+    // for roots
+    static constexpr uint8_t kInCluster = 1;
+    static constexpr uint8_t kOdd = 2;
+    static constexpr uint8_t kBoundary = 4;
+    static constexpr uint8_t kQueued = 8;
+
+    // Make a vertex outside every cluster a cluster of its own
+    void AddVertex_(IndexT v) {
+        if (flags_[v] & kInCluster) {
+            return;
+        }
+        flags_[v] |= kInCluster;
+        if (graph_.IsVertexOnBoundary(v)) {
+            flags_[v] |= kBoundary;
+        }
+        touched_vertices_.push_back(v);
+        boundary_[v].push_back(v);
+    }
+
+    // Queue a root as active if it is odd and does not touch the boundary
+    void Activate_(IndexT root) {
+        if ((flags_[root] & (kOdd | kBoundary | kQueued)) == kOdd) {
+            flags_[root] |= kQueued;
+            active_.push_back(root);
+        }
+    }
+
+    void FinishActivation_() {
+        for (IndexT root : active_) {
+            flags_[root] &= ~kQueued;
+        }
+    }
+
+    // Grow the half-edge `local` of edge `e`, returning whether it grew
+    bool GrowHalfEdge_(IndexT e, size_t local) {
+        if (edge_grown_[e]) {
+            return false;
+        }
+        if (growth_[local] == 0) {
+            touched_half_edges_.push_back(static_cast<IndexT>(local));
+        }
+        growth_[local]++;
+
+        const uint64_t grown =
+            growth_[graph_.GetLocalEdgeFromGlobalEdge(e, 0)] +
+            growth_[graph_.GetLocalEdgeFromGlobalEdge(e, 1)];
+        if (grown >= 2 * static_cast<uint64_t>(graph_.GetEdgeWeight(e))) {
+            edge_grown_[e] = 1;
+            grown_edges_.push_back(e);
+            fusion_edges_.push_back(e);
+        }
+        return true;
+    }
+
+    // Merge the clusters of two vertices, adding them to clusters if needed
+    void Union_(IndexT u, IndexT v) {
+        AddVertex_(u);
+        AddVertex_(v);
+        IndexT ru = FindRoot(u);
+        IndexT rv = FindRoot(v);
+        if (ru == rv) {
+            return;
+        }
+        if (size_[ru] < size_[rv]) {
+            std::swap(ru, rv);
+        }
+        parent_[rv] = ru;
+        size_[ru] += size_[rv];
+        flags_[ru] ^= flags_[rv] & kOdd;
+        flags_[ru] |= flags_[rv] & kBoundary;
+
+        auto &boundary = boundary_[ru];
+        boundary.insert(boundary.end(), boundary_[rv].begin(),
+                        boundary_[rv].end());
+        boundary_[rv].clear();
+    }
+
+    // Remove the vertices whose edges are all grown from a boundary list
+    void PruneBoundary_(IndexT root) {
+        auto &boundary = boundary_[root];
+        size_t kept = 0;
+        for (IndexT v : boundary) {
+            for (IndexT e : graph_.GetEdgesTouchingVertex(v)) {
+                if (!edge_grown_[e]) {
+                    boundary[kept++] = v;
+                    break;
+                }
+            }
+        }
+        boundary.resize(kept);
+    }
+
+    const graph_type &graph_;
+
+    std::vector<IndexT> parent_;
+    std::vector<IndexT> size_;
+    std::vector<uint8_t> flags_;
+    std::vector<std::vector<IndexT>> boundary_;
+    std::vector<uint64_t> growth_;
+    std::vector<uint8_t> edge_grown_;
+
+    std::vector<IndexT> active_;
+    std::vector<IndexT> previous_active_;
+    std::vector<IndexT> fusion_edges_;
+    std::vector<IndexT> grown_edges_;
+    std::vector<IndexT> touched_vertices_;
+    std::vector<IndexT> touched_half_edges_;
+};
+
+}; // namespace Plaquette
@@ -0,0 +1,787 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Instrumentation.hpp"
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+
+// Map a wrapped difference to an unsigned integer, small differences of
+// either sign getting small codes
+inline uint64_t ZigZag_(uint64_t delta) {
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+inline uint64_t UnZigZag_(uint64_t code) {
+    return (code >> 1) ^ (0 - (code & 1));
+}
+
+// Read `width` bits starting at bit `bit` of a byte stream padded with at
+// least 8 bytes, the bits of each byte being read from the least significant
+inline uint64_t ReadBits_(const uint8_t *data, size_t bit, unsigned width) {
+    const uint8_t *p = data + bit / 8;
+    const unsigned shift = bit % 8;
+    uint64_t word;
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&word, p, sizeof(word));
+    } else {
+        word = 0;
+        for (unsigned i = 0; i < 8; i++) {
+            word |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+    }
+    uint64_t value = word >> shift;
+    if (shift + width > 64) {
+        value |= static_cast<uint64_t>(p[8]) << (64 - shift);
+    }
+    return width == 64 ? value : value & ((uint64_t{1} << width) - 1);
+}
+
+inline uint64_t ReadVarint_(const uint8_t *&p) {
+    uint64_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+}
+
+inline void WriteVarint_(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Flag of the width byte of streams whose values never decrease, whose
+// differences are stored without zigzag encoding
+constexpr uint8_t kSortedStream_ = 0x80;
+
+/**
+ * @brief Append a compressed stream of values to a byte array.
+ *
+ * The first value is stored as a varint of its zigzag-encoded difference to
+ * `prediction`, followed by one byte giving the bit width of the remaining
+ * values and their differences to the previous value, packed at that width.
+ * The differences are zigzag-encoded unless the values never decrease, which
+ * is flagged by `kSortedStream_` in the width byte. Sorted rows of
+ * neighbouring IDs have small differences, so most rows pack into a few bits
+ * per value, and the fixed width of a row lets it be decoded with shifts and
+ * masks only.
+ *
+ * @param out The byte array to append to.
+ * @param values The values of the stream.
+ * @param prediction The expected value of the first value.
+ */
+template <typename IndexT>
+void EncodeStream_(std::vector<uint8_t> &out, std::span<const IndexT> values,
+                   uint64_t prediction) {
+    if (values.empty()) {
+        return;
+    }
+    WriteVarint_(out, ZigZag_(uint64_t{values[0]} - prediction));
+    const bool sorted = std::is_sorted(values.begin(), values.end());
+    auto code = [&](size_t k) {
+        const uint64_t delta = uint64_t{values[k]} - uint64_t{values[k - 1]};
+        return sorted ? delta : ZigZag_(delta);
+    };
+    uint64_t max_code = 0;
+    for (size_t k = 1; k < values.size(); k++) {
+        max_code = std::max(max_code, code(k));
+    }
+    const unsigned width = static_cast<unsigned>(std::bit_width(max_code));
+    out.push_back(static_cast<uint8_t>(width | (sorted ? kSortedStream_ : 0)));
+
+    const size_t start = out.size();
+    out.resize(start + ((values.size() - 1) * width + 7) / 8, 0);
+    size_t bit = 0;
+    for (size_t k = 1; k < values.size(); k++) {
+        const uint64_t bits = code(k);
+        for (unsigned b = 0; b < width; b += 8 - (bit + b) % 8) {
+            const size_t at = bit + b;
+            out[start + at / 8] |=
+                static_cast<uint8_t>((bits >> b) << (at % 8));
+        }
+        bit += width;
+    }
+}
+
+/**
+ * @brief A row of a compressed adjacency matrix, decoded on iteration.
+ *
+ * The `CompressedGraphRow` class provides the interface of `SparseGraphRow`
+ * over a stream written by `EncodeStream_`: `size()`, `operator[]()` and
+ * forward iterators. The values are decoded one after the other, so a full
+ * iteration takes linear time, while `operator[]()` takes time linear in the
+ * index. Rows and their iterators are non-owning views and must not outlive
+ * their graph.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> class CompressedGraphRow {
+  public:
+    using index_type = IndexT;
+
+    /**
+     * @brief Forward iterator decoding the values of a row.
+     */
+    class Iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IndexT;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const IndexT *;
+        using reference = IndexT;
+
+        Iterator() = default;
+        Iterator(const CompressedGraphRow &row, size_t pos)
+            : packed_(row.packed_), width_(row.width_), sorted_(row.sorted_),
+              size_(row.size_), pos_(pos), value_(row.first_) {}
+
+        IndexT operator*() const { return static_cast<IndexT>(value_); }
+
+        Iterator &operator++() {
+            if (++pos_ < size_) {
+                const uint64_t bits =
+                    ReadBits_(packed_, (pos_ - 1) * width_, width_);
+                value_ += sorted_ ? bits : UnZigZag_(bits);
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return pos_ == other.pos_;
+        }
+
+      private:
+        const uint8_t *packed_ = nullptr;
+        unsigned width_ = 0;
+        bool sorted_ = false;
+        size_t size_ = 0;
+        size_t pos_ = 0;
+        uint64_t value_ = 0;
+    };
+
+    CompressedGraphRow() = default;
+
+    /**
+     * @brief Construct a view of a stream.
+     *
+     * @param stream The start of the stream.
+     * @param size The number of values of the stream.
+     * @param prediction The prediction the stream was encoded with.
+     */
+    CompressedGraphRow(const uint8_t *stream, size_t size, uint64_t prediction)
+        : size_(size) {
+        if (size == 0) {
+            return;
+        }
+        first_ = prediction + UnZigZag_(ReadVarint_(stream));
+        width_ = *stream & ~kSortedStream_;
+        sorted_ = (*stream++ & kSortedStream_) != 0;
+        packed_ = stream;
+    }
+
+    // Get the number of non-zero elements in the row
+    size_t size() const { return size_; }
+
+    // Get the value at a specific index in the row
+    IndexT operator[](size_t index) const {
+        return *std::next(begin(), index);
+    }
+
+    // Iterators over the elements of the row
+    Iterator begin() const { return Iterator(*this, 0); }
+    Iterator end() const { return Iterator(*this, size_); }
+
+    // Get the first byte after the stream
+    const uint8_t *GetStreamEnd() const {
+        return size_ == 0 ? packed_ : packed_ + ((size_ - 1) * width_ + 7) / 8;
+    }
+
+  private:
+    size_t size_ = 0;
+    uint64_t first_ = 0;
+    unsigned width_ = 0;
+    bool sorted_ = false;
+    const uint8_t *packed_ = nullptr;
+};
+
+/**
+ * @class CompressedSparseGraph
+ * @brief A sparse graph whose adjacency matrices are stored compressed.
+ *
+ * The graph has the read interface of `SparseGraph`, with the vertex-vertex
+ * and edge-edge adjacency matrices stored as byte streams instead of arrays
+ * of indices. Each row is sorted, and its neighbouring vertices and edges are
+ * delta-encoded and bit-packed by `EncodeStream_`. The first vertex of the
+ * row of `v` is predicted to be `v`, and its first edge to be proportional to
+ * `v`, which holds for graphs whose vertices and edges are numbered with
+ * locality, e.g. by the generators or after `Reordering::Reorder`. Such
+ * graphs typically take one to two bytes per half-edge instead of two to
+ * four indices.
+ *
+ * The rows are decoded as they are iterated, so scans are somewhat slower
+ * than with `SparseGraph`. The rows are the rows of `SparseGraph` with
+ * `SparseGraphOptions::sort_rows`, and the edge-edge rows are sorted by edge.
+ * The edge to vertices list and the edge weights are not compressed.
+ *
+ * As for `SparseGraph`, the const member functions may be called from
+ * several threads at once.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> class CompressedSparseGraph {
+    static_assert(std::is_unsigned_v<IndexT>,
+                  "CompressedSparseGraph index type must be an unsigned "
+                  "integer");
+
+  public:
+    using index_type = IndexT;
+    using row_type = CompressedGraphRow<IndexT>;
+    using edge_type = std::pair<IndexT, IndexT>;
+    using weight_type = EdgeWeight;
+
+    /**
+     * @brief Index returned by edge lookups that find no edge.
+     */
+    static constexpr IndexT kInvalidIndex = std::numeric_limits<IndexT>::max();
+
+  private:
+    /**
+     * @brief A compressed matrix: the byte offset of every row, and the rows,
+     * followed by padding for `ReadBits_`.
+     */
+    struct CompressedMatrix {
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t> data;
+    };
+
+    // Lazily constructed edge-edge matrix, shared by copies of the graph, or
+    // null in a moved-from graph, which has no matrix to construct
+    struct EdgeToEdgeMatrix {
+        std::mutex mutex;
+        std::atomic<bool> constructed = false;
+        CompressedMatrix matrix;
+    };
+
+    static constexpr size_t kPadding_ = 8;
+
+    size_t num_vertices_ = 0;
+    double edges_per_vertex_ = 0;
+    CompressedMatrix v_to_v_;
+    std::shared_ptr<EdgeToEdgeMatrix> e_to_e_ =
+        std::make_shared<EdgeToEdgeMatrix>();
+    std::vector<edge_type> e_to_v_;
+    std::vector<weight_type> edge_weights_;
+
+    // Predict the first edge of a vertex row
+    uint64_t PredictEdge_(size_t vertex_index) const {
+        return static_cast<uint64_t>(static_cast<double>(vertex_index) *
+                                     edges_per_vertex_);
+    }
+
+    // Get the neighbouring vertices and the edges of a vertex row
+    std::pair<row_type, row_type> GetVertexRow_(size_t vertex_index) const {
+        const uint8_t *p = v_to_v_.data.data() + v_to_v_.offsets[vertex_index];
+        const size_t size = ReadVarint_(p);
+        row_type vertices(p, size, vertex_index);
+        row_type edges(vertices.GetStreamEnd(), size,
+                       PredictEdge_(vertex_index));
+        return {vertices, edges};
+    }
+
+    void Compress_(const SparseGraph<IndexT> &graph,
+                   EdgeToEdgeMode edge_to_edge) {
+        num_vertices_ = graph.GetNumVertices();
+        const size_t num_edges = graph.GetNumEdges();
+        edges_per_vertex_ =
+            num_vertices_ == 0 ? 0.0
+                               : static_cast<double>(num_edges) /
+                                     static_cast<double>(num_vertices_);
+        auto e_to_v = graph.GetEdgeToVertex();
+        e_to_v_.assign(e_to_v.begin(), e_to_v.end());
+        auto weights = graph.GetEdgeWeights();
+        edge_weights_.assign(weights.begin(), weights.end());
+
+        // Sort the rows by neighbouring vertex, keeping the order of the
+        // edges between the same pair of vertices
+        std::vector<std::pair<IndexT, IndexT>> row;
+        std::vector<IndexT> vertices, edges;
+        v_to_v_.offsets.resize(num_vertices_ + 1);
+        for (size_t v = 0; v < num_vertices_; v++) {
+            v_to_v_.offsets[v] = v_to_v_.data.size();
+            auto cols = graph.GetVerticesTouchingVertex(v);
+            auto ids = graph.GetEdgesTouchingVertex(v);
+            row.clear();
+            for (size_t k = 0; k < cols.size(); k++) {
+                row.emplace_back(cols[k], ids[k]);
+            }
+            if (!graph.AreRowsSorted()) {
+                std::stable_sort(
+                    row.begin(), row.end(),
+                    [](const auto &a, const auto &b) {
+                        return a.first < b.first;
+                    });
+            }
+            vertices.clear();
+            edges.clear();
+            for (const auto &[u, e] : row) {
+                vertices.push_back(u);
+                edges.push_back(e);
+            }
+            WriteVarint_(v_to_v_.data, row.size());
+            EncodeStream_<IndexT>(v_to_v_.data, vertices, v);
+            EncodeStream_<IndexT>(v_to_v_.data, edges, PredictEdge_(v));
+        }
+        v_to_v_.offsets[num_vertices_] = v_to_v_.data.size();
+        v_to_v_.data.resize(v_to_v_.data.size() + kPadding_, 0);
+        v_to_v_.data.shrink_to_fit();
+
+        if (edge_to_edge == EdgeToEdgeMode::Eager) {
+            ConstructEdgeToEdgeMatrix_();
+        }
+    }
+
+    // Build the edge-edge matrix from the compressed vertex rows, one edge
+    // at a time, so that the uncompressed matrix is never held in memory
+    void BuildEdgeToEdgeMatrix_(CompressedMatrix &matrix) const {
+        const size_t num_edges = GetNumEdges();
+        std::vector<IndexT> row;
+        matrix.offsets.resize(num_edges + 1);
+        for (size_t e = 0; e < num_edges; e++) {
+            matrix.offsets[e] = matrix.data.size();
+            const auto &[u, v] = e_to_v_[e];
+            row.clear();
+            for (IndexT f : GetEdgesTouchingVertex(u)) {
+                row.push_back(f);
+            }
+            if (u != v) {
+                for (IndexT f : GetEdgesTouchingVertex(v)) {
+                    row.push_back(f);
+                }
+            }
+            std::sort(row.begin(), row.end());
+            row.erase(std::unique(row.begin(), row.end()), row.end());
+            row.erase(std::lower_bound(row.begin(), row.end(),
+                                       static_cast<IndexT>(e)));
+            WriteVarint_(matrix.data, row.size());
+            EncodeStream_<IndexT>(matrix.data, row, e);
+        }
+        matrix.offsets[num_edges] = matrix.data.size();
+        matrix.data.resize(matrix.data.size() + kPadding_, 0);
+        matrix.data.shrink_to_fit();
+    }
+
+    static size_t MatrixBytes_(const CompressedMatrix &matrix) {
+        return matrix.offsets.size() * sizeof(uint64_t) + matrix.data.size();
+    }
+
+    /**
+     * @brief Construct the compressed edge-edge adjacency matrix.
+     *
+     * The matrix is constructed at most once, even if this function is called
+     * concurrently from several threads.
+     */
+    void ConstructEdgeToEdgeMatrix_() const {
+        if (!e_to_e_) {
+            return;
+        }
+        auto &e_to_e = *e_to_e_;
+        if (e_to_e.constructed.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard lock(e_to_e.mutex);
+        if (e_to_e.constructed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        BuildEdgeToEdgeMatrix_(e_to_e.matrix);
+        e_to_e.constructed.store(true, std::memory_order_release);
+    }
+
+    // Move the contents of `other` into this graph, leaving `other` an empty
+    // graph
+    void MoveFrom_(CompressedSparseGraph &other) noexcept {
+        num_vertices_ = std::exchange(other.num_vertices_, 0);
+        edges_per_vertex_ = std::exchange(other.edges_per_vertex_, 0);
+        v_to_v_ = std::move(other.v_to_v_);
+        e_to_e_ = std::move(other.e_to_e_);
+        e_to_v_ = std::move(other.e_to_v_);
+        edge_weights_ = std::move(other.edge_weights_);
+    }
+
+  public:
+    CompressedSparseGraph() = default;
+    CompressedSparseGraph(const CompressedSparseGraph &) = default;
+    CompressedSparseGraph &operator=(const CompressedSparseGraph &) = default;
+
+    /**
+     * @brief Move constructor, leaving `other` an empty graph.
+     */
+    CompressedSparseGraph(CompressedSparseGraph &&other) noexcept
+        : e_to_e_(nullptr) {
+        MoveFrom_(other);
+    }
+
+    /**
+     * @brief Move assignment, leaving `other` an empty graph.
+     */
+    CompressedSparseGraph &operator=(CompressedSparseGraph &&other) noexcept {
+        if (this != &other) {
+            MoveFrom_(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Compress a graph.
+     *
+     * @param graph The graph to compress.
+     * @param edge_to_edge When to construct the compressed edge-edge
+     * adjacency matrix. It is built from the compressed vertex rows, and the
+     * edge-edge matrix of `graph` is not used.
+     */
+    explicit CompressedSparseGraph(
+        const SparseGraph<IndexT> &graph,
+        EdgeToEdgeMode edge_to_edge = EdgeToEdgeMode::Lazy) {
+        Compress_(graph, edge_to_edge);
+    }
+
+    /**
+     * @brief Construct a compressed graph from a list of edges.
+     *
+     * The graph is first constructed as a `SparseGraph` and then compressed,
+     * so the peak memory is that of the uncompressed graph.
+     *
+     * @param num_vertices The number of vertices in the graph.
+     * @param edges A vector of pairs of vertices.
+     * @param weights The weight of every edge, or empty for an unweighted
+     * graph.
+     * @param options Options controlling the construction of the graph. The
+     * edge-edge matrix is never constructed uncompressed, the rows are always
+     * sorted, and no edge index is built.
+     */
+    CompressedSparseGraph(size_t num_vertices,
+                          const std::vector<std::pair<size_t, size_t>> &edges,
+                          std::span<const weight_type> weights = {},
+                          const SparseGraphOptions &options = {}) {
+        SparseGraphOptions uncompressed = options;
+        uncompressed.edge_to_edge = EdgeToEdgeMode::Lazy;
+        uncompressed.edge_index = false;
+        uncompressed.sort_rows = true;
+        Compress_(SparseGraph<IndexT>(num_vertices, edges, weights,
+                                      uncompressed),
+                  options.edge_to_edge);
+    }
+
+    /**
+     * @brief Decompress the graph.
+     *
+     * @return The equivalent `SparseGraph`, with sorted rows. Its edge-edge
+     * matrix is constructed on first use.
+     */
+    SparseGraph<IndexT> Decompress() const {
+        SparseGraphArrays<IndexT> arrays;
+        std::vector<IndexT> row_ptr(num_vertices_ + 1, 0);
+        std::vector<IndexT> col, ids;
+        col.reserve(2 * GetNumEdges());
+        ids.reserve(2 * GetNumEdges());
+        for (size_t v = 0; v < num_vertices_; v++) {
+            auto [vertices, edges] = GetVertexRow_(v);
+            col.insert(col.end(), vertices.begin(), vertices.end());
+            ids.insert(ids.end(), edges.begin(), edges.end());
+            row_ptr[v + 1] = static_cast<IndexT>(col.size());
+        }
+        arrays.v_to_v_row_ptr = std::move(row_ptr);
+        arrays.v_to_v_col = std::move(col);
+        arrays.v_to_v_edges = std::move(ids);
+        arrays.e_to_v = std::vector<edge_type>(e_to_v_);
+        arrays.edge_weights = std::vector<weight_type>(edge_weights_);
+        arrays.sorted_rows = true;
+        return SparseGraph<IndexT>::FromArrays(num_vertices_,
+                                               std::move(arrays));
+    }
+
+    /**
+     * @brief Get the number of vertices in the graph.
+     */
+    size_t GetNumVertices() const { return num_vertices_; }
+
+    /**
+     * @brief Get the number of edges in the graph.
+     */
+    size_t GetNumEdges() const { return e_to_v_.size(); }
+
+    /**
+     * @brief Check whether the edges of the graph carry weights.
+     */
+    bool HasEdgeWeights() const { return !edge_weights_.empty(); }
+
+    /**
+     * @brief Get the weight of an edge.
+     *
+     * @param edge_index The index of the edge in the graph.
+     * @return The weight of the edge, or 1 if the graph is unweighted.
+     */
+    weight_type GetEdgeWeight(size_t edge_index) const {
+        return edge_weights_.empty() ? weight_type{1}
+                                     : edge_weights_[edge_index];
+    }
+
+    /**
+     * @brief Check whether each vertex-vertex row is sorted by neighbouring
+     * vertex, which is always the case.
+     */
+    bool AreRowsSorted() const { return true; }
+
+    /**
+     * @brief Check whether the edge-edge adjacency matrix is constructed.
+     */
+    bool IsEdgeToEdgeMatrixConstructed() const {
+        return e_to_e_ &&
+               e_to_e_->constructed.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the number of bytes taken by the compressed adjacency
+     * matrices, including their row offsets.
+     *
+     * The edge-edge matrix is only counted once it is constructed.
+     */
+    size_t GetCompressedBytes() const {
+        return MatrixBytes_(v_to_v_) +
+               (IsEdgeToEdgeMatrixConstructed()
+                    ? MatrixBytes_(e_to_e_->matrix)
+                    : 0);
+    }
+
+    /**
+     * @brief Get the memory held by each array of the graph.
+     *
+     * The edge-edge arrays are only reported once the matrix is constructed.
+     *
+     * @return The footprint of every array.
+     */
+    MemoryFootprint GetMemoryFootprint() const {
+        MemoryFootprint footprint;
+        footprint.Add("v_to_v_offsets", v_to_v_.offsets);
+        footprint.Add("v_to_v_data", v_to_v_.data);
+        footprint.Add("e_to_v", e_to_v_);
+        footprint.Add("edge_weights", edge_weights_);
+        if (IsEdgeToEdgeMatrixConstructed()) {
+            footprint.Add("e_to_e_offsets", e_to_e_->matrix.offsets);
+            footprint.Add("e_to_e_data", e_to_e_->matrix.data);
+        }
+        return footprint;
+    }
+
+    /**
+     * @brief Get the edges that touch a given vertex.
+     *
+     * @param vertex_index The index of the vertex in the graph.
+     * @return The edges of the vertex, in the order of its neighbouring
+     * vertices.
+     */
+    row_type GetEdgesTouchingVertex(size_t vertex_index) const {
+        return GetVertexRow_(vertex_index).second;
+    }
+
+    /**
+     * @brief Get the vertices connected to a given vertex.
+     *
+     * @param vertex_index The index of the vertex in the graph.
+     * @return The neighbouring vertices, in increasing order.
+     */
+    row_type GetVerticesTouchingVertex(size_t vertex_index) const {
+        return GetVertexRow_(vertex_index).first;
+    }
+
+    /**
+     * @brief Get the edges that touch a given edge.
+     *
+     * The matrix is constructed on the first call if the graph was created
+     * with `EdgeToEdgeMode::Lazy`.
+     *
+     * @param edge_index The index of the edge in the graph.
+     * @return The neighbouring edges, in increasing order.
+     */
+    row_type GetEdgesTouchingEdge(size_t edge_index) const {
+        // A moved-from graph has no edges and no matrix
+        if (!e_to_e_) {
+            return row_type();
+        }
+        ConstructEdgeToEdgeMatrix_();
+        const auto &matrix = e_to_e_->matrix;
+        const uint8_t *p = matrix.data.data() + matrix.offsets[edge_index];
+        const size_t size = ReadVarint_(p);
+        return row_type(p, size, edge_index);
+    }
+
+    /**
+     * @brief Get the pair of vertices connected by a given edge.
+     */
+    const edge_type &GetVerticesConnectedByEdge(size_t edge_index) const {
+        return e_to_v_[edge_index];
+    }
+
+    /**
+     * @brief Get the index of the edge that connects a given pair of vertices.
+     *
+     * The shorter of the rows of the two vertices is decoded until its
+     * neighbouring vertices pass the other vertex. Edges between the same
+     * pair of vertices are in the same order in both rows, so either row
+     * gives the first of them.
+     *
+     * @param vertex_pair A pair of indices of the two vertices.
+     * @return The index of the first edge connecting the vertices, or
+     * `kInvalidIndex` if they are not connected or out of range.
+     */
+    IndexT
+    GetEdgeFromVertexPair(const std::pair<size_t, size_t> &vertex_pair) const {
+        auto [u, v] = vertex_pair;
+        if (u >= num_vertices_ || v >= num_vertices_) {
+            return kInvalidIndex;
+        }
+        auto row = GetVertexRow_(u);
+        auto other = GetVertexRow_(v);
+        if (other.first.size() < row.first.size()) {
+            std::swap(row, other);
+            std::swap(u, v);
+        }
+        auto edge = row.second.begin();
+        for (IndexT w : row.first) {
+            if (w >= v) {
+                return w == v ? *edge : kInvalidIndex;
+            }
+            ++edge;
+        }
+        return kInvalidIndex;
+    }
+
+    /**
+     * @brief Get the edges that touch each vertex of a batch.
+     *
+     * @param vertices The indices of the vertices.
+     * @return The rows of `GetEdgesTouchingVertex` for every vertex,
+     * concatenated in query order.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    RaggedRows<IndexT>
+    GetEdgesTouchingVertices(std::span<const IndexT> vertices) const {
+        return GatherVertexRows_(vertices, false);
+    }
+
+    /**
+     * @brief Get the vertices connected to each vertex of a batch.
+     *
+     * @param vertices The indices of the vertices.
+     * @return The rows of `GetVerticesTouchingVertex` for every vertex,
+     * concatenated in query order.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    RaggedRows<IndexT>
+    GetVerticesTouchingVertices(std::span<const IndexT> vertices) const {
+        return GatherVertexRows_(vertices, true);
+    }
+
+    /**
+     * @brief Get the pair of vertices connected by each edge of a batch.
+     *
+     * @param edges The indices of the edges.
+     * @param out Output array of size `2 * edges.size()`, receiving the two
+     * endpoints of every edge.
+     * @throws std::out_of_range if an edge is not part of the graph.
+     */
+    void GetVerticesConnectedByEdges(std::span<const IndexT> edges,
+                                     std::span<IndexT> out) const {
+        if (out.size() != 2 * edges.size()) {
+            throw std::invalid_argument(
+                "CompressedSparseGraph: output size must be twice the number "
+                "of edges");
+        }
+        for (size_t i = 0; i < edges.size(); i++) {
+            if (edges[i] >= e_to_v_.size()) {
+                throw std::out_of_range(
+                    "CompressedSparseGraph: edge index out of range");
+            }
+            out[2 * i] = e_to_v_[edges[i]].first;
+            out[2 * i + 1] = e_to_v_[edges[i]].second;
+        }
+    }
+
+    /**
+     * @brief Get the index of the edge connecting each pair of vertices of a
+     * batch, as in `GetEdgeFromVertexPair`.
+     *
+     * @param vertex_pairs The flattened pairs of vertices, of size twice the
+     * number of queries.
+     * @param out Output array of size `vertex_pairs.size() / 2`.
+     */
+    void GetEdgesFromVertexPairs(std::span<const IndexT> vertex_pairs,
+                                 std::span<IndexT> out) const {
+        if (2 * out.size() != vertex_pairs.size()) {
+            throw std::invalid_argument(
+                "CompressedSparseGraph: output size must be half the number "
+                "of vertices");
+        }
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] = GetEdgeFromVertexPair(
+                {vertex_pairs[2 * i], vertex_pairs[2 * i + 1]});
+        }
+    }
+
+    /**
+     * @brief Get the edge to vertices lookup list.
+     */
+    std::span<const edge_type> GetEdgeToVertex() const { return e_to_v_; }
+
+    /**
+     * @brief Get the weight of every edge, empty if the graph is unweighted.
+     */
+    std::span<const weight_type> GetEdgeWeights() const {
+        return edge_weights_;
+    }
+
+  private:
+    RaggedRows<IndexT> GatherVertexRows_(std::span<const IndexT> vertices,
+                                         bool neighbours) const {
+        RaggedRows<IndexT> rows;
+        rows.offsets.reserve(vertices.size() + 1);
+        rows.offsets.push_back(0);
+        for (IndexT v : vertices) {
+            if (v >= num_vertices_) {
+                throw std::out_of_range(
+                    "CompressedSparseGraph: vertex index out of range");
+            }
+            auto [row_vertices, row_edges] = GetVertexRow_(v);
+            const auto &row = neighbours ? row_vertices : row_edges;
+            rows.values.insert(rows.values.end(), row.begin(), row.end());
+            rows.offsets.push_back(rows.values.size());
+        }
+        return rows;
+    }
+};
+}; // namespace Plaquette
@@ -1,8 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "ArrayBuffer.hpp"
+#include "Instrumentation.hpp"
 #include "SparseGraph.hpp"
 
 namespace Plaquette {
+
+/**
+ * @brief The arrays making up a DecodingGraph, in addition to those of its
+ * SparseGraph base.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> struct DecodingGraphArrays {
+    ArrayBuffer<uint8_t> vertex_boundary_type;
+    ArrayBuffer<IndexT> local_edge_strides;
+    ArrayBuffer<IndexT> local_to_global_edge_map;
+    ArrayBuffer<IndexT> global_to_local_edge_map;
+};
+
 /**
  * @class DecodingGraph
  *
@@ -13,22 +34,77 @@ namespace Plaquette {
  * SparseGraph object, with an additional vector of boolean values indicating
  * which vertices are on the boundary of the graph.
  *
+ * @tparam IndexT Unsigned integer type of the stored indices.
  */
-class DecodingGraph : public SparseGraph {
+template <typename IndexT = size_t>
+class DecodingGraph : public SparseGraph<IndexT> {
 
   private:
-    std::vector<bool>
-        vertex_boundary_type_; ///< A vector of boolean values indicating which
+    ArrayBuffer<uint8_t>
+        vertex_boundary_type_; ///< A vector of flags indicating which
                                ///< vertices are on the boundary of the graph.
 
-    std::vector<size_t>
+    ArrayBuffer<IndexT>
         local_edge_strides_; ///< A vector of edge strides for each vertex.
-    std::vector<size_t> local_to_global_edge_map_;
-    std::vector<int> global_to_local_edge_map_;
-    size_t num_local_edges_;
+    ArrayBuffer<IndexT> local_to_global_edge_map_;
+    ArrayBuffer<IndexT> global_to_local_edge_map_;
+    size_t num_local_edges_ = 0;
+    double local_edge_maps_seconds_ = 0;
+
+    // Move the boundary flags and local edge maps of `other`, leaving it
+    // without any
+    void MoveLocalEdgeMaps_(DecodingGraph &other) noexcept {
+        vertex_boundary_type_ = std::move(other.vertex_boundary_type_);
+        local_edge_strides_ = std::move(other.local_edge_strides_);
+        local_to_global_edge_map_ = std::move(other.local_to_global_edge_map_);
+        global_to_local_edge_map_ = std::move(other.global_to_local_edge_map_);
+        num_local_edges_ = std::exchange(other.num_local_edges_, 0);
+        local_edge_maps_seconds_ =
+            std::exchange(other.local_edge_maps_seconds_, 0);
+    }
+
+    /**
+     * @brief Rebuild the graph, leaving it empty if construction throws.
+     */
+    template <typename EdgeList>
+    void Rebuild_(size_t num_vertices, const EdgeList &edges,
+                  std::span<const EdgeWeight> weights,
+                  const std::vector<bool> &vertex_boundary_type,
+                  const SparseGraphOptions &options) {
+        try {
+            SparseGraph<IndexT>::Rebuild(num_vertices, edges, weights,
+                                         options);
+            ConstructLocalEdgeMaps_(vertex_boundary_type);
+        } catch (...) {
+            // Moving out cannot throw and leaves this graph empty
+            DecodingGraph discarded(std::move(*this));
+            throw;
+        }
+    }
 
   public:
     DecodingGraph() = default; ///< Default constructor.
+    DecodingGraph(const DecodingGraph &) = default;
+    DecodingGraph &operator=(const DecodingGraph &) = default;
+
+    /**
+     * @brief Move constructor, leaving `other` an empty decoding graph.
+     */
+    DecodingGraph(DecodingGraph &&other) noexcept
+        : SparseGraph<IndexT>(std::move(other)) {
+        MoveLocalEdgeMaps_(other);
+    }
+
+    /**
+     * @brief Move assignment, leaving `other` an empty decoding graph.
+     */
+    DecodingGraph &operator=(DecodingGraph &&other) noexcept {
+        if (this != &other) {
+            SparseGraph<IndexT>::operator=(std::move(other));
+            MoveLocalEdgeMaps_(other);
+        }
+        return *this;
+    }
     /**
      * @brief Constructor for the DecodingGraph class.
      *
@@ -43,38 +119,236 @@ class DecodingGraph : public SparseGraph {
      * edges in the decoding graph.
      * @param vertex_boundary_type A vector of boolean values indicating which
      * vertices are on the boundary of the decoding graph.
+     * @param options Options controlling the construction of the graph.
+     */
+    DecodingGraph(size_t num_vertices,
+                  const std::vector<std::pair<size_t, size_t>> &edges,
+                  const std::vector<bool> &vertex_boundary_type,
+                  const SparseGraphOptions &options = {})
+        : SparseGraph<IndexT>(num_vertices, edges, options) {
+        ConstructLocalEdgeMaps_(vertex_boundary_type);
+    }
+
+    /**
+     * @brief Construct a decoding graph from a flat `(E, 2)` array of edges.
+     *
+     * @param num_vertices The number of vertices in the decoding graph.
+     * @param edges A view of the edges of the decoding graph.
+     * @param vertex_boundary_type A vector of boolean values indicating which
+     * vertices are on the boundary of the decoding graph.
+     * @param options Options controlling the construction of the graph.
+     */
+    template <typename T>
+    DecodingGraph(size_t num_vertices, const FlatEdgeList<T> &edges,
+                  const std::vector<bool> &vertex_boundary_type,
+                  const SparseGraphOptions &options = {})
+        : SparseGraph<IndexT>(num_vertices, edges, options) {
+        ConstructLocalEdgeMaps_(vertex_boundary_type);
+    }
+
+    /**
+     * @brief Construct a decoding graph with weighted edges.
+     *
+     * @param num_vertices The number of vertices in the decoding graph.
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param weights The weight of every edge, aligned with `edges`.
+     * @param vertex_boundary_type A vector of boolean values indicating which
+     * vertices are on the boundary of the decoding graph.
+     * @param options Options controlling the construction of the graph.
      */
     DecodingGraph(size_t num_vertices,
                   const std::vector<std::pair<size_t, size_t>> &edges,
-                  const std::vector<bool> &vertex_boundary_type)
-        : SparseGraph(num_vertices, edges) {
-        vertex_boundary_type_ = vertex_boundary_type;
+                  std::span<const EdgeWeight> weights,
+                  const std::vector<bool> &vertex_boundary_type,
+                  const SparseGraphOptions &options = {})
+        : SparseGraph<IndexT>(num_vertices, edges, weights, options) {
+        ConstructLocalEdgeMaps_(vertex_boundary_type);
+    }
+
+    template <typename T>
+    DecodingGraph(size_t num_vertices, const FlatEdgeList<T> &edges,
+                  std::span<const EdgeWeight> weights,
+                  const std::vector<bool> &vertex_boundary_type,
+                  const SparseGraphOptions &options = {})
+        : SparseGraph<IndexT>(num_vertices, edges, weights, options) {
+        ConstructLocalEdgeMaps_(vertex_boundary_type);
+    }
+
+    /**
+     * @brief Rebuild the decoding graph from new edges, reusing its memory.
+     *
+     * As `SparseGraph::Rebuild`, the local edge maps are also refilled in
+     * place. If rebuilding throws, the graph is left empty.
+     *
+     * @param num_vertices The number of vertices in the decoding graph.
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param vertex_boundary_type A vector of boolean values indicating which
+     * vertices are on the boundary of the decoding graph.
+     * @param options Options controlling the construction of the graph.
+     */
+    void Rebuild(size_t num_vertices,
+                 const std::vector<std::pair<size_t, size_t>> &edges,
+                 const std::vector<bool> &vertex_boundary_type,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, {}, vertex_boundary_type, options);
+    }
+
+    template <typename T>
+    void Rebuild(size_t num_vertices, const FlatEdgeList<T> &edges,
+                 const std::vector<bool> &vertex_boundary_type,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, {}, vertex_boundary_type, options);
+    }
+
+    /**
+     * @brief Rebuild the decoding graph with weighted edges, reusing its
+     * memory.
+     *
+     * @param num_vertices The number of vertices in the decoding graph.
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param weights The weight of every edge, aligned with `edges`.
+     * @param vertex_boundary_type A vector of boolean values indicating which
+     * vertices are on the boundary of the decoding graph.
+     * @param options Options controlling the construction of the graph.
+     */
+    void Rebuild(size_t num_vertices,
+                 const std::vector<std::pair<size_t, size_t>> &edges,
+                 std::span<const EdgeWeight> weights,
+                 const std::vector<bool> &vertex_boundary_type,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, weights, vertex_boundary_type, options);
+    }
+
+    template <typename T>
+    void Rebuild(size_t num_vertices, const FlatEdgeList<T> &edges,
+                 std::span<const EdgeWeight> weights,
+                 const std::vector<bool> &vertex_boundary_type,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, weights, vertex_boundary_type, options);
+    }
+
+    /**
+     * @brief Construct the boundary flags and the maps between global edges
+     * and local (per-vertex) edges.
+     *
+     * The arrays of a rebuilt graph are refilled in place.
+     *
+     * @param vertex_boundary_type A vector of boolean values indicating which
+     * vertices are on the boundary of the decoding graph.
+     * @throws std::invalid_argument if `vertex_boundary_type` does not hold
+     * one flag per vertex.
+     */
+    void
+    ConstructLocalEdgeMaps_(const std::vector<bool> &vertex_boundary_type) {
+        PhaseTimer timer(local_edge_maps_seconds_);
+        const size_t num_vertices = this->GetNumVertices();
+        if (vertex_boundary_type.size() != num_vertices) {
+            throw std::invalid_argument(
+                "DecodingGraph: expected one boundary flag per vertex");
+        }
+        auto row_ptr = this->GetVertexToVertexRowPtr();
+        auto row_edges = this->GetVertexToVertexEdges();
+        auto *resource = this->GetMemoryResource();
+        auto boundary_type = vertex_boundary_type_.Release(resource);
+        boundary_type.assign(vertex_boundary_type.begin(),
+                             vertex_boundary_type.end());
+        vertex_boundary_type_ = std::move(boundary_type);
 
+        auto local_edge_strides = local_edge_strides_.Release(resource);
+        local_edge_strides.reserve(num_vertices);
         num_local_edges_ = 0;
         for (size_t i = 0; i < num_vertices; i++) {
-            local_edge_strides_.push_back(num_local_edges_);
-            const auto &edges = GetEdgesTouchingVertex(i);
-            num_local_edges_ += edges.size();
+            local_edge_strides.push_back(num_local_edges_);
+            num_local_edges_ += row_ptr[i + 1] - row_ptr[i];
         }
 
-        std::vector<bool> local_edge_visited(GetNumEdges() * 2, false);
-        global_to_local_edge_map_.resize(GetNumEdges() * 2, -1);
-        local_to_global_edge_map_.resize(num_local_edges_);
+        // The first half-edge of every edge is the one met first in the rows,
+        // and is still unset when the second one is met
+        constexpr IndexT unset = static_cast<IndexT>(-1);
+        auto global_to_local_edge_map =
+            global_to_local_edge_map_.Release(resource);
+        global_to_local_edge_map.assign(this->GetNumEdges() * 2, unset);
+        auto local_to_global_edge_map =
+            local_to_global_edge_map_.Release(resource);
+        local_to_global_edge_map.resize(num_local_edges_);
 
         for (size_t i = 0; i < num_vertices; i++) {
-            const auto &edges = GetEdgesTouchingVertex(i);
-            size_t stride = local_edge_strides_[i];
+            auto edges =
+                row_edges.subspan(row_ptr[i], row_ptr[i + 1] - row_ptr[i]);
+            size_t stride = local_edge_strides[i];
             for (size_t e = 0; e < edges.size(); e++) {
-                local_to_global_edge_map_[stride + e] = edges[e];
-                if (local_edge_visited[2 * edges[e] + 0] == false) {
-                    global_to_local_edge_map_[2 * edges[e] + 0] = stride + e;
-                    local_edge_visited[2 * edges[e] + 0] = true;
+                local_to_global_edge_map[stride + e] = edges[e];
+                if (global_to_local_edge_map[2 * edges[e] + 0] == unset) {
+                    global_to_local_edge_map[2 * edges[e] + 0] = stride + e;
                 } else {
-                    global_to_local_edge_map_[2 * edges[e] + 1] = stride + e;
-                    local_edge_visited[2 * edges[e] + 1] = true;
+                    global_to_local_edge_map[2 * edges[e] + 1] = stride + e;
                 }
             }
         }
+
+        local_edge_strides_ = std::move(local_edge_strides);
+        local_to_global_edge_map_ = std::move(local_to_global_edge_map);
+        global_to_local_edge_map_ = std::move(global_to_local_edge_map);
+    }
+
+    /**
+     * @brief Assemble a decoding graph from its arrays.
+     *
+     * As with `SparseGraph::FromArrays`, the arrays are adopted without any
+     * construction work after an O(V + E) consistency check: the local edge
+     * strides must be the row pointers of the graph, and the two local edge
+     * maps must be inverse to each other and to the vertex rows, with
+     * distinct local edges for the two endpoints of every edge.
+     *
+     * @param num_vertices The number of vertices in the decoding graph.
+     * @param graph_arrays The arrays of the underlying sparse graph.
+     * @param arrays The boundary flags and local edge maps.
+     * @return The decoding graph.
+     * @throws std::invalid_argument if the arrays are inconsistent.
+     */
+    static DecodingGraph FromArrays(size_t num_vertices,
+                                    SparseGraphArrays<IndexT> graph_arrays,
+                                    DecodingGraphArrays<IndexT> arrays) {
+        DecodingGraph graph;
+        static_cast<SparseGraph<IndexT> &>(graph) =
+            SparseGraph<IndexT>::FromArrays(num_vertices,
+                                            std::move(graph_arrays));
+
+        const size_t num_half_edges = 2 * graph.GetNumEdges();
+        if (arrays.vertex_boundary_type.size() != num_vertices ||
+            arrays.local_edge_strides.size() != num_vertices ||
+            arrays.local_to_global_edge_map.size() != num_half_edges ||
+            arrays.global_to_local_edge_map.size() != num_half_edges) {
+            throw std::invalid_argument(
+                "DecodingGraph: inconsistent local edge arrays");
+        }
+        auto row_ptr = graph.GetVertexToVertexRowPtr();
+        auto row_edges = graph.GetVertexToVertexEdges();
+        const auto &strides = arrays.local_edge_strides;
+        const auto &local_to_global = arrays.local_to_global_edge_map;
+        const auto &global_to_local = arrays.global_to_local_edge_map;
+        bool consistent =
+            std::ranges::equal(strides, row_ptr.first(num_vertices)) &&
+            std::ranges::equal(local_to_global, row_edges);
+        for (size_t h = 0; consistent && h < num_half_edges; h++) {
+            consistent = global_to_local[h] < num_half_edges &&
+                         local_to_global[global_to_local[h]] == h / 2 &&
+                         (h % 2 == 0 ||
+                          global_to_local[h] != global_to_local[h - 1]);
+        }
+        if (!consistent) {
+            throw std::invalid_argument(
+                "DecodingGraph: inconsistent local edge maps");
+        }
+
+        graph.vertex_boundary_type_ = std::move(arrays.vertex_boundary_type);
+        graph.local_edge_strides_ = std::move(arrays.local_edge_strides);
+        graph.local_to_global_edge_map_ =
+            std::move(arrays.local_to_global_edge_map);
+        graph.global_to_local_edge_map_ =
+            std::move(arrays.global_to_local_edge_map);
+        graph.num_local_edges_ = num_half_edges;
+        return graph;
     }
 
     /**
@@ -89,7 +363,30 @@ class DecodingGraph : public SparseGraph {
      * false otherwise.
      */
     bool IsVertexOnBoundary(size_t vertex_id) const {
-        return vertex_boundary_type_[vertex_id];
+        return vertex_boundary_type_[vertex_id] != 0;
+    }
+
+    /**
+     * @brief Check if each vertex of a batch is on the boundary of the
+     * decoding graph.
+     *
+     * @param vertices The identifiers of the vertices to check.
+     * @param out Output array of the same size as `vertices`.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    void AreVerticesOnBoundary(std::span<const IndexT> vertices,
+                               std::span<bool> out) const {
+        if (out.size() != vertices.size()) {
+            throw std::invalid_argument(
+                "DecodingGraph: output size must match the number of vertices");
+        }
+        for (size_t i = 0; i < vertices.size(); i++) {
+            if (vertices[i] >= vertex_boundary_type_.size()) {
+                throw std::out_of_range(
+                    "DecodingGraph: vertex index out of range");
+            }
+            out[i] = vertex_boundary_type_[vertices[i]] != 0;
+        }
     }
 
     /**
@@ -105,7 +402,7 @@ class DecodingGraph : public SparseGraph {
      * @param vertex_id The ID of the vertex to get the local edge stride for.
      * @return The local edge stride for the given vertex ID.
      */
-    inline size_t GetLocalEdgeStride(size_t vertex_id) const {
+    inline IndexT GetLocalEdgeStride(size_t vertex_id) const {
         return local_edge_strides_[vertex_id];
     }
 
@@ -115,7 +412,7 @@ class DecodingGraph : public SparseGraph {
      * @param local_edge_id The ID of the local edge.
      * @return The corresponding global edge ID.
      */
-    inline size_t GetGlobalEdgeFromLocalEdge(size_t local_edge_id) const {
+    inline IndexT GetGlobalEdgeFromLocalEdge(size_t local_edge_id) const {
         return local_to_global_edge_map_[local_edge_id];
     }
 
@@ -127,9 +424,73 @@ class DecodingGraph : public SparseGraph {
        endpoint of the edge.
        @return The corresponding local edge ID.
     */
-    inline size_t GetLocalEdgeFromGlobalEdge(size_t global_edge_id,
+    inline IndexT GetLocalEdgeFromGlobalEdge(size_t global_edge_id,
                                              size_t left_or_right_id) const {
         return global_to_local_edge_map_[2 * global_edge_id + left_or_right_id];
     }
+
+    /**
+     * @brief Returns the boundary flag of every vertex.
+     *
+     * @return A view of one flag per vertex, nonzero for boundary vertices.
+     */
+    std::span<const uint8_t> GetVertexBoundaryTypes() const {
+        return vertex_boundary_type_;
+    }
+
+    /**
+     * @brief Returns the local edge stride of every vertex.
+     *
+     * @return A view of one stride per vertex.
+     */
+    std::span<const IndexT> GetLocalEdgeStrides() const {
+        return local_edge_strides_;
+    }
+
+    /**
+     * @brief Returns the map from local edge IDs to global edge IDs.
+     *
+     * @return A view of one global edge ID per local edge.
+     */
+    std::span<const IndexT> GetLocalToGlobalEdgeMap() const {
+        return local_to_global_edge_map_;
+    }
+
+    /**
+     * @brief Returns the map from global edge endpoints to local edge IDs.
+     *
+     * @return A view of two local edge IDs per global edge.
+     */
+    std::span<const IndexT> GetGlobalToLocalEdgeMap() const {
+        return global_to_local_edge_map_;
+    }
+
+    /**
+     * @brief Get the time spent in each phase of the construction of the
+     * decoding graph, including its local edge maps.
+     *
+     * @return The timings, in seconds.
+     */
+    ConstructionTimings GetConstructionTimings() const {
+        ConstructionTimings timings =
+            SparseGraph<IndexT>::GetConstructionTimings();
+        timings.local_edge_maps = local_edge_maps_seconds_;
+        return timings;
+    }
+
+    /**
+     * @brief Get the memory held by each array of the decoding graph,
+     * including its boundary flags and local edge maps.
+     *
+     * @return The footprint of every array.
+     */
+    MemoryFootprint GetMemoryFootprint() const {
+        MemoryFootprint footprint = SparseGraph<IndexT>::GetMemoryFootprint();
+        footprint.Add("vertex_boundary_type", vertex_boundary_type_);
+        footprint.Add("local_edge_strides", local_edge_strides_);
+        footprint.Add("local_to_global_edge_map", local_to_global_edge_map_);
+        footprint.Add("global_to_local_edge_map", global_to_local_edge_map_);
+        return footprint;
+    }
 };
 }; // namespace Plaquette
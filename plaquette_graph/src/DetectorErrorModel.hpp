@@ -0,0 +1,708 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "DecodingGraph.hpp"
+#include "Hypergraph.hpp"
+#include "Serialization.hpp"
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+namespace DetectorErrorModel {
+
+/**
+ * @brief Options controlling how a detector error model is turned into a
+ * decoding graph.
+ */
+struct LoadOptions {
+    /**
+     * @brief The factor applied to the log-likelihood ratio ln((1 - p) / p)
+     * of an edge before it is rounded to an integer weight.
+     */
+    double weight_scale = 1000;
+
+    /**
+     * @brief How error mechanisms, or components of a mechanism separated by
+     * `^`, that flip more than two detectors are split into edges.
+     */
+    HyperedgeDecomposition decomposition = HyperedgeDecomposition::Pairs;
+
+    /**
+     * @brief Options controlling the construction of the graph. Edges are
+     * merged while parsing, so `assume_unique_edges` is always set.
+     */
+    SparseGraphOptions graph;
+};
+
+/**
+ * @brief Convert the probability of an edge to an integer weight.
+ *
+ * @param probability The probability of the edge, in (0, 1].
+ * @param scale The factor applied to the log-likelihood ratio.
+ * @return The rounded, scaled log-likelihood ratio ln((1 - p) / p), clamped
+ * to the range of `EdgeWeight`. Edges with a probability of at least 1/2
+ * have a weight of zero.
+ */
+inline EdgeWeight ProbabilityToWeight(double probability, double scale) {
+    if (probability >= 0.5) {
+        return 0;
+    }
+    const double weight =
+        std::round(scale * std::log((1 - probability) / probability));
+    constexpr auto kMax = std::numeric_limits<EdgeWeight>::max();
+    if (weight >= static_cast<double>(kMax)) {
+        return kMax;
+    }
+    return static_cast<EdgeWeight>(weight);
+}
+
+/**
+ * @brief Streaming parser building the edges of a decoding graph from the
+ * text of a detector error model.
+ *
+ * Top-level instructions are applied as they are read, so memory is bounded
+ * by the number of distinct edges rather than by the size of the text. The
+ * body of a `repeat` block is compiled once into a compact instruction list,
+ * which is then run once per repetition with the current detector shift,
+ * without unrolling the block. Error mechanisms flipping the same detectors
+ * are merged as independent errors, p = p1 (1 - p2) + p2 (1 - p1).
+ */
+class Parser_ {
+  public:
+    explicit Parser_(std::string_view text, const LoadOptions &options)
+        : text_(text), options_(options) {}
+
+    /**
+     * @brief Parse the whole model.
+     *
+     * @throws std::runtime_error if the text is not a valid detector error
+     * model.
+     */
+    void Parse() {
+        Instruction instruction;
+        std::vector<size_t> targets;
+        while (true) {
+            targets.clear();
+            const Token token = ReadInstruction_(instruction, targets);
+            if (token == Token::EndOfText) {
+                return;
+            }
+            if (token == Token::BlockEnd) {
+                Fail_("unmatched '}'");
+            }
+            if (instruction.kind != Kind::Repeat) {
+                Execute_(instruction, targets);
+                continue;
+            }
+            std::vector<Instruction> body;
+            std::vector<size_t> body_targets;
+            CompileBlock_(body, body_targets);
+            for (size_t r = 0; r < instruction.value; r++) {
+                ExecuteBlock_(body, body_targets);
+            }
+        }
+    }
+
+    /**
+     * @brief Add an error mechanism flipping the given detectors, as an
+     * `error` instruction without separators would.
+     *
+     * @param detectors The distinct detectors flipped by the mechanism.
+     * @param probability The probability of the mechanism, in [0, 1].
+     */
+    template <typename Detectors>
+    void AddMechanism(const Detectors &detectors, double probability) {
+        for (size_t detector : detectors) {
+            num_detectors_ = std::max(num_detectors_, detector + 1);
+        }
+        if (probability == 0) {
+            return;
+        }
+        component_.assign(detectors.begin(), detectors.end());
+        AddComponent_(probability);
+    }
+
+    /**
+     * @brief Count the detectors up to `num_detectors`, flipped or not.
+     */
+    void CountDetectors(size_t num_detectors) {
+        num_detectors_ = std::max(num_detectors_, num_detectors);
+    }
+
+    /**
+     * @brief Build the decoding graph of the parsed model.
+     *
+     * The graph has one vertex per detector followed by a single boundary
+     * vertex, which takes the edges of the mechanisms that flip an odd
+     * number of detectors.
+     */
+    template <typename IndexT> DecodingGraph<IndexT> Build() const {
+        const size_t boundary = num_detectors_;
+        std::vector<size_t> edges;
+        edges.reserve(2 * probabilities_.size());
+        std::vector<EdgeWeight> weights;
+        weights.reserve(probabilities_.size());
+        for (size_t e = 0; e < probabilities_.size(); e++) {
+            const auto [u, v] = edges_[e];
+            edges.push_back(u);
+            edges.push_back(v == kBoundary ? boundary : v);
+            weights.push_back(ProbabilityToWeight(probabilities_[e],
+                                                  options_.weight_scale));
+        }
+
+        std::vector<bool> boundary_type(num_detectors_ + 1, false);
+        boundary_type.back() = true;
+        SparseGraphOptions graph_options = options_.graph;
+        graph_options.assume_unique_edges = true;
+        return DecodingGraph<IndexT>(
+            num_detectors_ + 1,
+            FlatEdgeList<size_t>(edges.data(), weights.size()), weights,
+            boundary_type, graph_options);
+    }
+
+  private:
+    enum class Kind : uint8_t { Error, Detector, Observable, Shift, Repeat };
+    enum class Token : uint8_t { Instruction, BlockEnd, EndOfText };
+
+    // A parsed instruction, whose targets are stored separately. `value` is
+    // the shift of `shift_detectors` or the count of `repeat`, and
+    // `body_size` the number of instructions in the body of a `repeat`.
+    struct Instruction {
+        Kind kind = Kind::Error;
+        double probability = 0;
+        size_t value = 0;
+        size_t targets_begin = 0;
+        size_t targets_end = 0;
+        size_t body_size = 0;
+    };
+
+    // Target standing for a `^` separator in an error instruction
+    static constexpr size_t kSeparator = std::numeric_limits<size_t>::max();
+    // Placeholder of the boundary vertex until the detectors are counted
+    static constexpr size_t kBoundary = std::numeric_limits<size_t>::max();
+    // Value of an empty slot of the edge table
+    static constexpr size_t kEmptySlot = std::numeric_limits<size_t>::max();
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    size_t line_ = 1;
+    const LoadOptions &options_;
+
+    size_t detector_offset_ = 0;
+    size_t num_detectors_ = 0;
+    std::vector<size_t> component_;
+    std::vector<std::pair<size_t, size_t>> edges_;
+    std::vector<double> probabilities_;
+    // Open-addressing table of the edge IDs, probed linearly as in
+    // `EdgeHashIndex`, which grows to keep its load factor below one half
+    std::vector<size_t> slots_;
+    size_t mask_ = 0;
+    std::vector<double> arguments_;
+
+    [[noreturn]] void Fail_(const std::string &what) const {
+        throw std::runtime_error("DetectorErrorModel: line " +
+                                 std::to_string(line_) + ": " + what);
+    }
+
+    bool AtEnd_() const { return pos_ >= text_.size(); }
+
+    void SkipSpaces_() {
+        while (!AtEnd_() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                             text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    // Skip spaces and a comment, stopping before the end of the line
+    void SkipToEndOfLine_() {
+        SkipSpaces_();
+        if (!AtEnd_() && text_[pos_] == '#') {
+            while (!AtEnd_() && text_[pos_] != '\n') {
+                pos_++;
+            }
+        }
+    }
+
+    // Check that nothing but a comment is left on the line, and consume it
+    void EndLine_() {
+        SkipToEndOfLine_();
+        if (!AtEnd_()) {
+            if (text_[pos_] != '\n') {
+                Fail_("unexpected '" + std::string(1, text_[pos_]) + "'");
+            }
+            pos_++;
+            line_++;
+        }
+    }
+
+    static bool IsTokenEnd_(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#' ||
+               c == '{' || c == '(' || c == ')' || c == ',' || c == '[';
+    }
+
+    std::string_view ReadToken_() {
+        const size_t begin = pos_;
+        while (!AtEnd_() && !IsTokenEnd_(text_[pos_])) {
+            pos_++;
+        }
+        return text_.substr(begin, pos_ - begin);
+    }
+
+    size_t ParseInteger_(std::string_view token) const {
+        size_t value = 0;
+        auto [end, error] =
+            std::from_chars(token.data(), token.data() + token.size(), value);
+        if (token.empty() || error != std::errc() ||
+            end != token.data() + token.size()) {
+            Fail_("invalid integer '" + std::string(token) + "'");
+        }
+        return value;
+    }
+
+    double ParseNumber_(std::string_view token) const {
+        double value = 0;
+        auto [end, error] =
+            std::from_chars(token.data(), token.data() + token.size(), value);
+        if (token.empty() || error != std::errc() ||
+            end != token.data() + token.size()) {
+            Fail_("invalid number '" + std::string(token) + "'");
+        }
+        return value;
+    }
+
+    /**
+     * @brief Read the next instruction, skipping blank and comment lines.
+     *
+     * The `D` targets of the instruction are appended to `targets`, relative
+     * to the current detector shift, with `^` separators as `kSeparator`.
+     */
+    Token ReadInstruction_(Instruction &instruction,
+                           std::vector<size_t> &targets) {
+        while (true) {
+            SkipToEndOfLine_();
+            if (AtEnd_()) {
+                return Token::EndOfText;
+            }
+            if (text_[pos_] != '\n') {
+                break;
+            }
+            pos_++;
+            line_++;
+        }
+        if (text_[pos_] == '}') {
+            pos_++;
+            EndLine_();
+            return Token::BlockEnd;
+        }
+
+        const std::string_view name = ReadToken_();
+        if (!AtEnd_() && text_[pos_] == '[') {
+            // Skip the tag of the instruction
+            while (!AtEnd_() && text_[pos_] != ']' && text_[pos_] != '\n') {
+                pos_++;
+            }
+            if (AtEnd_() || text_[pos_] != ']') {
+                Fail_("unterminated tag");
+            }
+            pos_++;
+        }
+        arguments_.clear();
+        if (!AtEnd_() && text_[pos_] == '(') {
+            pos_++;
+            while (true) {
+                SkipSpaces_();
+                arguments_.push_back(ParseNumber_(ReadToken_()));
+                SkipSpaces_();
+                if (AtEnd_() || (text_[pos_] != ',' && text_[pos_] != ')')) {
+                    Fail_("unterminated arguments");
+                }
+                if (text_[pos_++] == ')') {
+                    break;
+                }
+            }
+        }
+
+        instruction = Instruction();
+        instruction.targets_begin = targets.size();
+        if (name == "error") {
+            instruction.kind = Kind::Error;
+            if (arguments_.size() != 1 || !(arguments_[0] >= 0) ||
+                arguments_[0] > 1) {
+                Fail_("error takes one probability between 0 and 1");
+            }
+            instruction.probability = arguments_[0];
+        } else if (name == "detector") {
+            instruction.kind = Kind::Detector;
+        } else if (name == "logical_observable") {
+            instruction.kind = Kind::Observable;
+        } else if (name == "shift_detectors") {
+            instruction.kind = Kind::Shift;
+        } else if (name == "repeat") {
+            instruction.kind = Kind::Repeat;
+        } else {
+            Fail_("unknown instruction '" + std::string(name) + "'");
+        }
+
+        size_t num_integers = 0;
+        while (true) {
+            SkipToEndOfLine_();
+            if (AtEnd_() || text_[pos_] == '\n' || text_[pos_] == '{') {
+                break;
+            }
+            const std::string_view token = ReadToken_();
+            if (token.empty()) {
+                Fail_("unexpected '" + std::string(1, text_[pos_]) + "'");
+            }
+            if (token == "^") {
+                if (instruction.kind != Kind::Error) {
+                    Fail_("unexpected '^'");
+                }
+                targets.push_back(kSeparator);
+            } else if (token[0] == 'D') {
+                if (instruction.kind != Kind::Error &&
+                    instruction.kind != Kind::Detector) {
+                    Fail_("unexpected detector target");
+                }
+                // The largest index would read as a separator, and overflows
+                // even without a shift, as it is the boundary placeholder
+                const size_t detector = ParseInteger_(token.substr(1));
+                if (detector == kSeparator) {
+                    Fail_("detector index overflows");
+                }
+                targets.push_back(detector);
+            } else if (token[0] == 'L') {
+                if (instruction.kind != Kind::Error &&
+                    instruction.kind != Kind::Observable) {
+                    Fail_("unexpected observable target");
+                }
+                // Logical observables are not part of the decoding graph
+                ParseInteger_(token.substr(1));
+            } else {
+                if (instruction.kind != Kind::Shift &&
+                    instruction.kind != Kind::Repeat) {
+                    Fail_("unexpected target '" + std::string(token) + "'");
+                }
+                instruction.value = ParseInteger_(token);
+                num_integers++;
+            }
+        }
+        instruction.targets_end = targets.size();
+
+        if ((instruction.kind == Kind::Shift ||
+             instruction.kind == Kind::Repeat) &&
+            num_integers != 1) {
+            Fail_(std::string(name) + " takes one integer");
+        }
+        if (instruction.kind == Kind::Repeat) {
+            if (AtEnd_() || text_[pos_] != '{') {
+                Fail_("expected '{' after repeat");
+            }
+            pos_++;
+        } else if (!AtEnd_() && text_[pos_] == '{') {
+            Fail_("unexpected '{'");
+        }
+        EndLine_();
+        return Token::Instruction;
+    }
+
+    /**
+     * @brief Compile the body of a `repeat` block, up to its closing brace.
+     *
+     * Nested blocks are compiled in place, each `Repeat` instruction being
+     * followed by the `body_size` instructions of its body.
+     */
+    void CompileBlock_(std::vector<Instruction> &body,
+                       std::vector<size_t> &targets) {
+        const size_t first_line = line_;
+        while (true) {
+            Instruction instruction;
+            const Token token = ReadInstruction_(instruction, targets);
+            if (token == Token::BlockEnd) {
+                return;
+            }
+            if (token == Token::EndOfText) {
+                line_ = first_line;
+                Fail_("unterminated repeat block");
+            }
+            const size_t index = body.size();
+            body.push_back(instruction);
+            if (instruction.kind == Kind::Repeat) {
+                CompileBlock_(body, targets);
+                body[index].body_size = body.size() - index - 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Run a compiled block once.
+     */
+    void ExecuteBlock_(std::span<const Instruction> body,
+                       std::span<const size_t> targets) {
+        for (size_t i = 0; i < body.size(); i++) {
+            const Instruction &instruction = body[i];
+            if (instruction.kind != Kind::Repeat) {
+                Execute_(instruction, targets);
+                continue;
+            }
+            auto nested = body.subspan(i + 1, instruction.body_size);
+            for (size_t r = 0; r < instruction.value; r++) {
+                ExecuteBlock_(nested, targets);
+            }
+            i += instruction.body_size;
+        }
+    }
+
+    void Execute_(const Instruction &instruction,
+                  std::span<const size_t> targets) {
+        auto own_targets = targets.subspan(
+            instruction.targets_begin,
+            instruction.targets_end - instruction.targets_begin);
+        switch (instruction.kind) {
+        case Kind::Error:
+            if (instruction.probability == 0) {
+                // The detectors are counted, but the mechanism adds no edge
+                for (size_t target : own_targets) {
+                    if (target != kSeparator) {
+                        Shift_(target);
+                    }
+                }
+                return;
+            }
+            component_.clear();
+            for (size_t target : own_targets) {
+                if (target == kSeparator) {
+                    AddComponent_(instruction.probability);
+                    component_.clear();
+                } else {
+                    component_.push_back(Shift_(target));
+                }
+            }
+            AddComponent_(instruction.probability);
+            return;
+        case Kind::Detector:
+            for (size_t target : own_targets) {
+                Shift_(target);
+            }
+            return;
+        case Kind::Shift:
+            detector_offset_ += instruction.value;
+            return;
+        default:
+            return;
+        }
+    }
+
+    // Shift a detector target and count the detector
+    size_t Shift_(size_t target) {
+        const size_t detector = target + detector_offset_;
+        if (detector < target || detector == kBoundary) {
+            Fail_("detector index overflows");
+        }
+        num_detectors_ = std::max(num_detectors_, detector + 1);
+        return detector;
+    }
+
+    /**
+     * @brief Add the edges of a component of an error mechanism.
+     *
+     * Detectors flipped an even number of times cancel out. The remaining
+     * detectors are split into edges as in `Hypergraph::ToDecodingGraph`.
+     */
+    void AddComponent_(double probability) {
+        std::sort(component_.begin(), component_.end());
+        size_t size = 0;
+        for (size_t i = 0; i < component_.size(); i++) {
+            if (i + 1 < component_.size() &&
+                component_[i] == component_[i + 1]) {
+                i++;
+            } else {
+                component_[size++] = component_[i];
+            }
+        }
+
+        if (options_.decomposition == HyperedgeDecomposition::Pairs) {
+            for (size_t i = 0; i + 1 < size; i += 2) {
+                AddEdge_(component_[i], component_[i + 1], probability);
+            }
+        } else {
+            for (size_t i = 0; i < size; i++) {
+                for (size_t j = i + 1; j < size; j++) {
+                    AddEdge_(component_[i], component_[j], probability);
+                }
+            }
+        }
+        if (size == 1 || (options_.decomposition ==
+                              HyperedgeDecomposition::Pairs &&
+                          size % 2)) {
+            AddEdge_(component_[size - 1], kBoundary, probability);
+        }
+    }
+
+    // Hash an ordered pair of vertices with the 64-bit finalizer of
+    // MurmurHash3
+    static size_t Hash_(size_t u, size_t v) {
+        uint64_t h = u * 0x9e3779b97f4a7c15ULL ^ v;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    // Find the slot of an edge, or the empty slot where it belongs
+    size_t FindSlot_(size_t u, size_t v) const {
+        size_t slot = Hash_(u, v) & mask_;
+        while (slots_[slot] != kEmptySlot &&
+               edges_[slots_[slot]] != std::make_pair(u, v)) {
+            slot = (slot + 1) & mask_;
+        }
+        return slot;
+    }
+
+    void Grow_() {
+        slots_.assign(std::max<size_t>(2 * slots_.size(), 1024), kEmptySlot);
+        mask_ = slots_.size() - 1;
+        for (size_t e = 0; e < edges_.size(); e++) {
+            slots_[FindSlot_(edges_[e].first, edges_[e].second)] = e;
+        }
+    }
+
+    void AddEdge_(size_t u, size_t v, double probability) {
+        if (2 * (edges_.size() + 1) > slots_.size()) {
+            Grow_();
+        }
+        const size_t slot = FindSlot_(u, v);
+        if (slots_[slot] == kEmptySlot) {
+            slots_[slot] = edges_.size();
+            edges_.emplace_back(u, v);
+            probabilities_.push_back(probability);
+            return;
+        }
+        double &merged = probabilities_[slots_[slot]];
+        merged = merged * (1 - probability) + probability * (1 - merged);
+    }
+};
+
+/**
+ * @brief Build a decoding graph from the text of a detector error model.
+ *
+ * The model is written in the text format of Stim: `error(p)` instructions
+ * with `D` and `L` targets and `^` separators, `detector`,
+ * `logical_observable`, `shift_detectors` and nested `repeat` blocks.
+ * Coordinates, tags and logical observables are ignored. Every component of
+ * an error mechanism, separated by `^`, becomes one edge between the two
+ * detectors it flips, or between the detector it flips and the boundary.
+ * Components flipping more detectors are decomposed as set by
+ * `options.decomposition`. Edges produced by several mechanisms are merged,
+ * and the weight of every edge is derived from its probability with
+ * `ProbabilityToWeight`.
+ *
+ * The graph has one vertex per detector, followed by a single boundary
+ * vertex.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param text The text of the model.
+ * @param options Options controlling the weights and the graph.
+ * @return The decoding graph.
+ * @throws std::runtime_error if the text is not a valid detector error model.
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT> ParseDecodingGraph(std::string_view text,
+                                         const LoadOptions &options = {}) {
+    Parser_ parser(text, options);
+    parser.Parse();
+    return parser.Build<IndexT>();
+}
+
+/**
+ * @brief Build a decoding graph from error mechanisms stored as the
+ * hyperedges of a hypergraph.
+ *
+ * Hyperedge `e` is an error mechanism flipping its vertices, as detectors,
+ * with probability `probabilities[e]`. The mechanisms are decomposed and
+ * merged exactly as when parsing a detector error model: edges produced by
+ * several hyperedges are merged as independent errors, and weighted with
+ * `ProbabilityToWeight`. The graph is therefore the one `ParseDecodingGraph`
+ * builds from the equivalent model, with one vertex per vertex of the
+ * hypergraph followed by the boundary vertex. The weights of the hypergraph,
+ * if any, are ignored; `Hypergraph::ToDecodingGraph` converts the weights
+ * without merging instead.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param hypergraph The error mechanisms.
+ * @param probabilities The probability of every hyperedge.
+ * @param options Options controlling the weights and the graph.
+ * @return The decoding graph.
+ * @throws std::invalid_argument if the number of probabilities does not
+ * match the number of hyperedges, or if a probability is not in [0, 1].
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT>
+BuildDecodingGraph(const Hypergraph<IndexT> &hypergraph,
+                   std::span<const double> probabilities,
+                   const LoadOptions &options = {}) {
+    if (probabilities.size() != hypergraph.GetNumHyperedges()) {
+        throw std::invalid_argument(
+            "DetectorErrorModel: the number of probabilities must match the "
+            "number of hyperedges");
+    }
+    if (!std::ranges::all_of(probabilities, [](double probability) {
+            return probability >= 0 && probability <= 1;
+        })) {
+        throw std::invalid_argument(
+            "DetectorErrorModel: probabilities must be between 0 and 1");
+    }
+    Parser_ parser({}, options);
+    parser.CountDetectors(hypergraph.GetNumVertices());
+    for (size_t e = 0; e < probabilities.size(); e++) {
+        parser.AddMechanism(hypergraph.GetVerticesOfHyperedge(e),
+                            probabilities[e]);
+    }
+    return parser.Build<IndexT>();
+}
+
+/**
+ * @brief Build a decoding graph from a detector error model file.
+ *
+ * See `ParseDecodingGraph`. With `memory_map`, the file is mapped with
+ * `mmap` and parsed in place, so that the model is never copied and pages
+ * are read as the parser reaches them. Otherwise, the file is read into
+ * memory in one go.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param path The path of the file.
+ * @param options Options controlling the weights and the graph.
+ * @param memory_map Map the file instead of reading it.
+ * @return The decoding graph.
+ * @throws std::runtime_error if the file cannot be read or is not a valid
+ * detector error model.
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT> LoadDecodingGraph(const std::string &path,
+                                        const LoadOptions &options = {},
+                                        bool memory_map = true) {
+    std::error_code error;
+    if (std::filesystem::file_size(path, error) == 0 && !error) {
+        return ParseDecodingGraph<IndexT>({}, options);
+    }
+    Serialization::FileBuffer file(path, memory_map);
+    return ParseDecodingGraph<IndexT>(
+        std::string_view(reinterpret_cast<const char *>(file.data()),
+                         file.size()),
+        options);
+}
+
+}; // namespace DetectorErrorModel
+}; // namespace Plaquette
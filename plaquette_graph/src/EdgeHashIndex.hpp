@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Plaquette {
+
+/**
+ * @class EdgeHashIndex
+ * @brief An open-addressing hash index from pairs of vertices to edges.
+ *
+ * The table only stores edge IDs, one `IndexT` per slot, and the endpoints
+ * of a candidate edge are read back from the edge to vertices list when
+ * probing. The capacity is the smallest power of two holding every edge at
+ * a load factor of at most one half, and collisions are resolved by linear
+ * probing, so a lookup touches one cache line of the table in the common
+ * case whatever the degree of the vertices.
+ *
+ * @tparam IndexT Unsigned integer type of the indices of the graph.
+ */
+template <typename IndexT = size_t> class EdgeHashIndex {
+  public:
+    using edge_type = std::pair<IndexT, IndexT>;
+
+    /** @brief Value of an empty slot, and result of failed lookups. */
+    static constexpr IndexT kEmpty = std::numeric_limits<IndexT>::max();
+
+    EdgeHashIndex() = default;
+
+    /**
+     * @brief Build the index of a list of edges.
+     *
+     * If several edges connect the same pair of vertices, the one with the
+     * smallest index is kept.
+     *
+     * @param edges The endpoints of every edge, in either orientation.
+     */
+    explicit EdgeHashIndex(std::span<const edge_type> edges) {
+        const size_t capacity = std::bit_ceil(2 * edges.size() + 1);
+        slots_.assign(capacity, kEmpty);
+        mask_ = capacity - 1;
+        for (size_t e = 0; e < edges.size(); e++) {
+            const auto &[u, v] = edges[e];
+            size_t slot = Hash_(u, v) & mask_;
+            while (slots_[slot] != kEmpty &&
+                   !Matches_(edges[slots_[slot]], u, v)) {
+                slot = (slot + 1) & mask_;
+            }
+            if (slots_[slot] == kEmpty) {
+                slots_[slot] = static_cast<IndexT>(e);
+            }
+        }
+    }
+
+    /**
+     * @brief Find the edge connecting two vertices.
+     *
+     * @param u The index of the first vertex.
+     * @param v The index of the second vertex.
+     * @param edges The edge list the index was built from.
+     * @return The index of the edge, or `kEmpty` if there is none.
+     */
+    IndexT Find(size_t u, size_t v, std::span<const edge_type> edges) const {
+        if (slots_.empty()) {
+            return kEmpty;
+        }
+        for (size_t slot = Hash_(u, v) & mask_;; slot = (slot + 1) & mask_) {
+            const IndexT e = slots_[slot];
+            if (e == kEmpty || Matches_(edges[e], u, v)) {
+                return e;
+            }
+        }
+    }
+
+    // Check whether the index was built
+    bool empty() const { return slots_.empty(); }
+
+    // Get the number of slots of the table
+    size_t capacity() const { return slots_.size(); }
+
+  private:
+    static bool Matches_(const edge_type &edge, size_t u, size_t v) {
+        return (edge.first == u && edge.second == v) ||
+               (edge.first == v && edge.second == u);
+    }
+
+    // Hash an unordered pair of vertices with the 64-bit finalizer of
+    // MurmurHash3
+    static size_t Hash_(size_t u, size_t v) {
+        uint64_t h = std::min(u, v) * 0x9e3779b97f4a7c15ULL ^ std::max(u, v);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    std::vector<IndexT> slots_;
+    size_t mask_ = 0;
+};
+
+}; // namespace Plaquette
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DecodingGraph.hpp"
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+namespace Generators {
+
+/**
+ * @brief The decoding graph of a single measurement round of a code.
+ *
+ * The detectors of the round are numbered from 0 to `detectors_per_round - 1`
+ * and the index `detectors_per_round` stands for the boundary vertex. Every
+ * space edge is an error mechanism flipping the detectors at its endpoints,
+ * e.g. a data qubit error.
+ */
+struct SpaceTimeLayout {
+    size_t detectors_per_round = 0;
+    std::vector<std::pair<size_t, size_t>> space_edges;
+};
+
+/**
+ * @brief Options of the space-time graphs built by `SpaceTimeGraph`.
+ */
+struct SpaceTimeOptions {
+    /** @brief The number of measurement rounds. */
+    size_t rounds = 1;
+    /**
+     * @brief Also connect consecutive rounds with a diagonal edge for every
+     * space edge between two detectors `(u, v)`, from `u` in a round to `v`
+     * in the next round.
+     */
+    bool diagonal_edges = false;
+    /** @brief The weight of the space edges. */
+    EdgeWeight space_weight = 1;
+    /** @brief The weight of the time-like edges. */
+    EdgeWeight time_weight = 1;
+    /** @brief The weight of the diagonal edges. */
+    EdgeWeight diagonal_weight = 1;
+};
+
+/**
+ * @brief The layout of a distance-`distance` repetition code.
+ *
+ * The `distance - 1` detectors form a chain whose two ends are connected to
+ * the boundary.
+ *
+ * @throws std::invalid_argument if the distance is smaller than 2.
+ */
+inline SpaceTimeLayout RepetitionCodeLayout(size_t distance) {
+    if (distance < 2) {
+        throw std::invalid_argument(
+            "Generators: the distance must be at least 2");
+    }
+    const size_t detectors = distance - 1;
+    SpaceTimeLayout layout{detectors, {}};
+    layout.space_edges.emplace_back(detectors, 0);
+    for (size_t d = 0; d + 1 < detectors; d++) {
+        layout.space_edges.emplace_back(d, d + 1);
+    }
+    layout.space_edges.emplace_back(detectors - 1, detectors);
+    return layout;
+}
+
+/**
+ * @brief The layout of one stabilizer type of a distance-`distance` planar
+ * (unrotated) surface code.
+ *
+ * The detectors form a `distance` x `(distance - 1)` grid in row-major order,
+ * whose rows end on the left and right boundaries. Every data qubit is an
+ * edge: first the horizontal edges of every row, then the vertical edges.
+ *
+ * @throws std::invalid_argument if the distance is smaller than 2.
+ */
+inline SpaceTimeLayout SurfaceCodeLayout(size_t distance) {
+    if (distance < 2) {
+        throw std::invalid_argument(
+            "Generators: the distance must be at least 2");
+    }
+    const size_t rows = distance;
+    const size_t cols = distance - 1;
+    const size_t detectors = rows * cols;
+    auto detector = [&](size_t row, size_t col) { return row * cols + col; };
+
+    SpaceTimeLayout layout{detectors, {}};
+    auto &edges = layout.space_edges;
+    for (size_t row = 0; row < rows; row++) {
+        edges.emplace_back(detectors, detector(row, 0));
+        for (size_t col = 0; col + 1 < cols; col++) {
+            edges.emplace_back(detector(row, col), detector(row, col + 1));
+        }
+        edges.emplace_back(detector(row, cols - 1), detectors);
+    }
+    for (size_t row = 0; row + 1 < rows; row++) {
+        for (size_t col = 0; col < cols; col++) {
+            edges.emplace_back(detector(row, col), detector(row + 1, col));
+        }
+    }
+    return layout;
+}
+
+/**
+ * @brief The layout of the Z-type stabilizers of a distance-`distance`
+ * rotated surface code.
+ *
+ * The data qubits sit at `(x, y)` for `0 <= x, y < distance`, and the
+ * stabilizer with lower-left corner `(x, y)` acts on the qubits `(x, y)`,
+ * `(x + 1, y)`, `(x, y + 1)` and `(x + 1, y + 1)` that exist. The Z-type
+ * stabilizers are those with `x + y` odd, for `-1 <= x < distance` and
+ * `0 <= y < distance - 1`, so that the weight-two stabilizers lie on the
+ * left and right sides. They are numbered in row-major order. Every data
+ * qubit is an edge, in row-major order, and the qubits of the top and bottom
+ * rows are connected to the boundary.
+ *
+ * @throws std::invalid_argument if the distance is smaller than 2.
+ */
+inline SpaceTimeLayout RotatedSurfaceCodeLayout(size_t distance) {
+    if (distance < 2) {
+        throw std::invalid_argument(
+            "Generators: the distance must be at least 2");
+    }
+    // Stabilizers are indexed by (x + 1, y) on a (distance + 1) x
+    // (distance - 1) grid, of which only those with x + y odd are detectors
+    const size_t width = distance + 1;
+    const size_t height = distance - 1;
+    std::vector<size_t> detector(width * height);
+    size_t detectors = 0;
+    for (size_t y = 0; y < height; y++) {
+        for (size_t i = 0; i < width; i++) {
+            // x + y = i - 1 + y is odd
+            if ((i + y) % 2 == 0) {
+                detector[y * width + i] = detectors++;
+            }
+        }
+    }
+
+    SpaceTimeLayout layout{detectors, {}};
+    for (size_t qy = 0; qy < distance; qy++) {
+        for (size_t qx = 0; qx < distance; qx++) {
+            // The two corners of the qubit with x + y odd, as (x + 1, y + 1)
+            // pairs to stay unsigned
+            std::pair<size_t, size_t> corners[2];
+            if ((qx + qy) % 2 == 1) {
+                corners[0] = {qx, qy};
+                corners[1] = {qx + 1, qy + 1};
+            } else {
+                corners[0] = {qx + 1, qy};
+                corners[1] = {qx, qy + 1};
+            }
+            size_t endpoints[2];
+            for (size_t k = 0; k < 2; k++) {
+                const auto [i, y1] = corners[k];
+                endpoints[k] = y1 == 0 || y1 > height
+                                   ? detectors
+                                   : detector[(y1 - 1) * width + i];
+            }
+            layout.space_edges.emplace_back(endpoints[0], endpoints[1]);
+        }
+    }
+    return layout;
+}
+
+/**
+ * @brief Build the space-time decoding graph of a code measured over several
+ * rounds.
+ *
+ * Detector `d` of round `r` is vertex `r * detectors_per_round + d`, and the
+ * boundary vertex, shared by all rounds, is the last vertex. Every round has
+ * a copy of the space edges, and consecutive rounds are connected by a
+ * time-like edge between the copies of every detector, as well as by the
+ * diagonal edges if enabled. The edges of a round are numbered in this order:
+ * space edges, then time-like edges to the next round, then diagonal edges to
+ * the next round.
+ *
+ * The degree of every vertex follows from the layout, so the row pointers of
+ * the adjacency matrix are computed directly and the edges are written into
+ * their final positions, together with the local edge maps, without building
+ * an intermediate edge list, removing duplicates or hashing. The result is
+ * identical to the `DecodingGraph` constructed from the same edges with
+ * `assume_unique_edges`, so parallel edges, e.g. the two boundary edges of a
+ * distance-2 repetition code, are kept. Unit weights are left implicit when
+ * all weights are 1.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param layout The decoding graph of one round.
+ * @param options The number of rounds, diagonal edges and weights.
+ * @return The decoding graph.
+ * @throws std::invalid_argument if the layout has no detectors, an endpoint
+ * is out of range, or there are no rounds.
+ * @throws std::overflow_error if the graph exceeds the range of `IndexT`.
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT> SpaceTimeGraph(const SpaceTimeLayout &layout,
+                                     const SpaceTimeOptions &options = {}) {
+    const size_t D = layout.detectors_per_round;
+    const size_t R = options.rounds;
+    if (D == 0 || R == 0) {
+        throw std::invalid_argument(
+            "Generators: the layout must have detectors and at least one "
+            "round");
+    }
+
+    // Degrees of the detectors within a round, and towards the next and the
+    // previous rounds
+    std::vector<size_t> space_degree(D + 1, 0);
+    std::vector<size_t> up_degree(D, 1);
+    std::vector<size_t> down_degree(D, 1);
+    size_t num_diagonal = 0;
+    for (const auto &[u, v] : layout.space_edges) {
+        if (u > D || v > D) {
+            throw std::invalid_argument(
+                "Generators: space edge endpoints must be at most the number "
+                "of detectors per round");
+        }
+        space_degree[u]++;
+        space_degree[v]++;
+        if (options.diagonal_edges && u < D && v < D) {
+            up_degree[u]++;
+            down_degree[v]++;
+            num_diagonal++;
+        }
+    }
+
+    const size_t num_space = layout.space_edges.size();
+    const size_t num_vertices = R * D + 1;
+    const size_t num_edges = R * num_space + (R - 1) * (D + num_diagonal);
+    constexpr size_t max_index = std::numeric_limits<IndexT>::max();
+    if (R > (max_index - 1) / D || num_edges > max_index / 2) {
+        throw std::overflow_error(
+            "Generators: the graph exceeds the range of the index type");
+    }
+    const size_t boundary = num_vertices - 1;
+
+    std::pmr::vector<IndexT> row_ptr(num_vertices + 1);
+    row_ptr[0] = 0;
+    for (size_t r = 0; r < R; r++) {
+        for (size_t d = 0; d < D; d++) {
+            const size_t v = r * D + d;
+            const size_t degree = space_degree[d] +
+                                  (r + 1 < R ? up_degree[d] : 0) +
+                                  (r > 0 ? down_degree[d] : 0);
+            row_ptr[v + 1] = static_cast<IndexT>(row_ptr[v] + degree);
+        }
+    }
+    row_ptr[num_vertices] =
+        static_cast<IndexT>(row_ptr[boundary] + R * space_degree[D]);
+
+    const bool weighted = options.space_weight != 1 ||
+                          options.time_weight != 1 ||
+                          options.diagonal_weight != 1;
+    std::pmr::vector<IndexT> col(2 * num_edges);
+    std::pmr::vector<IndexT> ids(2 * num_edges);
+    std::pmr::vector<std::pair<IndexT, IndexT>> e_to_v(num_edges);
+    std::pmr::vector<EdgeWeight> weights(weighted ? num_edges : 0);
+    std::pmr::vector<IndexT> global_to_local(2 * num_edges);
+    std::vector<IndexT> next(row_ptr.begin(), row_ptr.end() - 1);
+
+    // Write both half-edges of the next edge into the rows of its endpoints.
+    // The first half-edge is the one in the row of the smaller endpoint, as
+    // in DecodingGraph::ConstructLocalEdgeMaps_
+    size_t e = 0;
+    auto add_edge = [&](size_t a, size_t b, EdgeWeight weight) {
+        const size_t pa = next[a]++;
+        const size_t pb = next[b]++;
+        col[pa] = static_cast<IndexT>(b);
+        col[pb] = static_cast<IndexT>(a);
+        ids[pa] = ids[pb] = static_cast<IndexT>(e);
+        e_to_v[e] = {static_cast<IndexT>(a), static_cast<IndexT>(b)};
+        if (weighted) {
+            weights[e] = weight;
+        }
+        global_to_local[2 * e] = static_cast<IndexT>(a <= b ? pa : pb);
+        global_to_local[2 * e + 1] = static_cast<IndexT>(a <= b ? pb : pa);
+        e++;
+    };
+    auto vertex = [&](size_t r, size_t d) {
+        return d == D ? boundary : r * D + d;
+    };
+    for (size_t r = 0; r < R; r++) {
+        for (const auto &[u, v] : layout.space_edges) {
+            add_edge(vertex(r, u), vertex(r, v), options.space_weight);
+        }
+        if (r + 1 == R) {
+            break;
+        }
+        for (size_t d = 0; d < D; d++) {
+            add_edge(vertex(r, d), vertex(r + 1, d), options.time_weight);
+        }
+        if (options.diagonal_edges) {
+            for (const auto &[u, v] : layout.space_edges) {
+                if (u < D && v < D) {
+                    add_edge(vertex(r, u), vertex(r + 1, v),
+                             options.diagonal_weight);
+                }
+            }
+        }
+    }
+
+    std::pmr::vector<uint8_t> boundary_type(num_vertices, 0);
+    boundary_type[boundary] = 1;
+    std::pmr::vector<IndexT> strides(row_ptr.begin(), row_ptr.end() - 1);
+    std::pmr::vector<IndexT> local_to_global = ids;
+
+    SparseGraphArrays<IndexT> graph_arrays;
+    graph_arrays.v_to_v_row_ptr = std::move(row_ptr);
+    graph_arrays.v_to_v_col = std::move(col);
+    graph_arrays.v_to_v_edges = std::move(ids);
+    graph_arrays.e_to_v = std::move(e_to_v);
+    graph_arrays.edge_weights = std::move(weights);
+
+    DecodingGraphArrays<IndexT> arrays;
+    arrays.vertex_boundary_type = std::move(boundary_type);
+    arrays.local_edge_strides = std::move(strides);
+    arrays.local_to_global_edge_map = std::move(local_to_global);
+    arrays.global_to_local_edge_map = std::move(global_to_local);
+    return DecodingGraph<IndexT>::FromArrays(
+        num_vertices, std::move(graph_arrays), std::move(arrays));
+}
+
+/**
+ * @brief The space-time decoding graph of a repetition code.
+ *
+ * @see RepetitionCodeLayout, SpaceTimeGraph
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT>
+RepetitionCodeGraph(size_t distance, const SpaceTimeOptions &options = {}) {
+    return SpaceTimeGraph<IndexT>(RepetitionCodeLayout(distance), options);
+}
+
+/**
+ * @brief The space-time decoding graph of a planar surface code.
+ *
+ * @see SurfaceCodeLayout, SpaceTimeGraph
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT> SurfaceCodeGraph(size_t distance,
+                                       const SpaceTimeOptions &options = {}) {
+    return SpaceTimeGraph<IndexT>(SurfaceCodeLayout(distance), options);
+}
+
+/**
+ * @brief The space-time decoding graph of a rotated surface code.
+ *
+ * @see RotatedSurfaceCodeLayout, SpaceTimeGraph
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT>
+RotatedSurfaceCodeGraph(size_t distance, const SpaceTimeOptions &options = {}) {
+    return SpaceTimeGraph<IndexT>(RotatedSurfaceCodeLayout(distance), options);
+}
+
+}; // namespace Generators
+}; // namespace Plaquette
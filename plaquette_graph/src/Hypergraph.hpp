@@ -0,0 +1,360 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ArrayBuffer.hpp"
+#include "DecodingGraph.hpp"
+#include "Instrumentation.hpp"
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+
+/**
+ * @brief How `Hypergraph::ToDecodingGraph` splits hyperedges into edges.
+ */
+enum class HyperedgeDecomposition {
+    /**
+     * Pair consecutive vertices of each hyperedge, in increasing order, and
+     * connect the last vertex of an odd hyperedge to the boundary. A
+     * hyperedge of k vertices gives ceil(k / 2) edges which flip the same
+     * vertices as the hyperedge.
+     */
+    Pairs,
+    /**
+     * Connect every pair of vertices of each hyperedge. A hyperedge of k
+     * vertices gives k (k - 1) / 2 edges, and a single vertex hyperedge gives
+     * an edge to the boundary.
+     */
+    Clique,
+};
+
+/**
+ * @class Hypergraph
+ * @brief A hypergraph whose hyperedges connect any number of vertices.
+ *
+ * The error mechanisms of circuit-level noise flip any number of detectors,
+ * so they are hyperedges rather than edges. The incidence matrix is stored in
+ * CSR format in both directions: hyperedge-vertex, with the vertices of each
+ * hyperedge in increasing order, and vertex-hyperedge, with the hyperedges of
+ * each vertex in increasing order. Both are queried through non-owning
+ * `SparseGraphRow` views, so that hypergraph-aware decoders read the compact
+ * incidence data directly. Decoders that need a graph convert the hypergraph
+ * with `ToDecodingGraph`.
+ *
+ * Hyperedges may be empty, and may be weighted with one `EdgeWeight` each.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> class Hypergraph {
+  public:
+    using index_type = IndexT;
+    using weight_type = EdgeWeight;
+
+    Hypergraph() = default; ///< Default constructor.
+
+    /**
+     * @brief Construct a hypergraph from lists of vertices.
+     *
+     * @param num_vertices The number of vertices in the hypergraph.
+     * @param hyperedges The vertices of every hyperedge, in any order.
+     * @param weights The weight of every hyperedge, or empty for an
+     * unweighted hypergraph.
+     * @throws std::invalid_argument if a vertex is out of range or repeated
+     * within a hyperedge, or if the number of weights does not match the
+     * number of hyperedges.
+     * @throws std::overflow_error if the hypergraph is too large for
+     * `IndexT`.
+     */
+    Hypergraph(size_t num_vertices,
+               const std::vector<std::vector<size_t>> &hyperedges,
+               std::span<const weight_type> weights = {}) {
+        std::vector<size_t> offsets(hyperedges.size() + 1, 0);
+        for (size_t e = 0; e < hyperedges.size(); e++) {
+            offsets[e + 1] = offsets[e] + hyperedges[e].size();
+        }
+        std::vector<size_t> vertices;
+        vertices.reserve(offsets.back());
+        for (const auto &hyperedge : hyperedges) {
+            vertices.insert(vertices.end(), hyperedge.begin(),
+                            hyperedge.end());
+        }
+        Construct_(num_vertices, std::span<const size_t>(offsets),
+                   std::span<const size_t>(vertices), weights);
+    }
+
+    /**
+     * @brief Construct a hypergraph from a flat incidence list.
+     *
+     * The vertices of hyperedge `e` are `vertices[offsets[e]]` to
+     * `vertices[offsets[e + 1] - 1]`. Signed element types are accepted:
+     * negative indices wrap around to out of range values and are rejected.
+     *
+     * @param num_vertices The number of vertices in the hypergraph.
+     * @param offsets The start of every hyperedge in `vertices`, followed by
+     * the size of `vertices`.
+     * @param vertices The vertices of all the hyperedges, concatenated.
+     * @param weights The weight of every hyperedge, or empty for an
+     * unweighted hypergraph.
+     * @throws std::invalid_argument if the offsets are not a non-decreasing
+     * sequence from 0 to the size of `vertices`, if a vertex is out of range
+     * or repeated within a hyperedge, or if the number of weights does not
+     * match the number of hyperedges.
+     * @throws std::overflow_error if the hypergraph is too large for
+     * `IndexT`.
+     */
+    template <typename T>
+    Hypergraph(size_t num_vertices, std::span<const T> offsets,
+               std::span<const T> vertices,
+               std::span<const weight_type> weights = {}) {
+        Construct_(num_vertices, offsets, vertices, weights);
+    }
+
+    /**
+     * @brief Get the vertices of a hyperedge.
+     *
+     * @param hyperedge The index of the hyperedge.
+     * @return A view of the indices of the vertices, in increasing order.
+     */
+    SparseGraphRow<IndexT> GetVerticesOfHyperedge(size_t hyperedge) const {
+        return SparseGraphRow<IndexT>(e_to_v_col_, e_to_v_row_ptr_[hyperedge],
+                                      e_to_v_row_ptr_[hyperedge + 1]);
+    }
+
+    /**
+     * @brief Get the hyperedges touching a vertex.
+     *
+     * @param vertex The index of the vertex.
+     * @return A view of the indices of the hyperedges, in increasing order.
+     */
+    SparseGraphRow<IndexT> GetHyperedgesTouchingVertex(size_t vertex) const {
+        return SparseGraphRow<IndexT>(v_to_e_col_, v_to_e_row_ptr_[vertex],
+                                      v_to_e_row_ptr_[vertex + 1]);
+    }
+
+    size_t GetNumVertices() const { return num_vertices_; }
+
+    size_t GetNumHyperedges() const { return num_hyperedges_; }
+
+    /**
+     * @brief Get the number of (vertex, hyperedge) incidences, which is the
+     * sum of the sizes of the hyperedges.
+     */
+    size_t GetNumIncidences() const { return e_to_v_col_.size(); }
+
+    bool HasHyperedgeWeights() const { return !weights_.empty(); }
+
+    /**
+     * @brief Get the weight of a hyperedge.
+     *
+     * @param hyperedge The index of the hyperedge.
+     * @return The weight of the hyperedge, or 1 if the hypergraph is
+     * unweighted.
+     */
+    weight_type GetHyperedgeWeight(size_t hyperedge) const {
+        return weights_.empty() ? weight_type{1} : weights_[hyperedge];
+    }
+
+    std::span<const IndexT> GetHyperedgeToVertexRowPtr() const {
+        return e_to_v_row_ptr_;
+    }
+    std::span<const IndexT> GetHyperedgeToVertexCol() const {
+        return e_to_v_col_;
+    }
+    std::span<const IndexT> GetVertexToHyperedgeRowPtr() const {
+        return v_to_e_row_ptr_;
+    }
+    std::span<const IndexT> GetVertexToHyperedgeCol() const {
+        return v_to_e_col_;
+    }
+    std::span<const weight_type> GetHyperedgeWeights() const {
+        return weights_;
+    }
+
+    /**
+     * @brief Decompose the hyperedges into edges of a decoding graph.
+     *
+     * The graph has one more vertex than the hypergraph, the boundary vertex
+     * `GetNumVertices()`, which is the only vertex on the boundary. Each edge
+     * takes the weight of its hyperedge. Empty hyperedges are dropped, and an
+     * edge produced by several hyperedges keeps the weight of the first one,
+     * as in the `DecodingGraph` constructor. To merge such edges as
+     * independent errors instead, as the detector error model parser does,
+     * build the graph from the probabilities of the hyperedges with
+     * `DetectorErrorModel::BuildDecodingGraph`.
+     *
+     * @param decomposition How hyperedges are split into edges.
+     * @param options Options controlling the construction of the graph.
+     * @return The decoding graph.
+     */
+    DecodingGraph<IndexT> ToDecodingGraph(
+        HyperedgeDecomposition decomposition = HyperedgeDecomposition::Pairs,
+        const SparseGraphOptions &options = {}) const {
+        const IndexT boundary = static_cast<IndexT>(num_vertices_);
+        std::vector<IndexT> edges;
+        std::vector<weight_type> weights;
+        edges.reserve(decomposition == HyperedgeDecomposition::Pairs
+                          ? 2 * GetNumIncidences()
+                          : 4 * GetNumIncidences());
+        auto add_edge = [&](IndexT u, IndexT v, size_t hyperedge) {
+            edges.push_back(u);
+            edges.push_back(v);
+            if (!weights_.empty()) {
+                weights.push_back(weights_[hyperedge]);
+            }
+        };
+
+        for (size_t e = 0; e < num_hyperedges_; e++) {
+            const auto vertices = GetVerticesOfHyperedge(e);
+            const size_t size = vertices.size();
+            if (decomposition == HyperedgeDecomposition::Pairs) {
+                for (size_t i = 0; i + 1 < size; i += 2) {
+                    add_edge(vertices[i], vertices[i + 1], e);
+                }
+            } else {
+                for (size_t i = 0; i < size; i++) {
+                    for (size_t j = i + 1; j < size; j++) {
+                        add_edge(vertices[i], vertices[j], e);
+                    }
+                }
+            }
+            if (size == 1 ||
+                (decomposition == HyperedgeDecomposition::Pairs && size % 2)) {
+                add_edge(vertices[size - 1], boundary, e);
+            }
+        }
+
+        std::vector<bool> boundary_type(num_vertices_ + 1, false);
+        boundary_type.back() = true;
+        return DecodingGraph<IndexT>(
+            num_vertices_ + 1, FlatEdgeList<IndexT>(edges.data(),
+                                                    edges.size() / 2),
+            weights, boundary_type, options);
+    }
+
+    /**
+     * @brief Get the memory held by each array of the hypergraph.
+     *
+     * @return The footprint of every array.
+     */
+    MemoryFootprint GetMemoryFootprint() const {
+        MemoryFootprint footprint;
+        footprint.Add("e_to_v_row_ptr", e_to_v_row_ptr_);
+        footprint.Add("e_to_v_col", e_to_v_col_);
+        footprint.Add("v_to_e_row_ptr", v_to_e_row_ptr_);
+        footprint.Add("v_to_e_col", v_to_e_col_);
+        footprint.Add("hyperedge_weights", weights_);
+        return footprint;
+    }
+
+  private:
+    size_t num_vertices_ = 0;
+    size_t num_hyperedges_ = 0;
+
+    ArrayBuffer<IndexT> e_to_v_row_ptr_ =
+        ArrayBuffer<IndexT>(std::vector<IndexT>{0});
+    ArrayBuffer<IndexT> e_to_v_col_;
+    ArrayBuffer<IndexT> v_to_e_row_ptr_ =
+        ArrayBuffer<IndexT>(std::vector<IndexT>{0});
+    ArrayBuffer<IndexT> v_to_e_col_;
+    ArrayBuffer<weight_type> weights_;
+
+    /**
+     * @brief Throw if `count` cannot be represented by `IndexT`.
+     *
+     * @param count The largest index (or CSR offset) that will be stored.
+     * @param what A description of the quantity, used in the error message.
+     */
+    static void CheckIndexRange_(size_t count, const char *what) {
+        if (count > static_cast<size_t>(std::numeric_limits<IndexT>::max())) {
+            throw std::overflow_error(std::string("Hypergraph: ") + what +
+                                      " exceeds the range of the index type");
+        }
+    }
+
+    /**
+     * @brief Construct both incidence matrices from a flat incidence list.
+     */
+    template <typename T>
+    void Construct_(size_t num_vertices, std::span<const T> offsets,
+                    std::span<const T> vertices,
+                    std::span<const weight_type> weights) {
+        if (offsets.empty() || offsets[0] != 0 ||
+            static_cast<size_t>(offsets.back()) != vertices.size()) {
+            throw std::invalid_argument(
+                "Hypergraph: the offsets must start at 0 and end at the "
+                "number of incidences");
+        }
+        const size_t num_hyperedges = offsets.size() - 1;
+        if (!weights.empty() && weights.size() != num_hyperedges) {
+            throw std::invalid_argument(
+                "Hypergraph: the number of weights must match the number of "
+                "hyperedges");
+        }
+        CheckIndexRange_(num_vertices, "number of vertices");
+        CheckIndexRange_(num_hyperedges, "number of hyperedges");
+        CheckIndexRange_(vertices.size(), "number of incidences");
+
+        // Hyperedge-vertex matrix, with the vertices of each row sorted
+        std::pmr::vector<IndexT> e_to_v_row_ptr(num_hyperedges + 1);
+        std::pmr::vector<IndexT> e_to_v_col(vertices.size());
+        std::pmr::vector<IndexT> v_to_e_row_ptr(num_vertices + 1, 0);
+        for (size_t e = 0; e < num_hyperedges; e++) {
+            const size_t begin = static_cast<size_t>(offsets[e]);
+            const size_t end = static_cast<size_t>(offsets[e + 1]);
+            if (end < begin || end > vertices.size()) {
+                throw std::invalid_argument(
+                    "Hypergraph: the offsets must be non-decreasing");
+            }
+            for (size_t k = begin; k < end; k++) {
+                const size_t vertex = static_cast<size_t>(vertices[k]);
+                if (vertex >= num_vertices) {
+                    throw std::invalid_argument(
+                        "Hypergraph: hyperedge vertex out of range");
+                }
+                e_to_v_col[k] = static_cast<IndexT>(vertex);
+                v_to_e_row_ptr[vertex + 1]++;
+            }
+            auto row_begin = e_to_v_col.begin() + begin;
+            auto row_end = e_to_v_col.begin() + end;
+            std::sort(row_begin, row_end);
+            if (std::adjacent_find(row_begin, row_end) != row_end) {
+                throw std::invalid_argument(
+                    "Hypergraph: repeated vertex in a hyperedge");
+            }
+            e_to_v_row_ptr[e] = static_cast<IndexT>(begin);
+        }
+        e_to_v_row_ptr[num_hyperedges] = static_cast<IndexT>(vertices.size());
+
+        // Vertex-hyperedge matrix, as the transpose. Scattering the hyperedges
+        // in increasing order sorts every row.
+        for (size_t v = 0; v < num_vertices; v++) {
+            v_to_e_row_ptr[v + 1] += v_to_e_row_ptr[v];
+        }
+        std::pmr::vector<IndexT> v_to_e_col(vertices.size());
+        std::pmr::vector<IndexT> next(v_to_e_row_ptr.begin(),
+                                      v_to_e_row_ptr.end() - 1);
+        for (size_t e = 0; e < num_hyperedges; e++) {
+            for (size_t k = e_to_v_row_ptr[e]; k < e_to_v_row_ptr[e + 1];
+                 k++) {
+                v_to_e_col[next[e_to_v_col[k]]++] = static_cast<IndexT>(e);
+            }
+        }
+
+        num_vertices_ = num_vertices;
+        num_hyperedges_ = num_hyperedges;
+        e_to_v_row_ptr_ = std::move(e_to_v_row_ptr);
+        e_to_v_col_ = std::move(e_to_v_col);
+        v_to_e_row_ptr_ = std::move(v_to_e_row_ptr);
+        v_to_e_col_ = std::move(v_to_e_col);
+        weights_ = ArrayBuffer<weight_type>(
+            std::pmr::vector<weight_type>(weights.begin(), weights.end()));
+    }
+};
+
+}; // namespace Plaquette
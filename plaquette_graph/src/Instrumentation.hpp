@@ -0,0 +1,218 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ArrayBuffer.hpp"
+
+namespace Plaquette {
+
+/**
+ * @brief Wall-clock time spent in each phase of the construction of a graph,
+ * in seconds.
+ *
+ * Phases that did not run, e.g. for graphs assembled from arrays, take zero
+ * seconds. The edge-edge matrix is only timed once it is constructed.
+ */
+struct ConstructionTimings {
+    /** Validating the edges and removing duplicates. */
+    double deduplicate_edges = 0;
+    /** Building (and sorting) the vertex-vertex matrix. */
+    double vertex_to_vertex = 0;
+    /** Building the hash index from pairs of vertices to edges. */
+    double edge_index = 0;
+    /** Building the edge-edge matrix. */
+    double edge_to_edge = 0;
+    /** Building the local edge maps of a decoding graph. */
+    double local_edge_maps = 0;
+};
+
+/**
+ * @brief Measure the time spent in a scope into a `ConstructionTimings`
+ * field.
+ */
+class PhaseTimer {
+  public:
+    explicit PhaseTimer(double &seconds)
+        : seconds_(seconds), start_(std::chrono::steady_clock::now()) {}
+
+    ~PhaseTimer() {
+        seconds_ = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count();
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  private:
+    double &seconds_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief The memory held by one array of a graph.
+ */
+struct ArrayFootprint {
+    /** The name of the array, e.g. `v_to_v_col`. */
+    std::string name;
+    /** The number of bytes of the elements of the array. */
+    size_t bytes = 0;
+    /** The number of bytes allocated by the graph for the array, which
+     * exceeds `bytes` if the array has spare capacity and is zero if the
+     * array views external memory. */
+    size_t capacity_bytes = 0;
+    /** Whether the array views memory owned by another object, such as a
+     * memory-mapped file. */
+    bool external = false;
+};
+
+/**
+ * @brief The memory held by a graph, broken down per array.
+ *
+ * Arrays shared between copies of a graph, such as a lazily constructed
+ * edge-edge matrix, are reported by every copy.
+ */
+struct MemoryFootprint {
+    std::vector<ArrayFootprint> arrays;
+
+    // Add an array of a graph
+    template <typename T>
+    void Add(const char *name, const ArrayBuffer<T> &array) {
+        arrays.push_back({name, array.size() * sizeof(T),
+                          array.GetOwnedBytes(), array.IsExternal()});
+    }
+
+    template <typename T>
+    void Add(const char *name, const std::vector<T> &array) {
+        arrays.push_back({name, array.size() * sizeof(T),
+                          array.capacity() * sizeof(T), false});
+    }
+
+    // Get the number of bytes of the elements of all arrays
+    size_t GetTotalBytes() const {
+        size_t total = 0;
+        for (const auto &array : arrays) {
+            total += array.bytes;
+        }
+        return total;
+    }
+
+    // Get the number of bytes allocated by the graph for all arrays
+    size_t GetTotalCapacityBytes() const {
+        size_t total = 0;
+        for (const auto &array : arrays) {
+            total += array.capacity_bytes;
+        }
+        return total;
+    }
+};
+
+/**
+ * @brief Whether graphs count their queries.
+ *
+ * Counting is enabled by defining `PLAQUETTE_GRAPH_ENABLE_COUNTERS`, e.g. with
+ * the CMake option of the same name, for every translation unit of a build.
+ */
+#ifdef PLAQUETTE_GRAPH_ENABLE_COUNTERS
+inline constexpr bool kQueryCountersEnabled = true;
+#else
+inline constexpr bool kQueryCountersEnabled = false;
+#endif
+
+/**
+ * @brief The number of queries answered by a graph, by kind.
+ *
+ * Batch queries count one query per vertex, edge or pair of the batch.
+ */
+struct QueryCounts {
+    /** Rows of edges or vertices touching a vertex. */
+    uint64_t vertex_rows = 0;
+    /** Rows of edges touching an edge. */
+    uint64_t edge_rows = 0;
+    /** Lookups of the vertices connected by an edge. */
+    uint64_t edge_endpoints = 0;
+    /** Lookups of the edge connecting a pair of vertices. */
+    uint64_t vertex_pairs = 0;
+    /** Lookups of pairs of vertices that are not connected. */
+    uint64_t vertex_pair_misses = 0;
+};
+
+/**
+ * @brief Counters of the queries answered by a graph.
+ *
+ * Without `PLAQUETTE_GRAPH_ENABLE_COUNTERS` the counters are an empty class
+ * whose member functions do nothing, so counting compiles away. Otherwise
+ * every query costs a relaxed atomic increment, which is cheap but contends
+ * between threads querying the same graph. A copy of a graph starts with its
+ * counters at zero.
+ *
+ * @tparam Enabled Whether the queries are counted.
+ */
+template <bool Enabled = kQueryCountersEnabled> class QueryCounters {
+  public:
+    void CountVertexRows(uint64_t = 1) const {}
+    void CountEdgeRows(uint64_t = 1) const {}
+    void CountEdgeEndpoints(uint64_t = 1) const {}
+    void CountVertexPair(bool) const {}
+    QueryCounts Get() const { return {}; }
+    void Reset() const {}
+};
+
+template <> class QueryCounters<true> {
+  public:
+    QueryCounters() = default;
+    QueryCounters(const QueryCounters &) {}
+    QueryCounters &operator=(const QueryCounters &) {
+        Reset();
+        return *this;
+    }
+
+    void CountVertexRows(uint64_t count = 1) const {
+        vertex_rows_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void CountEdgeRows(uint64_t count = 1) const {
+        edge_rows_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void CountEdgeEndpoints(uint64_t count = 1) const {
+        edge_endpoints_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void CountVertexPair(bool found) const {
+        vertex_pairs_.fetch_add(1, std::memory_order_relaxed);
+        if (!found) {
+            vertex_pair_misses_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Get a snapshot of the counters
+    QueryCounts Get() const {
+        return {vertex_rows_.load(std::memory_order_relaxed),
+                edge_rows_.load(std::memory_order_relaxed),
+                edge_endpoints_.load(std::memory_order_relaxed),
+                vertex_pairs_.load(std::memory_order_relaxed),
+                vertex_pair_misses_.load(std::memory_order_relaxed)};
+    }
+
+    // Set all counters to zero
+    void Reset() const {
+        for (auto *counter : {&vertex_rows_, &edge_rows_, &edge_endpoints_,
+                              &vertex_pairs_, &vertex_pair_misses_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+  private:
+    mutable std::atomic<uint64_t> vertex_rows_ = 0;
+    mutable std::atomic<uint64_t> edge_rows_ = 0;
+    mutable std::atomic<uint64_t> edge_endpoints_ = 0;
+    mutable std::atomic<uint64_t> vertex_pairs_ = 0;
+    mutable std::atomic<uint64_t> vertex_pair_misses_ = 0;
+};
+
+}; // namespace Plaquette
@@ -1,17 +1,72 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "ArrayBuffer.hpp"
+#include "EdgeHashIndex.hpp"
+#include "SparseGraph.hpp"
+#include "Utils.hpp"
+
 namespace Plaquette {
 
+/**
+ * @brief The arrays making up a MultiGraph.
+ *
+ * As for `SparseGraphArrays`, the arrays may view external memory, in which
+ * case `MultiGraph::FromArrays` uses them in place.
+ */
+struct MultiGraphArrays {
+    ArrayBuffer<size_t> v_to_v_row_ptr;
+    ArrayBuffer<size_t> v_to_v_col;
+    ArrayBuffer<size_t> v_to_v_edges;
+    ArrayBuffer<std::pair<size_t, size_t>> edges;
+    ArrayBuffer<size_t> weights;
+    bool sorted_rows = false;
+};
+
+/**
+ * @class MultiGraph
+ * @brief A class representing an undirected multi-graph with weighted edges.
+ *
+ * Multiple edges can connect the same pair of vertices. The vertex-vertex
+ * adjacency is stored in CSR format, with the edge ID of every entry, and the
+ * neighbourhood queries return non-owning `SparseGraphRow` views into it, so
+ * they never allocate. The edge-edge adjacency (line graph) can either be
+ * computed per query from the vertex rows or precomputed once in CSR format.
+ *
+ * The rows of the vertex-vertex matrix can be sorted by neighbouring vertex,
+ * and an `EdgeHashIndex` can be built, to speed up
+ * `GetEdgeConnectingVertices`.
+ */
 class MultiGraph {
   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param edges The pairs of vertices connected by every edge.
+     * @param weights The weight of every edge.
+     * @param sort_rows Sort the rows of the vertex-vertex matrix by
+     * neighbouring vertex, so that they are searched by binary search.
+     * @throws std::invalid_argument if the number of weights does not match
+     * the number of edges.
+     */
     MultiGraph(const std::vector<std::pair<size_t, size_t>> &edges,
-               const std::vector<size_t> &weights)
-        : num_vertices_(0), num_edges_(edges.size()) {
+               const std::vector<size_t> &weights, bool sort_rows = false)
+        : num_vertices_(0), num_edges_(edges.size()), sorted_rows_(sort_rows) {
+        if (weights.size() != num_edges_) {
+            throw std::invalid_argument(
+                "MultiGraph: the number of weights must match the number of "
+                "edges");
+        }
+
         // Determine number of vertices
         for (const auto &edge : edges) {
             num_vertices_ =
@@ -19,85 +74,388 @@ class MultiGraph {
         }
 
         // Initialize edge weight map
-        edge_to_weight_map_.resize(num_edges_);
-        for (size_t i = 0; i < num_edges_; i++) {
-            edge_to_weight_map_[i] = weights[i];
+        edge_to_weight_map_ = ArrayBuffer<size_t>(weights);
+
+        // Initialize the vertex-vertex adjacency matrix
+        auto csr = Utils::BuildCSR(num_vertices_, edges, true);
+        if (sort_rows) {
+            Utils::SortSymmetricCSRRows(csr);
         }
+        v_to_v_row_ptr_ = std::move(csr.row_ptr);
+        v_to_v_col_ = std::move(csr.col);
+        v_to_v_edges_ = std::move(csr.ids);
+
+        edges_ = ArrayBuffer<std::pair<size_t, size_t>>(edges);
+    }
 
-        // Initialize edge connectivity and adjacency lists
-        vertex_to_edge_map_.resize(num_vertices_);
-        vertex_adjacency_lists_.resize(num_vertices_);
-        for (size_t i = 0; i < num_edges_; i++) {
-            const auto &edge = edges[i];
-            vertex_to_edge_map_[edge.first].push_back(i);
-            vertex_to_edge_map_[edge.second].push_back(i);
+    MultiGraph(const MultiGraph &) = default;
+    MultiGraph &operator=(const MultiGraph &) = default;
 
-            vertex_adjacency_lists_[edge.first].push_back(edge.second);
-            vertex_adjacency_lists_[edge.second].push_back(edge.first);
+    /**
+     * @brief Move constructor, leaving `other` an empty multi-graph.
+     */
+    MultiGraph(MultiGraph &&other) noexcept : e_to_e_(nullptr) {
+        MoveFrom_(other);
+    }
+
+    /**
+     * @brief Move assignment, leaving `other` an empty multi-graph.
+     */
+    MultiGraph &operator=(MultiGraph &&other) noexcept {
+        if (this != &other) {
+            MoveFrom_(other);
         }
+        return *this;
+    }
 
-        edges_ = edges;
+    /**
+     * @brief Assemble a multi-graph from its arrays.
+     *
+     * No construction work is done: the arrays are adopted as they are,
+     * after one O(V + E) pass checking that their sizes agree, that the row
+     * pointers never decrease and that every vertex and edge index is in
+     * range, as in `SparseGraph::FromArrays`. Their contents should be those
+     * of a multi-graph built by this class.
+     *
+     * @param arrays The arrays of the multi-graph.
+     * @return The multi-graph.
+     * @throws std::invalid_argument if the arrays are inconsistent.
+     */
+    static MultiGraph FromArrays(MultiGraphArrays arrays) {
+        const size_t num_edges = arrays.edges.size();
+        const auto &row_ptr = arrays.v_to_v_row_ptr;
+        if (row_ptr.empty() || row_ptr[0] != 0 ||
+            row_ptr.back() != 2 * num_edges ||
+            arrays.v_to_v_col.size() != 2 * num_edges ||
+            arrays.v_to_v_edges.size() != 2 * num_edges ||
+            arrays.weights.size() != num_edges) {
+            throw std::invalid_argument("MultiGraph: inconsistent arrays");
+        }
+        const size_t num_vertices = row_ptr.size() - 1;
+        auto all_below = [](const ArrayBuffer<size_t> &values, size_t bound) {
+            return std::ranges::all_of(
+                values, [bound](size_t value) { return value < bound; });
+        };
+        if (!std::ranges::is_sorted(row_ptr) ||
+            !all_below(arrays.v_to_v_col, num_vertices) ||
+            !all_below(arrays.v_to_v_edges, num_edges) ||
+            !std::ranges::all_of(arrays.edges, [&](const auto &edge) {
+                return edge.first < num_vertices && edge.second < num_vertices;
+            })) {
+            throw std::invalid_argument("MultiGraph: array index out of range");
+        }
+
+        MultiGraph graph;
+        graph.num_vertices_ = num_vertices;
+        graph.num_edges_ = num_edges;
+        graph.v_to_v_row_ptr_ = std::move(arrays.v_to_v_row_ptr);
+        graph.v_to_v_col_ = std::move(arrays.v_to_v_col);
+        graph.v_to_v_edges_ = std::move(arrays.v_to_v_edges);
+        graph.edges_ = std::move(arrays.edges);
+        graph.edge_to_weight_map_ = std::move(arrays.weights);
+        graph.sorted_rows_ = arrays.sorted_rows;
+        return graph;
     }
 
-    std::vector<size_t> GetEdgesTouchingVertex(size_t vertex) const {
-        return vertex_to_edge_map_[vertex];
+    /**
+     * @brief Get the edges that touch a given vertex.
+     *
+     * @param vertex The index of the vertex.
+     * @return A view of the indices of the edges touching the vertex, in
+     * increasing order, or ordered by neighbouring vertex if the rows are
+     * sorted. A self-loop appears twice.
+     */
+    SparseGraphRow<size_t> GetEdgesTouchingVertex(size_t vertex) const {
+        return SparseGraphRow<size_t>(v_to_v_edges_, v_to_v_row_ptr_[vertex],
+                                      v_to_v_row_ptr_[vertex + 1]);
     }
 
-    std::vector<size_t> GetVerticesTouchingVertex(size_t vertex) const {
+    /**
+     * @brief Get the vertices connected to a given vertex.
+     *
+     * @param vertex The index of the vertex.
+     * @return A view of the indices of the neighbouring vertices, aligned with
+     * `GetEdgesTouchingVertex`. The view is empty if the vertex is not part of
+     * the graph.
+     */
+    SparseGraphRow<size_t> GetVerticesTouchingVertex(size_t vertex) const {
         if (vertex >= num_vertices_) {
-            return {};
+            return SparseGraphRow<size_t>(v_to_v_col_, 0, 0);
         }
-        return vertex_adjacency_lists_[vertex];
+        return SparseGraphRow<size_t>(v_to_v_col_, v_to_v_row_ptr_[vertex],
+                                      v_to_v_row_ptr_[vertex + 1]);
     }
 
     size_t GetWeight(size_t edge_index) const {
         return edge_to_weight_map_[edge_index];
     }
 
+    /**
+     * @brief Get the edge connecting two vertices.
+     *
+     * The edge is looked up in the hash index if it was built, and otherwise
+     * in the row of `vertex1`, by binary search if the rows are sorted.
+     *
+     * @param vertex1 The index of the first vertex.
+     * @param vertex2 The index of the second vertex.
+     * @return The smallest index of the edges connecting the two vertices, or
+     * the number of edges if there is none or if a vertex is not part of the
+     * graph.
+     */
     size_t GetEdgeConnectingVertices(size_t vertex1, size_t vertex2) const {
+        if (vertex1 >= num_vertices_ || vertex2 >= num_vertices_) {
+            return num_edges_;
+        }
+        if (edge_index_) {
+            size_t edge = edge_index_->Find(vertex1, vertex2, edges_);
+            return edge == EdgeHashIndex<size_t>::kEmpty ? num_edges_ : edge;
+        }
 
-        const auto &vem = vertex_to_edge_map_[vertex1];
-        for (const auto &edge_index : vem) {
-            const auto &edge = edges_[edge_index];
-            if ((edge.first == vertex1 && edge.second == vertex2) ||
-                (edge.first == vertex2 && edge.second == vertex1)) {
-                return edge_index;
+        const size_t begin = v_to_v_row_ptr_[vertex1];
+        const size_t end = v_to_v_row_ptr_[vertex1 + 1];
+        if (sorted_rows_) {
+            size_t k = Utils::FindInSortedRow(v_to_v_col_.data(), begin, end,
+                                              vertex2);
+            return k == end ? num_edges_ : v_to_v_edges_[k];
+        }
+        for (size_t k = begin; k < end; k++) {
+            if (v_to_v_col_[k] == vertex2) {
+                return v_to_v_edges_[k];
             }
         }
         return num_edges_;
     }
 
+    /**
+     * @brief Build the hash index used by `GetEdgeConnectingVertices`.
+     *
+     * The index takes two to four indices of memory per edge and answers
+     * lookups in constant time whatever the degree of the vertices.
+     */
+    void BuildEdgeIndex() {
+        edge_index_ = std::make_shared<const EdgeHashIndex<size_t>>(edges_);
+    }
+
+    // Check whether the hash index from pairs of vertices to edges was built
+    bool HasEdgeIndex() const { return edge_index_ != nullptr; }
+
+    // Check whether the vertex-vertex rows are sorted by neighbouring vertex
+    bool AreRowsSorted() const { return sorted_rows_; }
+
+    /**
+     * @brief Get the edges that share an endpoint with a given edge.
+     *
+     * The neighbours are collected from the rows of the two endpoints, so the
+     * cost is proportional to their degree rather than to the number of edges.
+     * Edges parallel to `edge` and self-loops are reported once.
+     *
+     * @param edge The index of the edge.
+     * @return The indices of the edges touching the edge, in increasing order.
+     * The result is empty if the edge is not part of the graph.
+     */
     std::vector<size_t> GetEdgesTouchingEdge(size_t edge) const {
         std::vector<size_t> edges;
 
         if (edge < num_edges_) {
-            size_t u = edges_[edge].first;
-            size_t v = edges_[edge].second;
-
-            for (size_t i = 0; i < num_edges_; ++i) {
-                if (i != edge) {
-                    if (edges_[i].first == u || edges_[i].second == v ||
-                        edges_[i].first == v || edges_[i].second == u) {
-                        edges.push_back(i);
+            ForEachEndpointRow_(edge, [&](const SparseGraphRow<size_t> &row) {
+                for (size_t neighbour : row) {
+                    if (neighbour != edge) {
+                        edges.push_back(neighbour);
                     }
                 }
-            }
+            });
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
         }
 
         return edges;
     }
 
+    /**
+     * @brief Get the edges that share an endpoint with a given edge from the
+     * precomputed edge-edge adjacency matrix.
+     *
+     * The matrix is constructed on the first call, which makes repeated
+     * queries of the whole line graph cheaper than `GetEdgesTouchingEdge`.
+     *
+     * @param edge The index of the edge.
+     * @return A view of the indices of the edges touching the edge, in
+     * increasing order.
+     * @throws std::out_of_range if the edge is not part of the graph.
+     */
+    SparseGraphRow<size_t> GetEdgesTouchingEdgeRow(size_t edge) const {
+        if (edge >= num_edges_) {
+            throw std::out_of_range("MultiGraph: edge index out of range");
+        }
+        ConstructEdgeToEdgeMatrix();
+        return SparseGraphRow<size_t>(e_to_e_->col, e_to_e_->row_ptr[edge],
+                                      e_to_e_->row_ptr[edge + 1]);
+    }
+
+    /**
+     * @brief Construct the edge-edge adjacency matrix.
+     *
+     * Each row lists the distinct edges sharing an endpoint with the edge, in
+     * increasing order. The matrix is constructed at most once, even if this
+     * function is called concurrently from several threads.
+     */
+    void ConstructEdgeToEdgeMatrix() const {
+        if (!e_to_e_) {
+            return;
+        }
+        auto &e_to_e = *e_to_e_;
+        if (e_to_e.constructed.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard lock(e_to_e.mutex);
+        if (e_to_e.constructed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        BuildEdgeToEdgeMatrix_(e_to_e.row_ptr, e_to_e.col);
+        e_to_e.constructed.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Check whether the edge-edge adjacency matrix is constructed.
+     *
+     * @return true if the matrix has been constructed.
+     */
+    bool IsEdgeToEdgeMatrixConstructed() const {
+        return e_to_e_ &&
+               e_to_e_->constructed.load(std::memory_order_acquire);
+    }
+
     size_t GetNumVertices() const { return num_vertices_; }
 
     size_t GetNumEdges() const { return num_edges_; }
 
+    // Views of the arrays of the multi-graph, as taken by `FromArrays`
+    std::span<const size_t> GetVertexToVertexRowPtr() const {
+        return v_to_v_row_ptr_;
+    }
+    std::span<const size_t> GetVertexToVertexCol() const { return v_to_v_col_; }
+    std::span<const size_t> GetVertexToVertexEdges() const {
+        return v_to_v_edges_;
+    }
+    std::span<const std::pair<size_t, size_t>> GetEdges() const {
+        return edges_;
+    }
+    std::span<const size_t> GetWeights() const { return edge_to_weight_map_; }
+
   private:
-    size_t num_vertices_;
-    size_t num_edges_;
-    std::vector<std::pair<size_t, size_t>> edges_;
-    std::vector<size_t> edge_to_weight_map_;
-    std::vector<std::vector<size_t>> vertex_to_edge_map_;
-    std::vector<std::vector<size_t>> vertex_adjacency_lists_;
+    MultiGraph() = default;
+
+    /**
+     * @brief Move the contents of `other` into this multi-graph, leaving
+     * `other` an empty multi-graph.
+     */
+    void MoveFrom_(MultiGraph &other) noexcept {
+        num_vertices_ = std::exchange(other.num_vertices_, 0);
+        num_edges_ = std::exchange(other.num_edges_, 0);
+        edges_ = std::move(other.edges_);
+        edge_to_weight_map_ = std::move(other.edge_to_weight_map_);
+        v_to_v_row_ptr_ = std::exchange(other.v_to_v_row_ptr_, EmptyRowPtr_());
+        v_to_v_edges_ = std::move(other.v_to_v_edges_);
+        v_to_v_col_ = std::move(other.v_to_v_col_);
+        sorted_rows_ = std::exchange(other.sorted_rows_, false);
+        edge_index_ = std::move(other.edge_index_);
+        e_to_e_ = std::move(other.e_to_e_);
+    }
+
+    /** @brief Lazily constructed edge-edge adjacency matrix. */
+    struct EdgeToEdgeMatrix {
+        std::mutex mutex;
+        std::atomic<bool> constructed = false;
+        std::vector<size_t> row_ptr;
+        std::vector<size_t> col;
+    };
+
+    /**
+     * @brief Call `fn` with the edge rows of the distinct endpoints of an
+     * edge.
+     */
+    template <typename Fn>
+    void ForEachEndpointRow_(size_t edge, Fn &&fn) const {
+        const auto &vertices = edges_[edge];
+        fn(GetEdgesTouchingVertex(vertices.first));
+        if (vertices.second != vertices.first) {
+            fn(GetEdgesTouchingVertex(vertices.second));
+        }
+    }
+
+    /**
+     * @brief Build the edge-edge adjacency matrix into the given CSR arrays.
+     *
+     * Repeated neighbours are filtered with a per-edge stamp array, and each
+     * row is sorted once filled.
+     */
+    void BuildEdgeToEdgeMatrix_(std::vector<size_t> &row_ptr,
+                                std::vector<size_t> &col) const {
+        std::vector<size_t> stamp(num_edges_, num_edges_);
+        auto for_each_neighbour = [&](size_t edge, auto &&fn) {
+            stamp[edge] = edge;
+            ForEachEndpointRow_(edge, [&](const SparseGraphRow<size_t> &row) {
+                for (size_t neighbour : row) {
+                    if (stamp[neighbour] != edge) {
+                        stamp[neighbour] = edge;
+                        fn(neighbour);
+                    }
+                }
+            });
+        };
+
+        // Count the number of edges adjacent to each edge
+        row_ptr.assign(num_edges_ + 1, 0);
+        for (size_t e = 0; e < num_edges_; e++) {
+            for_each_neighbour(e, [&](size_t) { row_ptr[e + 1]++; });
+        }
+        for (size_t e = 1; e < row_ptr.size(); e++) {
+            row_ptr[e] += row_ptr[e - 1];
+        }
+
+        // Fill and sort the rows
+        col.resize(row_ptr.back());
+        std::fill(stamp.begin(), stamp.end(), num_edges_);
+        for (size_t e = 0; e < num_edges_; e++) {
+            size_t next = row_ptr[e];
+            for_each_neighbour(e, [&](size_t neighbour) {
+                col[next++] = neighbour;
+            });
+            std::sort(col.begin() + row_ptr[e], col.begin() + next);
+        }
+    }
+
+    /**
+     * @brief The row pointers of an empty multi-graph, viewed by default
+     * constructed and moved-from multi-graphs so that they hold one row
+     * pointer, as `FromArrays` requires, without allocating.
+     */
+    static constexpr size_t kEmptyRowPtr_[1] = {0};
+
+    static ArrayBuffer<size_t> EmptyRowPtr_() noexcept {
+        return ArrayBuffer<size_t>(kEmptyRowPtr_, 1, nullptr);
+    }
+
+    size_t num_vertices_ = 0;
+    size_t num_edges_ = 0;
+    ArrayBuffer<std::pair<size_t, size_t>> edges_;
+    ArrayBuffer<size_t> edge_to_weight_map_;
+
+    /** @brief adjacency matrix for vertex-vertex connections. */
+    ArrayBuffer<size_t> v_to_v_row_ptr_ = EmptyRowPtr_();
+    ArrayBuffer<size_t> v_to_v_edges_;
+    ArrayBuffer<size_t> v_to_v_col_;
+    bool sorted_rows_ = false;
+
+    /** @brief optional index from pairs of vertices to edges */
+    std::shared_ptr<const EdgeHashIndex<size_t>> edge_index_;
+
+    /**
+     * @brief adjacency matrix for edge-edge connections, or null in a
+     * moved-from multi-graph, which has no matrix to construct.
+     */
+    std::shared_ptr<EdgeToEdgeMatrix> e_to_e_ =
+        std::make_shared<EdgeToEdgeMatrix>();
 };
 
 }; // namespace Plaquette
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "DecodingGraph.hpp"
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+namespace Reordering {
+
+/**
+ * @brief Orders in which the vertices of a graph can be relabelled.
+ */
+enum class VertexOrder {
+    /** Reverse Cuthill-McKee, which minimises the bandwidth of the matrix. */
+    ReverseCuthillMcKee,
+    /** Breadth-first search order from the first vertex of each component. */
+    BreadthFirst,
+    /** Z-order (Morton) space-filling curve over vertex coordinates. */
+    Morton,
+};
+
+/**
+ * @brief A relabelling of vertices or edges and its inverse.
+ *
+ * `forward[old_id]` is the new ID of an element and `inverse[new_id]` its old
+ * ID, so that IDs can be translated in both directions at the boundary of an
+ * API using the relabelled graph.
+ *
+ * @tparam IndexT Unsigned integer type of the IDs.
+ */
+template <typename IndexT = size_t> struct Permutation {
+    std::vector<IndexT> forward;
+    std::vector<IndexT> inverse;
+
+    Permutation() = default;
+
+    /**
+     * @brief Construct a permutation from the old ID of every new ID.
+     *
+     * @param new_to_old The old ID of every element, in the new order.
+     * @throws std::invalid_argument if `new_to_old` is not a permutation.
+     */
+    explicit Permutation(std::vector<IndexT> new_to_old)
+        : forward(new_to_old.size(), kUnassigned_),
+          inverse(std::move(new_to_old)) {
+        for (size_t i = 0; i < inverse.size(); i++) {
+            const size_t old_id = inverse[i];
+            if (old_id >= forward.size() || forward[old_id] != kUnassigned_) {
+                throw std::invalid_argument(
+                    "Permutation: the order must contain every ID once");
+            }
+            forward[old_id] = static_cast<IndexT>(i);
+        }
+    }
+
+    // Get the number of permuted elements
+    size_t size() const { return forward.size(); }
+
+  private:
+    static constexpr IndexT kUnassigned_ = std::numeric_limits<IndexT>::max();
+};
+
+/**
+ * @brief A relabelled graph with the permutations of its vertices and edges.
+ *
+ * @tparam GraphT `SparseGraph` or `DecodingGraph`.
+ */
+template <typename GraphT> struct ReorderedGraph {
+    GraphT graph;
+    Permutation<typename GraphT::index_type> vertices;
+    Permutation<typename GraphT::index_type> edges;
+};
+
+/**
+ * @brief Compute the breadth-first order of the vertices of a graph.
+ *
+ * Each connected component is searched from its vertex with the smallest ID,
+ * in increasing order of these IDs, and the neighbours of a vertex are
+ * visited in the order of its row.
+ *
+ * @param graph The graph.
+ * @return The old ID of every vertex, in the new order.
+ */
+template <typename IndexT>
+std::vector<IndexT> BreadthFirstOrder(const SparseGraph<IndexT> &graph) {
+    const size_t num_vertices = graph.GetNumVertices();
+    std::vector<IndexT> order;
+    order.reserve(num_vertices);
+    std::vector<bool> visited(num_vertices, false);
+    for (size_t root = 0; root < num_vertices; root++) {
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = true;
+        order.push_back(static_cast<IndexT>(root));
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            for (IndexT w : graph.GetVerticesTouchingVertex(order[head])) {
+                if (!visited[w]) {
+                    visited[w] = true;
+                    order.push_back(w);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+// Breadth-first search of the component of `root` that records the level of
+// every vertex in `level`, which must be `kNoLevel` for every vertex of the
+// component on entry and is reset on exit. Returns the vertices of the last
+// level and the number of levels.
+template <typename IndexT>
+std::pair<std::vector<IndexT>, size_t>
+LastLevel_(const SparseGraph<IndexT> &graph, IndexT root,
+           std::vector<IndexT> &level, std::vector<IndexT> &queue) {
+    constexpr IndexT kNoLevel = std::numeric_limits<IndexT>::max();
+    queue.assign(1, root);
+    level[root] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        const IndexT v = queue[head];
+        for (IndexT w : graph.GetVerticesTouchingVertex(v)) {
+            if (level[w] == kNoLevel) {
+                level[w] = level[v] + 1;
+                queue.push_back(w);
+            }
+        }
+    }
+    const IndexT last = level[queue.back()];
+    std::vector<IndexT> last_level;
+    for (size_t i = queue.size(); i-- > 0 && level[queue[i]] == last;) {
+        last_level.push_back(queue[i]);
+    }
+    for (IndexT v : queue) {
+        level[v] = kNoLevel;
+    }
+    return {std::move(last_level), static_cast<size_t>(last) + 1};
+}
+
+// Find a pseudo-peripheral vertex of the component of `root` with the
+// heuristic of George and Liu: move to a vertex of minimum degree in the last
+// level of the search as long as this increases the number of levels
+template <typename IndexT>
+IndexT PseudoPeripheralVertex_(const SparseGraph<IndexT> &graph,
+                               IndexT root, std::vector<IndexT> &level,
+                               std::vector<IndexT> &queue) {
+    auto [last_level, depth] = LastLevel_(graph, root, level, queue);
+    while (true) {
+        const IndexT candidate = *std::min_element(
+            last_level.begin(), last_level.end(), [&](IndexT a, IndexT b) {
+                const size_t da = graph.GetVerticesTouchingVertex(a).size();
+                const size_t db = graph.GetVerticesTouchingVertex(b).size();
+                return da < db || (da == db && a < b);
+            });
+        auto [candidate_level, candidate_depth] =
+            LastLevel_(graph, candidate, level, queue);
+        if (candidate_depth <= depth) {
+            return root;
+        }
+        root = candidate;
+        depth = candidate_depth;
+        last_level = std::move(candidate_level);
+    }
+}
+
+/**
+ * @brief Compute the reverse Cuthill-McKee order of the vertices of a graph.
+ *
+ * Each connected component is searched breadth-first from a pseudo-peripheral
+ * vertex, visiting the unvisited neighbours of every vertex by increasing
+ * degree, and the resulting order is reversed. Neighbouring vertices end up
+ * with close IDs, which keeps the rows touched by a traversal close in memory.
+ *
+ * @param graph The graph.
+ * @return The old ID of every vertex, in the new order.
+ */
+template <typename IndexT>
+std::vector<IndexT> ReverseCuthillMcKeeOrder(const SparseGraph<IndexT> &graph) {
+    const size_t num_vertices = graph.GetNumVertices();
+    auto degree = [&](IndexT v) {
+        return graph.GetVerticesTouchingVertex(v).size();
+    };
+
+    std::vector<IndexT> order;
+    order.reserve(num_vertices);
+    std::vector<bool> visited(num_vertices, false);
+    std::vector<IndexT> level(num_vertices,
+                              std::numeric_limits<IndexT>::max());
+    std::vector<IndexT> queue;
+    for (size_t v = 0; v < num_vertices; v++) {
+        if (visited[v]) {
+            continue;
+        }
+        const IndexT root = PseudoPeripheralVertex_(
+            graph, static_cast<IndexT>(v), level, queue);
+        visited[root] = true;
+        order.push_back(root);
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            const size_t first = order.size();
+            for (IndexT w : graph.GetVerticesTouchingVertex(order[head])) {
+                if (!visited[w]) {
+                    visited[w] = true;
+                    order.push_back(w);
+                }
+            }
+            std::stable_sort(order.begin() + first, order.end(),
+                             [&](IndexT a, IndexT b) {
+                                 return degree(a) < degree(b);
+                             });
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/**
+ * @brief Compute the Z-order (Morton) curve order of points.
+ *
+ * The coordinates are scaled to the bounding cube of the points and quantized
+ * to `64 / dimension` bits per axis (at most 32), and the points are sorted by
+ * the interleaved bits of their quantized coordinates, ties keeping their
+ * relative order. Points that are close in space are then mostly close on the
+ * curve.
+ *
+ * @param coordinates The coordinates of every point, `dimension` consecutive
+ * values per point.
+ * @param dimension The number of coordinates per point, from 1 to 3.
+ * @return The old ID of every point, in the new order.
+ * @throws std::invalid_argument if the dimension is not between 1 and 3,
+ * the number of coordinates is not a multiple of it, or a coordinate is NaN
+ * or infinite.
+ */
+template <typename IndexT = size_t>
+std::vector<IndexT> MortonOrder(std::span<const double> coordinates,
+                                size_t dimension) {
+    if (dimension < 1 || dimension > 3 ||
+        coordinates.size() % dimension != 0) {
+        throw std::invalid_argument(
+            "MortonOrder: expected 1 to 3 coordinates per point");
+    }
+    if (!std::ranges::all_of(coordinates,
+                             [](double x) { return std::isfinite(x); })) {
+        throw std::invalid_argument(
+            "MortonOrder: the coordinates must be finite");
+    }
+    const size_t num_points = coordinates.size() / dimension;
+    const size_t bits = std::min<size_t>(32, 64 / dimension);
+    const double max_cell = static_cast<double>((uint64_t{1} << bits) - 1);
+
+    // The same scale on every axis, so that the cells of the curve are cubes.
+    // Offsets are taken between halved coordinates, which cannot overflow.
+    std::vector<double> low(dimension, 0);
+    double extent = 0;
+    for (size_t k = 0; k < dimension && num_points > 0; k++) {
+        double lo = coordinates[k], hi = coordinates[k];
+        for (size_t p = 1; p < num_points; p++) {
+            lo = std::min(lo, coordinates[p * dimension + k]);
+            hi = std::max(hi, coordinates[p * dimension + k]);
+        }
+        low[k] = lo / 2;
+        extent = std::max(extent, hi / 2 - lo / 2);
+    }
+    const double scale = extent > 0 ? max_cell / extent : 0;
+
+    std::vector<std::pair<uint64_t, IndexT>> keys(num_points);
+    for (size_t p = 0; p < num_points; p++) {
+        uint64_t key = 0;
+        for (size_t k = 0; k < dimension; k++) {
+            const double offset = coordinates[p * dimension + k] / 2 - low[k];
+            const auto cell =
+                static_cast<uint64_t>(std::min(max_cell, offset * scale));
+            for (size_t b = 0; b < bits; b++) {
+                key |= ((cell >> b) & 1) << (b * dimension + k);
+            }
+        }
+        keys[p] = {key, static_cast<IndexT>(p)};
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<IndexT> order(num_points);
+    for (size_t p = 0; p < num_points; p++) {
+        order[p] = keys[p].second;
+    }
+    return order;
+}
+
+/**
+ * @brief Compute an order of the vertices of a graph.
+ *
+ * @param graph The graph.
+ * @param order The order to compute.
+ * @param coordinates The coordinates of every vertex for `Morton`, with
+ * `dimension` values per vertex, and ignored otherwise.
+ * @param dimension The number of coordinates per vertex.
+ * @return The old ID of every vertex, in the new order.
+ * @throws std::invalid_argument if the coordinates of the `Morton` order do
+ * not match the vertices.
+ */
+template <typename IndexT>
+std::vector<IndexT> ComputeVertexOrder(const SparseGraph<IndexT> &graph,
+                                       VertexOrder order,
+                                       std::span<const double> coordinates = {},
+                                       size_t dimension = 0) {
+    switch (order) {
+    case VertexOrder::BreadthFirst:
+        return BreadthFirstOrder(graph);
+    case VertexOrder::Morton:
+        if (coordinates.size() != dimension * graph.GetNumVertices()) {
+            throw std::invalid_argument(
+                "ComputeVertexOrder: the Morton order needs the coordinates "
+                "of every vertex");
+        }
+        return MortonOrder<IndexT>(coordinates, dimension);
+    case VertexOrder::ReverseCuthillMcKee:
+    default:
+        return ReverseCuthillMcKeeOrder(graph);
+    }
+}
+
+// Number the edges in the order in which they are first met in the rows of
+// the relabelled vertices, so that the edges of a vertex have close IDs
+template <typename IndexT>
+Permutation<IndexT> EdgeOrder_(const SparseGraph<IndexT> &graph,
+                               const Permutation<IndexT> &vertices) {
+    const size_t num_edges = graph.GetNumEdges();
+    std::vector<IndexT> new_to_old;
+    new_to_old.reserve(num_edges);
+    std::vector<bool> numbered(num_edges, false);
+    for (IndexT v : vertices.inverse) {
+        for (IndexT e : graph.GetEdgesTouchingVertex(v)) {
+            if (!numbered[e]) {
+                numbered[e] = true;
+                new_to_old.push_back(e);
+            }
+        }
+    }
+    return Permutation<IndexT>(std::move(new_to_old));
+}
+
+// Relabel the edge list and the weights of a graph
+template <typename IndexT>
+std::pair<std::vector<std::pair<size_t, size_t>>, std::vector<EdgeWeight>>
+RelabelEdges_(const SparseGraph<IndexT> &graph,
+              const Permutation<IndexT> &vertices,
+              const Permutation<IndexT> &edges) {
+    const auto weights = graph.GetEdgeWeights();
+    std::vector<std::pair<size_t, size_t>> new_edges(edges.size());
+    std::vector<EdgeWeight> new_weights(weights.size());
+    for (size_t e = 0; e < edges.size(); e++) {
+        const auto &[u, v] = graph.GetVerticesConnectedByEdge(e);
+        new_edges[edges.forward[e]] = {vertices.forward[u],
+                                       vertices.forward[v]};
+        if (!weights.empty()) {
+            new_weights[edges.forward[e]] = weights[e];
+        }
+    }
+    return {std::move(new_edges), std::move(new_weights)};
+}
+
+// The options rebuilding the optional structures of a graph
+template <typename IndexT>
+SparseGraphOptions MatchingOptions_(const SparseGraph<IndexT> &graph) {
+    SparseGraphOptions options;
+    options.assume_unique_edges = true;
+    options.edge_to_edge = graph.IsEdgeToEdgeMatrixConstructed()
+                               ? EdgeToEdgeMode::Eager
+                               : EdgeToEdgeMode::Lazy;
+    options.sort_rows = graph.AreRowsSorted();
+    options.edge_index = graph.HasEdgeIndex();
+    return options;
+}
+
+template <typename IndexT>
+void CheckVertexPermutation_(const SparseGraph<IndexT> &graph,
+                             const Permutation<IndexT> &vertices) {
+    if (vertices.size() != graph.GetNumVertices()) {
+        throw std::invalid_argument(
+            "Reorder: the permutation must have one entry per vertex");
+    }
+}
+
+/**
+ * @brief Relabel the vertices and edges of a graph.
+ *
+ * The edges are numbered in the order in which they appear in the rows of
+ * the relabelled vertices, keeping their orientation, and all arrays of the
+ * graph are rebuilt. Parallel edges are kept, and the edge weights, sorted
+ * rows, edge-edge matrix and edge index of `graph` carry over.
+ *
+ * @param graph The graph.
+ * @param vertices The permutation of the vertices.
+ * @return The relabelled graph and the permutations of its vertices and
+ * edges.
+ * @throws std::invalid_argument if the permutation does not match the
+ * vertices.
+ */
+template <typename IndexT>
+ReorderedGraph<SparseGraph<IndexT>> Reorder(const SparseGraph<IndexT> &graph,
+                                            Permutation<IndexT> vertices) {
+    CheckVertexPermutation_(graph, vertices);
+    auto edges = EdgeOrder_(graph, vertices);
+    auto [new_edges, weights] = RelabelEdges_(graph, vertices, edges);
+    return {SparseGraph<IndexT>(graph.GetNumVertices(), new_edges, weights,
+                                MatchingOptions_(graph)),
+            std::move(vertices), std::move(edges)};
+}
+
+/**
+ * @brief Relabel the vertices and edges of a decoding graph.
+ *
+ * As for a `SparseGraph`, with the boundary flags permuted and the local edge
+ * maps rebuilt for the new rows.
+ */
+template <typename IndexT>
+ReorderedGraph<DecodingGraph<IndexT>>
+Reorder(const DecodingGraph<IndexT> &graph, Permutation<IndexT> vertices) {
+    CheckVertexPermutation_(graph, vertices);
+    auto edges = EdgeOrder_(graph, vertices);
+    auto [new_edges, weights] = RelabelEdges_(graph, vertices, edges);
+    std::vector<bool> boundary(graph.GetNumVertices());
+    for (size_t v = 0; v < boundary.size(); v++) {
+        boundary[vertices.forward[v]] = graph.IsVertexOnBoundary(v);
+    }
+    return {DecodingGraph<IndexT>(graph.GetNumVertices(), new_edges, weights,
+                                  boundary, MatchingOptions_(graph)),
+            std::move(vertices), std::move(edges)};
+}
+
+/**
+ * @brief Relabel the vertices and edges of a graph in a given vertex order.
+ *
+ * @param graph A `SparseGraph` or `DecodingGraph`.
+ * @param order The order of the vertices.
+ * @param coordinates The coordinates of every vertex for `Morton`, with
+ * `dimension` values per vertex.
+ * @param dimension The number of coordinates per vertex.
+ * @return The relabelled graph and the permutations of its vertices and
+ * edges.
+ */
+template <typename GraphT>
+ReorderedGraph<GraphT> Reorder(const GraphT &graph, VertexOrder order,
+                               std::span<const double> coordinates = {},
+                               size_t dimension = 0) {
+    using IndexT = typename GraphT::index_type;
+    return Reorder(graph, Permutation<IndexT>(ComputeVertexOrder(
+                              graph, order, coordinates, dimension)));
+}
+
+}; // namespace Reordering
+}; // namespace Plaquette
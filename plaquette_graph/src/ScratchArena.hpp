@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace Plaquette {
+
+/**
+ * @brief A per-thread stack allocator for the temporary arrays of graph
+ * construction.
+ *
+ * Graph construction needs scratch arrays (counting sort buckets, row
+ * cursors, duplicate markers) that live no longer than one construction
+ * phase. `ScratchArena` hands them out from one contiguous buffer by bumping
+ * an offset, and a `Scope` rewinds the offset when the phase ends. Requests
+ * that do not fit in the buffer are served from the upstream resource and
+ * freed at the end of their scope, and when the outermost scope ends the
+ * buffer grows to the largest amount of scratch memory used so far. Once the
+ * largest graph of a sweep has been built, later constructions therefore do
+ * not allocate any scratch memory.
+ *
+ * Deallocation is a no-op, so arena-backed vectors must not grow after they
+ * are sized, and nothing allocated in a scope may be used after it ends.
+ */
+class ScratchArena : public std::pmr::memory_resource {
+  public:
+    /**
+     * @brief Rewind the arena to its current position when destroyed.
+     */
+    class Scope {
+      public:
+        explicit Scope(ScratchArena &arena)
+            : arena_(arena), offset_(arena.offset_),
+              num_overflow_(arena.overflow_.size()),
+              overflow_bytes_(arena.overflow_bytes_) {
+            arena_.depth_++;
+        }
+
+        ~Scope() {
+            arena_.Rewind_(offset_, num_overflow_, overflow_bytes_);
+            if (--arena_.depth_ == 0) {
+                arena_.Grow_();
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+      private:
+        ScratchArena &arena_;
+        size_t offset_;
+        size_t num_overflow_;
+        size_t overflow_bytes_;
+    };
+
+    explicit ScratchArena(
+        std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+    ~ScratchArena() override {
+        Rewind_(0, 0, 0);
+        Release_();
+    }
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    /**
+     * @brief Get the arena of the calling thread.
+     */
+    static ScratchArena &ForThisThread() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    // Get the size of the buffer
+    size_t capacity() const { return capacity_; }
+
+  private:
+    struct Overflow {
+        void *data;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        const auto base = reinterpret_cast<uintptr_t>(buffer_);
+        const size_t begin =
+            ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+        if (buffer_ != nullptr && begin + bytes <= capacity_) {
+            offset_ = begin + bytes;
+            high_water_ = std::max(high_water_, offset_ + overflow_bytes_);
+            return buffer_ + begin;
+        }
+        void *data = upstream_->allocate(bytes, alignment);
+        overflow_.push_back({data, bytes, alignment});
+        overflow_bytes_ += bytes + alignment;
+        high_water_ = std::max(high_water_, offset_ + overflow_bytes_);
+        return data;
+    }
+
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    // Free the overflow allocations made since a scope began and rewind the
+    // buffer to where it was
+    void Rewind_(size_t offset, size_t num_overflow, size_t overflow_bytes) {
+        while (overflow_.size() > num_overflow) {
+            const auto &block = overflow_.back();
+            upstream_->deallocate(block.data, block.bytes, block.alignment);
+            overflow_.pop_back();
+        }
+        offset_ = offset;
+        overflow_bytes_ = overflow_bytes;
+    }
+
+    // Grow the buffer to the largest amount of memory used in one scope
+    void Grow_() {
+        if (high_water_ <= capacity_) {
+            return;
+        }
+        Release_();
+        capacity_ = high_water_ + high_water_ / 4;
+        buffer_ = static_cast<std::byte *>(
+            upstream_->allocate(capacity_, alignof(std::max_align_t)));
+    }
+
+    void Release_() {
+        if (buffer_ != nullptr) {
+            upstream_->deallocate(buffer_, capacity_,
+                                  alignof(std::max_align_t));
+            buffer_ = nullptr;
+            capacity_ = 0;
+        }
+    }
+
+    std::pmr::memory_resource *upstream_;
+    std::byte *buffer_ = nullptr;
+    size_t capacity_ = 0;
+    size_t offset_ = 0;
+    size_t high_water_ = 0;
+    std::vector<Overflow> overflow_;
+    size_t overflow_bytes_ = 0;
+    size_t depth_ = 0;
+};
+
+}; // namespace Plaquette
@@ -0,0 +1,553 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PLAQUETTE_GRAPH_HAS_MMAP 1
+#endif
+
+#include "ArrayBuffer.hpp"
+#include "DecodingGraph.hpp"
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+namespace Serialization {
+
+// A graph file consists of a 64-byte `FileHeader`, followed by a table of
+// `SectionEntry` records and by the sections themselves. Every section holds
+// one array of the graph, stored in the byte order of the machine that wrote
+// the file and aligned to `kAlignment` bytes, so that a memory-mapped file
+// can be used in place.
+
+/** @brief Magic bytes at the start of every graph file. */
+inline constexpr char kMagic[8] = {'P', 'Q', 'G', 'R', 'A', 'P', 'H', '\0'};
+
+/** @brief Current version of the file format. */
+inline constexpr uint32_t kVersion = 1;
+
+/** @brief Tag written in native byte order to detect foreign files. */
+inline constexpr uint32_t kEndianTag = 0x01020304;
+
+/** @brief Alignment of the sections, in bytes. */
+inline constexpr size_t kAlignment = 64;
+
+/** @brief The type of graph stored in a file. */
+enum class GraphKind : uint32_t {
+    Sparse = 0,
+    Decoding = 1,
+};
+
+/** @brief Identifiers of the arrays stored in a file. */
+enum class SectionId : uint32_t {
+    VertexRowPtr = 0,
+    VertexCol = 1,
+    VertexEdges = 2,
+    EdgeToVertex = 3,
+    EdgeRowPtr = 4,
+    EdgeCol = 5,
+    VertexBoundaryType = 6,
+    LocalEdgeStrides = 7,
+    LocalToGlobalEdgeMap = 8,
+    GlobalToLocalEdgeMap = 9,
+    EdgeWeights = 10,
+};
+
+/** @brief Flag of the header of files whose vertex-vertex rows are sorted. */
+inline constexpr uint64_t kFlagSortedRows = 1;
+
+/** @brief Header at the start of a graph file. */
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t index_size; ///< Size in bytes of the stored indices.
+    uint32_t kind;       ///< A `GraphKind`.
+    uint64_t num_vertices;
+    uint64_t num_edges;
+    uint64_t num_sections;
+    uint64_t flags; ///< A combination of the `kFlag` bits.
+    uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 64, "unexpected FileHeader padding");
+
+/** @brief Location of an array in a graph file. */
+struct SectionEntry {
+    uint32_t id;           ///< A `SectionId`.
+    uint32_t element_size; ///< Size in bytes of one element.
+    uint64_t offset;       ///< Offset of the array from the file start.
+    uint64_t count;        ///< Number of elements.
+};
+static_assert(sizeof(SectionEntry) == 24, "unexpected SectionEntry padding");
+
+/**
+ * @brief The contents of a graph file, either memory-mapped or read into an
+ * aligned buffer.
+ *
+ * Graphs loaded from a file view its sections in place and share ownership
+ * of the `FileBuffer`, which is released when the last graph is destroyed.
+ */
+class FileBuffer {
+  public:
+    /**
+     * @brief Map or read a file.
+     *
+     * @param path The path of the file.
+     * @param memory_map Map the file instead of reading it. Ignored on
+     * platforms without `mmap`.
+     * @throws std::runtime_error if the file cannot be opened or read.
+     */
+    FileBuffer(const std::string &path, bool memory_map) {
+#ifdef PLAQUETTE_GRAPH_HAS_MMAP
+        if (memory_map) {
+            Map_(path);
+            return;
+        }
+#endif
+        Read_(path);
+    }
+
+    FileBuffer(const FileBuffer &) = delete;
+    FileBuffer &operator=(const FileBuffer &) = delete;
+
+    ~FileBuffer() {
+#ifdef PLAQUETTE_GRAPH_HAS_MMAP
+        if (mapped_) {
+            munmap(data_, size_);
+            return;
+        }
+#endif
+        if (data_ != nullptr) {
+            ::operator delete(data_, std::align_val_t{kAlignment});
+        }
+    }
+
+    // Get a pointer to the first byte of the file
+    const std::byte *data() const { return static_cast<std::byte *>(data_); }
+
+    // Get the size of the file in bytes
+    size_t size() const { return size_; }
+
+    // Check whether the file is memory-mapped
+    bool IsMapped() const { return mapped_; }
+
+  private:
+#ifdef PLAQUETTE_GRAPH_HAS_MMAP
+    void Map_(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Serialization: cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            throw std::runtime_error("Serialization: cannot map " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Serialization: cannot map " + path);
+        }
+        data_ = data;
+        mapped_ = true;
+    }
+#endif
+
+    void Read_(const std::string &path) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            throw std::runtime_error("Serialization: cannot open " + path);
+        }
+        size_ = static_cast<size_t>(in.tellg());
+        data_ = ::operator new(size_, std::align_val_t{kAlignment});
+        in.seekg(0);
+        if (!in.read(static_cast<char *>(data_),
+                     static_cast<std::streamsize>(size_))) {
+            ::operator delete(data_, std::align_val_t{kAlignment});
+            throw std::runtime_error("Serialization: cannot read " + path);
+        }
+    }
+
+    void *data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+};
+
+/**
+ * @brief Check the header of a graph file.
+ *
+ * @param header The header to check.
+ * @throws std::runtime_error if the header is not that of a graph file that
+ * this version can read on this machine.
+ */
+inline void ValidateHeader_(const FileHeader &header) {
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Serialization: not a graph file");
+    }
+    if (header.endian_tag != kEndianTag) {
+        throw std::runtime_error(
+            "Serialization: graph file was written with a different byte "
+            "order");
+    }
+    if (header.version != kVersion) {
+        throw std::runtime_error(
+            "Serialization: unsupported graph file version " +
+            std::to_string(header.version));
+    }
+}
+
+/**
+ * @brief Read and check the header of a graph file.
+ *
+ * This only reads the first bytes of the file, e.g. to find out which type of
+ * graph to load.
+ *
+ * @param path The path of the file.
+ * @return The header of the file.
+ * @throws std::runtime_error if the file is not a valid graph file.
+ */
+inline FileHeader ReadHeader(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Serialization: cannot open " + path);
+    }
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        throw std::runtime_error("Serialization: not a graph file");
+    }
+    ValidateHeader_(header);
+    return header;
+}
+
+/** @brief An array to be written to a graph file. */
+struct Section_ {
+    SectionId id;
+    uint32_t element_size;
+    const void *data;
+    uint64_t count;
+};
+
+template <typename T>
+Section_ MakeSection_(SectionId id, std::span<const T> data) {
+    return {id, sizeof(T), data.data(), data.size()};
+}
+
+inline uint64_t AlignUp_(uint64_t offset) {
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+/**
+ * @brief Get the path of the temporary file a graph file is written to
+ * before it replaces `path`.
+ */
+inline std::string TemporaryPath_(const std::string &path) {
+#ifdef PLAQUETTE_GRAPH_HAS_MMAP
+    return path + ".tmp." + std::to_string(getpid());
+#else
+    return path + ".tmp";
+#endif
+}
+
+/**
+ * @brief Write a graph file.
+ *
+ * The file is written to a temporary file in the same directory, which then
+ * replaces `path` by renaming it. An existing file at `path` is therefore
+ * never truncated, so graphs that other processes mapped from it remain
+ * valid, and `path` is left untouched if writing fails.
+ *
+ * @param path The path of the file, which is replaced.
+ * @param header The header, whose `num_sections` is filled in.
+ * @param sections The arrays to write.
+ */
+inline void WriteFile_(const std::string &path, FileHeader header,
+                       const std::vector<Section_> &sections) {
+    const std::string temporary = TemporaryPath_(path);
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Serialization: cannot open " + temporary);
+    }
+
+    header.num_sections = sections.size();
+    std::vector<SectionEntry> table(sections.size());
+    uint64_t offset = AlignUp_(sizeof(FileHeader) +
+                               sections.size() * sizeof(SectionEntry));
+    for (size_t i = 0; i < sections.size(); i++) {
+        const auto &section = sections[i];
+        table[i] = {static_cast<uint32_t>(section.id), section.element_size,
+                    offset, section.count};
+        offset = AlignUp_(offset + section.count * section.element_size);
+    }
+
+    const uint64_t table_bytes = table.size() * sizeof(SectionEntry);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table.data()),
+              static_cast<std::streamsize>(table_bytes));
+
+    const char padding[kAlignment] = {};
+    uint64_t position = sizeof(FileHeader) + table_bytes;
+    for (size_t i = 0; i < sections.size(); i++) {
+        out.write(padding, static_cast<std::streamsize>(table[i].offset -
+                                                        position));
+        uint64_t bytes = sections[i].count * sections[i].element_size;
+        out.write(static_cast<const char *>(sections[i].data),
+                  static_cast<std::streamsize>(bytes));
+        position = table[i].offset + bytes;
+    }
+
+    out.flush();
+    const bool written = static_cast<bool>(out);
+    out.close();
+    std::error_code error;
+    if (written && !out.fail()) {
+        std::filesystem::rename(temporary, path, error);
+        if (!error) {
+            return;
+        }
+    }
+    std::filesystem::remove(temporary, error);
+    throw std::runtime_error("Serialization: cannot write " + path);
+}
+
+/**
+ * @brief View an array of a loaded graph file in place.
+ *
+ * @param file The file, kept alive by the returned array.
+ * @param header The header of the file.
+ * @param id The identifier of the array.
+ * @return The array, or an empty array if the file does not contain it.
+ * @throws std::runtime_error if the section table is corrupted.
+ */
+template <typename T>
+ArrayBuffer<T> GetSection_(const std::shared_ptr<const FileBuffer> &file,
+                           const FileHeader &header, SectionId id) {
+    const uint64_t table_end =
+        sizeof(FileHeader) + header.num_sections * sizeof(SectionEntry);
+    if (header.num_sections > file->size() || table_end > file->size()) {
+        throw std::runtime_error("Serialization: corrupted section table");
+    }
+
+    for (uint64_t i = 0; i < header.num_sections; i++) {
+        SectionEntry entry;
+        std::memcpy(&entry,
+                    file->data() + sizeof(FileHeader) + i * sizeof(entry),
+                    sizeof(entry));
+        if (entry.id != static_cast<uint32_t>(id)) {
+            continue;
+        }
+        if (entry.element_size != sizeof(T) || entry.offset % alignof(T) != 0 ||
+            entry.offset > file->size() ||
+            entry.count > (file->size() - entry.offset) / sizeof(T)) {
+            throw std::runtime_error("Serialization: corrupted section");
+        }
+        return ArrayBuffer<T>(
+            reinterpret_cast<const T *>(file->data() + entry.offset),
+            entry.count, file);
+    }
+    return {};
+}
+
+/**
+ * @brief Open a graph file and check that it holds a graph of the expected
+ * index type.
+ */
+template <typename IndexT>
+std::pair<std::shared_ptr<const FileBuffer>, FileHeader>
+OpenGraphFile_(const std::string &path, bool memory_map) {
+    auto file = std::make_shared<const FileBuffer>(path, memory_map);
+    FileHeader header;
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("Serialization: not a graph file");
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+    ValidateHeader_(header);
+    if (header.index_size != sizeof(IndexT)) {
+        throw std::runtime_error(
+            "Serialization: graph file stores " +
+            std::to_string(8 * header.index_size) + "-bit indices");
+    }
+    return {std::move(file), header};
+}
+
+template <typename IndexT>
+std::vector<Section_>
+GetSparseGraphSections_(const SparseGraph<IndexT> &graph) {
+    std::vector<Section_> sections = {
+        MakeSection_(SectionId::VertexRowPtr, graph.GetVertexToVertexRowPtr()),
+        MakeSection_(SectionId::VertexCol, graph.GetVertexToVertexCol()),
+        MakeSection_(SectionId::VertexEdges, graph.GetVertexToVertexEdges()),
+        MakeSection_(SectionId::EdgeToVertex, graph.GetEdgeToVertex()),
+    };
+    if (graph.IsEdgeToEdgeMatrixConstructed()) {
+        sections.push_back(
+            MakeSection_(SectionId::EdgeRowPtr, graph.GetEdgeToEdgeRowPtr()));
+        sections.push_back(
+            MakeSection_(SectionId::EdgeCol, graph.GetEdgeToEdgeCol()));
+    }
+    if (graph.HasEdgeWeights()) {
+        sections.push_back(
+            MakeSection_(SectionId::EdgeWeights, graph.GetEdgeWeights()));
+    }
+    return sections;
+}
+
+template <typename IndexT>
+FileHeader MakeHeader_(const SparseGraph<IndexT> &graph, GraphKind kind) {
+    FileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endian_tag = kEndianTag;
+    header.index_size = sizeof(IndexT);
+    header.kind = static_cast<uint32_t>(kind);
+    header.num_vertices = graph.GetNumVertices();
+    header.num_edges = graph.GetNumEdges();
+    header.flags = graph.AreRowsSorted() ? kFlagSortedRows : 0;
+    return header;
+}
+
+template <typename IndexT>
+SparseGraphArrays<IndexT>
+GetSparseGraphArrays_(const std::shared_ptr<const FileBuffer> &file,
+                      const FileHeader &header) {
+    using Edge = typename SparseGraph<IndexT>::edge_type;
+    SparseGraphArrays<IndexT> arrays;
+    arrays.v_to_v_row_ptr =
+        GetSection_<IndexT>(file, header, SectionId::VertexRowPtr);
+    arrays.v_to_v_col = GetSection_<IndexT>(file, header, SectionId::VertexCol);
+    arrays.v_to_v_edges =
+        GetSection_<IndexT>(file, header, SectionId::VertexEdges);
+    arrays.e_to_v = GetSection_<Edge>(file, header, SectionId::EdgeToVertex);
+    arrays.e_to_e_row_ptr =
+        GetSection_<IndexT>(file, header, SectionId::EdgeRowPtr);
+    arrays.e_to_e_col = GetSection_<IndexT>(file, header, SectionId::EdgeCol);
+    arrays.edge_weights =
+        GetSection_<EdgeWeight>(file, header, SectionId::EdgeWeights);
+    arrays.sorted_rows = (header.flags & kFlagSortedRows) != 0;
+
+    // The edge sections must hold as many edges as the header
+    if (arrays.e_to_v.size() != header.num_edges ||
+        (!arrays.edge_weights.empty() &&
+         arrays.edge_weights.size() != header.num_edges)) {
+        throw std::runtime_error(
+            "Serialization: edge sections do not match the header");
+    }
+    return arrays;
+}
+
+/**
+ * @brief Save a sparse graph to a file.
+ *
+ * The file holds the vertex-vertex matrix and the edge to vertices list, as
+ * well as the edge weights of a weighted graph and the edge-edge matrix if it
+ * has been constructed.
+ *
+ * @param graph The graph to save.
+ * @param path The path of the file, which is overwritten.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+template <typename IndexT>
+void SaveGraph(const SparseGraph<IndexT> &graph, const std::string &path) {
+    WriteFile_(path, MakeHeader_(graph, GraphKind::Sparse),
+               GetSparseGraphSections_(graph));
+}
+
+/**
+ * @brief Save a decoding graph to a file.
+ *
+ * In addition to the arrays of the sparse graph, the file holds the boundary
+ * flags and the local edge maps.
+ *
+ * @param graph The graph to save.
+ * @param path The path of the file, which is overwritten.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+template <typename IndexT>
+void SaveGraph(const DecodingGraph<IndexT> &graph, const std::string &path) {
+    auto sections = GetSparseGraphSections_(graph);
+    sections.push_back(MakeSection_(SectionId::VertexBoundaryType,
+                                    graph.GetVertexBoundaryTypes()));
+    sections.push_back(MakeSection_(SectionId::LocalEdgeStrides,
+                                    graph.GetLocalEdgeStrides()));
+    sections.push_back(MakeSection_(SectionId::LocalToGlobalEdgeMap,
+                                    graph.GetLocalToGlobalEdgeMap()));
+    sections.push_back(MakeSection_(SectionId::GlobalToLocalEdgeMap,
+                                    graph.GetGlobalToLocalEdgeMap()));
+    WriteFile_(path, MakeHeader_(graph, GraphKind::Decoding), sections);
+}
+
+/**
+ * @brief Load a sparse graph from a file.
+ *
+ * The arrays of the graph are used in place, without any copy or construction
+ * work. With `memory_map`, the file is mapped with `mmap`, so that pages are
+ * only read when first accessed and are shared between all processes loading
+ * the same file. Otherwise, the file is read into memory in one go. Decoding
+ * graph files can also be loaded as sparse graphs.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices, which must
+ * match that of the saved graph.
+ * @param path The path of the file.
+ * @param memory_map Map the file instead of reading it.
+ * @return The graph.
+ * @throws std::runtime_error if the file is not a valid graph file.
+ */
+template <typename IndexT = size_t>
+SparseGraph<IndexT> LoadSparseGraph(const std::string &path,
+                                    bool memory_map = true) {
+    auto [file, header] = OpenGraphFile_<IndexT>(path, memory_map);
+    return SparseGraph<IndexT>::FromArrays(
+        header.num_vertices, GetSparseGraphArrays_<IndexT>(file, header));
+}
+
+/**
+ * @brief Load a decoding graph from a file.
+ *
+ * See `LoadSparseGraph`.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices, which must
+ * match that of the saved graph.
+ * @param path The path of the file.
+ * @param memory_map Map the file instead of reading it.
+ * @return The decoding graph.
+ * @throws std::runtime_error if the file is not a valid decoding graph file.
+ */
+template <typename IndexT = size_t>
+DecodingGraph<IndexT> LoadDecodingGraph(const std::string &path,
+                                        bool memory_map = true) {
+    auto [file, header] = OpenGraphFile_<IndexT>(path, memory_map);
+    if (header.kind != static_cast<uint32_t>(GraphKind::Decoding)) {
+        throw std::runtime_error(
+            "Serialization: graph file does not hold a decoding graph");
+    }
+
+    DecodingGraphArrays<IndexT> arrays;
+    arrays.vertex_boundary_type =
+        GetSection_<uint8_t>(file, header, SectionId::VertexBoundaryType);
+    arrays.local_edge_strides =
+        GetSection_<IndexT>(file, header, SectionId::LocalEdgeStrides);
+    arrays.local_to_global_edge_map =
+        GetSection_<IndexT>(file, header, SectionId::LocalToGlobalEdgeMap);
+    arrays.global_to_local_edge_map =
+        GetSection_<IndexT>(file, header, SectionId::GlobalToLocalEdgeMap);
+    return DecodingGraph<IndexT>::FromArrays(
+        header.num_vertices, GetSparseGraphArrays_<IndexT>(file, header),
+        std::move(arrays));
+}
+
+}; // namespace Serialization
+}; // namespace Plaquette
@@ -0,0 +1,521 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+
+/**
+ * @brief A monotone priority queue for integer keys.
+ *
+ * A radix heap stores every element in the bucket given by the highest bit in
+ * which its key differs from the last key popped. Popping from an empty
+ * bucket 0 redistributes the lowest non-empty bucket around its smallest key,
+ * which moves every element to a strictly lower bucket. Each element is
+ * therefore moved at most 64 times, independently of the number of elements,
+ * and no comparisons between elements are needed.
+ *
+ * Keys must never be smaller than the last key popped, which is the case for
+ * the tentative distances of Dijkstra's algorithm with non-negative weights.
+ * The buckets keep their capacity when cleared, so a heap that is reused
+ * does not allocate once it has grown to its working size.
+ *
+ * @tparam ValueT Type of the values stored with the keys.
+ */
+template <typename ValueT> class RadixHeap {
+  public:
+    using key_type = uint64_t;
+
+    // Insert a value with a key no smaller than the last key popped
+    void push(key_type key, ValueT value) {
+        assert(key >= last_);
+        buckets_[Bucket_(key)].emplace_back(key, value);
+        size_++;
+    }
+
+    // Remove and return an element with the smallest key
+    std::pair<key_type, ValueT> pop() {
+        assert(size_ > 0);
+        if (buckets_[0].empty()) {
+            size_t i = 1;
+            while (buckets_[i].empty()) {
+                i++;
+            }
+            auto &bucket = buckets_[i];
+            last_ = std::min_element(bucket.begin(), bucket.end())->first;
+            for (const auto &entry : bucket) {
+                buckets_[Bucket_(entry.first)].push_back(entry);
+            }
+            bucket.clear();
+        }
+        auto entry = buckets_[0].back();
+        buckets_[0].pop_back();
+        size_--;
+        return entry;
+    }
+
+    // Get the number of elements in the heap
+    size_t size() const { return size_; }
+
+    // Check whether the heap is empty
+    bool empty() const { return size_ == 0; }
+
+    // Remove all elements, keeping the allocated memory
+    void clear() {
+        for (auto &bucket : buckets_) {
+            bucket.clear();
+        }
+        last_ = 0;
+        size_ = 0;
+    }
+
+  private:
+    size_t Bucket_(key_type key) const {
+        return static_cast<size_t>(std::bit_width(key ^ last_));
+    }
+
+    std::array<std::vector<std::pair<key_type, ValueT>>, 65> buckets_;
+    key_type last_ = 0;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Scratch buffers of a shortest-path search.
+ *
+ * The per-vertex arrays are allocated by the first search and reused by the
+ * following ones. Only the entries touched by a search are reset before the
+ * next one, so the cost of a search does not depend on the size of the graph.
+ * A workspace must not be used by several threads at the same time.
+ *
+ * @tparam IndexT Unsigned integer type of the vertex and edge indices.
+ */
+template <typename IndexT = size_t> class ShortestPathWorkspace {
+  public:
+    ShortestPathWorkspace() = default;
+
+  private:
+    template <typename GraphT> friend class ShortestPaths;
+
+    static constexpr uint64_t kInfinity = std::numeric_limits<uint64_t>::max();
+
+    // Flags of the vertices
+    static constexpr uint8_t kTouched = 1;
+    static constexpr uint8_t kSettled = 2;
+    static constexpr uint8_t kTarget = 4;
+
+    // Grow the arrays to `num_vertices` and reset the last search
+    void Prepare_(size_t num_vertices) {
+        for (IndexT v : touched_) {
+            distance_[v] = kInfinity;
+            flags_[v] = 0;
+        }
+        touched_.clear();
+        heap_.clear();
+        if (distance_.size() < num_vertices) {
+            distance_.resize(num_vertices, kInfinity);
+            predecessor_edge_.resize(num_vertices);
+            flags_.resize(num_vertices, 0);
+        }
+    }
+
+    // Record that a vertex must be reset before the next search
+    void Touch_(IndexT v) {
+        if (!(flags_[v] & kTouched)) {
+            flags_[v] |= kTouched;
+            touched_.push_back(v);
+        }
+    }
+
+    std::vector<uint64_t> distance_;
+    std::vector<IndexT> predecessor_edge_;
+    std::vector<uint8_t> flags_;
+    std::vector<IndexT> touched_;
+    RadixHeap<IndexT> heap_;
+};
+
+/**
+ * @class ShortestPaths
+ * @brief Shortest paths between the vertices of a weighted graph.
+ *
+ * Paths are found with Dijkstra's algorithm on the integer edge weights of the
+ * graph (unweighted graphs have unit weights), using a `RadixHeap` as the
+ * priority queue. A search stops as soon as all its targets are settled, so
+ * that queries between nearby defects only explore their neighbourhood.
+ *
+ * Every query has an overload taking a `ShortestPathWorkspace`, and one using
+ * a workspace local to the calling thread, so that repeated queries do not
+ * allocate. Queries can be run concurrently from several threads.
+ *
+ * Optionally, the results of single-target queries (including the distance
+ * to the nearest boundary vertex) are kept in a bounded cache, from which the
+ * least recently used entries are evicted.
+ *
+ * @tparam GraphT The graph type, a `SparseGraph` or a `DecodingGraph`. The
+ * boundary queries require a `DecodingGraph`.
+ */
+template <typename GraphT> class ShortestPaths {
+  public:
+    using index_type = typename GraphT::index_type;
+    using distance_type = uint64_t;
+    using Workspace = ShortestPathWorkspace<index_type>;
+
+    /** @brief Distance between vertices that are not connected. */
+    static constexpr distance_type kInfinity =
+        std::numeric_limits<distance_type>::max();
+
+    /** @brief Vertex index standing for "no vertex". */
+    static constexpr index_type kNoVertex =
+        std::numeric_limits<index_type>::max();
+
+    /**
+     * @brief A shortest path.
+     */
+    struct Path {
+        distance_type distance = kInfinity; ///< Sum of the edge weights.
+        index_type target = kNoVertex;      ///< The last vertex of the path.
+        std::vector<index_type> edges;      ///< The edges, from the source.
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param graph The graph, which must outlive this object.
+     * @param cache_capacity The maximum number of cached paths, 0 to disable
+     * the cache.
+     */
+    explicit ShortestPaths(const GraphT &graph, size_t cache_capacity = 0)
+        : graph_(graph), cache_capacity_(cache_capacity) {}
+
+    ShortestPaths(const ShortestPaths &) = delete;
+    ShortestPaths &operator=(const ShortestPaths &) = delete;
+
+    /**
+     * @brief Get the length of a shortest path between two vertices.
+     *
+     * @param source The index of the first vertex.
+     * @param target The index of the second vertex.
+     * @param workspace The scratch buffers of the search.
+     * @return The distance, or `kInfinity` if the vertices are not connected.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    distance_type GetDistance(size_t source, size_t target,
+                              Workspace &workspace) const {
+        if (cache_capacity_ == 0) {
+            const index_type targets[] = {static_cast<index_type>(target)};
+            CheckVertex_(target);
+            Search_(workspace, source, targets, false);
+            return workspace.distance_[target];
+        }
+        return GetPath(source, target, workspace).distance;
+    }
+
+    distance_type GetDistance(size_t source, size_t target) const {
+        return GetDistance(source, target, LocalWorkspace_());
+    }
+
+    /**
+     * @brief Get the lengths of shortest paths from a vertex to several
+     * vertices with a single search.
+     *
+     * @param source The index of the source vertex.
+     * @param targets The indices of the target vertices.
+     * @param out Output array of the same size as `targets`.
+     * @param workspace The scratch buffers of the search.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    void GetDistances(size_t source, std::span<const index_type> targets,
+                      std::span<distance_type> out,
+                      Workspace &workspace) const {
+        if (out.size() != targets.size()) {
+            throw std::invalid_argument(
+                "ShortestPaths: output size must match the number of targets");
+        }
+        for (index_type target : targets) {
+            CheckVertex_(target);
+        }
+        Search_(workspace, source, targets, false);
+        for (size_t i = 0; i < targets.size(); i++) {
+            out[i] = workspace.distance_[targets[i]];
+        }
+    }
+
+    void GetDistances(size_t source, std::span<const index_type> targets,
+                      std::span<distance_type> out) const {
+        GetDistances(source, targets, out, LocalWorkspace_());
+    }
+
+    /**
+     * @brief Get a shortest path between two vertices.
+     *
+     * @param source The index of the first vertex.
+     * @param target The index of the second vertex.
+     * @param workspace The scratch buffers of the search.
+     * @return The path, which has no edges and an infinite distance if the
+     * vertices are not connected.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    Path GetPath(size_t source, size_t target, Workspace &workspace) const {
+        CheckVertex_(source);
+        CheckVertex_(target);
+        const CacheKey_ key = {
+            static_cast<index_type>(std::min(source, target)),
+            static_cast<index_type>(std::max(source, target))};
+        Path path;
+        if (!FindInCache_(key, path)) {
+            const index_type targets[] = {key.second};
+            Search_(workspace, key.first, targets, false);
+            path = MakePath_(workspace, key.first, key.second);
+            InsertInCache_(key, path);
+        }
+        if (source != key.first) {
+            std::reverse(path.edges.begin(), path.edges.end());
+        }
+        path.target = static_cast<index_type>(target);
+        return path;
+    }
+
+    Path GetPath(size_t source, size_t target) const {
+        return GetPath(source, target, LocalWorkspace_());
+    }
+
+    /**
+     * @brief Get a shortest path from a vertex to the nearest boundary vertex.
+     *
+     * @param source The index of the vertex.
+     * @param workspace The scratch buffers of the search.
+     * @return The path, whose target is the boundary vertex. If no boundary
+     * vertex is connected to `source`, the path has no edges, no target and
+     * an infinite distance.
+     * @throws std::out_of_range if the vertex is not part of the graph.
+     */
+    Path GetPathToBoundary(size_t source, Workspace &workspace) const {
+        CheckVertex_(source);
+        const CacheKey_ key = {static_cast<index_type>(source), kNoVertex};
+        Path path;
+        if (!FindInCache_(key, path)) {
+            const index_type boundary = Search_(workspace, source, {}, true);
+            if (boundary != kNoVertex) {
+                path = MakePath_(workspace, source, boundary);
+            }
+            InsertInCache_(key, path);
+        }
+        return path;
+    }
+
+    Path GetPathToBoundary(size_t source) const {
+        return GetPathToBoundary(source, LocalWorkspace_());
+    }
+
+    /**
+     * @brief Get the distance from a vertex to the nearest boundary vertex.
+     *
+     * @param source The index of the vertex.
+     * @param workspace The scratch buffers of the search.
+     * @return The distance and the index of the boundary vertex, or
+     * `{kInfinity, kNoVertex}` if no boundary vertex is connected to `source`.
+     * @throws std::out_of_range if the vertex is not part of the graph.
+     */
+    std::pair<distance_type, index_type>
+    GetDistanceToBoundary(size_t source, Workspace &workspace) const {
+        if (cache_capacity_ == 0) {
+            CheckVertex_(source);
+            const index_type boundary = Search_(workspace, source, {}, true);
+            if (boundary == kNoVertex) {
+                return {kInfinity, kNoVertex};
+            }
+            return {workspace.distance_[boundary], boundary};
+        }
+        auto path = GetPathToBoundary(source, workspace);
+        return {path.distance, path.target};
+    }
+
+    std::pair<distance_type, index_type>
+    GetDistanceToBoundary(size_t source) const {
+        return GetDistanceToBoundary(source, LocalWorkspace_());
+    }
+
+    /**
+     * @brief Get the number of cached paths.
+     */
+    size_t GetCacheSize() const {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        return cache_.size();
+    }
+
+    /**
+     * @brief Get the maximum number of cached paths.
+     */
+    size_t GetCacheCapacity() const { return cache_capacity_; }
+
+    /**
+     * @brief Remove all cached paths.
+     */
+    void ClearCache() {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        cache_.clear();
+        cache_index_.clear();
+    }
+
+  private:
+    // Pair of path endpoints, with the second set to kNoVertex for paths to
+    // the boundary
+    using CacheKey_ = std::pair<index_type, index_type>;
+
+    struct CacheKeyHash_ {
+        size_t operator()(const CacheKey_ &key) const {
+            return std::hash<index_type>()(key.first) * 0x9E3779B97F4A7C15ull ^
+                   std::hash<index_type>()(key.second);
+        }
+    };
+
+    using CacheList_ = std::list<std::pair<CacheKey_, Path>>;
+
+    void CheckVertex_(size_t vertex) const {
+        if (vertex >= graph_.GetNumVertices()) {
+            throw std::out_of_range("ShortestPaths: vertex index out of range");
+        }
+    }
+
+    static Workspace &LocalWorkspace_() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
+
+    /**
+     * @brief Run Dijkstra's algorithm from a source vertex.
+     *
+     * The search stops once every target is settled or, if `to_boundary` is
+     * set, once the first boundary vertex is settled. Afterwards the
+     * workspace holds the distances and predecessor edges of the settled
+     * vertices.
+     *
+     * @return The boundary vertex or the last target settled, or `kNoVertex`
+     * if the search exhausted the component of the source.
+     */
+    index_type Search_(Workspace &workspace, size_t source,
+                       std::span<const index_type> targets,
+                       bool to_boundary) const {
+        CheckVertex_(source);
+        workspace.Prepare_(graph_.GetNumVertices());
+        auto &distance = workspace.distance_;
+        auto &flags = workspace.flags_;
+        auto &heap = workspace.heap_;
+
+        size_t remaining = 0;
+        for (index_type target : targets) {
+            if (!(flags[target] & Workspace::kTarget)) {
+                workspace.Touch_(target);
+                flags[target] |= Workspace::kTarget;
+                remaining++;
+            }
+        }
+        if (!to_boundary && remaining == 0) {
+            return kNoVertex;
+        }
+
+        workspace.Touch_(static_cast<index_type>(source));
+        distance[source] = 0;
+        heap.push(0, static_cast<index_type>(source));
+
+        while (!heap.empty()) {
+            const auto [d, u] = heap.pop();
+            if (flags[u] & Workspace::kSettled) {
+                continue;
+            }
+            flags[u] |= Workspace::kSettled;
+            if ((flags[u] & Workspace::kTarget) && --remaining == 0) {
+                return u;
+            }
+            if (to_boundary && graph_.IsVertexOnBoundary(u)) {
+                return u;
+            }
+
+            const auto &neighbours = graph_.GetVerticesTouchingVertex(u);
+            const auto &edges = graph_.GetEdgesTouchingVertex(u);
+            for (size_t k = 0; k < neighbours.size(); k++) {
+                const index_type v = neighbours[k];
+                const distance_type dv = d + graph_.GetEdgeWeight(edges[k]);
+                if (dv < distance[v]) {
+                    workspace.Touch_(v);
+                    distance[v] = dv;
+                    workspace.predecessor_edge_[v] = edges[k];
+                    heap.push(dv, v);
+                }
+            }
+        }
+        return kNoVertex;
+    }
+
+    // Follow the predecessor edges of the last search back to the source
+    Path MakePath_(const Workspace &workspace, size_t source,
+                   size_t target) const {
+        Path path;
+        path.distance = workspace.distance_[target];
+        path.target = static_cast<index_type>(target);
+        if (path.distance == kInfinity) {
+            return path;
+        }
+        for (size_t v = target; v != source;) {
+            const index_type e = workspace.predecessor_edge_[v];
+            path.edges.push_back(e);
+            const auto &vertices = graph_.GetVerticesConnectedByEdge(e);
+            v = vertices.first == v ? vertices.second : vertices.first;
+        }
+        std::reverse(path.edges.begin(), path.edges.end());
+        return path;
+    }
+
+    bool FindInCache_(const CacheKey_ &key, Path &path) const {
+        if (cache_capacity_ == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = cache_index_.find(key);
+        if (it == cache_index_.end()) {
+            return false;
+        }
+        cache_.splice(cache_.begin(), cache_, it->second);
+        path = it->second->second;
+        return true;
+    }
+
+    void InsertInCache_(const CacheKey_ &key, const Path &path) const {
+        if (cache_capacity_ == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (cache_index_.count(key)) {
+            return;
+        }
+        cache_.emplace_front(key, path);
+        cache_index_[key] = cache_.begin();
+        if (cache_.size() > cache_capacity_) {
+            cache_index_.erase(cache_.back().first);
+            cache_.pop_back();
+        }
+    }
+
+    const GraphT &graph_;
+    size_t cache_capacity_;
+    mutable std::mutex cache_mutex_;
+    mutable CacheList_ cache_;
+    mutable std::unordered_map<CacheKey_, typename CacheList_::iterator,
+                               CacheKeyHash_>
+        cache_index_;
+};
+
+}; // namespace Plaquette
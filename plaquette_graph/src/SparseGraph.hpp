@@ -1,10 +1,26 @@
 #pragma once
 
-#include <cassert>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
-#include <unordered_set>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "ArrayBuffer.hpp"
+#include "EdgeHashIndex.hpp"
+#include "Instrumentation.hpp"
+#include "ScratchArena.hpp"
 #include "Utils.hpp"
 
 namespace Plaquette {
@@ -15,34 +31,334 @@ namespace Plaquette {
  * The `SparseGraphRow` class provides a lightweight view into a range of
  * elements in a vector. The class is used to represent a row of non-zero
  * elements in a matrix stored as a compressed sparse row (CSR) format. A
- * `SparseGraphRow` object consists of a reference to the vector of non-zero
- * elements, along with start and end indices that delimit the range of elements
- * in the row.
+ * `SparseGraphRow` object consists of a non-owning span over the non-zero
+ * elements of the row, so it is cheap to copy and never allocates.
  *
  * The `SparseGraphRow` class provides two public member functions: `size()` and
  * `operator[]()`. The `size()` function returns the number of non-zero
  * elements in the row, and the `operator[]()` function returns the value
  * at a specific index in the row.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
  */
-class SparseGraphRow {
+template <typename IndexT = size_t> class SparseGraphRow {
   public:
-    // Constructor
-    SparseGraphRow(const std::vector<size_t> &row, size_t start, size_t end)
-        : row_(row), start_(start), end_(end) {}
+    using index_type = IndexT;
+
+    // Construct a row from the range [start, end) of a CSR array
+    SparseGraphRow(std::span<const IndexT> data, size_t start, size_t end)
+        : row_(data.subspan(start, end - start)) {}
+
+    // Construct a row from a span of its elements
+    explicit SparseGraphRow(std::span<const IndexT> row) : row_(row) {}
 
     // Get the number of non-zero elements in the row
-    size_t size() const { return end_ - start_; }
+    size_t size() const { return row_.size(); }
 
     // Get the value at a specific index in the row
-    size_t operator[](int index) const { return row_[start_ + index]; }
+    IndexT operator[](size_t index) const { return row_[index]; }
+
+    // Iterators over the elements of the row
+    const IndexT *begin() const { return row_.data(); }
+    const IndexT *end() const { return row_.data() + row_.size(); }
+
+  private:
+    // Non-owning view of the column indices or IDs of the row
+    std::span<const IndexT> row_;
+};
+
+/**
+ * @brief A row of the edge-edge adjacency matrix computed on the fly.
+ *
+ * The `ImplicitEdgeRow` class lists the edges sharing an endpoint with a given
+ * edge by walking the vertex-vertex rows of its two endpoints, skipping the
+ * edge itself and the second copy of any self-loop. It does not require the
+ * edge-edge adjacency matrix to be constructed. The rows are walked once when
+ * the view is created, to count the neighbours and record the skipped
+ * entries, so that `size()` is constant time and `operator[]()` is constant
+ * time unless more than `kMaxSkipped` entries are skipped, in which case it is
+ * linear in the degree of the endpoints. The neighbours are listed in the
+ * order of the endpoint rows, which may differ from the order of the
+ * corresponding `SparseGraphRow`.
+ *
+ * The two half-edges of a self-loop must be adjacent in the row of its
+ * vertex, as in every graph built by `SparseGraph` and checked by
+ * `SparseGraph::FromArrays`.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> class ImplicitEdgeRow {
+  public:
+    using index_type = IndexT;
+
+    /**
+     * @brief The number of skipped entries recorded for constant time
+     * indexing: the edge itself in both rows and a self-loop at each
+     * endpoint, which is the most a graph without parallel edges can have.
+     */
+    static constexpr size_t kMaxSkipped = 4;
+
+    /**
+     * @brief Forward iterator over the neighbouring edges.
+     */
+    class Iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IndexT;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const IndexT *;
+        using reference = IndexT;
+
+        Iterator() = default;
+        Iterator(const ImplicitEdgeRow *row, size_t pos)
+            : row_(row), pos_(pos) {
+            SkipFiltered_();
+        }
+
+        IndexT operator*() const { return row_->RawAt_(pos_); }
+
+        Iterator &operator++() {
+            pos_++;
+            SkipFiltered_();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return pos_ == other.pos_;
+        }
+
+      private:
+        void SkipFiltered_() {
+            while (pos_ < row_->RawSize_() && row_->IsFiltered_(pos_)) {
+                pos_++;
+            }
+        }
+
+        const ImplicitEdgeRow *row_ = nullptr;
+        size_t pos_ = 0;
+    };
+
+    // Constructor
+    ImplicitEdgeRow(size_t edge_index, const SparseGraphRow<IndexT> &first,
+                    const SparseGraphRow<IndexT> &second, bool self_loop)
+        : edge_index_(edge_index), first_(first.begin()),
+          first_size_(first.size()), second_(second.begin()),
+          second_size_(self_loop ? 0 : second.size()) {
+        size_t num_skipped = 0;
+        for (size_t pos = 0; pos < RawSize_(); pos++) {
+            if (IsFiltered_(pos)) {
+                if (num_skipped < kMaxSkipped) {
+                    skipped_[num_skipped] = pos;
+                }
+                num_skipped++;
+            }
+        }
+        size_ = RawSize_() - num_skipped;
+        num_skipped_ = num_skipped;
+    }
+
+    // Iterators over the neighbouring edges
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, RawSize_()); }
+
+    // Get the number of neighbouring edges
+    size_t size() const { return size_; }
+
+    // Get the neighbouring edge at a specific index in the row
+    IndexT operator[](size_t index) const {
+        if (num_skipped_ > kMaxSkipped) {
+            return *std::next(begin(), index);
+        }
+        // Every skipped entry at or before the position shifts it by one
+        size_t pos = index;
+        for (size_t k = 0; k < num_skipped_ && skipped_[k] <= pos; k++) {
+            pos++;
+        }
+        return RawAt_(pos);
+    }
+
+  private:
+    size_t RawSize_() const { return first_size_ + second_size_; }
+
+    IndexT RawAt_(size_t pos) const {
+        return pos < first_size_ ? first_[pos] : second_[pos - first_size_];
+    }
+
+    bool IsFiltered_(size_t pos) const {
+        IndexT value = RawAt_(pos);
+        if (value == edge_index_) {
+            return true;
+        }
+        // The two half-edges of a self-loop are adjacent in a vertex row
+        return pos != 0 && pos != first_size_ && RawAt_(pos - 1) == value;
+    }
+
+    size_t edge_index_;
+    const IndexT *first_;
+    size_t first_size_;
+    const IndexT *second_;
+    size_t second_size_;
+    size_t size_ = 0;
+    size_t num_skipped_ = 0;
+    std::array<size_t, kMaxSkipped> skipped_{};
+};
+
+/**
+ * @brief A non-owning view of an edge list stored as a flat array.
+ *
+ * The `FlatEdgeList` class views a row-major `(E, 2)` array of vertex indices,
+ * such as a NumPy array, as a list of edges, so that a graph can be
+ * constructed from it without first copying it into a vector of pairs. Signed
+ * element types are accepted: negative indices wrap around to out of range
+ * values and are rejected by the graph constructor.
+ *
+ * @tparam T Integer type of the array elements.
+ */
+template <typename T> class FlatEdgeList {
+  public:
+    // Constructor
+    FlatEdgeList(const T *data, size_t num_edges)
+        : data_(data), num_edges_(num_edges) {}
+
+    // Get the number of edges in the list
+    size_t size() const { return num_edges_; }
+
+    // Get the edge at a specific index in the list
+    std::pair<size_t, size_t> operator[](size_t index) const {
+        return {static_cast<size_t>(data_[2 * index]),
+                static_cast<size_t>(data_[2 * index + 1])};
+    }
 
   private:
-    // Reference to the column index and ID vectors
-    const std::vector<size_t> &row_;
+    const T *data_;
+    size_t num_edges_;
+};
 
-    // Start and end indices of the row
-    size_t start_;
-    size_t end_;
+/**
+ * @brief Integer weight of an edge.
+ *
+ * Decoders usually derive edge weights from log-likelihood ratios rounded to
+ * integers, for which 32 bits are plenty. Integer weights allow shortest
+ * paths to be computed with a radix heap (see `ShortestPaths`).
+ */
+using EdgeWeight = uint32_t;
+
+/**
+ * @brief The results of a batch of row queries, concatenated in CSR format.
+ *
+ * The row of query `i` is `values[offsets[i]]` to `values[offsets[i + 1] - 1]`.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> struct RaggedRows {
+    std::vector<size_t> offsets;
+    std::vector<IndexT> values;
+};
+
+/**
+ * @brief The arrays making up a SparseGraph.
+ *
+ * A graph can be assembled from previously constructed arrays, for example
+ * arrays loaded from a file, with `SparseGraph::FromArrays`. The arrays may
+ * view external memory (see `ArrayBuffer`), in which case they are used in
+ * place. The edge-edge arrays are optional and are left empty if the matrix
+ * is to be constructed on first use. The edge weights are left empty for an
+ * unweighted graph. `sorted_rows` records whether each vertex-vertex row is
+ * sorted by neighbouring vertex.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> struct SparseGraphArrays {
+    ArrayBuffer<IndexT> v_to_v_row_ptr;
+    ArrayBuffer<IndexT> v_to_v_col;
+    ArrayBuffer<IndexT> v_to_v_edges;
+    ArrayBuffer<std::pair<IndexT, IndexT>> e_to_v;
+    ArrayBuffer<IndexT> e_to_e_row_ptr;
+    ArrayBuffer<IndexT> e_to_e_col;
+    ArrayBuffer<EdgeWeight> edge_weights;
+    bool sorted_rows = false;
+};
+
+/**
+ * @brief When the edge-edge adjacency matrix of a SparseGraph is constructed.
+ */
+enum class EdgeToEdgeMode {
+    /** Construct the matrix together with the graph. */
+    Eager,
+    /** Construct the matrix on the first call to GetEdgesTouchingEdge. */
+    Lazy,
+};
+
+/**
+ * @brief Options controlling how a SparseGraph is constructed.
+ */
+struct SparseGraphOptions {
+    /**
+     * @brief Skip the duplicate edge removal pass.
+     *
+     * By default, repeated edges (in either orientation) are removed and only
+     * their first occurrence is kept. Callers that guarantee their edge list
+     * is already free of duplicates can set this flag to skip that pass.
+     */
+    bool assume_unique_edges = false;
+
+    /**
+     * @brief When to construct the edge-edge adjacency matrix.
+     *
+     * The edge-edge matrix is usually the largest part of a graph, and many
+     * algorithms never query it, so by default it is only constructed on the
+     * first call to `GetEdgesTouchingEdge`.
+     */
+    EdgeToEdgeMode edge_to_edge = EdgeToEdgeMode::Lazy;
+
+    /**
+     * @brief The number of threads used to build the vertex-vertex matrix.
+     *
+     * A value of 0 uses one thread per hardware thread. The result does not
+     * depend on the number of threads.
+     */
+    size_t num_threads = 1;
+
+    /**
+     * @brief Sort each row of the vertex-vertex matrix by neighbouring vertex.
+     *
+     * Edges between the same pair of vertices keep their relative order. The
+     * rows are then searched by binary search in `GetEdgeFromVertexPair`
+     * instead of being scanned, at the cost of one extra pass over the matrix
+     * during construction. The local edge IDs of a `DecodingGraph` follow the
+     * order of the rows.
+     */
+    bool sort_rows = false;
+
+    /**
+     * @brief Build an `EdgeHashIndex` from pairs of vertices to edges.
+     *
+     * The index answers `GetEdgeFromVertexPair` in constant time whatever the
+     * degree of the vertices, and takes two to four indices of memory per
+     * edge. It pays off for graphs with high-degree vertices, while sorted
+     * rows are as fast and smaller for low-degree graphs.
+     */
+    bool edge_index = false;
+
+    /**
+     * @brief The memory resource the arrays of the graph are allocated from.
+     *
+     * A null pointer keeps the resource of the graph, which is the default
+     * resource for a new graph. An arena, e.g. a
+     * `std::pmr::monotonic_buffer_resource`, avoids going through the heap
+     * when many graphs are built, and must outlive the graph. Copies of the
+     * graph allocate from the default resource but share its lazily built
+     * edge-edge matrix, so the resource must outlive them as well. The
+     * temporary arrays of construction always come from the `ScratchArena` of
+     * the calling thread.
+     */
+    std::pmr::memory_resource *memory_resource = nullptr;
 };
 
 /**
@@ -57,53 +373,589 @@ class SparseGraphRow {
  * The adjacency matrices are stored in CSR format, because usually the graphs
  * (e.g. decoding graphs) are sparse.
  *
+ * All CSR arrays and the edge to vertices lookup list store indices as
+ * `IndexT`. The default `size_t` places no limit on the graph size, while
+ * `uint32_t` halves the memory (and cache) footprint of the adjacency
+ * matrices for graphs with fewer than 2^32 vertices and half-edges.
+ *
+ * Thread safety: the const member functions may be called concurrently from
+ * any number of threads, including the first queries of a lazily constructed
+ * edge-edge matrix, which is built once under a lock while the other threads
+ * wait for it. The non-const member functions (`BuildEdgeIndex`, `Rebuild`
+ * and assignment) must not overlap with any other call on the same graph.
+ * With query counters enabled, concurrent queries contend on the counters.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
  */
-class SparseGraph {
+template <typename IndexT = size_t> class SparseGraph {
+    static_assert(std::is_unsigned_v<IndexT>,
+                  "SparseGraph index type must be an unsigned integer");
+
+  public:
+    using index_type = IndexT;
+    using row_type = SparseGraphRow<IndexT>;
+    using edge_type = std::pair<IndexT, IndexT>;
+    using weight_type = EdgeWeight;
+
+    /**
+     * @brief Index returned by edge lookups that find no edge.
+     */
+    static constexpr IndexT kInvalidIndex = std::numeric_limits<IndexT>::max();
 
   private:
-    size_t num_vertices_;
+    /**
+     * @brief Lazily constructed adjacency matrix for edge-edge connections.
+     *
+     * The matrix is only a function of the (immutable) vertex-vertex matrix,
+     * so copies of a graph share it, and whichever copy first needs it
+     * constructs it exactly once. A rebuilt graph that does not share the
+     * matrix resets it and reuses its storage.
+     */
+    struct EdgeToEdgeMatrix {
+        std::mutex mutex;
+        std::atomic<bool> constructed = false;
+        ArrayBuffer<IndexT> row_ptr;
+        ArrayBuffer<IndexT> col;
+        double seconds = 0;
+    };
+
+    /**
+     * @brief The row pointers of a matrix with no rows, viewed by the arrays
+     * of every empty graph, so that emptying a graph cannot throw.
+     */
+    static constexpr IndexT kEmptyRowPtr_[1] = {0};
+
+    static ArrayBuffer<IndexT> EmptyRowPtr_() noexcept {
+        return ArrayBuffer<IndexT>(kEmptyRowPtr_, 1, nullptr);
+    }
+
+    size_t num_vertices_ = 0;
 
     /** @brief adjacency matrix for vertex-vertex connections. */
-    std::vector<size_t> v_to_v_row_ptr_;
-    std::vector<size_t> v_to_v_edges_;
-    std::vector<size_t> v_to_v_col_;
+    ArrayBuffer<IndexT> v_to_v_row_ptr_ = EmptyRowPtr_();
+    ArrayBuffer<IndexT> v_to_v_edges_;
+    ArrayBuffer<IndexT> v_to_v_col_;
 
-    /** @brief adjacency matrix for edge-edge connections. */
-    std::vector<size_t> e_to_e_row_ptr_;
-    std::vector<size_t> e_to_e_vertices_;
-    std::vector<size_t> e_to_e_col_;
+    /**
+     * @brief adjacency matrix for edge-edge connections, or null in a
+     * moved-from graph, which has no matrix to construct and whose edge-edge
+     * row pointers are `kEmptyRowPtr_`, as for a default-constructed graph.
+     */
+    std::shared_ptr<EdgeToEdgeMatrix> e_to_e_ =
+        std::make_shared<EdgeToEdgeMatrix>();
 
     /** @brief edge to vertices lookup list */
-    std::vector<std::pair<size_t, size_t>> e_to_v_;
+    ArrayBuffer<edge_type> e_to_v_;
+
+    /** @brief weight of every edge, or empty if the graph is unweighted */
+    ArrayBuffer<weight_type> edge_weights_;
+
+    /** @brief whether each vertex-vertex row is sorted by column */
+    bool sorted_rows_ = false;
+
+    /** @brief optional index from pairs of vertices to edges */
+    std::shared_ptr<const EdgeHashIndex<IndexT>> edge_index_;
+
+    /** @brief time spent in each construction phase */
+    ConstructionTimings timings_;
+
+    /** @brief counters of the queries, empty unless counting is enabled */
+    [[no_unique_address]] QueryCounters<> counters_;
+
+    /**
+     * @brief Throw if `count` cannot be represented by `IndexT`.
+     *
+     * @param count The largest index (or CSR offset) that will be stored.
+     * @param what A description of the quantity, used in the error message.
+     */
+    static void CheckIndexRange_(size_t count, const char *what) {
+        if (count > static_cast<size_t>(std::numeric_limits<IndexT>::max())) {
+            throw std::overflow_error(std::string("SparseGraph: ") + what +
+                                      " exceeds the range of the index type");
+        }
+    }
+
+    /**
+     * @brief Throw if `index` is not smaller than `size`.
+     *
+     * @param index The vertex or edge index passed to a batch query.
+     * @param size The number of vertices or edges.
+     * @param what A description of the index, used in the error message.
+     */
+    static void CheckBatchIndex_(size_t index, size_t size, const char *what) {
+        if (index >= size) {
+            throw std::out_of_range(std::string("SparseGraph: ") + what +
+                                    " out of range");
+        }
+    }
+
+    /**
+     * @brief Construct the graph from a list of edges.
+     *
+     * @param num_vertices The number of vertices in the graph.
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param weights The weight of every edge, or empty for an unweighted
+     * graph.
+     * @param options Options controlling the construction of the graph.
+     */
+    template <typename EdgeList>
+    void Construct_(size_t num_vertices, const EdgeList &edges,
+                    std::span<const weight_type> weights,
+                    const SparseGraphOptions &options) {
+        CheckIndexRange_(num_vertices, "number of vertices");
+        CheckIndexRange_(2 * edges.size(), "number of half-edges");
+        std::pmr::memory_resource *resource = options.memory_resource != nullptr
+                                                  ? options.memory_resource
+                                                  : GetMemoryResource();
+        num_vertices_ = num_vertices;
+        timings_ = {};
+        counters_.Reset();
+        edge_index_.reset();
+        ResetEdgeToEdgeMatrix_();
+        {
+            PhaseTimer timer(timings_.deduplicate_edges);
+            ConstructEdgeToVertex_(edges, options.assume_unique_edges, weights,
+                                   resource);
+        }
+        {
+            PhaseTimer timer(timings_.vertex_to_vertex);
+            ConstructVertexToVertexMatrix_(e_to_v_, options.num_threads,
+                                           options.sort_rows, resource);
+        }
+        if (options.edge_index) {
+            BuildEdgeIndex();
+        }
+        if (options.edge_to_edge == EdgeToEdgeMode::Eager) {
+            ConstructEdgeToEdgeMatrix_();
+        }
+    }
+
+    /**
+     * @brief Rebuild the graph, leaving it empty if construction throws.
+     */
+    template <typename EdgeList>
+    void Rebuild_(size_t num_vertices, const EdgeList &edges,
+                  std::span<const weight_type> weights,
+                  const SparseGraphOptions &options) {
+        try {
+            Construct_(num_vertices, edges, weights, options);
+        } catch (...) {
+            // Moving out cannot throw, unlike allocating a new empty graph,
+            // and leaves this graph empty
+            SparseGraph discarded(std::move(*this));
+            throw;
+        }
+    }
+
+    /**
+     * @brief Discard the edge-edge matrix before the graph is rebuilt.
+     *
+     * The storage of the matrix is kept for reuse, unless the matrix is
+     * shared with a copy of the graph, which must keep it.
+     */
+    void ResetEdgeToEdgeMatrix_() {
+        // A null matrix, left by a move, has a use count of zero
+        if (e_to_e_.use_count() == 1) {
+            e_to_e_->constructed.store(false, std::memory_order_relaxed);
+            e_to_e_->seconds = 0;
+        } else {
+            e_to_e_ = std::make_shared<EdgeToEdgeMatrix>();
+        }
+    }
+
+    /**
+     * @brief Move the contents of `other` into this graph, leaving `other`
+     * an empty graph.
+     */
+    void MoveFrom_(SparseGraph &other) noexcept {
+        num_vertices_ = std::exchange(other.num_vertices_, 0);
+        v_to_v_row_ptr_ = std::exchange(other.v_to_v_row_ptr_, EmptyRowPtr_());
+        v_to_v_edges_ = std::move(other.v_to_v_edges_);
+        v_to_v_col_ = std::move(other.v_to_v_col_);
+        e_to_e_ = std::move(other.e_to_e_);
+        e_to_v_ = std::move(other.e_to_v_);
+        edge_weights_ = std::move(other.edge_weights_);
+        sorted_rows_ = std::exchange(other.sorted_rows_, false);
+        edge_index_ = std::move(other.edge_index_);
+        timings_ = std::exchange(other.timings_, {});
+        // Query counts belong to each object and are not moved, as they are
+        // not copied, so both graphs start counting from zero
+        counters_.Reset();
+        other.counters_.Reset();
+    }
 
   public:
     SparseGraph() = default;
+    SparseGraph(const SparseGraph &) = default;
+    SparseGraph &operator=(const SparseGraph &) = default;
+
+    /**
+     * @brief Move constructor, leaving `other` an empty graph.
+     */
+    SparseGraph(SparseGraph &&other) noexcept : e_to_e_(nullptr) {
+        MoveFrom_(other);
+    }
+
+    /**
+     * @brief Move assignment, leaving `other` an empty graph.
+     */
+    SparseGraph &operator=(SparseGraph &&other) noexcept {
+        if (this != &other) {
+            MoveFrom_(other);
+        }
+        return *this;
+    }
+
     SparseGraph(size_t num_vertices,
-                const std::vector<std::pair<size_t, size_t>> &edges) {
-        num_vertices_ = num_vertices;
-        ConstructEdgeToVertex_(edges);
-        ConstructVertexToVertexMatrix_(e_to_v_);
-        ConstructEdgeToEdgeMatrix_();
+                const std::vector<std::pair<size_t, size_t>> &edges,
+                const SparseGraphOptions &options = {}) {
+        Construct_(num_vertices, edges, {}, options);
+    }
+
+    /**
+     * @brief Construct a graph from a flat `(E, 2)` array of edges.
+     *
+     * The array is read in place, which avoids materializing a vector of
+     * pairs when the edges come from e.g. a NumPy array.
+     *
+     * @param num_vertices The number of vertices in the graph.
+     * @param edges A view of the edges of the graph.
+     * @param options Options controlling the construction of the graph.
+     */
+    template <typename T>
+    SparseGraph(size_t num_vertices, const FlatEdgeList<T> &edges,
+                const SparseGraphOptions &options = {}) {
+        Construct_(num_vertices, edges, {}, options);
+    }
+
+    /**
+     * @brief Construct a graph with weighted edges.
+     *
+     * When duplicate edges are removed, the weight of the first occurrence of
+     * each edge is kept.
+     *
+     * @param num_vertices The number of vertices in the graph.
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param weights The weight of every edge, aligned with `edges`.
+     * @param options Options controlling the construction of the graph.
+     * @throws std::invalid_argument if the number of weights does not match
+     * the number of edges.
+     */
+    SparseGraph(size_t num_vertices,
+                const std::vector<std::pair<size_t, size_t>> &edges,
+                std::span<const weight_type> weights,
+                const SparseGraphOptions &options = {}) {
+        Construct_(num_vertices, edges, weights, options);
+    }
+
+    template <typename T>
+    SparseGraph(size_t num_vertices, const FlatEdgeList<T> &edges,
+                std::span<const weight_type> weights,
+                const SparseGraphOptions &options = {}) {
+        Construct_(num_vertices, edges, weights, options);
+    }
+
+    /**
+     * @brief Rebuild the graph from a new list of edges, reusing its memory.
+     *
+     * The result is the graph the corresponding constructor would build, but
+     * the arrays of the graph are refilled in place: they are only
+     * reallocated when they are too small, and the temporary arrays of
+     * construction come from the `ScratchArena` of the calling thread. Once
+     * the largest graph of a Monte Carlo sweep has been built, rebuilding
+     * therefore does not allocate, except for the edge index and for
+     * construction with several threads. The edge-edge matrix is reused
+     * unless it is shared with a copy of the graph.
+     *
+     * The arrays keep their memory resource unless `options` sets one. Rows
+     * and views of the previous graph are invalidated. If rebuilding throws,
+     * the graph is left empty.
+     *
+     * @param num_vertices The number of vertices in the graph.
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param options Options controlling the construction of the graph.
+     */
+    void Rebuild(size_t num_vertices,
+                 const std::vector<std::pair<size_t, size_t>> &edges,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, {}, options);
+    }
+
+    template <typename T>
+    void Rebuild(size_t num_vertices, const FlatEdgeList<T> &edges,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, {}, options);
+    }
+
+    /**
+     * @brief Rebuild the graph with weighted edges, reusing its memory.
+     *
+     * @param num_vertices The number of vertices in the graph.
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param weights The weight of every edge, aligned with `edges`.
+     * @param options Options controlling the construction of the graph.
+     * @throws std::invalid_argument if the number of weights does not match
+     * the number of edges.
+     */
+    void Rebuild(size_t num_vertices,
+                 const std::vector<std::pair<size_t, size_t>> &edges,
+                 std::span<const weight_type> weights,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, weights, options);
+    }
+
+    template <typename T>
+    void Rebuild(size_t num_vertices, const FlatEdgeList<T> &edges,
+                 std::span<const weight_type> weights,
+                 const SparseGraphOptions &options = {}) {
+        Rebuild_(num_vertices, edges, weights, options);
+    }
+
+    /**
+     * @brief Assemble a graph from its arrays.
+     *
+     * No construction work is done: the arrays are adopted as they are,
+     * after O(V + E) passes checking that their sizes agree, that the row
+     * pointers never decrease, that every index is in range and that the
+     * vertex-vertex rows match the edges (see `CheckRowsMatchEdges_`), so
+     * that a corrupted file cannot lead to out-of-bounds reads or to queries
+     * that disagree with each other. The edge-edge arrays, if any, are only
+     * checked for shape. The arrays are typically those of a graph built by
+     * this class, e.g. saved to a file by `Serialization::SaveGraph`.
+     *
+     * @param num_vertices The number of vertices in the graph.
+     * @param arrays The arrays of the graph.
+     * @return The graph.
+     * @throws std::invalid_argument if the arrays are inconsistent.
+     */
+    static SparseGraph FromArrays(size_t num_vertices,
+                                  SparseGraphArrays<IndexT> arrays) {
+        const size_t num_edges = arrays.e_to_v.size();
+        CheckIndexRange_(num_vertices, "number of vertices");
+        CheckIndexRange_(2 * num_edges, "number of half-edges");
+
+        auto all_below = [](const ArrayBuffer<IndexT> &values, size_t bound) {
+            return std::ranges::all_of(
+                values, [bound](IndexT value) { return value < bound; });
+        };
+        auto is_csr = [&](const ArrayBuffer<IndexT> &row_ptr,
+                          const ArrayBuffer<IndexT> &col, size_t num_rows,
+                          size_t num_cols) {
+            return row_ptr.size() == num_rows + 1 && row_ptr[0] == 0 &&
+                   row_ptr.back() == col.size() &&
+                   std::ranges::is_sorted(row_ptr) && all_below(col, num_cols);
+        };
+        if (!is_csr(arrays.v_to_v_row_ptr, arrays.v_to_v_col, num_vertices,
+                    num_vertices) ||
+            arrays.v_to_v_col.size() != 2 * num_edges ||
+            arrays.v_to_v_edges.size() != 2 * num_edges ||
+            !all_below(arrays.v_to_v_edges, num_edges)) {
+            throw std::invalid_argument(
+                "SparseGraph: inconsistent vertex-vertex arrays");
+        }
+        if (!arrays.edge_weights.empty() &&
+            arrays.edge_weights.size() != num_edges) {
+            throw std::invalid_argument(
+                "SparseGraph: inconsistent edge weights");
+        }
+        if (!std::ranges::all_of(arrays.e_to_v, [&](const auto &edge) {
+                return edge.first < num_vertices && edge.second < num_vertices;
+            })) {
+            throw std::invalid_argument(
+                "SparseGraph: edge endpoint out of range");
+        }
+        const bool has_e_to_e =
+            !arrays.e_to_e_row_ptr.empty() || !arrays.e_to_e_col.empty();
+        if (has_e_to_e &&
+            !is_csr(arrays.e_to_e_row_ptr, arrays.e_to_e_col, num_edges,
+                    num_edges)) {
+            throw std::invalid_argument(
+                "SparseGraph: inconsistent edge-edge arrays");
+        }
+        CheckRowsMatchEdges_(arrays);
+
+        SparseGraph graph;
+        graph.num_vertices_ = num_vertices;
+        graph.v_to_v_row_ptr_ = std::move(arrays.v_to_v_row_ptr);
+        graph.v_to_v_col_ = std::move(arrays.v_to_v_col);
+        graph.v_to_v_edges_ = std::move(arrays.v_to_v_edges);
+        graph.e_to_v_ = std::move(arrays.e_to_v);
+        graph.edge_weights_ = std::move(arrays.edge_weights);
+        graph.sorted_rows_ = arrays.sorted_rows;
+        if (has_e_to_e) {
+            auto &e_to_e = *graph.e_to_e_;
+            e_to_e.row_ptr = std::move(arrays.e_to_e_row_ptr);
+            e_to_e.col = std::move(arrays.e_to_e_col);
+            e_to_e.constructed.store(true, std::memory_order_release);
+        }
+        return graph;
+    }
+
+    /**
+     * @brief Check that the vertex-vertex rows of adopted arrays match the
+     * edges.
+     *
+     * Every edge must appear exactly once in the row of each endpoint, with
+     * the other endpoint as column, and the two entries of a self-loop must be
+     * adjacent in its row, as `ImplicitEdgeRow` relies on. If `sorted_rows`
+     * is set, every row must be sorted by column. The indices must already be
+     * known to be in range.
+     *
+     * @param arrays The arrays of the graph.
+     * @throws std::invalid_argument if the rows do not match the edges.
+     */
+    static void CheckRowsMatchEdges_(const SparseGraphArrays<IndexT> &arrays) {
+        constexpr uint8_t kFirst = 1;
+        constexpr uint8_t kSecond = 2;
+        const auto &row_ptr = arrays.v_to_v_row_ptr;
+        const auto &col = arrays.v_to_v_col;
+        const auto &row_edges = arrays.v_to_v_edges;
+        std::vector<uint8_t> seen(arrays.e_to_v.size(), 0);
+        auto mark = [&seen](size_t edge, uint8_t flags) {
+            const bool fresh = (seen[edge] & flags) == 0;
+            seen[edge] |= flags;
+            return fresh;
+        };
+
+        bool consistent = true;
+        for (size_t v = 0; consistent && v + 1 < row_ptr.size(); v++) {
+            const size_t end = row_ptr[v + 1];
+            if (arrays.sorted_rows &&
+                !std::is_sorted(col.begin() + row_ptr[v], col.begin() + end)) {
+                throw std::invalid_argument(
+                    "SparseGraph: rows are not sorted");
+            }
+            for (size_t k = row_ptr[v]; consistent && k < end; k++) {
+                const size_t edge = row_edges[k];
+                const size_t u = col[k];
+                const auto endpoints = arrays.e_to_v[edge];
+                if (u == v) {
+                    consistent = endpoints.first == v &&
+                                 endpoints.second == v && k + 1 < end &&
+                                 row_edges[k + 1] == edge && col[k + 1] == v &&
+                                 mark(edge, kFirst | kSecond);
+                    k++;
+                } else if (endpoints.first == v && endpoints.second == u) {
+                    consistent = mark(edge, kFirst);
+                } else if (endpoints.first == u && endpoints.second == v) {
+                    consistent = mark(edge, kSecond);
+                } else {
+                    consistent = false;
+                }
+            }
+        }
+        if (!consistent ||
+            !std::ranges::all_of(seen, [](uint8_t flags) {
+                return flags == (kFirst | kSecond);
+            })) {
+            throw std::invalid_argument(
+                "SparseGraph: vertex-vertex arrays do not match the edges");
+        }
     }
 
     /**
      * @brief Construct the edge to vertex lookup list.
      *
-     * @param edges A vector of pairs of vertices that represent the edges in
-     * the graph.
+     * Duplicate edges, in either orientation, are removed while keeping the
+     * first occurrence of each edge in input order. The edges are bucketed by
+     * their smaller endpoint with a stable counting sort, so that duplicates
+     * land in the same bucket. Within a bucket, a per-vertex marker array
+     * records the buckets in which each larger endpoint was already seen.
+     * This takes O(V + E) time without hashing.
+     *
+     * @param edges A list of pairs of vertices that represent the edges in
+     * the graph, either a vector of pairs or a `FlatEdgeList`.
+     * @param assume_unique_edges Skip the duplicate removal pass.
+     * @param weights The weight of every edge, or empty for an unweighted
+     * graph. The weights of the kept edges are stored with them.
+     * @param resource The memory resource of the lookup list and weights.
      */
-    void ConstructEdgeToVertex_(
-        const std::vector<std::pair<size_t, size_t>> &edges) {
-        std::unordered_set<size_t> visited;
-        for (auto edge : edges) {
-            if (visited.contains(edge.first * num_vertices_ + edge.second) ||
-                visited.contains(edge.second * num_vertices_ + edge.first)) {
-                continue;
+    template <typename EdgeList>
+    void ConstructEdgeToVertex_(const EdgeList &edges,
+                                bool assume_unique_edges = false,
+                                std::span<const weight_type> weights = {},
+                                std::pmr::memory_resource *resource =
+                                    std::pmr::get_default_resource()) {
+        if (!weights.empty() && weights.size() != edges.size()) {
+            throw std::invalid_argument(
+                "SparseGraph: the number of weights must match the number of "
+                "edges");
+        }
+
+        for (size_t i = 0; i < edges.size(); i++) {
+            const auto &edge = edges[i];
+            if (edge.first >= num_vertices_ || edge.second >= num_vertices_) {
+                throw std::invalid_argument(
+                    "SparseGraph: edge endpoint out of range");
             }
-            e_to_v_.push_back(edge);
-            visited.insert(edge.first * num_vertices_ + edge.second);
-            visited.insert(edge.second * num_vertices_ + edge.first);
         }
+
+        auto e_to_v = e_to_v_.Release(resource);
+        e_to_v.reserve(edges.size());
+        auto edge_weights = edge_weights_.Release(resource);
+        edge_weights.reserve(weights.size());
+
+        if (assume_unique_edges) {
+            for (size_t i = 0; i < edges.size(); i++) {
+                const auto &edge = edges[i];
+                e_to_v.emplace_back(static_cast<IndexT>(edge.first),
+                                    static_cast<IndexT>(edge.second));
+            }
+            edge_weights.assign(weights.begin(), weights.end());
+            e_to_v_ = std::move(e_to_v);
+            edge_weights_ = std::move(edge_weights);
+            return;
+        }
+
+        ScratchArena &arena = ScratchArena::ForThisThread();
+        ScratchArena::Scope scope(arena);
+
+        // Stable counting sort of the edge indices by the smaller endpoint
+        std::pmr::vector<IndexT> bucket_ptr(num_vertices_ + 1, 0, &arena);
+        for (size_t i = 0; i < edges.size(); i++) {
+            const auto &edge = edges[i];
+            bucket_ptr[std::min(edge.first, edge.second) + 1]++;
+        }
+        for (size_t i = 1; i < bucket_ptr.size(); i++) {
+            bucket_ptr[i] += bucket_ptr[i - 1];
+        }
+
+        std::pmr::vector<IndexT> bucket(edges.size(), &arena);
+        std::pmr::vector<IndexT> next(bucket_ptr.begin(), bucket_ptr.end() - 1,
+                                      &arena);
+        for (size_t i = 0; i < edges.size(); i++) {
+            const auto &edge = edges[i];
+            bucket[next[std::min(edge.first, edge.second)]++] =
+                static_cast<IndexT>(i);
+        }
+
+        // Mark the first occurrence of each larger endpoint per bucket
+        constexpr IndexT unseen = std::numeric_limits<IndexT>::max();
+        std::pmr::vector<IndexT> last_seen(num_vertices_, unseen, &arena);
+        std::pmr::vector<bool> keep(edges.size(), false, &arena);
+        for (size_t u = 0; u < num_vertices_; u++) {
+            for (size_t k = bucket_ptr[u]; k < bucket_ptr[u + 1]; k++) {
+                const auto &edge = edges[bucket[k]];
+                size_t w = std::max(edge.first, edge.second);
+                if (last_seen[w] != u) {
+                    last_seen[w] = static_cast<IndexT>(u);
+                    keep[bucket[k]] = true;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < edges.size(); i++) {
+            if (keep[i]) {
+                const auto &edge = edges[i];
+                e_to_v.emplace_back(static_cast<IndexT>(edge.first),
+                                    static_cast<IndexT>(edge.second));
+                if (!weights.empty()) {
+                    edge_weights.push_back(weights[i]);
+                }
+            }
+        }
+        e_to_v_ = std::move(e_to_v);
+        edge_weights_ = std::move(edge_weights);
     }
 
     /**
@@ -126,101 +978,289 @@ class SparseGraph {
      */
     size_t GetNumEdges() const { return e_to_v_.size(); }
 
+    /**
+     * @brief Check whether the edges of the graph carry weights.
+     *
+     * @return true if the graph was constructed with edge weights.
+     */
+    bool HasEdgeWeights() const { return !edge_weights_.empty(); }
+
+    /**
+     * @brief Get the weight of an edge.
+     *
+     * @param edge_index The index of the edge in the graph.
+     * @return The weight of the edge, or 1 if the graph is unweighted.
+     */
+    weight_type GetEdgeWeight(size_t edge_index) const {
+        return edge_weights_.empty() ? weight_type{1}
+                                     : edge_weights_[edge_index];
+    }
+
     /**
      * @brief Construct the vertex-vertex adjacency matrix.
      *
-     * @param num_vertices The number of vertices in the graph.
      * @param edges A vector of pairs of vertex indices representing the edges
      * in the graph.
+     * @param num_threads The number of threads to use, 0 meaning one per
+     * hardware thread.
+     * @param sort_rows Sort each row by column.
+     * @param resource The memory resource of the matrix.
      */
-    void ConstructVertexToVertexMatrix_(
-        const std::vector<std::pair<size_t, size_t>> &edges) {
+    void ConstructVertexToVertexMatrix_(std::span<const edge_type> edges,
+                                        size_t num_threads = 1,
+                                        bool sort_rows = false,
+                                        std::pmr::memory_resource *resource =
+                                            std::pmr::get_default_resource()) {
+        Utils::CSRMatrix<IndexT> csr{v_to_v_row_ptr_.Release(resource),
+                                     v_to_v_col_.Release(resource),
+                                     v_to_v_edges_.Release(resource)};
+        Utils::BuildCSR(num_vertices_, edges, true, num_threads, csr);
+        if (sort_rows) {
+            Utils::SortSymmetricCSRRows(csr);
+        }
+        sorted_rows_ = sort_rows;
+        v_to_v_row_ptr_ = std::move(csr.row_ptr);
+        v_to_v_col_ = std::move(csr.col);
+        v_to_v_edges_ = std::move(csr.ids);
+    }
 
-        // Resize the CSR row pointer vector to hold one more element than the
-        // number of vertices
-        v_to_v_row_ptr_.resize(num_vertices_ + 1);
+    /**
+     * @brief Build the hash index used by `GetEdgeFromVertexPair`.
+     *
+     * Graphs constructed with `SparseGraphOptions::edge_index` already have
+     * the index. It can be built later for graphs assembled from arrays, e.g.
+     * loaded from a file. Copies of a graph made after this call share the
+     * index.
+     */
+    void BuildEdgeIndex() {
+        PhaseTimer timer(timings_.edge_index);
+        edge_index_ = std::make_shared<const EdgeHashIndex<IndexT>>(
+            std::span<const edge_type>(e_to_v_));
+    }
 
-        // Initialize the CSR row pointer vector to zero
-        std::fill(v_to_v_row_ptr_.begin(), v_to_v_row_ptr_.end(), 0);
+    /**
+     * @brief Check whether the graph has a hash index from pairs of vertices
+     * to edges.
+     */
+    bool HasEdgeIndex() const { return edge_index_ != nullptr; }
 
-        // Count the number of edges incident to each vertex
-        for (const auto &edge : edges) {
-            v_to_v_row_ptr_[edge.first + 1]++;
-            v_to_v_row_ptr_[edge.second + 1]++;
+    /**
+     * @brief Check whether each vertex-vertex row is sorted by neighbouring
+     * vertex.
+     */
+    bool AreRowsSorted() const { return sorted_rows_; }
+
+    /**
+     * @brief Visit the edges sharing an endpoint with a given edge.
+     *
+     * Every neighbouring edge `j > edge_index` is passed to `fn` exactly once,
+     * in the order in which it appears in the rows of the two endpoints.
+     * Neighbours with a smaller index are skipped, so that iterating over all
+     * edges visits every pair of adjacent edges once. Duplicates are detected
+     * with `stamp`, a per-edge scratch array that must not contain
+     * `edge_index` on entry.
+     *
+     * @param edge_index The index of the edge.
+     * @param stamp Scratch array with one entry per edge.
+     * @param fn Callable invoked with the index of each neighbouring edge.
+     */
+    template <typename Fn>
+    void ForEachLargerEdgeTouchingEdge_(size_t edge_index,
+                                        std::span<IndexT> stamp,
+                                        Fn &&fn) const {
+        const auto &vertices = e_to_v_[edge_index];
+        stamp[edge_index] = static_cast<IndexT>(edge_index);
+        for (IndexT vertex : {vertices.first, vertices.second}) {
+            const auto &edges = EdgeRow_(vertex);
+            for (size_t k = 0; k < edges.size(); k++) {
+                IndexT j = edges[k];
+                if (stamp[j] != edge_index) {
+                    stamp[j] = static_cast<IndexT>(edge_index);
+                    if (j > edge_index) {
+                        fn(j);
+                    }
+                }
+            }
         }
+    }
 
-        // Compute the prefix sum of the CSR row pointer vector
-        for (size_t i = 1; i < v_to_v_row_ptr_.size(); i++) {
-            v_to_v_row_ptr_[i] += v_to_v_row_ptr_[i - 1];
+    /**
+     * @brief Construct the edge-edge adjacency matrix.
+     *
+     * The line graph is built directly from the vertex-vertex CSR matrix in
+     * two passes over the rows of the edge endpoints: the first counts the
+     * neighbours of every edge and the second scatters them into the
+     * preallocated CSR arrays. Repeated neighbours (edges sharing both
+     * endpoints through a self-loop) are filtered with a per-edge stamp array
+     * instead of a hash set, so the peak memory is the final CSR matrix plus
+     * one scratch entry per edge.
+     *
+     * The matrix is constructed at most once, even if this function is called
+     * concurrently from several threads, into the storage left by the
+     * previous matrix if the graph was rebuilt.
+     */
+    void ConstructEdgeToEdgeMatrix_() const {
+        if (!e_to_e_) {
+            return;
+        }
+        auto &e_to_e = *e_to_e_;
+        if (e_to_e.constructed.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard lock(e_to_e.mutex);
+        if (e_to_e.constructed.load(std::memory_order_relaxed)) {
+            return;
         }
+        {
+            PhaseTimer timer(e_to_e.seconds);
+            auto row_ptr = e_to_e.row_ptr.Release(GetMemoryResource());
+            auto col = e_to_e.col.Release(GetMemoryResource());
+            BuildEdgeToEdgeMatrix_(row_ptr, col);
+            e_to_e.row_ptr = std::move(row_ptr);
+            e_to_e.col = std::move(col);
+        }
+        e_to_e.constructed.store(true, std::memory_order_release);
+    }
 
-        // Resize the CSR column index vector and edge ID vector to hold the
-        // total number of edges
-        int numEdges = v_to_v_row_ptr_.back();
-        v_to_v_col_.resize(numEdges);
-        v_to_v_edges_.resize(numEdges);
+    /**
+     * @brief Check whether the edge-edge adjacency matrix is constructed.
+     *
+     * @return true if the matrix has been constructed, false if it will be
+     * constructed on the next call to `GetEdgesTouchingEdge`.
+     */
+    bool IsEdgeToEdgeMatrixConstructed() const {
+        return e_to_e_ &&
+               e_to_e_->constructed.load(std::memory_order_acquire);
+    }
 
-        // Fill the CSR column index and edge ID vectors with the endpoints and
-        // IDs of the edges
-        std::vector<size_t> next(v_to_v_row_ptr_.begin(),
-                                 v_to_v_row_ptr_.end());
+    /**
+     * @brief Get the memory resource the arrays of the graph are allocated
+     * from.
+     *
+     * This is the resource of `SparseGraphOptions::memory_resource` for a
+     * graph built with one, and the default resource otherwise, including for
+     * copies and for graphs assembled from arrays.
+     */
+    std::pmr::memory_resource *GetMemoryResource() const {
+        return v_to_v_row_ptr_.GetMemoryResource();
+    }
 
-        for (size_t i = 0; i < edges.size(); i++) {
-            const auto &edge = edges[i];
-            v_to_v_col_[next[edge.first]] = edge.second;
-            v_to_v_edges_[next[edge.first]] = i;
-            next[edge.first]++;
+  private:
+    /**
+     * @brief Build the edge-edge adjacency matrix into the given CSR arrays.
+     *
+     * @param row_ptr The CSR row pointer vector to fill.
+     * @param col The CSR column index vector to fill.
+     */
+    void BuildEdgeToEdgeMatrix_(std::pmr::vector<IndexT> &row_ptr,
+                                std::pmr::vector<IndexT> &col) const {
+        size_t num_dual_vertices = GetNumEdges();
+        constexpr IndexT unseen = std::numeric_limits<IndexT>::max();
+        ScratchArena &arena = ScratchArena::ForThisThread();
+        ScratchArena::Scope scope(arena);
+        std::pmr::vector<IndexT> stamp(num_dual_vertices, unseen, &arena);
 
-            v_to_v_col_[next[edge.second]] = edge.first;
-            v_to_v_edges_[next[edge.second]] = i;
-            next[edge.second]++;
+        // Count the number of edges adjacent to each edge
+        row_ptr.assign(num_dual_vertices + 1, 0);
+        for (size_t i = 0; i < num_dual_vertices; i++) {
+            ForEachLargerEdgeTouchingEdge_(i, stamp, [&](IndexT j) {
+                row_ptr[i + 1]++;
+                row_ptr[j + 1]++;
+            });
+        }
+
+        // Compute the prefix sum of the CSR row pointer vector
+        size_t num_entries = 0;
+        for (size_t i = 1; i < row_ptr.size(); i++) {
+            num_entries += row_ptr[i];
+            CheckIndexRange_(num_entries, "number of edge-edge adjacencies");
+            row_ptr[i] = static_cast<IndexT>(num_entries);
+        }
+        col.resize(num_entries);
+
+        // Fill the CSR column index vector, emitting every pair of adjacent
+        // edges once in both directions
+        std::pmr::vector<IndexT> next(row_ptr.begin(), row_ptr.end() - 1,
+                                      &arena);
+        std::fill(stamp.begin(), stamp.end(), unseen);
+        for (size_t i = 0; i < num_dual_vertices; i++) {
+            ForEachLargerEdgeTouchingEdge_(i, stamp, [&](IndexT j) {
+                col[next[i]++] = j;
+                col[next[j]++] = static_cast<IndexT>(i);
+            });
         }
     }
 
     /**
-     * @brief Construct the edge-edge adjacency matrix.
+     * @brief Concatenate the rows of a vertex-vertex CSR array for a batch of
+     * vertices.
      *
-     * @param num_vertices The number of vertices in the graph.
-     * @param edges A vector of pairs of vertex indices representing the edges
-     * in the graph.
+     * @param vertices The indices of the vertices.
+     * @param data Either `v_to_v_col_` or `v_to_v_edges_`.
+     * @return The concatenated rows.
      */
-    void ConstructEdgeToEdgeMatrix_() {
+    RaggedRows<IndexT>
+    GatherVertexRows_(std::span<const IndexT> vertices,
+                      std::span<const IndexT> data) const {
+        RaggedRows<IndexT> rows;
+        rows.offsets.resize(vertices.size() + 1);
+        rows.offsets[0] = 0;
+        for (size_t i = 0; i < vertices.size(); i++) {
+            size_t v = vertices[i];
+            CheckBatchIndex_(v, num_vertices_, "vertex index");
+            rows.offsets[i + 1] =
+                rows.offsets[i] + (v_to_v_row_ptr_[v + 1] - v_to_v_row_ptr_[v]);
+        }
 
-        size_t num_dual_vertices = GetNumEdges();
-        std::unordered_set<size_t> visited;
-        std::vector<std::pair<size_t, size_t>> dual_edge_list;
+        rows.values.resize(rows.offsets.back());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            size_t v = vertices[i];
+            std::copy(data.begin() + v_to_v_row_ptr_[v],
+                      data.begin() + v_to_v_row_ptr_[v + 1],
+                      rows.values.begin() + rows.offsets[i]);
+        }
+        return rows;
+    }
 
-        for (size_t i = 0; i < num_dual_vertices; i++) {
-            const auto &vertices = GetVerticesConnectedByEdge(i);
-            const auto &edges1 = GetEdgesTouchingVertex(vertices.first);
-            const auto &edges2 = GetEdgesTouchingVertex(vertices.second);
-
-            for (size_t j = 0; j < edges1.size(); j++) {
-                if (edges1[j] != i &&
-                    !visited.contains(i * num_dual_vertices + edges1[j]) &&
-                    !visited.contains(edges1[j] * num_dual_vertices + i)) {
-                    dual_edge_list.push_back(std::make_pair(i, edges1[j]));
-                    visited.insert(i * num_dual_vertices + edges1[j]);
-                    visited.insert(edges1[j] * num_dual_vertices + i);
-                }
-            }
-            for (size_t j = 0; j < edges2.size(); j++) {
-                if (edges2[j] != i &&
-                    !visited.contains(i * num_dual_vertices + edges2[j]) &&
-                    !visited.contains(edges2[j] * num_dual_vertices + i)) {
-                    dual_edge_list.push_back(std::make_pair(i, edges2[j]));
-                    visited.insert(i * num_dual_vertices + edges2[j]);
-                    visited.insert(edges2[j] * num_dual_vertices + i);
-                }
+    /**
+     * @brief Find the edge connecting two vertices.
+     *
+     * The hash index is used if it was built, and otherwise the row of `u`
+     * is searched, by binary search if the rows are sorted.
+     *
+     * @return The index of the edge, or `kInvalidIndex` if the vertices are
+     * not connected or out of range.
+     */
+    IndexT FindEdge_(size_t u, size_t v) const {
+        if (u >= num_vertices_ || v >= num_vertices_) {
+            return kInvalidIndex;
+        }
+        if (edge_index_) {
+            return edge_index_->Find(u, v, e_to_v_);
+        }
+        const size_t begin = v_to_v_row_ptr_[u];
+        const size_t end = v_to_v_row_ptr_[u + 1];
+        if (sorted_rows_) {
+            const size_t k =
+                Utils::FindInSortedRow(v_to_v_col_.data(), begin, end, v);
+            return k == end ? kInvalidIndex : v_to_v_edges_[k];
+        }
+        for (size_t k = begin; k < end; k++) {
+            if (v_to_v_col_[k] == v) {
+                return v_to_v_edges_[k];
             }
         }
+        return kInvalidIndex;
+    }
 
-        auto csr =
-            Utils::ConvertEdgeListToCSR(num_dual_vertices, dual_edge_list);
-        e_to_e_row_ptr_ = std::get<0>(csr);
-        e_to_e_col_ = std::get<1>(csr);
+    // Get the edges touching a vertex without counting the query
+    row_type EdgeRow_(size_t vertex_index) const {
+        size_t start = v_to_v_row_ptr_[vertex_index];
+        size_t end = v_to_v_row_ptr_[vertex_index + 1];
+        return row_type(v_to_v_edges_, start, end);
     }
 
+  public:
     /**
      * @brief Get a row of edges in the graph that touch a given vertex.
      *
@@ -240,10 +1280,9 @@ class SparseGraph {
      * holds a reference to the `v_to_v_edges_` container owned by the
      * `DecodingGraph`.
      */
-    SparseGraphRow GetEdgesTouchingVertex(size_t vertex_index) const {
-        size_t start = v_to_v_row_ptr_[vertex_index];
-        size_t end = v_to_v_row_ptr_[vertex_index + 1];
-        return SparseGraphRow(v_to_v_edges_, start, end);
+    row_type GetEdgesTouchingVertex(size_t vertex_index) const {
+        counters_.CountVertexRows();
+        return EdgeRow_(vertex_index);
     }
 
     /**
@@ -259,10 +1298,11 @@ class SparseGraph {
      * touching the given vertex. The indices are obtained from the
      * v_to_v_row_ptr_ array.
      */
-    SparseGraphRow GetVerticesTouchingVertex(size_t vertex_index) const {
+    row_type GetVerticesTouchingVertex(size_t vertex_index) const {
+        counters_.CountVertexRows();
         size_t start = v_to_v_row_ptr_[vertex_index];
         size_t end = v_to_v_row_ptr_[vertex_index + 1];
-        return SparseGraphRow(v_to_v_col_, start, end);
+        return row_type(v_to_v_col_, start, end);
     }
 
     /**
@@ -281,13 +1321,37 @@ class SparseGraph {
      *
      * Note that the caller should not use the returned reference after the
      * lifetime of the `DecodingGraph` object, since the `SparseGraphRow` object
-     * holds a reference to the `e_to_e_col_` container owned by the
-     * `DecodingGraph`.
+     * holds a reference to the edge-edge adjacency matrix owned by the
+     * `DecodingGraph`. The matrix is constructed on the first call if the
+     * graph was created with `EdgeToEdgeMode::Lazy`.
+     */
+    row_type GetEdgesTouchingEdge(size_t edge_index) const {
+        counters_.CountEdgeRows();
+        ConstructEdgeToEdgeMatrix_();
+        size_t start = e_to_e_->row_ptr[edge_index];
+        size_t end = e_to_e_->row_ptr[edge_index + 1];
+        return row_type(e_to_e_->col, start, end);
+    }
+
+    /**
+     * @brief Get the edges that touch a given edge without the edge-edge
+     * adjacency matrix.
+     *
+     * @param edge_index The index of the edge in the graph.
+     * @return A view computing the edges that touch the edge on the fly.
+     *
+     * This function never constructs the edge-edge adjacency matrix, which
+     * makes it preferable for callers that only occasionally need the
+     * neighbourhood of an edge. The returned `ImplicitEdgeRow` holds pointers
+     * into the `v_to_v_edges_` container and must not outlive the graph.
      */
-    SparseGraphRow GetEdgesTouchingEdge(size_t edge_index) const {
-        size_t start = e_to_e_row_ptr_[edge_index];
-        size_t end = e_to_e_row_ptr_[edge_index + 1];
-        return SparseGraphRow(e_to_e_col_, start, end);
+    ImplicitEdgeRow<IndexT>
+    GetEdgesTouchingEdgeImplicit(size_t edge_index) const {
+        counters_.CountEdgeRows();
+        const auto &vertices = e_to_v_[edge_index];
+        return ImplicitEdgeRow<IndexT>(
+            edge_index, EdgeRow_(vertices.first), EdgeRow_(vertices.second),
+            vertices.first == vertices.second);
     }
 
     /**
@@ -305,8 +1369,8 @@ class SparseGraph {
      * attempt to modify the pair of vertices.
      */
 
-    const std::pair<size_t, size_t> &
-    GetVerticesConnectedByEdge(size_t edge_index) const {
+    const edge_type &GetVerticesConnectedByEdge(size_t edge_index) const {
+        counters_.CountEdgeEndpoints();
         return e_to_v_[edge_index];
     }
 
@@ -318,28 +1382,228 @@ class SparseGraph {
      *
      * This function returns the index of the edge in the graph that connects
      * the two vertices specified by `vertex_pair`. The function searches for
-     * the edge by iterating over the row in the graph corresponding to the
-     * first vertex in `vertex_pair` and looking for the column index
-     * corresponding to the second vertex in `vertex_pair`.
+     * the edge in the row in the graph corresponding to the first vertex in
+     * `vertex_pair`, looking for the column index corresponding to the second
+     * vertex in `vertex_pair`. The row is scanned linearly by default, and
+     * searched by binary search in graphs constructed with
+     * `SparseGraphOptions::sort_rows`. Graphs with an edge index (see
+     * `BuildEdgeIndex`) look the pair up in constant time instead.
      *
-     * If the edge is found, its index is returned. If the edge is not found, an
-     * assertion failure occurs.
+     * If the edge is found, its index is returned. Otherwise, including when
+     * a vertex is out of range, `kInvalidIndex` is returned.
      */
-    size_t
+    IndexT
     GetEdgeFromVertexPair(const std::pair<size_t, size_t> &vertex_pair) const {
-        size_t start = v_to_v_row_ptr_[vertex_pair.first];
-        size_t end = v_to_v_row_ptr_[vertex_pair.first + 1];
+        const IndexT edge = FindEdge_(vertex_pair.first, vertex_pair.second);
+        counters_.CountVertexPair(edge != kInvalidIndex);
+        return edge;
+    }
 
-        // Search for the column index j in the row
-        for (size_t k = start; k < end; k++) {
-            if (v_to_v_col_[k] == vertex_pair.second) {
-                // j is in the row, so the element is 1
-                return v_to_v_edges_[k];
-            }
+    /**
+     * @brief Get the edges that touch each vertex of a batch.
+     *
+     * @param vertices The indices of the vertices.
+     * @return The rows of `GetEdgesTouchingVertex` for every vertex,
+     * concatenated in query order.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    RaggedRows<IndexT>
+    GetEdgesTouchingVertices(std::span<const IndexT> vertices) const {
+        counters_.CountVertexRows(vertices.size());
+        return GatherVertexRows_(vertices, v_to_v_edges_);
+    }
+
+    /**
+     * @brief Get the vertices connected to each vertex of a batch.
+     *
+     * @param vertices The indices of the vertices.
+     * @return The rows of `GetVerticesTouchingVertex` for every vertex,
+     * concatenated in query order.
+     * @throws std::out_of_range if a vertex is not part of the graph.
+     */
+    RaggedRows<IndexT>
+    GetVerticesTouchingVertices(std::span<const IndexT> vertices) const {
+        counters_.CountVertexRows(vertices.size());
+        return GatherVertexRows_(vertices, v_to_v_col_);
+    }
+
+    /**
+     * @brief Get the pair of vertices connected by each edge of a batch.
+     *
+     * @param edges The indices of the edges.
+     * @param out Output array of size `2 * edges.size()`, receiving the two
+     * endpoints of every edge.
+     * @throws std::out_of_range if an edge is not part of the graph.
+     */
+    void GetVerticesConnectedByEdges(std::span<const IndexT> edges,
+                                     std::span<IndexT> out) const {
+        if (out.size() != 2 * edges.size()) {
+            throw std::invalid_argument(
+                "SparseGraph: output size must be twice the number of edges");
+        }
+        counters_.CountEdgeEndpoints(edges.size());
+        for (size_t i = 0; i < edges.size(); i++) {
+            CheckBatchIndex_(edges[i], e_to_v_.size(), "edge index");
+            const auto &vertices = e_to_v_[edges[i]];
+            out[2 * i] = vertices.first;
+            out[2 * i + 1] = vertices.second;
         }
+    }
 
-        assert(false && "Edge not found");
-        return -1;
+    /**
+     * @brief Get the index of the edge connecting each pair of vertices of a
+     * batch.
+     *
+     * Pairs of vertices are looked up as in `GetEdgeFromVertexPair`.
+     *
+     * @param vertex_pairs The flattened pairs of vertices, of size twice the
+     * number of queries.
+     * @param out Output array of size `vertex_pairs.size() / 2`, receiving
+     * the index of every edge, or `kInvalidIndex` if the vertices are not
+     * connected.
+     */
+    void GetEdgesFromVertexPairs(std::span<const IndexT> vertex_pairs,
+                                 std::span<IndexT> out) const {
+        if (2 * out.size() != vertex_pairs.size()) {
+            throw std::invalid_argument(
+                "SparseGraph: output size must be half the number of vertices");
+        }
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] = FindEdge_(vertex_pairs[2 * i], vertex_pairs[2 * i + 1]);
+            counters_.CountVertexPair(out[i] != kInvalidIndex);
+        }
     }
+
+    /**
+     * @brief Get the row pointer array of the vertex-vertex adjacency matrix.
+     *
+     * The raw CSR arrays are exposed for vectorized consumers (e.g. NumPy
+     * views). Row `v` spans the entries `[row_ptr[v], row_ptr[v + 1])` of
+     * both `GetVertexToVertexCol` and `GetVertexToVertexEdges`. The returned
+     * views must not outlive the graph.
+     *
+     * @return A view of the `num_vertices + 1` row pointers.
+     */
+    std::span<const IndexT> GetVertexToVertexRowPtr() const {
+        return v_to_v_row_ptr_;
+    }
+
+    /**
+     * @brief Get the column index array of the vertex-vertex adjacency matrix.
+     *
+     * @return A view of the neighbouring vertex of every half-edge.
+     */
+    std::span<const IndexT> GetVertexToVertexCol() const {
+        return v_to_v_col_;
+    }
+
+    /**
+     * @brief Get the edge ID array of the vertex-vertex adjacency matrix.
+     *
+     * @return A view of the edge index of every half-edge.
+     */
+    std::span<const IndexT> GetVertexToVertexEdges() const {
+        return v_to_v_edges_;
+    }
+
+    /**
+     * @brief Get the edge to vertices lookup list.
+     *
+     * @return A view of the pair of endpoints of every edge.
+     */
+    std::span<const edge_type> GetEdgeToVertex() const { return e_to_v_; }
+
+    /**
+     * @brief Get the weight of every edge.
+     *
+     * @return A view of one weight per edge, empty if the graph is
+     * unweighted.
+     */
+    std::span<const weight_type> GetEdgeWeights() const {
+        return edge_weights_;
+    }
+
+    /**
+     * @brief Get the row pointer array of the edge-edge adjacency matrix.
+     *
+     * The matrix is constructed on the first call if the graph was created
+     * with `EdgeToEdgeMode::Lazy`.
+     *
+     * @return A view of the `num_edges + 1` row pointers.
+     */
+    std::span<const IndexT> GetEdgeToEdgeRowPtr() const {
+        ConstructEdgeToEdgeMatrix_();
+        return e_to_e_ ? std::span<const IndexT>(e_to_e_->row_ptr)
+                       : std::span<const IndexT>(kEmptyRowPtr_);
+    }
+
+    /**
+     * @brief Get the column index array of the edge-edge adjacency matrix.
+     *
+     * The matrix is constructed on the first call if the graph was created
+     * with `EdgeToEdgeMode::Lazy`.
+     *
+     * @return A view of the neighbouring edges of every edge.
+     */
+    std::span<const IndexT> GetEdgeToEdgeCol() const {
+        ConstructEdgeToEdgeMatrix_();
+        return e_to_e_ ? std::span<const IndexT>(e_to_e_->col)
+                       : std::span<const IndexT>();
+    }
+
+    /**
+     * @brief Get the time spent in each phase of the construction of the
+     * graph.
+     *
+     * @return The timings, in seconds. The edge-edge matrix is timed once it
+     * is constructed.
+     */
+    ConstructionTimings GetConstructionTimings() const {
+        ConstructionTimings timings = timings_;
+        if (IsEdgeToEdgeMatrixConstructed()) {
+            timings.edge_to_edge = e_to_e_->seconds;
+        }
+        return timings;
+    }
+
+    /**
+     * @brief Get the memory held by each array of the graph.
+     *
+     * The edge-edge arrays are only reported once the matrix is constructed,
+     * and the edge index only if it was built.
+     *
+     * @return The footprint of every array.
+     */
+    MemoryFootprint GetMemoryFootprint() const {
+        MemoryFootprint footprint;
+        footprint.Add("v_to_v_row_ptr", v_to_v_row_ptr_);
+        footprint.Add("v_to_v_col", v_to_v_col_);
+        footprint.Add("v_to_v_edges", v_to_v_edges_);
+        footprint.Add("e_to_v", e_to_v_);
+        footprint.Add("edge_weights", edge_weights_);
+        if (IsEdgeToEdgeMatrixConstructed()) {
+            footprint.Add("e_to_e_row_ptr", e_to_e_->row_ptr);
+            footprint.Add("e_to_e_col", e_to_e_->col);
+        }
+        if (edge_index_) {
+            const size_t bytes = edge_index_->capacity() * sizeof(IndexT);
+            footprint.arrays.push_back({"edge_index", bytes, bytes, false});
+        }
+        return footprint;
+    }
+
+    /**
+     * @brief Get the number of queries answered by the graph since it was
+     * constructed or the counters were reset.
+     *
+     * @return The counts, all zero unless the library is built with
+     * `PLAQUETTE_GRAPH_ENABLE_COUNTERS` (see `kQueryCountersEnabled`).
+     */
+    QueryCounts GetQueryCounts() const { return counters_.Get(); }
+
+    /**
+     * @brief Set the query counters to zero.
+     */
+    void ResetQueryCounts() const { counters_.Reset(); }
 };
 }; // namespace Plaquette
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "DecodingGraph.hpp"
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+
+/**
+ * @brief How the bits of a SyndromeBatch are laid out in memory.
+ */
+enum class SyndromeLayout {
+    /** One row of bits per shot, with one bit per detector. */
+    ShotMajor,
+    /** One row of bits per detector, with one bit per shot. */
+    DetectorMajor,
+};
+
+/**
+ * @class SyndromeBatch
+ * @brief The syndromes of a batch of shots, stored as bitsets.
+ *
+ * A syndrome batch holds one bit per shot and detector, where the detectors
+ * are the vertices of a `DecodingGraph`. The bits are stored in rows of
+ * 64-bit words, one row per shot (shot-major layout) or one row per detector
+ * (detector-major layout), with bit `i` of a row in bit `i % 64` of word
+ * `i / 64`. On little-endian machines, a row is therefore also a row of bytes
+ * with bit `i` in bit `i % 8` of byte `i / 8`, which is the bit-packed format
+ * of common samplers. Rows are padded with zero bits to a whole number of
+ * words.
+ *
+ * Defects are extracted from whole words, with a popcount to count them and a
+ * count-trailing-zeros loop to list them. Boundary vertices are masked out
+ * word by word. Blocks of four zero words are skipped with a single test
+ * on their bitwise OR, which speeds up the sparse syndromes of low error
+ * rates.
+ *
+ * @tparam IndexT Unsigned integer type of the indices of the graph.
+ */
+template <typename IndexT = size_t> class SyndromeBatch {
+  public:
+    using graph_type = DecodingGraph<IndexT>;
+
+    /**
+     * @brief Construct a batch of shots without defects.
+     *
+     * @param graph The decoding graph whose vertices are the detectors.
+     * @param num_shots The number of shots.
+     * @param layout The memory layout of the bits.
+     */
+    SyndromeBatch(const graph_type &graph, size_t num_shots,
+                  SyndromeLayout layout = SyndromeLayout::ShotMajor)
+        : num_shots_(num_shots), num_detectors_(graph.GetNumVertices()),
+          layout_(layout) {
+        const size_t row_bits =
+            layout == SyndromeLayout::ShotMajor ? num_detectors_ : num_shots_;
+        num_rows_ =
+            layout == SyndromeLayout::ShotMajor ? num_shots_ : num_detectors_;
+        words_per_row_ = (row_bits + 63) / 64;
+        words_.assign(num_rows_ * words_per_row_, 0);
+
+        // One bit per detector, set for the detectors that are not on the
+        // boundary
+        const size_t mask_words = (num_detectors_ + 63) / 64;
+        detector_mask_.assign(mask_words, 0);
+        for (size_t d = 0; d < num_detectors_; d++) {
+            if (!graph.IsVertexOnBoundary(d)) {
+                detector_mask_[d / 64] |= uint64_t{1} << (d % 64);
+            }
+        }
+    }
+
+    /**
+     * @brief Construct a batch of shots from bit-packed rows of bytes.
+     *
+     * @param graph The decoding graph whose vertices are the detectors.
+     * @param num_shots The number of shots.
+     * @param data The rows of bytes, one per shot or detector depending on
+     * `layout`, each holding one bit per detector or shot.
+     * @param bytes_per_row The number of bytes of each row of `data`, at
+     * least enough for one bit per detector or shot.
+     * @param layout The memory layout of the bits.
+     * @throws std::invalid_argument if the rows are too short.
+     */
+    SyndromeBatch(const graph_type &graph, size_t num_shots,
+                  const uint8_t *data, size_t bytes_per_row,
+                  SyndromeLayout layout = SyndromeLayout::ShotMajor)
+        : SyndromeBatch(graph, num_shots, layout) {
+        const size_t row_bits = layout == SyndromeLayout::ShotMajor
+                                    ? num_detectors_
+                                    : num_shots_;
+        if (bytes_per_row < (row_bits + 7) / 8) {
+            throw std::invalid_argument(
+                "SyndromeBatch: rows are too short for the number of bits");
+        }
+        const size_t copied = std::min(bytes_per_row, words_per_row_ * 8);
+        for (size_t r = 0; r < num_rows_; r++) {
+            std::memcpy(Row_(r), data + r * bytes_per_row, copied);
+            ClearPadding_(r);
+        }
+    }
+
+    // Get the number of shots in the batch
+    size_t GetNumShots() const { return num_shots_; }
+
+    // Get the number of detectors, which is the number of vertices of the graph
+    size_t GetNumDetectors() const { return num_detectors_; }
+
+    // Get the memory layout of the bits
+    SyndromeLayout GetLayout() const { return layout_; }
+
+    // Get the number of rows of words
+    size_t GetNumRows() const { return num_rows_; }
+
+    // Get the number of words of each row
+    size_t GetWordsPerRow() const { return words_per_row_; }
+
+    // View the words of all rows, in row order
+    std::span<uint64_t> GetWords() { return words_; }
+    std::span<const uint64_t> GetWords() const { return words_; }
+
+    /**
+     * @brief Get the bit of a detector in a shot.
+     */
+    bool GetDetector(size_t shot, size_t detector) const {
+        auto [word, bit] = Locate_(shot, detector);
+        return (words_[word] >> bit) & 1;
+    }
+
+    /**
+     * @brief Set the bit of a detector in a shot.
+     */
+    void SetDetector(size_t shot, size_t detector, bool value = true) {
+        auto [word, bit] = Locate_(shot, detector);
+        if (value) {
+            words_[word] |= uint64_t{1} << bit;
+        } else {
+            words_[word] &= ~(uint64_t{1} << bit);
+        }
+    }
+
+    /**
+     * @brief Count the defects of every shot.
+     *
+     * @param out Output array with one entry per shot.
+     * @param exclude_boundary Do not count the boundary vertices.
+     */
+    void CountDefects(std::span<size_t> out,
+                      bool exclude_boundary = true) const {
+        CheckOutputSize_(out.size());
+        if (layout_ == SyndromeLayout::ShotMajor) {
+            for (size_t s = 0; s < num_shots_; s++) {
+                out[s] = CountRow_(Row_(s), exclude_boundary);
+            }
+            return;
+        }
+        std::fill(out.begin(), out.end(), 0);
+        ForEachDetectorMajorDefect_(exclude_boundary,
+                                    [&](size_t s, size_t) { out[s]++; });
+    }
+
+    /**
+     * @brief Get the defects of one shot.
+     *
+     * @param shot The index of the shot.
+     * @param out Vector receiving the defect vertices in increasing order. It
+     * is cleared first and keeps its capacity, so that reusing it across
+     * shots does not allocate.
+     * @param exclude_boundary Leave out the boundary vertices.
+     */
+    void GetDefects(size_t shot, std::vector<IndexT> &out,
+                    bool exclude_boundary = true) const {
+        if (shot >= num_shots_) {
+            throw std::out_of_range("SyndromeBatch: shot index out of range");
+        }
+        out.clear();
+        if (layout_ == SyndromeLayout::ShotMajor) {
+            ForEachSetBit_(Row_(shot), exclude_boundary,
+                           [&](size_t d) { out.push_back(IndexT(d)); });
+            return;
+        }
+        const size_t word = shot / 64;
+        const uint64_t bit = uint64_t{1} << (shot % 64);
+        for (size_t d = 0; d < num_detectors_; d++) {
+            if ((Row_(d)[word] & bit) && IsCounted_(d, exclude_boundary)) {
+                out.push_back(static_cast<IndexT>(d));
+            }
+        }
+    }
+
+    /**
+     * @brief Get the defects of every shot.
+     *
+     * @param exclude_boundary Leave out the boundary vertices.
+     * @return The defect vertices of shot `s`, in increasing order, are
+     * `values[offsets[s]]` to `values[offsets[s + 1] - 1]`.
+     */
+    RaggedRows<IndexT> ExtractDefects(bool exclude_boundary = true) const {
+        RaggedRows<IndexT> defects;
+        defects.offsets.assign(num_shots_ + 1, 0);
+        CountDefects(std::span<size_t>(defects.offsets).subspan(1),
+                     exclude_boundary);
+        for (size_t s = 0; s < num_shots_; s++) {
+            defects.offsets[s + 1] += defects.offsets[s];
+        }
+        defects.values.resize(defects.offsets.back());
+
+        if (layout_ == SyndromeLayout::ShotMajor) {
+            for (size_t s = 0; s < num_shots_; s++) {
+                IndexT *out = defects.values.data() + defects.offsets[s];
+                ForEachSetBit_(Row_(s), exclude_boundary,
+                               [&](size_t d) { *out++ = IndexT(d); });
+            }
+            return defects;
+        }
+        std::vector<size_t> next(defects.offsets.begin(),
+                                 defects.offsets.end() - 1);
+        ForEachDetectorMajorDefect_(exclude_boundary, [&](size_t s, size_t d) {
+            defects.values[next[s]++] = static_cast<IndexT>(d);
+        });
+        return defects;
+    }
+
+  private:
+    uint64_t *Row_(size_t row) { return words_.data() + row * words_per_row_; }
+    const uint64_t *Row_(size_t row) const {
+        return words_.data() + row * words_per_row_;
+    }
+
+    std::pair<size_t, size_t> Locate_(size_t shot, size_t detector) const {
+        if (shot >= num_shots_ || detector >= num_detectors_) {
+            throw std::out_of_range(
+                "SyndromeBatch: shot or detector index out of range");
+        }
+        if (layout_ == SyndromeLayout::ShotMajor) {
+            return {shot * words_per_row_ + detector / 64, detector % 64};
+        }
+        return {detector * words_per_row_ + shot / 64, shot % 64};
+    }
+
+    void CheckOutputSize_(size_t size) const {
+        if (size != num_shots_) {
+            throw std::invalid_argument(
+                "SyndromeBatch: output size must match the number of shots");
+        }
+    }
+
+    bool IsCounted_(size_t detector, bool exclude_boundary) const {
+        return !exclude_boundary ||
+               ((detector_mask_[detector / 64] >> (detector % 64)) & 1);
+    }
+
+    // Clear the bits of a row past its last shot or detector
+    void ClearPadding_(size_t row) {
+        const size_t row_bits = layout_ == SyndromeLayout::ShotMajor
+                                    ? num_detectors_
+                                    : num_shots_;
+        if (row_bits % 64 != 0) {
+            Row_(row)[words_per_row_ - 1] &=
+                (uint64_t{1} << (row_bits % 64)) - 1;
+        }
+    }
+
+    // Check whether the four words starting at `row[w]` are zero
+    static bool IsZeroBlock_(const uint64_t *row, size_t w) {
+        return (row[w] | row[w + 1] | row[w + 2] | row[w + 3]) == 0;
+    }
+
+    // Count the set bits of a shot-major row
+    size_t CountRow_(const uint64_t *row, bool exclude_boundary) const {
+        size_t count = 0;
+        size_t w = 0;
+        for (; w + 4 <= words_per_row_; w += 4) {
+            if (IsZeroBlock_(row, w)) {
+                continue;
+            }
+            for (size_t k = w; k < w + 4; k++) {
+                count += std::popcount(Masked_(row, k, exclude_boundary));
+            }
+        }
+        for (; w < words_per_row_; w++) {
+            count += std::popcount(Masked_(row, w, exclude_boundary));
+        }
+        return count;
+    }
+
+    // Call `fn(detector)` for every set bit of a shot-major row
+    template <typename Fn>
+    void ForEachSetBit_(const uint64_t *row, bool exclude_boundary,
+                        Fn &&fn) const {
+        auto visit = [&](size_t w) {
+            for (uint64_t bits = Masked_(row, w, exclude_boundary); bits;
+                 bits &= bits - 1) {
+                fn(64 * w + std::countr_zero(bits));
+            }
+        };
+        size_t w = 0;
+        for (; w + 4 <= words_per_row_; w += 4) {
+            if (IsZeroBlock_(row, w)) {
+                continue;
+            }
+            for (size_t k = w; k < w + 4; k++) {
+                visit(k);
+            }
+        }
+        for (; w < words_per_row_; w++) {
+            visit(w);
+        }
+    }
+
+    uint64_t Masked_(const uint64_t *row, size_t w,
+                     bool exclude_boundary) const {
+        return exclude_boundary ? row[w] & detector_mask_[w] : row[w];
+    }
+
+    // Call `fn(shot, detector)` for every defect of a detector-major batch,
+    // in increasing detector order
+    template <typename Fn>
+    void ForEachDetectorMajorDefect_(bool exclude_boundary, Fn &&fn) const {
+        for (size_t d = 0; d < num_detectors_; d++) {
+            if (!IsCounted_(d, exclude_boundary)) {
+                continue;
+            }
+            ForEachShotBit_(Row_(d), [&](size_t s) { fn(s, d); });
+        }
+    }
+
+    // Call `fn(shot)` for every set bit of a detector-major row
+    template <typename Fn>
+    void ForEachShotBit_(const uint64_t *row, Fn &&fn) const {
+        for (size_t w = 0; w < words_per_row_; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                fn(64 * w + std::countr_zero(bits));
+            }
+        }
+    }
+
+    size_t num_shots_;
+    size_t num_detectors_;
+    SyndromeLayout layout_;
+    size_t num_rows_ = 0;
+    size_t words_per_row_ = 0;
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> detector_mask_;
+};
+
+}; // namespace Plaquette
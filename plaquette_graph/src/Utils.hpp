@@ -1,54 +1,342 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
+#include <memory_resource>
+#include <span>
+#include <thread>
 #include <tuple>
 #include <vector>
 
+#include "ScratchArena.hpp"
+
 namespace Plaquette {
 namespace Utils {
 
-std::tuple<std::vector<size_t>, std::vector<size_t>>
-ConvertEdgeListToCSR(size_t num_vertices,
-                     const std::vector<std::pair<size_t, size_t>> &edges) {
+/**
+ * @brief Resolve a requested number of threads.
+ *
+ * @param num_threads The requested number of threads, 0 meaning one thread
+ * per hardware thread.
+ * @return The number of threads to use, at least 1.
+ */
+inline size_t ResolveNumThreads(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    return std::max<size_t>(num_threads, 1);
+}
+
+/**
+ * @brief Run `fn(thread_id)` for every thread ID in `[0, num_threads)`.
+ *
+ * The calling thread runs thread 0 and the call returns once all threads have
+ * finished, so consecutive calls act as barriers between the phases of a
+ * parallel algorithm.
+ *
+ * @param num_threads The number of threads.
+ * @param fn The callable to run on each thread.
+ */
+template <typename Fn> void ParallelFor(size_t num_threads, Fn &&fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; t++) {
+        threads.emplace_back([&fn, t] { fn(t); });
+    }
+    fn(size_t{0});
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Get the range of a chunk of `[0, size)` split into `num_chunks`
+ * contiguous chunks.
+ *
+ * @param size The size of the range to split.
+ * @param num_chunks The number of chunks.
+ * @param chunk The index of the chunk.
+ * @return The begin and end of the chunk.
+ */
+inline std::pair<size_t, size_t> ChunkRange(size_t size, size_t num_chunks,
+                                            size_t chunk) {
+    return {size * chunk / num_chunks, size * (chunk + 1) / num_chunks};
+}
+
+/**
+ * @brief A CSR adjacency matrix of an undirected edge list.
+ *
+ * Row `i` holds the entries `col[row_ptr[i]]` to `col[row_ptr[i + 1] - 1]`.
+ * If requested at construction, `ids[k]` is the index in the edge list of the
+ * edge that produced the entry `col[k]`. The arrays may use any memory
+ * resource, and building into an existing matrix reuses their capacity.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT> struct CSRMatrix {
+    std::pmr::vector<IndexT> row_ptr;
+    std::pmr::vector<IndexT> col;
+    std::pmr::vector<IndexT> ids;
+};
+
+/**
+ * @brief Build the CSR adjacency matrix of an undirected edge list.
+ *
+ * Every edge `(u, v)` contributes the entry `v` to row `u` and the entry `u`
+ * to row `v`, and the entries of each row appear in edge list order. With
+ * more than one thread, the degree histogram, the prefix sum and the scatter
+ * are split between the threads: each thread counts the degrees of a chunk of
+ * the edge list into its own histogram, the histograms are combined into the
+ * row pointers and per-thread write offsets with a parallel scan, and each
+ * thread then scatters its chunk without atomics. The result is identical to
+ * the serial construction.
+ *
+ * The per-thread histograms need one index per vertex and thread, so the
+ * number of threads is reduced for graphs with few edges per vertex, and small
+ * graphs are always built serially.
+ *
+ * The matrix is built into `csr`, whose arrays keep their memory resource
+ * and are only reallocated if they are too small. The temporary cursors and
+ * histograms come from the `ScratchArena` of the calling thread.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param num_vertices The number of vertices (rows) of the matrix.
+ * @param edges A span of pairs of vertex indices.
+ * @param with_ids Also fill the edge ID of every entry.
+ * @param num_threads The number of threads to use, 0 meaning one per hardware
+ * thread.
+ * @param csr The matrix to build, whose previous contents are discarded.
+ */
+template <typename IndexT>
+void BuildCSR(size_t num_vertices,
+              std::span<const std::pair<IndexT, IndexT>> edges, bool with_ids,
+              size_t num_threads, CSRMatrix<IndexT> &csr) {
+    constexpr size_t min_edges_per_thread = size_t{1} << 14;
+
+    const size_t num_edges = edges.size();
+    num_threads = ResolveNumThreads(num_threads);
+    num_threads = std::min(num_threads, num_edges / min_edges_per_thread);
+    num_threads = std::min(num_threads, 4 * num_edges / (num_vertices + 1));
+
+    csr.row_ptr.assign(num_vertices + 1, 0);
+    csr.col.resize(2 * num_edges);
+    csr.ids.resize(with_ids ? 2 * num_edges : 0);
 
-    std::vector<size_t> row_ptr;
-    std::vector<size_t> col_ind;
+    ScratchArena &arena = ScratchArena::ForThisThread();
+    ScratchArena::Scope scope(arena);
 
-    row_ptr.resize(num_vertices + 1);
+    auto scatter = [&](size_t begin, size_t end, IndexT *next) {
+        for (size_t i = begin; i < end; i++) {
+            const auto &edge = edges[i];
+            size_t first = next[edge.first]++;
+            size_t second = next[edge.second]++;
+            csr.col[first] = edge.second;
+            csr.col[second] = edge.first;
+            if (with_ids) {
+                csr.ids[first] = static_cast<IndexT>(i);
+                csr.ids[second] = static_cast<IndexT>(i);
+            }
+        }
+    };
 
-    // Initialize the CSR row pointer vector to zero
-    std::fill(row_ptr.begin(), row_ptr.end(), 0);
+    if (num_threads <= 1) {
+        // Count the number of edges incident to each vertex
+        for (const auto &edge : edges) {
+            csr.row_ptr[edge.first + 1]++;
+            csr.row_ptr[edge.second + 1]++;
+        }
 
-    // Count the number of edges incident to each vertex
-    for (const auto &edge : edges) {
-        row_ptr[edge.first + 1]++;
-        row_ptr[edge.second + 1]++;
+        // Compute the prefix sum of the CSR row pointer vector
+        for (size_t i = 1; i < csr.row_ptr.size(); i++) {
+            csr.row_ptr[i] += csr.row_ptr[i - 1];
+        }
+
+        std::pmr::vector<IndexT> next(csr.row_ptr.begin(),
+                                      csr.row_ptr.end() - 1, &arena);
+        scatter(0, num_edges, next.data());
+        return;
     }
 
-    // Compute the prefix sum of the CSR row pointer vector
-    for (size_t i = 1; i < row_ptr.size(); i++) {
-        row_ptr[i] += row_ptr[i - 1];
+    // Per-thread degree histograms, later turned into write cursors
+    std::pmr::vector<IndexT> counts(num_threads * num_vertices, 0, &arena);
+    std::pmr::vector<size_t> block_offset(num_threads + 1, 0, &arena);
+
+    ParallelFor(num_threads, [&](size_t t) {
+        auto [begin, end] = ChunkRange(num_edges, num_threads, t);
+        IndexT *count = counts.data() + t * num_vertices;
+        for (size_t i = begin; i < end; i++) {
+            count[edges[i].first]++;
+            count[edges[i].second]++;
+        }
+    });
+
+    // Sum the histograms into the vertex degrees, replacing each count by the
+    // offset of the thread within the row
+    ParallelFor(num_threads, [&](size_t t) {
+        auto [begin, end] = ChunkRange(num_vertices, num_threads, t);
+        size_t block_total = 0;
+        for (size_t v = begin; v < end; v++) {
+            IndexT degree = 0;
+            for (size_t s = 0; s < num_threads; s++) {
+                IndexT count = counts[s * num_vertices + v];
+                counts[s * num_vertices + v] = degree;
+                degree += count;
+            }
+            csr.row_ptr[v] = degree;
+            block_total += degree;
+        }
+        block_offset[t + 1] = block_total;
+    });
+
+    for (size_t t = 1; t <= num_threads; t++) {
+        block_offset[t] += block_offset[t - 1];
     }
 
-    // Resize the CSR col_indumn index vector and edge ID vector to hold the
-    // total number of edges
-    int numEdges = row_ptr.back();
-    col_ind.resize(numEdges);
+    // Scan the degrees of each block of vertices into the row pointers and
+    // make the per-thread offsets absolute
+    ParallelFor(num_threads, [&](size_t t) {
+        auto [begin, end] = ChunkRange(num_vertices, num_threads, t);
+        size_t offset = block_offset[t];
+        for (size_t v = begin; v < end; v++) {
+            IndexT degree = csr.row_ptr[v];
+            csr.row_ptr[v] = static_cast<IndexT>(offset);
+            for (size_t s = 0; s < num_threads; s++) {
+                counts[s * num_vertices + v] += static_cast<IndexT>(offset);
+            }
+            offset += degree;
+        }
+    });
+    csr.row_ptr[num_vertices] = static_cast<IndexT>(block_offset.back());
+
+    ParallelFor(num_threads, [&](size_t t) {
+        auto [begin, end] = ChunkRange(num_edges, num_threads, t);
+        scatter(begin, end, counts.data() + t * num_vertices);
+    });
+}
+
+/**
+ * @brief Build the CSR adjacency matrix of an undirected edge list.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param num_vertices The number of vertices (rows) of the matrix.
+ * @param edges A span of pairs of vertex indices.
+ * @param with_ids Also fill the edge ID of every entry.
+ * @param num_threads The number of threads to use, 0 meaning one per hardware
+ * thread.
+ * @return The CSR matrix, allocated from the default memory resource.
+ */
+template <typename IndexT>
+CSRMatrix<IndexT> BuildCSR(size_t num_vertices,
+                           std::span<const std::pair<IndexT, IndexT>> edges,
+                           bool with_ids, size_t num_threads = 1) {
+    CSRMatrix<IndexT> csr;
+    BuildCSR(num_vertices, edges, with_ids, num_threads, csr);
+    return csr;
+}
 
-    // Fill the CSR col_indumn index and edge ID vectors with the endpoints and
-    // IDs of the edges
-    std::vector<size_t> next(row_ptr.begin(), row_ptr.end());
+/**
+ * @brief Build the CSR adjacency matrix of an undirected edge list.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param num_vertices The number of vertices (rows) of the matrix.
+ * @param edges A vector of pairs of vertex indices.
+ * @param with_ids Also fill the edge ID of every entry.
+ * @param num_threads The number of threads to use, 0 meaning one per hardware
+ * thread.
+ * @return The CSR matrix.
+ */
+template <typename IndexT>
+CSRMatrix<IndexT> BuildCSR(size_t num_vertices,
+                           const std::vector<std::pair<IndexT, IndexT>> &edges,
+                           bool with_ids, size_t num_threads = 1) {
+    return BuildCSR(num_vertices,
+                    std::span<const std::pair<IndexT, IndexT>>(edges), with_ids,
+                    num_threads);
+}
 
-    for (size_t i = 0; i < edges.size(); i++) {
-        const auto &edge = edges[i];
-        col_ind[next[edge.first]] = edge.second;
-        next[edge.first]++;
+/**
+ * @brief Sort each row of a symmetric CSR matrix by column.
+ *
+ * The matrix of an undirected edge list is its own transpose. Scattering the
+ * rows in increasing row order into the transpose therefore fills every row
+ * in increasing column order, which sorts all rows in O(V + E) time without
+ * comparisons. Entries with equal columns keep their relative order, so
+ * parallel edges stay in edge list order. The unsorted entries are copied to
+ * the `ScratchArena` of the calling thread and scattered back, so the arrays
+ * of `csr` are reused.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ * @param csr The matrix, as built by `BuildCSR`, sorted in place.
+ */
+template <typename IndexT> void SortSymmetricCSRRows(CSRMatrix<IndexT> &csr) {
+    const bool with_ids = !csr.ids.empty();
+    ScratchArena &arena = ScratchArena::ForThisThread();
+    ScratchArena::Scope scope(arena);
+    std::pmr::vector<IndexT> col(csr.col.begin(), csr.col.end(), &arena);
+    std::pmr::vector<IndexT> ids(csr.ids.begin(), csr.ids.end(), &arena);
+    std::pmr::vector<IndexT> next(csr.row_ptr.begin(), csr.row_ptr.end() - 1,
+                                  &arena);
+    for (size_t u = 0; u + 1 < csr.row_ptr.size(); u++) {
+        for (size_t k = csr.row_ptr[u]; k < csr.row_ptr[u + 1]; k++) {
+            const IndexT slot = next[col[k]]++;
+            csr.col[slot] = static_cast<IndexT>(u);
+            if (with_ids) {
+                csr.ids[slot] = ids[k];
+            }
+        }
+    }
+}
 
-        col_ind[next[edge.second]] = edge.first;
-        next[edge.second]++;
+/**
+ * @brief Find the first entry with a given column in a sorted CSR row.
+ *
+ * The search halves the range without branching on the comparisons, so that
+ * it compiles to conditional moves and its cost only depends on the length
+ * of the row.
+ *
+ * @param col The column array of the matrix.
+ * @param begin The first entry of the row.
+ * @param end One past the last entry of the row.
+ * @param value The column to find.
+ * @return The position of the entry, or `end` if the row does not contain
+ * `value`.
+ */
+template <typename IndexT>
+size_t FindInSortedRow(const IndexT *col, size_t begin, size_t end,
+                       size_t value) {
+    if (begin == end) {
+        return end;
     }
+    size_t base = begin;
+    for (size_t n = end - begin; n > 1;) {
+        const size_t half = n / 2;
+        base = col[base + half - 1] < value ? base + half : base;
+        n -= half;
+    }
+    return col[base] == value ? base : end;
+}
 
-    return std::make_tuple(row_ptr, col_ind);
+/**
+ * @brief Convert an undirected edge list into a CSR adjacency matrix.
+ *
+ * This keeps the original signature for compatibility, so the arrays built
+ * by `BuildCSR` are copied into the returned vectors. The graph classes call
+ * `BuildCSR` directly, which avoids the copy.
+ *
+ * @param num_vertices The number of vertices (rows) of the matrix.
+ * @param edges A vector of pairs of vertex indices.
+ * @param num_threads The number of threads to use, 0 meaning one per hardware
+ * thread.
+ * @return The CSR row pointer and column index vectors.
+ */
+inline std::tuple<std::vector<size_t>, std::vector<size_t>>
+ConvertEdgeListToCSR(size_t num_vertices,
+                     const std::vector<std::pair<size_t, size_t>> &edges,
+                     size_t num_threads = 1) {
+    auto csr = BuildCSR(num_vertices, edges, false, num_threads);
+    return std::make_tuple(
+        std::vector<size_t>(csr.row_ptr.begin(), csr.row_ptr.end()),
+        std::vector<size_t>(csr.col.begin(), csr.col.end()));
 }
 
 }; // namespace Utils
@@ -0,0 +1,511 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SparseGraph.hpp"
+
+namespace Plaquette {
+
+/**
+ * @class WindowedDecodingGraph
+ * @brief A decoding graph over a sliding window of time layers.
+ *
+ * The graph holds up to `num_layers` consecutive layers of
+ * `vertices_per_layer` vertices each, e.g. the detectors of one syndrome
+ * round. New layers are appended at the end of the window and the oldest
+ * layers are retired from its start, so that a decoder can follow a stream
+ * of syndrome rounds without ever rebuilding the whole graph.
+ *
+ * Every layer occupies a slot of a ring buffer, and vertex and edge IDs are
+ * positions in that ring buffer: vertex `i` of a layer stored in slot `s` has
+ * ID `s * vertices_per_layer + i`, and the `k`-th edge appended with it has
+ * ID `s * max_edges_per_layer + k`. IDs are therefore reused once a layer is
+ * retired, and `GetVertex` and `GetLayerOfVertex` convert between IDs and
+ * absolute layer indices.
+ *
+ * Each vertex has a row of `max_degree` entries in the vertex-vertex
+ * adjacency matrix, of which the first `degree` are in use. All arrays are
+ * allocated once at construction and updated in place: appending a layer
+ * writes the rows of its vertices and appends its edges to the rows of the
+ * previous layer, and retiring a layer clears its rows and removes its edges
+ * from the rows of the next layer. The cost of both operations is
+ * proportional to the size of the layers involved, not to the size of the
+ * window.
+ *
+ * As in `DecodingGraph`, local edge IDs number the half-edges, and are the
+ * positions of the half-edges in the adjacency matrix. The maps between
+ * global and local edges and the boundary flags are updated together with the
+ * rows. Boundary vertices belong to layers like any other vertex, since a
+ * single boundary vertex shared by all layers would have an unbounded degree.
+ *
+ * The class provides the read interface of `DecodingGraph`, so that it can be
+ * used with e.g. `ShortestPaths`. Vertices and edges of retired layers have
+ * empty rows and are reported as inactive.
+ *
+ * @tparam IndexT Unsigned integer type of the stored indices.
+ */
+template <typename IndexT = size_t> class WindowedDecodingGraph {
+    static_assert(std::is_unsigned_v<IndexT>,
+                  "WindowedDecodingGraph index type must be an unsigned "
+                  "integer");
+
+  public:
+    using index_type = IndexT;
+    using row_type = SparseGraphRow<IndexT>;
+    using edge_type = std::pair<IndexT, IndexT>;
+    using weight_type = EdgeWeight;
+
+    /**
+     * @brief Index of missing vertices and edges.
+     */
+    static constexpr IndexT kInvalidIndex = std::numeric_limits<IndexT>::max();
+
+    /**
+     * @brief Layer index of vertices outside the window.
+     */
+    static constexpr size_t kNoLayer = std::numeric_limits<size_t>::max();
+
+    WindowedDecodingGraph() = default;
+
+    /**
+     * @brief Construct an empty window.
+     *
+     * @param vertices_per_layer The number of vertices of every layer.
+     * @param num_layers The maximum number of layers in the window.
+     * @param max_edges_per_layer The maximum number of edges appended with a
+     * layer.
+     * @param max_degree The maximum number of edges touching a vertex.
+     * @throws std::invalid_argument if a size is zero.
+     * @throws std::overflow_error if the window exceeds the range of `IndexT`.
+     */
+    WindowedDecodingGraph(size_t vertices_per_layer, size_t num_layers,
+                          size_t max_edges_per_layer, size_t max_degree)
+        : vertices_per_layer_(vertices_per_layer), num_slots_(num_layers),
+          max_edges_per_layer_(max_edges_per_layer), max_degree_(max_degree) {
+        if (vertices_per_layer == 0 || num_layers == 0 ||
+            max_edges_per_layer == 0 || max_degree == 0) {
+            throw std::invalid_argument(
+                "WindowedDecodingGraph: sizes must be positive");
+        }
+        const size_t num_vertices = CheckedProduct_(
+            vertices_per_layer, num_layers, "number of vertices");
+        const size_t num_edges = CheckedProduct_(
+            max_edges_per_layer, num_layers, "number of edges");
+        const size_t num_local_edges =
+            CheckedProduct_(num_vertices, max_degree, "number of half-edges");
+        CheckedProduct_(num_edges, 2, "number of half-edges");
+
+        degree_.assign(num_vertices, 0);
+        vertex_boundary_type_.assign(num_vertices, 0);
+        v_to_v_col_.assign(num_local_edges, kInvalidIndex);
+        v_to_v_edges_.assign(num_local_edges, kInvalidIndex);
+        e_to_v_.assign(num_edges, {kInvalidIndex, kInvalidIndex});
+        edge_weights_.assign(num_edges, 0);
+        global_to_local_edge_map_.assign(2 * num_edges, kInvalidIndex);
+        added_degree_.assign(2 * vertices_per_layer, 0);
+    }
+
+    /**
+     * @brief Append a layer at the end of the window.
+     *
+     * The endpoints of the edges index the concatenation of the previous
+     * layer and the new layer: `i < vertices_per_layer` is vertex `i` of the
+     * previous layer, and `vertices_per_layer + i` is vertex `i` of the new
+     * layer. Every edge must touch the new layer, and edges are taken as they
+     * are, without removing duplicates. The layer is validated before the
+     * graph is modified, so a failed call leaves the window unchanged.
+     *
+     * @param edges A vector of pairs of vertices or a `FlatEdgeList`.
+     * @param weights The weight of every edge, or empty for unit weights.
+     * @param boundary The boundary flag of every vertex of the new layer.
+     * @return The absolute index of the new layer, counting every layer
+     * appended since construction.
+     * @throws std::length_error if the window is full, if there are more
+     * than `max_edges_per_layer` edges, or if a vertex would exceed
+     * `max_degree` edges.
+     * @throws std::invalid_argument if the sizes of `weights` or `boundary`
+     * are wrong, or if an edge does not touch the new layer or touches the
+     * previous layer of the first layer in the window.
+     */
+    template <typename EdgeList>
+    size_t AppendLayer(const EdgeList &edges,
+                       std::span<const weight_type> weights,
+                       const std::vector<bool> &boundary) {
+        ValidateLayer_(edges, weights, boundary);
+
+        const size_t slot = (first_slot_ + num_layers_) % num_slots_;
+        const size_t base = slot * vertices_per_layer_;
+        const size_t previous_base =
+            ((slot + num_slots_ - 1) % num_slots_) * vertices_per_layer_;
+        for (size_t i = 0; i < vertices_per_layer_; i++) {
+            vertex_boundary_type_[base + i] = boundary[i];
+        }
+
+        auto vertex = [&](size_t v) {
+            return static_cast<IndexT>(v < vertices_per_layer_
+                                           ? previous_base + v
+                                           : base + v - vertices_per_layer_);
+        };
+        for (size_t k = 0; k < edges.size(); k++) {
+            const auto &[u, v] = edges[k];
+            const size_t e = slot * max_edges_per_layer_ + k;
+            const IndexT a = vertex(u);
+            const IndexT b = vertex(v);
+            e_to_v_[e] = {a, b};
+            edge_weights_[e] = weights.empty() ? 1 : weights[k];
+            global_to_local_edge_map_[2 * e] = AddHalfEdge_(a, b, e);
+            global_to_local_edge_map_[2 * e + 1] = AddHalfEdge_(b, a, e);
+        }
+        num_layers_++;
+        return first_layer_ + num_layers_ - 1;
+    }
+
+    template <typename EdgeList>
+    size_t AppendLayer(const EdgeList &edges,
+                       const std::vector<bool> &boundary) {
+        return AppendLayer(edges, {}, boundary);
+    }
+
+    /**
+     * @brief Retire the oldest layer of the window.
+     *
+     * The rows and boundary flags of its vertices are cleared, and its edges,
+     * as well as the edges of the next layer that touch it, are removed.
+     *
+     * @throws std::logic_error if the window is empty.
+     */
+    void RetireLayer() {
+        if (num_layers_ == 0) {
+            throw std::logic_error("WindowedDecodingGraph: window is empty");
+        }
+        const size_t slot = first_slot_;
+        const size_t base = slot * vertices_per_layer_;
+
+        // The rows of the layer hold its own edges and the edges of the next
+        // layer to it, since the edges to the previous layer were removed
+        // when that layer was retired
+        for (size_t v = base; v < base + vertices_per_layer_; v++) {
+            for (size_t k = 0; k < degree_[v]; k++) {
+                const size_t local = v * max_degree_ + k;
+                ClearEdge_(v_to_v_edges_[local]);
+                v_to_v_col_[local] = kInvalidIndex;
+                v_to_v_edges_[local] = kInvalidIndex;
+            }
+            degree_[v] = 0;
+            vertex_boundary_type_[v] = 0;
+        }
+
+        first_slot_ = (first_slot_ + 1) % num_slots_;
+        first_layer_++;
+        num_layers_--;
+        if (num_layers_ > 0) {
+            RemoveEdgesToSlot_(first_slot_, slot);
+        }
+    }
+
+    // Check whether no more layers can be appended before one is retired
+    bool IsFull() const { return num_layers_ == num_slots_; }
+
+    // Get the number of layers in the window
+    size_t GetNumLayers() const { return num_layers_; }
+
+    // Get the maximum number of layers in the window
+    size_t GetLayerCapacity() const { return num_slots_; }
+
+    // Get the absolute index of the oldest layer in the window
+    size_t GetFirstLayer() const { return first_layer_; }
+
+    // Get the number of vertices of every layer
+    size_t GetVerticesPerLayer() const { return vertices_per_layer_; }
+
+    // Get the maximum number of edges appended with a layer
+    size_t GetMaxEdgesPerLayer() const { return max_edges_per_layer_; }
+
+    // Get the maximum number of edges touching a vertex
+    size_t GetMaxDegree() const { return max_degree_; }
+
+    /**
+     * @brief Get the ID of a vertex of a layer in the window.
+     *
+     * @param layer The absolute index of the layer.
+     * @param index The index of the vertex within the layer.
+     * @throws std::out_of_range if the layer is not in the window or the
+     * index is too large.
+     */
+    IndexT GetVertex(size_t layer, size_t index) const {
+        if (!IsLayerInWindow(layer) || index >= vertices_per_layer_) {
+            throw std::out_of_range(
+                "WindowedDecodingGraph: vertex is not in the window");
+        }
+        return static_cast<IndexT>((layer % num_slots_) * vertices_per_layer_ +
+                                   index);
+    }
+
+    /**
+     * @brief Get the absolute index of the layer of a vertex.
+     *
+     * @return The index of the layer, or `kNoLayer` if the vertex is not part
+     * of a layer in the window.
+     */
+    size_t GetLayerOfVertex(size_t vertex) const {
+        if (!IsVertexActive(vertex)) {
+            return kNoLayer;
+        }
+        const size_t slot = vertex / vertices_per_layer_;
+        return first_layer_ + (slot + num_slots_ - first_slot_) % num_slots_;
+    }
+
+    // Check whether a layer is in the window
+    bool IsLayerInWindow(size_t layer) const {
+        return layer >= first_layer_ && layer < first_layer_ + num_layers_;
+    }
+
+    // Check whether a vertex belongs to a layer in the window
+    bool IsVertexActive(size_t vertex) const {
+        if (vertex >= degree_.size()) {
+            return false;
+        }
+        const size_t slot = vertex / vertices_per_layer_;
+        return (slot + num_slots_ - first_slot_) % num_slots_ < num_layers_;
+    }
+
+    // Check whether an edge connects two vertices of the window
+    bool IsEdgeActive(size_t edge) const {
+        return edge < e_to_v_.size() && e_to_v_[edge].first != kInvalidIndex;
+    }
+
+    // Get the number of vertex IDs, including those of free slots
+    size_t GetNumVertices() const { return degree_.size(); }
+
+    // Get the number of edge IDs, including those of unused edges
+    size_t GetNumEdges() const { return e_to_v_.size(); }
+
+    // Get the number of local edge IDs, including those of unused entries
+    size_t GetNumLocalEdges() const { return v_to_v_col_.size(); }
+
+    /**
+     * @brief Get the edges touching a vertex.
+     */
+    row_type GetEdgesTouchingVertex(size_t vertex_index) const {
+        return row_type(v_to_v_edges_, vertex_index * max_degree_,
+                        vertex_index * max_degree_ + degree_[vertex_index]);
+    }
+
+    /**
+     * @brief Get the vertices connected to a vertex, aligned with
+     * `GetEdgesTouchingVertex`.
+     */
+    row_type GetVerticesTouchingVertex(size_t vertex_index) const {
+        return row_type(v_to_v_col_, vertex_index * max_degree_,
+                        vertex_index * max_degree_ + degree_[vertex_index]);
+    }
+
+    /**
+     * @brief Get the pair of vertices connected by an edge, which is a pair
+     * of `kInvalidIndex` for inactive edges.
+     */
+    const edge_type &GetVerticesConnectedByEdge(size_t edge_index) const {
+        return e_to_v_[edge_index];
+    }
+
+    /**
+     * @brief Get the index of the edge connecting two vertices.
+     *
+     * @return The index of the edge, or `kInvalidIndex` if there is none.
+     */
+    IndexT
+    GetEdgeFromVertexPair(const std::pair<size_t, size_t> &vertex_pair) const {
+        const auto &[u, v] = vertex_pair;
+        if (u >= degree_.size()) {
+            return kInvalidIndex;
+        }
+        const auto &neighbours = GetVerticesTouchingVertex(u);
+        for (size_t k = 0; k < neighbours.size(); k++) {
+            if (neighbours[k] == v) {
+                return v_to_v_edges_[u * max_degree_ + k];
+            }
+        }
+        return kInvalidIndex;
+    }
+
+    // Get the weight of an edge
+    weight_type GetEdgeWeight(size_t edge_index) const {
+        return edge_weights_[edge_index];
+    }
+
+    // Check whether a vertex is a boundary vertex of a layer in the window
+    bool IsVertexOnBoundary(size_t vertex_id) const {
+        return vertex_boundary_type_[vertex_id] != 0;
+    }
+
+    /**
+     * @brief Get the local edge ID of the first half-edge of a vertex.
+     *
+     * The half-edges of the vertex have the local IDs `stride` to
+     * `stride + degree - 1`.
+     */
+    IndexT GetLocalEdgeStride(size_t vertex_id) const {
+        return static_cast<IndexT>(vertex_id * max_degree_);
+    }
+
+    // Get the edge of a half-edge, or kInvalidIndex for unused entries
+    IndexT GetGlobalEdgeFromLocalEdge(size_t local_edge_id) const {
+        return v_to_v_edges_[local_edge_id];
+    }
+
+    /**
+     * @brief Get the local edge ID of one of the two half-edges of an edge.
+     *
+     * @param global_edge_id The index of the edge.
+     * @param which 0 for the half-edge in the row of the first endpoint
+     * returned by `GetVerticesConnectedByEdge`, and 1 for the second.
+     */
+    IndexT GetLocalEdgeFromGlobalEdge(size_t global_edge_id,
+                                      size_t which) const {
+        return global_to_local_edge_map_[2 * global_edge_id + which];
+    }
+
+  private:
+    static size_t CheckedProduct_(size_t a, size_t b, const char *what) {
+        constexpr size_t max = std::numeric_limits<IndexT>::max();
+        if (b != 0 && a > max / b) {
+            throw std::overflow_error(std::string("WindowedDecodingGraph: ") +
+                                      what +
+                                      " exceeds the range of the index type");
+        }
+        return a * b;
+    }
+
+    template <typename EdgeList>
+    void ValidateLayer_(const EdgeList &edges,
+                        std::span<const weight_type> weights,
+                        const std::vector<bool> &boundary) {
+        if (IsFull()) {
+            throw std::length_error("WindowedDecodingGraph: window is full");
+        }
+        if (edges.size() > max_edges_per_layer_) {
+            throw std::length_error(
+                "WindowedDecodingGraph: too many edges in the layer");
+        }
+        if (!weights.empty() && weights.size() != edges.size()) {
+            throw std::invalid_argument(
+                "WindowedDecodingGraph: the number of weights must match the "
+                "number of edges");
+        }
+        if (boundary.size() != vertices_per_layer_) {
+            throw std::invalid_argument(
+                "WindowedDecodingGraph: the number of boundary flags must "
+                "match the number of vertices per layer");
+        }
+
+        // Count the new half-edges of the previous and new layers
+        const size_t n = vertices_per_layer_;
+        const size_t first = num_layers_ == 0 ? n : 0;
+        std::fill(added_degree_.begin(), added_degree_.end(), 0);
+        for (size_t k = 0; k < edges.size(); k++) {
+            const auto &[u, v] = edges[k];
+            if (u >= 2 * n || v >= 2 * n || u < first || v < first ||
+                (u < n && v < n)) {
+                throw std::invalid_argument(
+                    "WindowedDecodingGraph: edge " + std::to_string(k) +
+                    " must connect the new layer to itself or to the "
+                    "previous layer");
+            }
+            added_degree_[u]++;
+            added_degree_[v]++;
+        }
+
+        const size_t slot = (first_slot_ + num_layers_) % num_slots_;
+        const size_t previous_base =
+            ((slot + num_slots_ - 1) % num_slots_) * vertices_per_layer_;
+        for (size_t i = 0; i < 2 * n; i++) {
+            const size_t degree =
+                i < n && num_layers_ > 0 ? degree_[previous_base + i] : 0;
+            if (degree + added_degree_[i] > max_degree_) {
+                throw std::length_error(
+                    "WindowedDecodingGraph: vertex degree exceeds the "
+                    "maximum degree");
+            }
+        }
+    }
+
+    // Append the half-edge of edge `e` from `u` to `v` to the row of `u`,
+    // returning its local edge ID
+    IndexT AddHalfEdge_(IndexT u, IndexT v, size_t e) {
+        const size_t local = u * max_degree_ + degree_[u]++;
+        v_to_v_col_[local] = v;
+        v_to_v_edges_[local] = static_cast<IndexT>(e);
+        return static_cast<IndexT>(local);
+    }
+
+    void ClearEdge_(IndexT e) {
+        e_to_v_[e] = {kInvalidIndex, kInvalidIndex};
+        global_to_local_edge_map_[2 * e] = kInvalidIndex;
+        global_to_local_edge_map_[2 * e + 1] = kInvalidIndex;
+    }
+
+    // Remove the entries pointing to the vertices of slot `retired` from the
+    // rows of the vertices of slot `slot`, keeping the order of the others
+    void RemoveEdgesToSlot_(size_t slot, size_t retired) {
+        const size_t base = slot * vertices_per_layer_;
+        for (size_t v = base; v < base + vertices_per_layer_; v++) {
+            const size_t row = v * max_degree_;
+            size_t kept = 0;
+            for (size_t k = 0; k < degree_[v]; k++) {
+                const IndexT u = v_to_v_col_[row + k];
+                const IndexT e = v_to_v_edges_[row + k];
+                if (u / vertices_per_layer_ == retired) {
+                    ClearEdge_(e);
+                    continue;
+                }
+                if (kept != k) {
+                    v_to_v_col_[row + kept] = u;
+                    v_to_v_edges_[row + kept] = e;
+                    const size_t which =
+                        global_to_local_edge_map_[2 * e] == row + k ? 0 : 1;
+                    global_to_local_edge_map_[2 * e + which] =
+                        static_cast<IndexT>(row + kept);
+                }
+                kept++;
+            }
+            for (size_t k = kept; k < degree_[v]; k++) {
+                v_to_v_col_[row + k] = kInvalidIndex;
+                v_to_v_edges_[row + k] = kInvalidIndex;
+            }
+            degree_[v] = static_cast<IndexT>(kept);
+        }
+    }
+
+    size_t vertices_per_layer_ = 0;
+    size_t num_slots_ = 0;
+    size_t max_edges_per_layer_ = 0;
+    size_t max_degree_ = 0;
+
+    /** @brief the window, as a range of slots of the ring buffer */
+    size_t first_slot_ = 0;
+    size_t first_layer_ = 0;
+    size_t num_layers_ = 0;
+
+    /** @brief rows of `max_degree_` entries, of which `degree_` are used */
+    std::vector<IndexT> degree_;
+    std::vector<IndexT> v_to_v_col_;
+    std::vector<IndexT> v_to_v_edges_;
+
+    std::vector<edge_type> e_to_v_;
+    std::vector<weight_type> edge_weights_;
+    std::vector<IndexT> global_to_local_edge_map_;
+    std::vector<uint8_t> vertex_boundary_type_;
+
+    /** @brief scratch space to validate the degrees of a new layer */
+    std::vector<size_t> added_degree_;
+};
+
+}; // namespace Plaquette
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SyntheticGraphs.hpp"
+
+namespace Plaquette {
+namespace Benchmarks {
+
+/**
+ * @brief The timings of one benchmark on one graph.
+ */
+struct BenchmarkResult {
+    std::string name;
+    std::string index_type;
+    std::string family;
+    size_t distance;
+    size_t rounds;
+    size_t num_vertices;
+    size_t num_edges;
+    size_t items; ///< Number of items (queries, edges, ...) per repetition.
+    std::vector<double> times_ns;
+
+    double Min() const {
+        return *std::min_element(times_ns.begin(), times_ns.end());
+    }
+
+    double Median() const {
+        std::vector<double> sorted = times_ns;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t n = sorted.size();
+        return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    }
+
+    double Mean() const {
+        return std::accumulate(times_ns.begin(), times_ns.end(), 0.0) /
+               static_cast<double>(times_ns.size());
+    }
+};
+
+/**
+ * @brief Runs benchmarks and collects their timings.
+ *
+ * Every benchmark is repeated a fixed number of times after one warm-up run.
+ * The benchmarked callable returns a checksum, which is accumulated so that
+ * the compiler cannot optimise the measured work away.
+ */
+class BenchmarkSuite {
+  public:
+    BenchmarkSuite(size_t repetitions, std::string filter = "")
+        : repetitions_(std::max<size_t>(repetitions, 1)),
+          filter_(std::move(filter)) {}
+
+    /**
+     * @brief Time `fn(setup())`, excluding the time spent in `setup`.
+     *
+     * @param name The name of the benchmark.
+     * @param index_type The name of the index type of the graph.
+     * @param graph The input graph.
+     * @param items The number of items processed by one call of `fn`.
+     * @param setup Callable creating the (untimed) state of one repetition.
+     * @param fn Callable taking the state by reference and returning a
+     * checksum.
+     */
+    template <typename Setup, typename Fn>
+    void RunWithSetup(const std::string &name, const std::string &index_type,
+                      const SyntheticGraph &graph, size_t items, Setup &&setup,
+                      Fn &&fn) {
+        if (name.find(filter_) == std::string::npos) {
+            return;
+        }
+
+        BenchmarkResult result{name,
+                               index_type,
+                               graph.family,
+                               graph.distance,
+                               graph.rounds,
+                               graph.num_vertices,
+                               graph.edges.size(),
+                               items,
+                               {}};
+        for (size_t r = 0; r <= repetitions_; r++) {
+            auto state = setup();
+            const auto start = std::chrono::steady_clock::now();
+            checksum_ += fn(state);
+            const auto stop = std::chrono::steady_clock::now();
+            if (r > 0) {
+                result.times_ns.push_back(
+                    std::chrono::duration<double, std::nano>(stop - start)
+                        .count());
+            }
+        }
+        results_.push_back(std::move(result));
+    }
+
+    /**
+     * @brief Time `fn()`.
+     */
+    template <typename Fn>
+    void Run(const std::string &name, const std::string &index_type,
+             const SyntheticGraph &graph, size_t items, Fn &&fn) {
+        RunWithSetup(
+            name, index_type, graph, items, [] { return 0; },
+            [&](int) { return fn(); });
+    }
+
+    const std::vector<BenchmarkResult> &GetResults() const { return results_; }
+
+    size_t GetChecksum() const { return checksum_; }
+
+    /**
+     * @brief Write the results as a JSON document.
+     */
+    void WriteJson(std::ostream &out) const {
+        out << "{\n  \"context\": {\n";
+        out << "    \"repetitions\": " << repetitions_ << ",\n";
+        out << "    \"hardware_concurrency\": "
+            << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+        out << "    \"assertions\": false,\n";
+#else
+        out << "    \"assertions\": true,\n";
+#endif
+        out << "    \"compiler\": \"" << Escape_(__VERSION__) << "\",\n";
+        out << "    \"checksum\": " << checksum_ << "\n  },\n";
+        out << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results_.size(); i++) {
+            const auto &r = results_[i];
+            out << (i ? ",\n" : "\n") << "    {";
+            out << "\"name\": \"" << Escape_(r.name) << "\", ";
+            out << "\"index_type\": \"" << r.index_type << "\", ";
+            out << "\"family\": \"" << r.family << "\", ";
+            out << "\"distance\": " << r.distance << ", ";
+            out << "\"rounds\": " << r.rounds << ", ";
+            out << "\"num_vertices\": " << r.num_vertices << ", ";
+            out << "\"num_edges\": " << r.num_edges << ", ";
+            out << "\"items\": " << r.items << ", ";
+            out << "\"min_ns\": " << r.Min() << ", ";
+            out << "\"median_ns\": " << r.Median() << ", ";
+            out << "\"mean_ns\": " << r.Mean() << ", ";
+            const auto items = std::max<size_t>(r.items, 1);
+            out << "\"median_ns_per_item\": "
+                << r.Median() / static_cast<double>(items) << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+  private:
+    static std::string Escape_(const std::string &text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    size_t repetitions_;
+    std::string filter_;
+    std::vector<BenchmarkResult> results_;
+    size_t checksum_ = 0;
+};
+
+}; // namespace Benchmarks
+}; // namespace Plaquette
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Generators.hpp"
+
+namespace Plaquette {
+namespace Benchmarks {
+
+/**
+ * @brief A synthetic decoding graph used as benchmark input.
+ *
+ * Every graph has a single boundary vertex, which is the last vertex.
+ */
+struct SyntheticGraph {
+    std::string family;
+    size_t distance;
+    size_t rounds;
+    size_t num_vertices;
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<bool> boundary;
+    Generators::SpaceTimeLayout layout;
+};
+
+/**
+ * @brief Connect `rounds` copies of a single-round graph with time-like edges
+ * between copies of the same detector and add the shared boundary vertex.
+ *
+ * The edges are listed in the order in which `Generators::SpaceTimeGraph`
+ * numbers them, so that both build the same graph.
+ *
+ * @param family The name of the code family.
+ * @param distance The code distance.
+ * @param rounds The number of measurement rounds.
+ * @param layout The decoding graph of one round.
+ */
+inline SyntheticGraph
+MakeSpaceTimeGraph_(const std::string &family, size_t distance, size_t rounds,
+                    const Generators::SpaceTimeLayout &layout) {
+    SyntheticGraph graph{family, distance, rounds, 0, {}, {}, layout};
+    const size_t detectors_per_round = layout.detectors_per_round;
+    const size_t boundary = rounds * detectors_per_round;
+    graph.num_vertices = boundary + 1;
+    graph.boundary.assign(graph.num_vertices, false);
+    graph.boundary[boundary] = true;
+
+    auto vertex = [&](size_t round, size_t detector) {
+        return detector == detectors_per_round
+                   ? boundary
+                   : round * detectors_per_round + detector;
+    };
+    for (size_t r = 0; r < rounds; r++) {
+        for (const auto &[u, v] : layout.space_edges) {
+            graph.edges.emplace_back(vertex(r, u), vertex(r, v));
+        }
+        if (r + 1 < rounds) {
+            for (size_t d = 0; d < detectors_per_round; d++) {
+                graph.edges.emplace_back(vertex(r, d), vertex(r + 1, d));
+            }
+        }
+    }
+    return graph;
+}
+
+/**
+ * @brief The phenomenological decoding graph of a distance-`distance`
+ * repetition code measured for `rounds` rounds.
+ */
+inline SyntheticGraph RepetitionCodeGraph(size_t distance, size_t rounds) {
+    return MakeSpaceTimeGraph_("repetition_code", distance, rounds,
+                               Generators::RepetitionCodeLayout(distance));
+}
+
+/**
+ * @brief The phenomenological decoding graph of one stabilizer type of a
+ * distance-`distance` planar surface code measured for `rounds` rounds.
+ *
+ * @see Generators::SurfaceCodeLayout
+ */
+inline SyntheticGraph SurfaceCodeGraph(size_t distance, size_t rounds) {
+    return MakeSpaceTimeGraph_("surface_code", distance, rounds,
+                               Generators::SurfaceCodeLayout(distance));
+}
+
+}; // namespace Benchmarks
+}; // namespace Plaquette
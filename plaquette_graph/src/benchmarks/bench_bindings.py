@@ -0,0 +1,146 @@
+"""Benchmarks of the overhead of the Python bindings.
+
+Compares the construction of graphs from Python lists and from NumPy arrays,
+and per-call queries with their batched counterparts, on the phenomenological
+decoding graph of a surface code. The results are printed as JSON.
+
+Usage: python bench_bindings.py [--distances 5 11 21] [--repetitions 5]
+                                [--output FILE]
+"""
+
+import argparse
+import json
+import statistics
+import time
+
+import numpy as np
+import plaquette_graph as pcg
+
+
+def surface_code_graph(distance, rounds):
+    """Return the number of vertices, the edges and the boundary flags of the
+    phenomenological decoding graph of a planar surface code.
+
+    Mirrors ``SurfaceCodeGraph`` in ``SyntheticGraphs.hpp``.
+    """
+    rows, cols = distance, distance - 1
+    detectors = rows * cols
+    boundary = rounds * detectors
+
+    space_edges = []
+    for row in range(rows):
+        space_edges.append((detectors, row * cols))
+        space_edges.extend((row * cols + c, row * cols + c + 1) for c in range(cols - 1))
+        space_edges.append((row * cols + cols - 1, detectors))
+    for row in range(rows - 1):
+        space_edges.extend((row * cols + c, (row + 1) * cols + c) for c in range(cols))
+
+    def vertex(r, d):
+        return boundary if d == detectors else r * detectors + d
+
+    edges = []
+    for r in range(rounds):
+        edges.extend((vertex(r, u), vertex(r, v)) for u, v in space_edges)
+        if r + 1 < rounds:
+            edges.extend((vertex(r, d), vertex(r + 1, d)) for d in range(detectors))
+    is_boundary = [False] * boundary + [True]
+    return boundary + 1, edges, is_boundary
+
+
+def measure(fn, repetitions):
+    """Return the timings of ``repetitions`` calls of ``fn`` in nanoseconds,
+    after one warm-up call."""
+    fn()
+    times = []
+    for _ in range(repetitions):
+        start = time.perf_counter_ns()
+        fn()
+        times.append(time.perf_counter_ns() - start)
+    return times
+
+
+def benchmark_graph(distance, repetitions):
+    num_vertices, edges, is_boundary = surface_code_graph(distance, distance)
+    edge_array = np.asarray(edges, dtype=np.uint32)
+    graph = pcg.DecodingGraph32(num_vertices, edge_array, is_boundary)
+    vertices = np.arange(num_vertices, dtype=np.uint32)
+    edge_ids = np.arange(len(edges), dtype=np.uint32)
+
+    def per_call_edges_touching_vertex():
+        for v in range(num_vertices):
+            graph.get_edges_touching_vertex(v)
+
+    def per_call_vertices_connected_by_edge():
+        for e in range(len(edges)):
+            graph.get_vertices_connected_by_edge(e)
+
+    cases = {
+        "construct/list": (
+            len(edges),
+            lambda: pcg.DecodingGraph32(num_vertices, edges, is_boundary),
+        ),
+        "construct/numpy": (
+            len(edges),
+            lambda: pcg.DecodingGraph32(num_vertices, edge_array, is_boundary),
+        ),
+        "query/edges_touching_vertex": (num_vertices, per_call_edges_touching_vertex),
+        "query/edges_touching_vertices_batch": (
+            num_vertices,
+            lambda: graph.get_edges_touching_vertices(vertices),
+        ),
+        "query/vertices_connected_by_edge": (len(edges), per_call_vertices_connected_by_edge),
+        "query/vertices_connected_by_edges_batch": (
+            len(edges),
+            lambda: graph.get_vertices_connected_by_edges(edge_ids),
+        ),
+        "query/edges_from_vertex_pairs_batch": (
+            len(edges),
+            lambda: graph.get_edges_from_vertex_pairs(edge_array),
+        ),
+        "view/e_to_v": (1, lambda: graph.e_to_v),
+    }
+
+    results = []
+    for name, (items, fn) in cases.items():
+        times = measure(fn, repetitions)
+        median = statistics.median(times)
+        results.append(
+            {
+                "name": name,
+                "family": "surface_code",
+                "distance": distance,
+                "rounds": distance,
+                "num_vertices": num_vertices,
+                "num_edges": len(edges),
+                "items": items,
+                "min_ns": min(times),
+                "median_ns": median,
+                "median_ns_per_item": median / items,
+            }
+        )
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--distances", type=int, nargs="+", default=[5, 11, 21])
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--output", help="write the results to this file")
+    args = parser.parse_args()
+
+    benchmarks = []
+    for distance in args.distances:
+        benchmarks.extend(benchmark_graph(distance, args.repetitions))
+    document = json.dumps(
+        {"context": {"repetitions": args.repetitions}, "benchmarks": benchmarks},
+        indent=2,
+    )
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(document + "\n")
+    else:
+        print(document)
+
+
+if __name__ == "__main__":
+    main()
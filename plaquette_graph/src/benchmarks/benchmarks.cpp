@@ -0,0 +1,554 @@
+/**
+ * @file benchmarks.cpp
+ *
+ * @brief Benchmarks of the construction and query hot paths of the graphs.
+ *
+ * The benchmarks run on the phenomenological decoding graphs of repetition
+ * and surface codes at several distances, with as many rounds as the
+ * distance, and are written as JSON to stdout or to the file given with
+ * `--output`.
+ *
+ * Usage: plaquette_graph_benchmarks [--output FILE] [--repetitions N]
+ *                                   [--filter SUBSTRING] [--quick]
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "ClusterGrowth.hpp"
+#include "CompressedSparseGraph.hpp"
+#include "DecodingGraph.hpp"
+#include "Generators.hpp"
+#include "MultiGraph.hpp"
+#include "Reordering.hpp"
+#include "ShortestPaths.hpp"
+#include "SparseGraph.hpp"
+#include "SyndromeBatch.hpp"
+#include "SyntheticGraphs.hpp"
+#include "Utils.hpp"
+#include "WindowedDecodingGraph.hpp"
+
+using namespace Plaquette;
+using namespace Plaquette::Benchmarks;
+
+namespace {
+
+template <typename IndexT> const char *IndexTypeName() {
+    return sizeof(IndexT) == 4 ? "uint32" : "uint64";
+}
+
+// The vertex pairs of all edges of a graph, in a fixed random order
+std::vector<std::pair<size_t, size_t>>
+ShuffledVertexPairs(const SyntheticGraph &graph) {
+    auto pairs = graph.edges;
+    std::mt19937_64 rng(1234);
+    std::shuffle(pairs.begin(), pairs.end(), rng);
+    return pairs;
+}
+
+template <typename IndexT>
+void BenchmarkConstruction(BenchmarkSuite &suite, const SyntheticGraph &graph) {
+    const std::string index_type = IndexTypeName<IndexT>();
+    const size_t num_vertices = graph.num_vertices;
+    const size_t num_edges = graph.edges.size();
+
+    suite.Run("construct/sparse_graph", index_type, graph, num_edges, [&] {
+        SparseGraph<IndexT> g(num_vertices, graph.edges);
+        return g.GetNumEdges();
+    });
+
+    suite.Run("construct/sparse_graph_assume_unique", index_type, graph,
+              num_edges, [&] {
+                  SparseGraphOptions options;
+                  options.assume_unique_edges = true;
+                  SparseGraph<IndexT> g(num_vertices, graph.edges, options);
+                  return g.GetNumEdges();
+              });
+
+    std::vector<uint64_t> flat;
+    for (const auto &[u, v] : graph.edges) {
+        flat.push_back(u);
+        flat.push_back(v);
+    }
+    suite.Run("construct/sparse_graph_flat_array", index_type, graph,
+              num_edges, [&] {
+                  FlatEdgeList<uint64_t> edges(flat.data(), num_edges);
+                  SparseGraph<IndexT> g(num_vertices, edges);
+                  return g.GetNumEdges();
+              });
+
+    std::vector<std::pair<IndexT, IndexT>> typed_edges(graph.edges.begin(),
+                                                       graph.edges.end());
+    suite.Run("construct/vertex_csr", index_type, graph, num_edges, [&] {
+        auto csr = Utils::BuildCSR<IndexT>(num_vertices, typed_edges, true);
+        return csr.col.size();
+    });
+
+    suite.RunWithSetup(
+        "construct/edge_to_edge", index_type, graph, num_edges,
+        [&] { return SparseGraph<IndexT>(num_vertices, graph.edges); },
+        [](SparseGraph<IndexT> &g) {
+            g.ConstructEdgeToEdgeMatrix_();
+            return g.GetEdgeToEdgeCol().size();
+        });
+
+    suite.Run("construct/decoding_graph", index_type, graph, num_edges, [&] {
+        DecodingGraph<IndexT> g(num_vertices, graph.edges, graph.boundary);
+        return g.GetNumLocalEdges();
+    });
+
+    // Monte Carlo sweeps rebuild one graph per sample into the same storage
+    DecodingGraph<IndexT> rebuilt(num_vertices, graph.edges, graph.boundary);
+    suite.Run("construct/decoding_graph_rebuild", index_type, graph, num_edges,
+              [&] {
+                  rebuilt.Rebuild(num_vertices, graph.edges, graph.boundary);
+                  return rebuilt.GetNumLocalEdges();
+              });
+
+    suite.Run("construct/generator", index_type, graph, num_edges, [&] {
+        auto g = Generators::SpaceTimeGraph<IndexT>(graph.layout,
+                                                    {.rounds = graph.rounds});
+        return g.GetNumLocalEdges();
+    });
+
+    suite.RunWithSetup(
+        "construct/local_edge_maps", index_type, graph, num_edges,
+        [&] {
+            return DecodingGraph<IndexT>(num_vertices, graph.edges,
+                                         graph.boundary);
+        },
+        [&](DecodingGraph<IndexT> &g) {
+            g.ConstructLocalEdgeMaps_(graph.boundary);
+            return g.GetNumLocalEdges();
+        });
+}
+
+template <typename IndexT>
+void BenchmarkQueries(BenchmarkSuite &suite, const SyntheticGraph &graph) {
+    const std::string index_type = IndexTypeName<IndexT>();
+    const size_t num_vertices = graph.num_vertices;
+    const size_t num_edges = graph.edges.size();
+
+    DecodingGraph<IndexT> g(num_vertices, graph.edges, graph.boundary);
+    g.ConstructEdgeToEdgeMatrix_();
+
+    suite.Run("query/edges_touching_vertex", index_type, graph, num_vertices,
+              [&] {
+                  size_t sum = 0;
+                  for (size_t v = 0; v < num_vertices; v++) {
+                      for (auto e : g.GetEdgesTouchingVertex(v)) {
+                          sum += e;
+                      }
+                  }
+                  return sum;
+              });
+
+    suite.Run("query/vertices_touching_vertex", index_type, graph,
+              num_vertices, [&] {
+                  size_t sum = 0;
+                  for (size_t v = 0; v < num_vertices; v++) {
+                      for (auto u : g.GetVerticesTouchingVertex(v)) {
+                          sum += u;
+                      }
+                  }
+                  return sum;
+              });
+
+    suite.Run("query/edges_touching_edge", index_type, graph, num_edges, [&] {
+        size_t sum = 0;
+        for (size_t e = 0; e < num_edges; e++) {
+            for (auto f : g.GetEdgesTouchingEdge(e)) {
+                sum += f;
+            }
+        }
+        return sum;
+    });
+
+    suite.Run("query/edges_touching_edge_implicit", index_type, graph,
+              num_edges, [&] {
+                  size_t sum = 0;
+                  for (size_t e = 0; e < num_edges; e++) {
+                      for (auto f : g.GetEdgesTouchingEdgeImplicit(e)) {
+                          sum += f;
+                      }
+                  }
+                  return sum;
+              });
+
+    const auto pairs = ShuffledVertexPairs(graph);
+    suite.Run("query/edge_from_vertex_pair", index_type, graph, num_edges,
+              [&] {
+                  size_t sum = 0;
+                  for (const auto &pair : pairs) {
+                      sum += g.GetEdgeFromVertexPair(pair);
+                  }
+                  return sum;
+              });
+
+    SparseGraphOptions sorted_options;
+    sorted_options.sort_rows = true;
+    const DecodingGraph<IndexT> sorted(num_vertices, graph.edges,
+                                       graph.boundary, sorted_options);
+    suite.Run("query/edge_from_vertex_pair_sorted", index_type, graph,
+              num_edges, [&] {
+                  size_t sum = 0;
+                  for (const auto &pair : pairs) {
+                      sum += sorted.GetEdgeFromVertexPair(pair);
+                  }
+                  return sum;
+              });
+
+    SparseGraphOptions index_options;
+    index_options.edge_index = true;
+    const DecodingGraph<IndexT> indexed(num_vertices, graph.edges,
+                                        graph.boundary, index_options);
+    suite.Run("query/edge_from_vertex_pair_indexed", index_type, graph,
+              num_edges, [&] {
+                  size_t sum = 0;
+                  for (const auto &pair : pairs) {
+                      sum += indexed.GetEdgeFromVertexPair(pair);
+                  }
+                  return sum;
+              });
+
+    std::vector<IndexT> flat_pairs;
+    for (const auto &[u, v] : pairs) {
+        flat_pairs.push_back(u);
+        flat_pairs.push_back(v);
+    }
+    std::vector<IndexT> out(num_edges);
+    suite.Run("query/edges_from_vertex_pairs_batch", index_type, graph,
+              num_edges, [&] {
+                  g.GetEdgesFromVertexPairs(flat_pairs, out);
+                  return static_cast<size_t>(out.back());
+              });
+
+    suite.Run("query/local_global_edge_maps", index_type, graph, num_edges,
+              [&] {
+                  size_t sum = 0;
+                  for (size_t e = 0; e < num_edges; e++) {
+                      for (size_t side = 0; side < 2; side++) {
+                          auto local = g.GetLocalEdgeFromGlobalEdge(e, side);
+                          sum += g.GetGlobalEdgeFromLocalEdge(local);
+                      }
+                  }
+                  return sum;
+              });
+
+    ShortestPaths paths(g);
+    suite.Run("query/distance_to_boundary", index_type, graph, num_vertices,
+              [&] {
+                  size_t sum = 0;
+                  for (size_t v = 0; v < num_vertices; v++) {
+                      sum += paths.GetDistanceToBoundary(v).first;
+                  }
+                  return sum;
+              });
+
+    suite.Run("query/distance_between_neighbours", index_type, graph,
+              num_edges, [&] {
+                  size_t sum = 0;
+                  for (const auto &[u, v] : pairs) {
+                      sum += paths.GetDistance(u, v);
+                  }
+                  return sum;
+              });
+
+    // Shots with every non-boundary vertex flipped with probability 1/20
+    std::mt19937_64 rng(42);
+    std::vector<std::vector<IndexT>> shots(100);
+    size_t num_defects = 0;
+    for (auto &defects : shots) {
+        for (size_t v = 0; v < num_vertices; v++) {
+            if (!graph.boundary[v] && rng() % 20 == 0) {
+                defects.push_back(static_cast<IndexT>(v));
+            }
+        }
+        num_defects += defects.size();
+    }
+    ClusterGrowth growth(g);
+    suite.Run("query/cluster_growth", index_type, graph, shots.size(), [&] {
+        size_t sum = 0;
+        for (const auto &defects : shots) {
+            growth.LoadDefects(defects);
+            growth.GrowUntilNeutral();
+            sum += growth.GetGrownEdges().size();
+        }
+        return sum + num_defects;
+    });
+
+    SyndromeBatch<IndexT> batch(g, shots.size());
+    for (size_t s = 0; s < shots.size(); s++) {
+        for (IndexT v : shots[s]) {
+            batch.SetDetector(s, v);
+        }
+    }
+    suite.Run("query/syndrome_extraction", index_type, graph, shots.size(),
+              [&] { return batch.ExtractDefects().values.size(); });
+}
+
+void BenchmarkMultiGraph(BenchmarkSuite &suite, const SyntheticGraph &graph) {
+    const std::string index_type = IndexTypeName<size_t>();
+    const size_t num_edges = graph.edges.size();
+    std::vector<size_t> weights(num_edges, 1);
+
+    suite.Run("multigraph/construct", index_type, graph, num_edges, [&] {
+        MultiGraph g(graph.edges, weights);
+        return g.GetNumVertices();
+    });
+
+    MultiGraph g(graph.edges, weights);
+    const auto pairs = ShuffledVertexPairs(graph);
+    suite.Run("multigraph/edge_connecting_vertices", index_type, graph,
+              num_edges, [&] {
+                  size_t sum = 0;
+                  for (const auto &[u, v] : pairs) {
+                      sum += g.GetEdgeConnectingVertices(u, v);
+                  }
+                  return sum;
+              });
+
+    suite.Run("multigraph/edges_touching_edge", index_type, graph, num_edges,
+              [&] {
+                  size_t sum = 0;
+                  for (size_t e = 0; e < num_edges; e++) {
+                      for (auto f : g.GetEdgesTouchingEdge(e)) {
+                          sum += f;
+                      }
+                  }
+                  return sum;
+              });
+
+    g.ConstructEdgeToEdgeMatrix();
+    suite.Run("multigraph/edges_touching_edge_row", index_type, graph,
+              num_edges, [&] {
+                  size_t sum = 0;
+                  for (size_t e = 0; e < num_edges; e++) {
+                      for (auto f : g.GetEdgesTouchingEdgeRow(e)) {
+                          sum += f;
+                      }
+                  }
+                  return sum;
+              });
+}
+
+template <typename IndexT>
+void BenchmarkWindow(BenchmarkSuite &suite, const SyntheticGraph &graph) {
+    const std::string index_type = IndexTypeName<IndexT>();
+
+    // One round of the graph as a layer of the window, with its own copy of
+    // the boundary vertex and time-like edges to the previous round
+    const size_t boundary = graph.num_vertices - 1;
+    const size_t detectors_per_round = boundary / graph.rounds;
+    const size_t n = detectors_per_round + 1;
+    auto in_layer = [&](size_t v) {
+        return n + (v == boundary ? detectors_per_round : v);
+    };
+    std::vector<std::pair<size_t, size_t>> layer;
+    for (const auto &[u, v] : graph.edges) {
+        if ((u < detectors_per_round || u == boundary) &&
+            (v < detectors_per_round || v == boundary)) {
+            layer.emplace_back(in_layer(u), in_layer(v));
+        }
+    }
+    const auto first_layer = layer;
+    for (size_t i = 0; i < detectors_per_round; i++) {
+        layer.emplace_back(i, n + i);
+    }
+    std::vector<bool> layer_boundary(n, false);
+    layer_boundary.back() = true;
+
+    // A vertex has the edges of its own layer and of the next one
+    std::vector<size_t> degree(2 * n, 0);
+    for (const auto &[u, v] : layer) {
+        degree[u]++;
+        degree[v]++;
+    }
+    size_t max_degree = 0;
+    for (size_t i = 0; i < n; i++) {
+        max_degree = std::max(max_degree, degree[i] + degree[n + i]);
+    }
+    WindowedDecodingGraph<IndexT> window(n, graph.rounds, layer.size(),
+                                         max_degree);
+    window.AppendLayer(first_layer, layer_boundary);
+    suite.Run("window/append_retire", index_type, graph, graph.rounds, [&] {
+        size_t sum = 0;
+        for (size_t t = 0; t < graph.rounds; t++) {
+            if (window.IsFull()) {
+                window.RetireLayer();
+            }
+            sum += window.AppendLayer(layer, layer_boundary);
+        }
+        return sum;
+    });
+}
+
+template <typename IndexT>
+void BenchmarkCompressed(BenchmarkSuite &suite, const SyntheticGraph &graph) {
+    const std::string index_type = IndexTypeName<IndexT>();
+    const size_t num_vertices = graph.num_vertices;
+    const size_t num_edges = graph.edges.size();
+
+    const SparseGraph<IndexT> g(num_vertices, graph.edges);
+    suite.Run("compressed/construct", index_type, graph, num_edges, [&] {
+        CompressedSparseGraph<IndexT> compressed(g);
+        return compressed.GetCompressedBytes();
+    });
+
+    const CompressedSparseGraph<IndexT> compressed(g, EdgeToEdgeMode::Eager);
+    suite.Run("compressed/vertices_touching_vertex", index_type, graph,
+              num_vertices, [&] {
+                  size_t sum = 0;
+                  for (size_t v = 0; v < num_vertices; v++) {
+                      for (auto u : compressed.GetVerticesTouchingVertex(v)) {
+                          sum += u;
+                      }
+                  }
+                  return sum;
+              });
+
+    suite.Run("compressed/edges_touching_edge", index_type, graph, num_edges,
+              [&] {
+                  size_t sum = 0;
+                  for (size_t e = 0; e < num_edges; e++) {
+                      for (auto f : compressed.GetEdgesTouchingEdge(e)) {
+                          sum += f;
+                      }
+                  }
+                  return sum;
+              });
+
+    const auto pairs = ShuffledVertexPairs(graph);
+    suite.Run("compressed/edge_from_vertex_pair", index_type, graph,
+              num_edges, [&] {
+                  size_t sum = 0;
+                  for (const auto &pair : pairs) {
+                      sum += compressed.GetEdgeFromVertexPair(pair);
+                  }
+                  return sum;
+              });
+}
+
+template <typename IndexT>
+void BenchmarkReordering(BenchmarkSuite &suite, const SyntheticGraph &graph) {
+    const std::string index_type = IndexTypeName<IndexT>();
+    const size_t num_vertices = graph.num_vertices;
+
+    // The graph with shuffled vertex labels, as read from an unordered file
+    std::vector<size_t> label(num_vertices);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), std::mt19937_64(7));
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (const auto &[u, v] : graph.edges) {
+        edges.emplace_back(label[u], label[v]);
+    }
+    std::vector<bool> boundary(num_vertices);
+    for (size_t v = 0; v < num_vertices; v++) {
+        boundary[label[v]] = graph.boundary[v];
+    }
+    const DecodingGraph<IndexT> shuffled(num_vertices, edges, boundary);
+
+    suite.Run("reorder/reverse_cuthill_mckee", index_type, graph,
+              num_vertices, [&] {
+                  auto reordered = Reordering::Reorder(
+                      shuffled, Reordering::VertexOrder::ReverseCuthillMcKee);
+                  return reordered.graph.GetNumLocalEdges();
+              });
+
+    // A sweep gathering a value from the neighbours of every vertex, as in a
+    // sparse matrix-vector product, on the shuffled and the reordered graph
+    auto gather = [num_vertices](const DecodingGraph<IndexT> &g) {
+        return [&g, values = std::vector<uint64_t>(num_vertices, 1)] {
+            uint64_t sum = 0;
+            for (size_t v = 0; v < g.GetNumVertices(); v++) {
+                for (auto u : g.GetVerticesTouchingVertex(v)) {
+                    sum += values[u];
+                }
+            }
+            return static_cast<size_t>(sum);
+        };
+    };
+    const auto reordered = Reordering::Reorder(
+        shuffled, Reordering::VertexOrder::ReverseCuthillMcKee);
+    suite.Run("reorder/neighbour_gather_shuffled", index_type, graph,
+              num_vertices, gather(shuffled));
+    suite.Run("reorder/neighbour_gather_reordered", index_type, graph,
+              num_vertices, gather(reordered.graph));
+}
+
+void BenchmarkGraph(BenchmarkSuite &suite, const SyntheticGraph &graph) {
+    BenchmarkConstruction<size_t>(suite, graph);
+    BenchmarkConstruction<uint32_t>(suite, graph);
+    BenchmarkQueries<size_t>(suite, graph);
+    BenchmarkQueries<uint32_t>(suite, graph);
+    BenchmarkMultiGraph(suite, graph);
+    BenchmarkWindow<size_t>(suite, graph);
+    BenchmarkWindow<uint32_t>(suite, graph);
+    BenchmarkCompressed<size_t>(suite, graph);
+    BenchmarkCompressed<uint32_t>(suite, graph);
+    BenchmarkReordering<size_t>(suite, graph);
+    BenchmarkReordering<uint32_t>(suite, graph);
+}
+
+void PrintUsage(const char *program) {
+    std::cerr << "Usage: " << program
+              << " [--output FILE] [--repetitions N] [--filter SUBSTRING]"
+                 " [--quick]\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string output;
+    std::string filter;
+    size_t repetitions = 10;
+    bool quick = false;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--quick") {
+            quick = true;
+        } else if (i + 1 < argc && arg == "--output") {
+            output = argv[++i];
+        } else if (i + 1 < argc && arg == "--filter") {
+            filter = argv[++i];
+        } else if (i + 1 < argc && arg == "--repetitions") {
+            repetitions = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            PrintUsage(argv[0]);
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    const std::vector<size_t> surface_distances =
+        quick ? std::vector<size_t>{5, 9} : std::vector<size_t>{5, 11, 21, 31};
+    const std::vector<size_t> repetition_distances =
+        quick ? std::vector<size_t>{25} : std::vector<size_t>{25, 101, 401};
+
+    BenchmarkSuite suite(quick ? 3 : repetitions, filter);
+    for (size_t d : repetition_distances) {
+        BenchmarkGraph(suite, RepetitionCodeGraph(d, d));
+    }
+    for (size_t d : surface_distances) {
+        BenchmarkGraph(suite, SurfaceCodeGraph(d, d));
+    }
+
+    if (output.empty()) {
+        suite.WriteJson(std::cout);
+    } else {
+        std::ofstream file(output);
+        if (!file) {
+            std::cerr << "Cannot open " << output << " for writing\n";
+            return EXIT_FAILURE;
+        }
+        suite.WriteJson(file);
+    }
+    return EXIT_SUCCESS;
+}
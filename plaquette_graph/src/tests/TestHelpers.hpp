@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Helpers shared by the test files.
+
+// Copy a row, or any range of indices, into a vector that Catch2 can compare
+// and print
+template <typename Row> std::vector<size_t> RowToVector(const Row &row) {
+    return std::vector<size_t>(row.begin(), row.end());
+}
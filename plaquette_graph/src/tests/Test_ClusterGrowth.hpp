@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "ClusterGrowth.hpp"
+#include "DecodingGraph.hpp"
+
+using namespace Plaquette;
+
+namespace {
+// A chain 0 - 1 - ... - (n - 1) whose two ends are boundary vertices
+DecodingGraph<size_t> Chain(size_t n, const std::vector<EdgeWeight> &weights) {
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t v = 0; v + 1 < n; v++) {
+        edges.emplace_back(v, v + 1);
+    }
+    std::vector<bool> boundary(n, false);
+    boundary.front() = boundary.back() = true;
+    return DecodingGraph<size_t>(n, edges, weights, boundary);
+}
+} // namespace
+
+TEST_CASE("ClusterGrowth merges adjacent defects", "[ClusterGrowth]") {
+    auto graph = Chain(5, {1, 1, 1, 1});
+    ClusterGrowth growth(graph);
+    std::vector<size_t> defects = {1, 2};
+    growth.LoadDefects(defects);
+    REQUIRE(growth.GetActiveClusters().size() == 2);
+
+    REQUIRE(growth.Grow());
+    REQUIRE(growth.GetActiveClusters().empty());
+    REQUIRE(growth.FindRoot(1) == growth.FindRoot(2));
+    REQUIRE_FALSE(growth.IsClusterOdd(growth.FindRoot(1)));
+    REQUIRE(std::vector<size_t>(growth.GetGrownEdges().begin(),
+                                growth.GetGrownEdges().end()) ==
+            std::vector<size_t>{1});
+    REQUIRE(growth.GetHalfEdgeGrowth(graph.GetLocalEdgeFromGlobalEdge(0, 1)) ==
+            1);
+    REQUIRE_FALSE(growth.IsVertexInCluster(0));
+    REQUIRE(growth.GrowUntilNeutral());
+}
+
+TEST_CASE("ClusterGrowth neutralizes defects at the boundary",
+          "[ClusterGrowth]") {
+    auto graph = Chain(5, {1, 1, 1, 1});
+    ClusterGrowth growth(graph);
+    std::vector<size_t> defects = {1};
+    growth.LoadDefects(defects);
+
+    REQUIRE(growth.Grow());
+    REQUIRE(growth.GetGrownEdges().empty());
+    REQUIRE(growth.Grow());
+    REQUIRE(growth.GetActiveClusters().empty());
+
+    auto root = growth.FindRoot(1);
+    REQUIRE(growth.IsClusterOnBoundary(root));
+    REQUIRE(growth.IsClusterOdd(root));
+    REQUIRE(growth.GetClusterSize(root) == 3);
+    REQUIRE(growth.IsEdgeGrown(0));
+    REQUIRE(growth.IsEdgeGrown(1));
+    REQUIRE_FALSE(growth.IsEdgeGrown(2));
+}
+
+TEST_CASE("ClusterGrowth grows weighted edges by half units",
+          "[ClusterGrowth]") {
+    auto graph = Chain(4, {3, 1, 1});
+    ClusterGrowth growth(graph);
+    std::vector<size_t> defects = {1};
+    growth.LoadDefects(defects);
+
+    REQUIRE(growth.GrowUntilNeutral());
+    REQUIRE_FALSE(growth.IsEdgeGrown(0));
+    REQUIRE(growth.IsEdgeGrown(1));
+    REQUIRE(growth.IsEdgeGrown(2));
+    REQUIRE(growth.GetHalfEdgeGrowth(graph.GetLocalEdgeFromGlobalEdge(0, 0)) ==
+            0);
+    REQUIRE(growth.GetHalfEdgeGrowth(graph.GetLocalEdgeFromGlobalEdge(0, 1)) ==
+            4);
+    REQUIRE(growth.FindRoot(3) == growth.FindRoot(1));
+}
+
+TEST_CASE("ClusterGrowth reports odd clusters that cannot be neutralized",
+          "[ClusterGrowth]") {
+    DecodingGraph graph(3, {{0, 1}, {1, 2}, {2, 0}}, {false, false, false});
+    ClusterGrowth growth(graph);
+    std::vector<size_t> defects = {0, 2, 2, 1, 1};
+    growth.LoadDefects(defects);
+
+    REQUIRE_FALSE(growth.GrowUntilNeutral());
+    auto root = growth.FindRoot(0);
+    REQUIRE(growth.GetClusterSize(root) == 3);
+    REQUIRE(growth.IsClusterOdd(root));
+    REQUIRE(growth.GetGrownEdges().size() == 3);
+}
+
+TEST_CASE("ClusterGrowth shots do not depend on previous shots",
+          "[ClusterGrowth]") {
+    // A 6 x 6 grid whose left and right columns are boundary vertices
+    const size_t n = 6;
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<bool> boundary(n * n, false);
+    for (size_t r = 0; r < n; r++) {
+        boundary[r * n] = boundary[r * n + n - 1] = true;
+        for (size_t c = 0; c < n; c++) {
+            if (c + 1 < n) {
+                edges.emplace_back(r * n + c, r * n + c + 1);
+            }
+            if (r + 1 < n) {
+                edges.emplace_back(r * n + c, (r + 1) * n + c);
+            }
+        }
+    }
+    std::mt19937 rng(11);
+    std::vector<EdgeWeight> weights;
+    for (size_t e = 0; e < edges.size(); e++) {
+        weights.push_back(1 + rng() % 3);
+    }
+    DecodingGraph<uint32_t> graph(n * n, edges, weights, boundary);
+
+    ClusterGrowth reused(graph);
+    for (size_t shot = 0; shot < 20; shot++) {
+        std::vector<uint32_t> defects;
+        for (uint32_t v = 0; v < n * n; v++) {
+            if (!boundary[v] && rng() % 5 == 0) {
+                defects.push_back(v);
+            }
+        }
+
+        ClusterGrowth fresh(graph);
+        fresh.LoadDefects(defects);
+        reused.LoadDefects(defects);
+        REQUIRE(fresh.GrowUntilNeutral());
+        REQUIRE(reused.GrowUntilNeutral());
+
+        REQUIRE(std::equal(fresh.GetGrownEdges().begin(),
+                           fresh.GetGrownEdges().end(),
+                           reused.GetGrownEdges().begin(),
+                           reused.GetGrownEdges().end()));
+        REQUIRE(fresh.GetNumTouchedVertices() ==
+                reused.GetNumTouchedVertices());
+        for (uint32_t v : defects) {
+            auto root = reused.FindRoot(v);
+            REQUIRE((!reused.IsClusterOdd(root) ||
+                     reused.IsClusterOnBoundary(root)));
+        }
+        for (uint32_t e : reused.GetGrownEdges()) {
+            auto [u, v] = graph.GetVerticesConnectedByEdge(e);
+            REQUIRE(reused.FindRoot(u) == reused.FindRoot(v));
+        }
+    }
+
+    reused.Reset();
+    REQUIRE(reused.GetNumTouchedVertices() == 0);
+    REQUIRE(reused.GetGrownEdges().empty());
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "CompressedSparseGraph.hpp"
+#include "Generators.hpp"
+#include "SparseGraph.hpp"
+#include "TestHelpers.hpp"
+
+using namespace Plaquette;
+
+TEMPLATE_TEST_CASE("Compressed graphs match sorted sparse graphs",
+                   "[CompressedSparseGraph]", size_t, uint32_t) {
+    std::mt19937 rng(11);
+    for (size_t num_vertices : {1, 2, 17, 200}) {
+        // Random edges with parallel edges, self-loops and isolated vertices
+        std::uniform_int_distribution<size_t> vertex(0, num_vertices - 1);
+        std::vector<std::pair<size_t, size_t>> edges;
+        std::vector<EdgeWeight> weights;
+        for (size_t e = 0; e < 3 * num_vertices; e++) {
+            const size_t u = vertex(rng);
+            edges.emplace_back(u, e % 7 == 0 ? u : vertex(rng));
+            weights.push_back(static_cast<EdgeWeight>(rng()));
+        }
+        SparseGraphOptions options;
+        options.assume_unique_edges = true;
+        options.sort_rows = true;
+        const SparseGraph<TestType> graph(num_vertices, edges, weights,
+                                          options);
+        const CompressedSparseGraph<TestType> compressed(graph);
+        REQUIRE(compressed.GetNumVertices() == num_vertices);
+        REQUIRE(compressed.GetNumEdges() == edges.size());
+        REQUIRE_FALSE(compressed.IsEdgeToEdgeMatrixConstructed());
+
+        for (size_t v = 0; v < num_vertices; v++) {
+            auto vertices = compressed.GetVerticesTouchingVertex(v);
+            REQUIRE(vertices.size() ==
+                    graph.GetVerticesTouchingVertex(v).size());
+            REQUIRE(RowToVector(vertices) ==
+                    RowToVector(graph.GetVerticesTouchingVertex(v)));
+            REQUIRE(RowToVector(compressed.GetEdgesTouchingVertex(v)) ==
+                    RowToVector(graph.GetEdgesTouchingVertex(v)));
+            for (size_t k = 0; k < vertices.size(); k++) {
+                REQUIRE(vertices[k] == graph.GetVerticesTouchingVertex(v)[k]);
+            }
+            for (size_t u = 0; u < num_vertices; u++) {
+                REQUIRE(compressed.GetEdgeFromVertexPair({v, u}) ==
+                        graph.GetEdgeFromVertexPair({v, u}));
+            }
+        }
+        REQUIRE(compressed.GetEdgeFromVertexPair({num_vertices, 0}) ==
+                CompressedSparseGraph<TestType>::kInvalidIndex);
+
+        // Edge-edge rows are sorted by edge
+        for (size_t e = 0; e < edges.size(); e++) {
+            auto expected = RowToVector(graph.GetEdgesTouchingEdge(e));
+            std::sort(expected.begin(), expected.end());
+            REQUIRE(RowToVector(compressed.GetEdgesTouchingEdge(e)) ==
+                    expected);
+            REQUIRE(compressed.GetVerticesConnectedByEdge(e) ==
+                    graph.GetVerticesConnectedByEdge(e));
+            REQUIRE(compressed.GetEdgeWeight(e) == weights[e]);
+        }
+        REQUIRE(compressed.IsEdgeToEdgeMatrixConstructed());
+
+        std::vector<TestType> batch(num_vertices);
+        std::iota(batch.rbegin(), batch.rend(), 0);
+        auto rows = compressed.GetEdgesTouchingVertices(batch);
+        auto expected_rows = graph.GetEdgesTouchingVertices(batch);
+        REQUIRE(rows.offsets == expected_rows.offsets);
+        REQUIRE(rows.values == expected_rows.values);
+        rows = compressed.GetVerticesTouchingVertices(batch);
+        expected_rows = graph.GetVerticesTouchingVertices(batch);
+        REQUIRE(rows.values == expected_rows.values);
+        batch.push_back(static_cast<TestType>(num_vertices));
+        REQUIRE_THROWS_AS(compressed.GetVerticesTouchingVertices(batch),
+                          std::out_of_range);
+
+        auto decompressed = compressed.Decompress();
+        REQUIRE(decompressed.AreRowsSorted());
+        auto same = [](auto a, auto b) {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end());
+        };
+        REQUIRE(same(decompressed.GetVertexToVertexRowPtr(),
+                     graph.GetVertexToVertexRowPtr()));
+        REQUIRE(same(decompressed.GetVertexToVertexCol(),
+                     graph.GetVertexToVertexCol()));
+        REQUIRE(same(decompressed.GetVertexToVertexEdges(),
+                     graph.GetVertexToVertexEdges()));
+        REQUIRE(same(decompressed.GetEdgeWeights(), graph.GetEdgeWeights()));
+    }
+}
+
+TEST_CASE("Compressed rows round trip extreme values",
+          "[CompressedSparseGraph]") {
+    std::mt19937_64 rng(5);
+    const uint64_t max = std::numeric_limits<uint64_t>::max();
+    for (unsigned bits : {0u, 1u, 7u, 8u, 31u, 57u, 63u, 64u}) {
+        for (size_t size : {1, 2, 9, 33}) {
+            std::vector<size_t> values(size);
+            const uint64_t mask = bits == 64 ? max : (uint64_t{1} << bits) - 1;
+            for (auto &value : values) {
+                value = rng() & mask;
+            }
+            values[0] = size % 2 == 0 ? max : values[0];
+            auto sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+            for (const auto &stream_values : {values, sorted}) {
+                for (uint64_t prediction : {uint64_t{0}, max, values[0]}) {
+                    std::vector<uint8_t> stream;
+                    EncodeStream_<size_t>(stream, stream_values, prediction);
+                    stream.resize(stream.size() + 8, 0);
+                    CompressedGraphRow<size_t> row(stream.data(), size,
+                                                   prediction);
+                    REQUIRE(RowToVector(row) == stream_values);
+                    REQUIRE(row[size - 1] == stream_values[size - 1]);
+                    REQUIRE(row.GetStreamEnd() ==
+                            stream.data() + stream.size() - 8);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Compressed graphs are smaller", "[CompressedSparseGraph]") {
+    auto graph = Generators::RotatedSurfaceCodeGraph(
+        9, {.rounds = 9, .diagonal_edges = true});
+    CompressedSparseGraph compressed(graph, EdgeToEdgeMode::Eager);
+    const size_t v_to_v_bytes =
+        (graph.GetVertexToVertexRowPtr().size() +
+         graph.GetVertexToVertexCol().size() +
+         graph.GetVertexToVertexEdges().size()) *
+        sizeof(size_t);
+    const size_t e_to_e_bytes = (graph.GetEdgeToEdgeRowPtr().size() +
+                                 graph.GetEdgeToEdgeCol().size()) *
+                                sizeof(size_t);
+    REQUIRE(4 * compressed.GetCompressedBytes() < v_to_v_bytes + e_to_e_bytes);
+
+    // The edge list constructor compresses the same graph
+    std::vector<std::pair<size_t, size_t>> edges(
+        graph.GetEdgeToVertex().begin(), graph.GetEdgeToVertex().end());
+    SparseGraphOptions options;
+    options.assume_unique_edges = true;
+    CompressedSparseGraph<uint32_t> from_edges(graph.GetNumVertices(), edges,
+                                               {}, options);
+    for (size_t v = 0; v < graph.GetNumVertices(); v++) {
+        REQUIRE(RowToVector(from_edges.GetEdgesTouchingVertex(v)) ==
+                RowToVector(compressed.GetEdgesTouchingVertex(v)));
+    }
+    REQUIRE_FALSE(from_edges.HasEdgeWeights());
+    REQUIRE(from_edges.GetEdgeWeight(0) == 1);
+}
+
+TEST_CASE("A moved-from compressed graph is an empty graph",
+          "[CompressedSparseGraph]") {
+    static_assert(
+        std::is_nothrow_move_constructible_v<CompressedSparseGraph<>>);
+    static_assert(std::is_nothrow_move_assignable_v<CompressedSparseGraph<>>);
+    SparseGraph<> graph(3, {{0, 1}, {1, 2}, {2, 0}});
+    CompressedSparseGraph compressed(graph, EdgeToEdgeMode::Eager);
+
+    auto require_empty = [](const CompressedSparseGraph<> &g) {
+        REQUIRE(g.GetNumVertices() == 0);
+        REQUIRE(g.GetNumEdges() == 0);
+        REQUIRE_FALSE(g.IsEdgeToEdgeMatrixConstructed());
+        REQUIRE(g.GetCompressedBytes() == 0);
+        REQUIRE(g.GetMemoryFootprint().arrays.size() == 4);
+        REQUIRE(g.GetEdgesTouchingEdge(0).size() == 0);
+    };
+
+    CompressedSparseGraph moved(std::move(compressed));
+    require_empty(compressed);
+    REQUIRE(moved.IsEdgeToEdgeMatrixConstructed());
+    CompressedSparseGraph copy = compressed;
+    require_empty(copy);
+
+    compressed = std::move(moved);
+    require_empty(moved);
+    REQUIRE(RowToVector(compressed.GetEdgesTouchingEdge(0)) ==
+            std::vector<size_t>{1, 2});
+}
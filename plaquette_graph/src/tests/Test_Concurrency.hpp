@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "CompressedSparseGraph.hpp"
+#include "DecodingGraph.hpp"
+#include "Generators.hpp"
+#include "MultiGraph.hpp"
+#include "ShortestPaths.hpp"
+#include "SparseGraph.hpp"
+#include "Utils.hpp"
+#include "TestHelpers.hpp"
+
+using namespace Plaquette;
+
+// These tests are meant to be run under ThreadSanitizer, e.g. in a build
+// configured with -DPLAQUETTE_GRAPH_ENABLE_TSAN=ON. Catch2 assertions are not
+// thread safe, so the threads count their mismatches, which are checked once
+// all threads have joined.
+
+namespace {
+constexpr size_t kNumReaderThreads = 8;
+
+template <typename IndexT>
+DecodingGraph<IndexT> ConcurrencyTestGraph() {
+    return Generators::SpaceTimeGraph<IndexT>(
+        Generators::SurfaceCodeLayout(5),
+        {.rounds = 5, .diagonal_edges = true});
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("Const queries on a shared graph are thread safe",
+                   "[Concurrency]", size_t, uint32_t) {
+    // The reference graph is built independently, since copies would share
+    // the lazily constructed edge-edge matrix
+    auto reference = ConcurrencyTestGraph<TestType>();
+    reference.ConstructEdgeToEdgeMatrix_();
+    auto graph = ConcurrencyTestGraph<TestType>();
+    graph.BuildEdgeIndex();
+    REQUIRE_FALSE(graph.IsEdgeToEdgeMatrixConstructed());
+
+    const size_t num_vertices = graph.GetNumVertices();
+    const size_t num_edges = graph.GetNumEdges();
+    std::vector<TestType> vertices(num_vertices);
+    for (size_t v = 0; v < num_vertices; v++) {
+        vertices[v] = static_cast<TestType>(v);
+    }
+    const auto expected_rows = reference.GetEdgesTouchingVertices(vertices);
+
+    std::vector<size_t> mismatches(kNumReaderThreads, 0);
+    Utils::ParallelFor(kNumReaderThreads, [&](size_t t) {
+        size_t &count = mismatches[t];
+        // Every thread starts at a different edge, so that the first queries
+        // race to construct the edge-edge matrix
+        for (size_t k = 0; k < num_edges; k++) {
+            const size_t e =
+                (k + t * num_edges / kNumReaderThreads) % num_edges;
+            count += RowToVector(graph.GetEdgesTouchingEdge(e)) !=
+                     RowToVector(reference.GetEdgesTouchingEdge(e));
+            count += graph.GetEdgesTouchingEdgeImplicit(e).size() !=
+                     reference.GetEdgesTouchingEdge(e).size();
+            const auto &[u, v] = graph.GetVerticesConnectedByEdge(e);
+            count += graph.GetEdgeFromVertexPair({u, v}) != e;
+        }
+        for (size_t v = 0; v < num_vertices; v++) {
+            count += RowToVector(graph.GetVerticesTouchingVertex(v)) !=
+                     RowToVector(reference.GetVerticesTouchingVertex(v));
+            count += graph.IsVertexOnBoundary(v) !=
+                     reference.IsVertexOnBoundary(v);
+        }
+        const auto rows = graph.GetEdgesTouchingVertices(vertices);
+        count += rows.offsets != expected_rows.offsets;
+        count += rows.values != expected_rows.values;
+    });
+
+    for (size_t t = 0; t < kNumReaderThreads; t++) {
+        REQUIRE(mismatches[t] == 0);
+    }
+    REQUIRE(graph.IsEdgeToEdgeMatrixConstructed());
+    if constexpr (kQueryCountersEnabled) {
+        REQUIRE(graph.GetQueryCounts().vertex_pairs ==
+                kNumReaderThreads * num_edges);
+    }
+}
+
+TEST_CASE("Compressed graphs can be queried from several threads",
+          "[Concurrency]") {
+    auto graph = ConcurrencyTestGraph<uint32_t>();
+    const CompressedSparseGraph<uint32_t> compressed(graph);
+    const size_t num_edges = graph.GetNumEdges();
+
+    std::vector<std::vector<size_t>> expected(num_edges);
+    for (size_t e = 0; e < num_edges; e++) {
+        expected[e] = RowToVector(graph.GetEdgesTouchingEdge(e));
+        std::sort(expected[e].begin(), expected[e].end());
+    }
+
+    std::vector<size_t> mismatches(kNumReaderThreads, 0);
+    Utils::ParallelFor(kNumReaderThreads, [&](size_t t) {
+        for (size_t k = 0; k < num_edges; k++) {
+            const size_t e =
+                (k + t * num_edges / kNumReaderThreads) % num_edges;
+            mismatches[t] +=
+                RowToVector(compressed.GetEdgesTouchingEdge(e)) != expected[e];
+        }
+    });
+    for (size_t t = 0; t < kNumReaderThreads; t++) {
+        REQUIRE(mismatches[t] == 0);
+    }
+}
+
+TEST_CASE("Multi-graph edge rows can be queried from several threads",
+          "[Concurrency]") {
+    auto graph = ConcurrencyTestGraph<size_t>();
+    std::vector<std::pair<size_t, size_t>> edges(
+        graph.GetEdgeToVertex().begin(), graph.GetEdgeToVertex().end());
+    // Parallel edges and self-loops
+    edges.insert(edges.end(), edges.begin(), edges.begin() + 10);
+    edges.emplace_back(0, 0);
+    const MultiGraph multi(edges, std::vector<size_t>(edges.size(), 1));
+    REQUIRE_FALSE(multi.IsEdgeToEdgeMatrixConstructed());
+
+    std::vector<size_t> mismatches(kNumReaderThreads, 0);
+    Utils::ParallelFor(kNumReaderThreads, [&](size_t t) {
+        for (size_t k = 0; k < edges.size(); k++) {
+            const size_t e =
+                (k + t * edges.size() / kNumReaderThreads) % edges.size();
+            mismatches[t] += RowToVector(multi.GetEdgesTouchingEdgeRow(e)) !=
+                             multi.GetEdgesTouchingEdge(e);
+        }
+    });
+    for (size_t t = 0; t < kNumReaderThreads; t++) {
+        REQUIRE(mismatches[t] == 0);
+    }
+}
+
+TEST_CASE("Shortest paths can be queried from several threads",
+          "[Concurrency]") {
+    auto graph = ConcurrencyTestGraph<size_t>();
+    const size_t num_vertices = graph.GetNumVertices();
+    ShortestPaths<DecodingGraph<size_t>> reference(graph);
+    ShortestPaths<DecodingGraph<size_t>> paths(graph, 32);
+
+    std::vector<size_t> mismatches(kNumReaderThreads, 0);
+    Utils::ParallelFor(kNumReaderThreads, [&](size_t t) {
+        for (size_t source = t; source < num_vertices; source += 7) {
+            for (size_t target = 0; target < num_vertices; target += 13) {
+                // Repeated queries are served from the shared cache
+                const auto path = paths.GetPath(source, target);
+                mismatches[t] +=
+                    path.distance != reference.GetDistance(source, target);
+                mismatches[t] += paths.GetDistance(source, target) !=
+                                 path.distance;
+            }
+            mismatches[t] += paths.GetDistanceToBoundary(source) !=
+                             reference.GetDistanceToBoundary(source);
+        }
+    });
+    for (size_t t = 0; t < kNumReaderThreads; t++) {
+        REQUIRE(mismatches[t] == 0);
+    }
+    REQUIRE(paths.GetCacheSize() <= 32);
+}
+
+TEST_CASE("Graphs can be constructed on several threads at once",
+          "[Concurrency]") {
+    const auto reference = ConcurrencyTestGraph<uint32_t>();
+    std::vector<std::pair<size_t, size_t>> edges(
+        reference.GetEdgeToVertex().begin(), reference.GetEdgeToVertex().end());
+    std::vector<bool> boundary(reference.GetNumVertices());
+    for (size_t v = 0; v < boundary.size(); v++) {
+        boundary[v] = reference.IsVertexOnBoundary(v);
+    }
+    const DecodingGraph<uint32_t> expected(reference.GetNumVertices(), edges,
+                                           boundary);
+
+    // Every thread builds its graphs from the scratch arena of its own thread
+    std::vector<size_t> mismatches(kNumReaderThreads, 0);
+    Utils::ParallelFor(kNumReaderThreads, [&](size_t t) {
+        DecodingGraph<uint32_t> graph(expected.GetNumVertices(), edges,
+                                      boundary);
+        for (size_t i = 0; i < 3; i++) {
+            graph.Rebuild(expected.GetNumVertices(), edges, boundary,
+                          {.sort_rows = i % 2 == 1});
+            graph.Rebuild(expected.GetNumVertices(), edges, boundary);
+        }
+        auto col = graph.GetVertexToVertexCol();
+        auto expected_col = expected.GetVertexToVertexCol();
+        mismatches[t] += !std::equal(col.begin(), col.end(),
+                                     expected_col.begin(), expected_col.end());
+        mismatches[t] += RowToVector(graph.GetEdgesTouchingEdge(t)) !=
+                         RowToVector(expected.GetEdgesTouchingEdge(t));
+    });
+    for (size_t t = 0; t < kNumReaderThreads; t++) {
+        REQUIRE(mismatches[t] == 0);
+    }
+}
@@ -82,3 +82,105 @@ TEST_CASE("Check GetLocalEdgeFromGlobalEdge") {
     REQUIRE(graph.GetLocalEdgeFromGlobalEdge(2, 0) == 1);
     REQUIRE(graph.GetLocalEdgeFromGlobalEdge(2, 1) == 5);
 }
+
+TEST_CASE("DecodingGraph with 32-bit indices", "[DecodingGraph]") {
+    std::vector<bool> vertex_boundary_type = {true, false, false};
+    DecodingGraph<uint32_t> graph(3, {{0, 1}, {1, 2}, {2, 0}},
+                                  vertex_boundary_type);
+
+    REQUIRE(graph.IsVertexOnBoundary(0) == true);
+    REQUIRE(graph.IsVertexOnBoundary(1) == false);
+    REQUIRE(graph.GetNumLocalEdges() == 6);
+    REQUIRE(graph.GetLocalEdgeStride(2) == 4);
+    REQUIRE(graph.GetGlobalEdgeFromLocalEdge(1) == 2);
+    REQUIRE(graph.GetLocalEdgeFromGlobalEdge(2, 1) == 5);
+}
+
+TEST_CASE("DecodingGraph AreVerticesOnBoundary", "[DecodingGraph]") {
+    DecodingGraph graph(3, {{0, 1}, {1, 2}}, {true, false, true});
+
+    std::vector<size_t> vertices = {2, 1, 0, 2};
+    bool out[4];
+    graph.AreVerticesOnBoundary(vertices, out);
+    REQUIRE(out[0]);
+    REQUIRE_FALSE(out[1]);
+    REQUIRE(out[2]);
+    REQUIRE(out[3]);
+
+    std::vector<size_t> invalid = {3};
+    REQUIRE_THROWS_AS(graph.AreVerticesOnBoundary(invalid, {out, 1}),
+                      std::out_of_range);
+}
+
+TEST_CASE("DecodingGraph requires one boundary flag per vertex",
+          "[DecodingGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}, {1, 2}};
+    std::vector<EdgeWeight> weights = {1, 2};
+    REQUIRE_THROWS_AS(DecodingGraph(3, edges, {true, false}),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        DecodingGraph(3, edges, weights, {true, false, true, true}),
+        std::invalid_argument);
+
+    // A failed rebuild leaves the graph empty
+    DecodingGraph graph(3, edges, {true, false, true});
+    REQUIRE_THROWS_AS(graph.Rebuild(4, edges, {true, false, true}),
+                      std::invalid_argument);
+    REQUIRE(graph.GetNumVertices() == 0);
+    REQUIRE(graph.GetNumEdges() == 0);
+    graph.Rebuild(4, edges, {true, false, false, true});
+    REQUIRE(graph.IsVertexOnBoundary(3));
+}
+
+TEST_CASE("A moved-from DecodingGraph is an empty graph", "[DecodingGraph]") {
+    static_assert(std::is_nothrow_move_constructible_v<DecodingGraph<>>);
+    static_assert(std::is_nothrow_move_assignable_v<DecodingGraph<>>);
+    DecodingGraph graph(3, {{0, 1}, {1, 2}}, {true, false, true});
+    DecodingGraph moved(std::move(graph));
+    REQUIRE(graph.GetNumVertices() == 0);
+    REQUIRE(graph.GetNumLocalEdges() == 0);
+    REQUIRE(graph.GetVertexBoundaryTypes().empty());
+    REQUIRE(moved.GetNumLocalEdges() == 4);
+    REQUIRE(moved.IsVertexOnBoundary(2));
+
+    graph = std::move(moved);
+    REQUIRE(moved.GetNumLocalEdges() == 0);
+    REQUIRE(graph.GetLocalEdgeFromGlobalEdge(1, 1) == 3);
+    moved.Rebuild(2, {{0, 1}}, {false, true});
+    REQUIRE(moved.GetNumLocalEdges() == 2);
+}
+
+TEST_CASE("DecodingGraph FromArrays rejects a shared local edge",
+          "[DecodingGraph]") {
+    DecodingGraph graph(3, {{0, 1}, {1, 2}}, {true, false, true});
+    auto copy = [](auto values) {
+        using T = typename decltype(values)::value_type;
+        return ArrayBuffer<std::remove_const_t<T>>(
+            std::vector<std::remove_const_t<T>>(values.begin(), values.end()));
+    };
+    auto from_arrays = [&](bool share_local_edge) {
+        SparseGraphArrays<> graph_arrays;
+        graph_arrays.v_to_v_row_ptr = copy(graph.GetVertexToVertexRowPtr());
+        graph_arrays.v_to_v_col = copy(graph.GetVertexToVertexCol());
+        graph_arrays.v_to_v_edges = copy(graph.GetVertexToVertexEdges());
+        graph_arrays.e_to_v = copy(graph.GetEdgeToVertex());
+        DecodingGraphArrays<> arrays;
+        arrays.vertex_boundary_type = copy(graph.GetVertexBoundaryTypes());
+        arrays.local_edge_strides = copy(graph.GetLocalEdgeStrides());
+        arrays.local_to_global_edge_map = copy(graph.GetLocalToGlobalEdgeMap());
+        std::vector<size_t> global_to_local(
+            graph.GetGlobalToLocalEdgeMap().begin(),
+            graph.GetGlobalToLocalEdgeMap().end());
+        if (share_local_edge) {
+            // Still an inverse of the local to global map
+            global_to_local[1] = global_to_local[0];
+        }
+        arrays.global_to_local_edge_map = std::move(global_to_local);
+        return DecodingGraph<>::FromArrays(3, std::move(graph_arrays),
+                                           std::move(arrays));
+    };
+
+    REQUIRE(from_arrays(false).GetLocalEdgeFromGlobalEdge(0, 1) ==
+            graph.GetLocalEdgeFromGlobalEdge(0, 1));
+    REQUIRE_THROWS_AS(from_arrays(true), std::invalid_argument);
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "DecodingGraph.hpp"
+#include "DetectorErrorModel.hpp"
+
+using namespace Plaquette;
+
+namespace {
+template <typename IndexT>
+EdgeWeight DemEdgeWeight(const DecodingGraph<IndexT> &graph, size_t u,
+                         size_t v) {
+    size_t edge = graph.GetEdgeFromVertexPair(std::make_pair(u, v));
+    REQUIRE(edge != graph.kInvalidIndex);
+    return graph.GetEdgeWeight(edge);
+}
+} // namespace
+
+TEST_CASE("ProbabilityToWeight scales log-likelihood ratios",
+          "[DetectorErrorModel]") {
+    using DetectorErrorModel::ProbabilityToWeight;
+    REQUIRE(ProbabilityToWeight(0.1, 1000) == 2197);
+    REQUIRE(ProbabilityToWeight(0.1, 1) == 2);
+    REQUIRE(ProbabilityToWeight(0.5, 1000) == 0);
+    REQUIRE(ProbabilityToWeight(0.9, 1000) == 0);
+    REQUIRE(ProbabilityToWeight(1e-300, 1e300) ==
+            std::numeric_limits<EdgeWeight>::max());
+}
+
+TEMPLATE_TEST_CASE("Detector error models are parsed into decoding graphs",
+                   "[DetectorErrorModel]", size_t, uint32_t) {
+    const std::string text = R"(# A comment
+error(0.1) D0 D1
+error(0.2) D1 L0   # observables are ignored
+error[tag](0.01) D0 D1 D2 ^ D3
+detector(1, 0) D4
+
+error(0) D6
+logical_observable L0
+)";
+    DetectorErrorModel::LoadOptions options;
+    options.weight_scale = 1;
+    auto graph =
+        DetectorErrorModel::ParseDecodingGraph<TestType>(text, options);
+
+    // Detectors 0 to 6 and the boundary
+    const size_t boundary = 7;
+    REQUIRE(graph.GetNumVertices() == 8);
+    for (size_t v = 0; v < 8; v++) {
+        REQUIRE(graph.IsVertexOnBoundary(v) == (v == boundary));
+    }
+    // (0, 1) is flipped by the first and third mechanisms, whose
+    // probabilities are merged
+    REQUIRE(graph.GetNumEdges() == 4);
+    const double merged = 0.1 * 0.99 + 0.01 * 0.9;
+    REQUIRE(DemEdgeWeight(graph, 0, 1) ==
+            DetectorErrorModel::ProbabilityToWeight(merged, 1));
+    REQUIRE(DemEdgeWeight(graph, 1, boundary) == 1);
+    REQUIRE(DemEdgeWeight(graph, 2, boundary) == 5);
+    REQUIRE(DemEdgeWeight(graph, 3, boundary) == 5);
+
+    DetectorErrorModel::LoadOptions clique = options;
+    clique.decomposition = HyperedgeDecomposition::Clique;
+    // (0, 2) and (1, 2) are added, (0, 1) is merged
+    REQUIRE(DetectorErrorModel::ParseDecodingGraph<TestType>(text, clique)
+                .GetNumEdges() == 5);
+}
+
+TEST_CASE("Repeat blocks shift detectors without being unrolled",
+          "[DetectorErrorModel]") {
+    const std::string text = R"(
+error(0.1) D0
+repeat 3 {
+    error(0.1) D0 D2
+    repeat 2 {
+        error(0.1) D1
+        shift_detectors 1
+    }
+    error(0.1) D0 D0 D1
+}
+shift_detectors(0, 0, 1) 1
+error(0.1) D0
+)";
+    auto graph = DetectorErrorModel::ParseDecodingGraph(text);
+
+    // Every repetition shifts the detectors by two, and the last error
+    // flips detector 7
+    const size_t boundary = 8;
+    REQUIRE(graph.GetNumVertices() == 9);
+    std::vector<std::pair<size_t, size_t>> expected{
+        {0, boundary}, {0, 2},        {1, boundary}, {2, boundary},
+        {3, boundary}, {2, 4},        {4, boundary}, {5, boundary},
+        {4, 6},        {6, boundary}, {7, boundary}};
+    REQUIRE(graph.GetNumEdges() == expected.size());
+    for (const auto &[u, v] : expected) {
+        REQUIRE(graph.GetEdgeFromVertexPair(std::make_pair(u, v)) !=
+                graph.kInvalidIndex);
+    }
+    // Detector 3 is flipped alone by the last error of the first repetition
+    // and by the inner block of the second one
+    const auto twice = DetectorErrorModel::ProbabilityToWeight(0.18, 1000);
+    REQUIRE(DemEdgeWeight(graph, 3, boundary) == twice);
+    REQUIRE(DemEdgeWeight(graph, 7, boundary) == twice);
+    REQUIRE(DemEdgeWeight(graph, 0, boundary) ==
+            DetectorErrorModel::ProbabilityToWeight(0.1, 1000));
+}
+
+TEMPLATE_TEST_CASE("Hypergraphs of error mechanisms merge edges as the "
+                   "parser does",
+                   "[DetectorErrorModel]", size_t, uint32_t) {
+    const std::string text = R"(error(0.1) D0 D1 D2
+error(0.2) D2
+error(0.05) D1 D0
+error(0) D3 D4
+error(0.3) D0 D1 D2 D3
+)";
+    std::vector<std::vector<size_t>> mechanisms{
+        {0, 1, 2}, {2}, {1, 0}, {3, 4}, {0, 1, 2, 3}};
+    std::vector<double> probabilities{0.1, 0.2, 0.05, 0, 0.3};
+    Hypergraph<TestType> hypergraph(5, mechanisms);
+
+    for (auto decomposition :
+         {HyperedgeDecomposition::Pairs, HyperedgeDecomposition::Clique}) {
+        DetectorErrorModel::LoadOptions options;
+        options.decomposition = decomposition;
+        auto parsed =
+            DetectorErrorModel::ParseDecodingGraph<TestType>(text, options);
+        auto built = DetectorErrorModel::BuildDecodingGraph(
+            hypergraph, probabilities, options);
+        REQUIRE(built.GetNumVertices() == parsed.GetNumVertices());
+        REQUIRE(built.GetNumEdges() == parsed.GetNumEdges());
+        for (size_t e = 0; e < built.GetNumEdges(); e++) {
+            const auto [u, v] = built.GetVerticesConnectedByEdge(e);
+            REQUIRE(DemEdgeWeight(parsed, u, v) == built.GetEdgeWeight(e));
+        }
+    }
+    // (0, 1) is flipped by three mechanisms
+    auto built = DetectorErrorModel::BuildDecodingGraph(hypergraph,
+                                                        probabilities);
+    const double twice = 0.1 * 0.95 + 0.05 * 0.9;
+    REQUIRE(DemEdgeWeight(built, 0, 1) ==
+            DetectorErrorModel::ProbabilityToWeight(
+                twice * 0.7 + 0.3 * (1 - twice), 1000));
+
+    std::vector<double> too_few{0.1};
+    REQUIRE_THROWS_AS(
+        DetectorErrorModel::BuildDecodingGraph(hypergraph, too_few),
+        std::invalid_argument);
+    probabilities[1] = 1.5;
+    REQUIRE_THROWS_AS(
+        DetectorErrorModel::BuildDecodingGraph(hypergraph, probabilities),
+        std::invalid_argument);
+}
+
+TEST_CASE("Invalid detector error models are rejected",
+          "[DetectorErrorModel]") {
+    using DetectorErrorModel::ParseDecodingGraph;
+    REQUIRE_THROWS_AS(ParseDecodingGraph("error(1.5) D0"), std::runtime_error);
+    REQUIRE_THROWS_AS(ParseDecodingGraph("error D0"), std::runtime_error);
+    REQUIRE_THROWS_AS(ParseDecodingGraph("error(0.1) D0 X1"),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(ParseDecodingGraph("repeat 2 {\nerror(0.1) D0\n"),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(ParseDecodingGraph("}"), std::runtime_error);
+    REQUIRE_THROWS_AS(ParseDecodingGraph("shift_detectors D1"),
+                      std::runtime_error);
+    REQUIRE_THROWS_WITH(ParseDecodingGraph("error(0.1) D0\nflip D1"),
+                        Catch::Contains("line 2"));
+
+    // Detector indices that overflow, with or without a shift
+    const std::string largest =
+        std::to_string(std::numeric_limits<size_t>::max());
+    REQUIRE_THROWS_WITH(ParseDecodingGraph("error(0.1) D" + largest),
+                        Catch::Contains("overflows"));
+    REQUIRE_THROWS_WITH(ParseDecodingGraph("error(0.1) D0 ^ D" + largest),
+                        Catch::Contains("overflows"));
+    REQUIRE_THROWS_WITH(ParseDecodingGraph("detector D" + largest),
+                        Catch::Contains("overflows"));
+    REQUIRE_THROWS_WITH(
+        ParseDecodingGraph("shift_detectors 2\nerror(0.1) D" +
+                           std::to_string(std::numeric_limits<size_t>::max() -
+                                          1)),
+        Catch::Contains("overflows"));
+
+    auto empty = ParseDecodingGraph("# nothing\n\n");
+    REQUIRE(empty.GetNumVertices() == 1);
+    REQUIRE(empty.GetNumEdges() == 0);
+}
+
+TEST_CASE("Detector error model files are loaded", "[DetectorErrorModel]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "plaquette_graph_test.dem")
+            .string();
+    std::string text;
+    for (size_t i = 0; i < 1000; i++) {
+        text += "error(0.01) D" + std::to_string(i) + " D" +
+                std::to_string(i + 1) + "\n";
+    }
+    {
+        std::ofstream out(path);
+        out << text;
+    }
+
+    auto parsed = DetectorErrorModel::ParseDecodingGraph<uint32_t>(text);
+    for (bool memory_map : {true, false}) {
+        auto loaded = DetectorErrorModel::LoadDecodingGraph<uint32_t>(
+            path, {}, memory_map);
+        REQUIRE(loaded.GetNumVertices() == parsed.GetNumVertices());
+        REQUIRE(std::ranges::equal(loaded.GetEdgeToVertex(),
+                                   parsed.GetEdgeToVertex()));
+        REQUIRE(std::ranges::equal(loaded.GetEdgeWeights(),
+                                   parsed.GetEdgeWeights()));
+    }
+    std::filesystem::remove(path);
+    REQUIRE_THROWS_AS(DetectorErrorModel::LoadDecodingGraph(path),
+                      std::runtime_error);
+}
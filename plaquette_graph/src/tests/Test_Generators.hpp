@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "DecodingGraph.hpp"
+#include "Generators.hpp"
+#include "ShortestPaths.hpp"
+
+using namespace Plaquette;
+using namespace Plaquette::Generators;
+
+namespace {
+// The space-time graph of a layout built edge by edge with the DecodingGraph
+// constructor, keeping parallel edges
+template <typename IndexT>
+DecodingGraph<IndexT> ReferenceSpaceTimeGraph(const SpaceTimeLayout &layout,
+                                              const SpaceTimeOptions &options) {
+    const size_t D = layout.detectors_per_round;
+    const size_t boundary = options.rounds * D;
+    auto vertex = [&](size_t r, size_t d) {
+        return d == D ? boundary : r * D + d;
+    };
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<EdgeWeight> weights;
+    for (size_t r = 0; r < options.rounds; r++) {
+        for (const auto &[u, v] : layout.space_edges) {
+            edges.emplace_back(vertex(r, u), vertex(r, v));
+            weights.push_back(options.space_weight);
+        }
+        if (r + 1 == options.rounds) {
+            continue;
+        }
+        for (size_t d = 0; d < D; d++) {
+            edges.emplace_back(vertex(r, d), vertex(r + 1, d));
+            weights.push_back(options.time_weight);
+        }
+        for (const auto &[u, v] : layout.space_edges) {
+            if (options.diagonal_edges && u < D && v < D) {
+                edges.emplace_back(vertex(r, u), vertex(r + 1, v));
+                weights.push_back(options.diagonal_weight);
+            }
+        }
+    }
+    std::vector<bool> is_boundary(boundary + 1, false);
+    is_boundary[boundary] = true;
+    SparseGraphOptions unique;
+    unique.assume_unique_edges = true;
+    return DecodingGraph<IndexT>(boundary + 1, edges, weights, is_boundary,
+                                 unique);
+}
+
+template <typename T>
+bool SameArray(std::span<const T> a, std::span<const T> b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+template <typename IndexT>
+void RequireSameGraph(const DecodingGraph<IndexT> &actual,
+                      const DecodingGraph<IndexT> &expected) {
+    REQUIRE(actual.GetNumVertices() == expected.GetNumVertices());
+    REQUIRE(actual.GetNumEdges() == expected.GetNumEdges());
+    REQUIRE(SameArray(actual.GetVertexToVertexRowPtr(),
+                      expected.GetVertexToVertexRowPtr()));
+    REQUIRE(SameArray(actual.GetVertexToVertexCol(),
+                      expected.GetVertexToVertexCol()));
+    REQUIRE(SameArray(actual.GetVertexToVertexEdges(),
+                      expected.GetVertexToVertexEdges()));
+    REQUIRE(SameArray(actual.GetEdgeToVertex(), expected.GetEdgeToVertex()));
+    REQUIRE(SameArray(actual.GetVertexBoundaryTypes(),
+                      expected.GetVertexBoundaryTypes()));
+    REQUIRE(SameArray(actual.GetLocalEdgeStrides(),
+                      expected.GetLocalEdgeStrides()));
+    REQUIRE(SameArray(actual.GetLocalToGlobalEdgeMap(),
+                      expected.GetLocalToGlobalEdgeMap()));
+    REQUIRE(SameArray(actual.GetGlobalToLocalEdgeMap(),
+                      expected.GetGlobalToLocalEdgeMap()));
+    for (size_t e = 0; e < actual.GetNumEdges(); e++) {
+        REQUIRE(actual.GetEdgeWeight(e) == expected.GetEdgeWeight(e));
+    }
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("Generated graphs match the constructed graphs",
+                   "[Generators]", size_t, uint32_t) {
+    for (size_t distance : {2, 3, 5, 6}) {
+        for (const auto &layout :
+             {RepetitionCodeLayout(distance), SurfaceCodeLayout(distance),
+              RotatedSurfaceCodeLayout(distance)}) {
+            for (size_t rounds : {1, 2, 4}) {
+                SpaceTimeOptions options;
+                options.rounds = rounds;
+                RequireSameGraph(
+                    SpaceTimeGraph<TestType>(layout, options),
+                    ReferenceSpaceTimeGraph<TestType>(layout, options));
+
+                options.diagonal_edges = true;
+                options.time_weight = 3;
+                options.diagonal_weight = 5;
+                auto graph = SpaceTimeGraph<TestType>(layout, options);
+                REQUIRE(graph.GetEdgeWeights().size() == graph.GetNumEdges());
+                RequireSameGraph(
+                    graph, ReferenceSpaceTimeGraph<TestType>(layout, options));
+            }
+        }
+    }
+}
+
+TEST_CASE("Code layouts", "[Generators]") {
+    SECTION("Repetition code") {
+        auto graph = RepetitionCodeGraph(5, {.rounds = 3});
+        REQUIRE(graph.GetNumVertices() == 13);
+        REQUIRE(graph.GetNumEdges() == 3 * 5 + 2 * 4);
+        REQUIRE(graph.GetEdgeWeights().empty());
+        REQUIRE(graph.GetEdgesTouchingVertex(12).size() == 6);
+    }
+
+    SECTION("Planar surface code") {
+        auto layout = SurfaceCodeLayout(5);
+        REQUIRE(layout.detectors_per_round == 20);
+        REQUIRE(layout.space_edges.size() == 25 + 16);
+    }
+
+    SECTION("Rotated surface code") {
+        for (size_t d : {3, 5, 7}) {
+            auto layout = RotatedSurfaceCodeLayout(d);
+            REQUIRE(layout.detectors_per_round == (d * d - 1) / 2);
+            REQUIRE(layout.space_edges.size() == d * d);
+
+            // Weight-4 stabilizers in the bulk and weight-2 ones on the left
+            // and right sides, and one boundary edge per qubit of the top and
+            // bottom rows
+            auto graph = RotatedSurfaceCodeGraph(d);
+            const size_t boundary = graph.GetNumVertices() - 1;
+            size_t weight_two = 0;
+            for (size_t v = 0; v < boundary; v++) {
+                const size_t degree = graph.GetEdgesTouchingVertex(v).size();
+                REQUIRE((degree == 4 || degree == 2));
+                weight_two += degree == 2;
+            }
+            REQUIRE(weight_two == d - 1);
+            REQUIRE(graph.GetEdgesTouchingVertex(boundary).size() == 2 * d);
+
+            // Every detector is at most halfway from the top or the bottom
+            ShortestPaths paths(graph);
+            for (size_t v = 0; v < boundary; v++) {
+                REQUIRE(paths.GetDistanceToBoundary(v).first <= (d + 1) / 2);
+            }
+        }
+    }
+}
+
+TEST_CASE("Generators reject invalid layouts", "[Generators]") {
+    REQUIRE_THROWS_AS(RepetitionCodeLayout(1), std::invalid_argument);
+    REQUIRE_THROWS_AS(RotatedSurfaceCodeLayout(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(SurfaceCodeGraph(3, {.rounds = 0}),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(SpaceTimeGraph(SpaceTimeLayout{2, {{0, 3}}}),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(SpaceTimeGraph<uint32_t>(RepetitionCodeLayout(3),
+                                               {.rounds = 1ul << 32}),
+                      std::overflow_error);
+}
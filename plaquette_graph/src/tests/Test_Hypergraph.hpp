@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "Hypergraph.hpp"
+#include "TestHelpers.hpp"
+
+using namespace Plaquette;
+
+TEMPLATE_TEST_CASE("Hypergraph stores the incidence in both directions",
+                   "[Hypergraph]", size_t, uint32_t) {
+    std::vector<std::vector<size_t>> hyperedges{
+        {2, 0, 1}, {1}, {}, {3, 1}, {0, 1, 2, 3}};
+    std::vector<EdgeWeight> weights{5, 6, 7, 8, 9};
+    Hypergraph<TestType> h(5, hyperedges, weights);
+
+    REQUIRE(h.GetNumVertices() == 5);
+    REQUIRE(h.GetNumHyperedges() == 5);
+    REQUIRE(h.GetNumIncidences() == 10);
+    REQUIRE(h.HasHyperedgeWeights());
+    REQUIRE(h.GetHyperedgeWeight(3) == 8);
+
+    REQUIRE(RowToVector(h.GetVerticesOfHyperedge(0)) ==
+            std::vector<size_t>{0, 1, 2});
+    REQUIRE(RowToVector(h.GetVerticesOfHyperedge(2)).empty());
+    REQUIRE(RowToVector(h.GetVerticesOfHyperedge(3)) ==
+            std::vector<size_t>{1, 3});
+
+    REQUIRE(RowToVector(h.GetHyperedgesTouchingVertex(0)) ==
+            std::vector<size_t>{0, 4});
+    REQUIRE(RowToVector(h.GetHyperedgesTouchingVertex(1)) ==
+            std::vector<size_t>{0, 1, 3, 4});
+    REQUIRE(RowToVector(h.GetHyperedgesTouchingVertex(3)) ==
+            std::vector<size_t>{3, 4});
+    REQUIRE(RowToVector(h.GetHyperedgesTouchingVertex(4)).empty());
+
+    // The flat incidence list gives the same hypergraph
+    std::vector<int64_t> offsets{0, 3, 4, 4, 6, 10};
+    std::vector<int64_t> vertices{2, 0, 1, 1, 3, 1, 0, 1, 2, 3};
+    Hypergraph<TestType> flat(5, std::span<const int64_t>(offsets),
+                              std::span<const int64_t>(vertices), weights);
+    REQUIRE(std::ranges::equal(flat.GetHyperedgeToVertexCol(),
+                               h.GetHyperedgeToVertexCol()));
+    REQUIRE(std::ranges::equal(flat.GetVertexToHyperedgeRowPtr(),
+                               h.GetVertexToHyperedgeRowPtr()));
+    REQUIRE(std::ranges::equal(flat.GetVertexToHyperedgeCol(),
+                               h.GetVertexToHyperedgeCol()));
+}
+
+TEST_CASE("Hypergraph rejects invalid hyperedges", "[Hypergraph]") {
+    std::vector<EdgeWeight> weights{1};
+    REQUIRE_THROWS_AS(Hypergraph<>(3, {{0, 3}}), std::invalid_argument);
+    REQUIRE_THROWS_AS(Hypergraph<>(3, {{0, 2, 0}}), std::invalid_argument);
+    REQUIRE_THROWS_AS(Hypergraph<>(3, {{0}, {1}}, weights),
+                      std::invalid_argument);
+
+    std::vector<int64_t> offsets{0, 2, 1, 3};
+    std::vector<int64_t> vertices{0, 1, 2};
+    REQUIRE_THROWS_AS(Hypergraph<>(3, std::span<const int64_t>(offsets),
+                                   std::span<const int64_t>(vertices)),
+                      std::invalid_argument);
+    std::vector<int64_t> negative{0, -1, 2};
+    offsets = {0, 3};
+    REQUIRE_THROWS_AS(Hypergraph<>(3, std::span<const int64_t>(offsets),
+                                   std::span<const int64_t>(negative)),
+                      std::invalid_argument);
+
+    REQUIRE_THROWS_AS(Hypergraph<uint8_t>(256, {{0}}), std::overflow_error);
+
+    Hypergraph<> empty;
+    REQUIRE(empty.GetNumHyperedges() == 0);
+    REQUIRE(empty.GetHyperedgeToVertexRowPtr().size() == 1);
+}
+
+TEMPLATE_TEST_CASE("Hypergraph decomposes into a decoding graph",
+                   "[Hypergraph]", size_t, uint32_t) {
+    std::vector<std::vector<size_t>> hyperedges{
+        {0, 1, 2}, {3}, {0, 1, 2, 3}, {}, {1, 2}};
+    std::vector<EdgeWeight> weights{10, 20, 30, 40, 50};
+    Hypergraph<TestType> h(4, hyperedges, weights);
+    const size_t boundary = 4;
+
+    auto pairs = h.ToDecodingGraph();
+    REQUIRE(pairs.GetNumVertices() == 5);
+    for (size_t v = 0; v < 5; v++) {
+        REQUIRE(pairs.IsVertexOnBoundary(v) == (v == boundary));
+    }
+    // (0, 1) and (2, b), then (3, b), then (0, 1) again and (2, 3), then
+    // (1, 2)
+    REQUIRE(pairs.GetNumEdges() == 5);
+    auto edge_weight = [](const auto &graph, size_t u, size_t v) {
+        size_t edge = graph.GetEdgeFromVertexPair(std::make_pair(u, v));
+        REQUIRE(edge != graph.kInvalidIndex);
+        return graph.GetEdgeWeight(edge);
+    };
+    REQUIRE(edge_weight(pairs, 0, 1) == 10);
+    REQUIRE(edge_weight(pairs, 2, boundary) == 10);
+    REQUIRE(edge_weight(pairs, 3, boundary) == 20);
+    REQUIRE(edge_weight(pairs, 2, 3) == 30);
+    REQUIRE(edge_weight(pairs, 1, 2) == 50);
+
+    auto clique = h.ToDecodingGraph(HyperedgeDecomposition::Clique);
+    // The 6 pairs of {0, 1, 2, 3} and (3, b)
+    REQUIRE(clique.GetNumEdges() == 7);
+    REQUIRE(edge_weight(clique, 0, 2) == 10);
+    REQUIRE(edge_weight(clique, 1, 2) == 10);
+    REQUIRE(edge_weight(clique, 0, 3) == 30);
+    REQUIRE(edge_weight(clique, 3, boundary) == 20);
+    REQUIRE(clique.GetEdgeFromVertexPair(std::make_pair(
+                size_t{2}, boundary)) == clique.kInvalidIndex);
+
+    // Unweighted hypergraphs give unweighted graphs
+    Hypergraph<TestType> unweighted(4, hyperedges);
+    REQUIRE_FALSE(unweighted.HasHyperedgeWeights());
+    REQUIRE(unweighted.GetHyperedgeWeight(0) == 1);
+    REQUIRE(unweighted.ToDecodingGraph().GetEdgeWeights().empty());
+}
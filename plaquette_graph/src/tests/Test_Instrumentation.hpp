@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "CompressedSparseGraph.hpp"
+#include "DecodingGraph.hpp"
+#include "Instrumentation.hpp"
+#include "SparseGraph.hpp"
+
+using namespace Plaquette;
+
+namespace {
+std::map<std::string, ArrayFootprint>
+FootprintByName(const MemoryFootprint &footprint) {
+    std::map<std::string, ArrayFootprint> arrays;
+    for (const auto &array : footprint.arrays) {
+        arrays[array.name] = array;
+    }
+    return arrays;
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("Graphs report their construction timings",
+                   "[Instrumentation]", size_t, uint32_t) {
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t v = 0; v + 1 < 1000; v++) {
+        edges.emplace_back(v, v + 1);
+        edges.emplace_back(v + 1, v);
+    }
+    SparseGraphOptions options;
+    options.edge_index = true;
+    DecodingGraph<TestType> graph(1000, edges,
+                                  std::vector<bool>(1000, false), options);
+
+    auto timings = graph.GetConstructionTimings();
+    REQUIRE(timings.deduplicate_edges > 0);
+    REQUIRE(timings.vertex_to_vertex > 0);
+    REQUIRE(timings.edge_index > 0);
+    REQUIRE(timings.edge_to_edge == 0);
+    REQUIRE(timings.local_edge_maps > 0);
+    REQUIRE(graph.SparseGraph<TestType>::GetConstructionTimings()
+                .local_edge_maps == 0);
+
+    graph.GetEdgesTouchingEdge(0);
+    REQUIRE(graph.GetConstructionTimings().edge_to_edge > 0);
+
+    // Graphs assembled from arrays did no construction work
+    SparseGraphArrays<TestType> arrays;
+    arrays.v_to_v_row_ptr = std::vector<TestType>{0};
+    auto empty = SparseGraph<TestType>::FromArrays(0, std::move(arrays));
+    REQUIRE(empty.GetConstructionTimings().vertex_to_vertex == 0);
+}
+
+TEMPLATE_TEST_CASE("Graphs report their memory footprint",
+                   "[Instrumentation]", size_t, uint32_t) {
+    const size_t num_vertices = 50;
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<bool> boundary(num_vertices, false);
+    boundary[0] = true;
+    for (size_t v = 1; v < num_vertices; v++) {
+        edges.emplace_back(v - 1, v);
+        edges.emplace_back(v, 0);
+    }
+    std::vector<EdgeWeight> weights(edges.size(), 3);
+    DecodingGraph<TestType> graph(num_vertices, edges, weights, boundary);
+    const size_t num_edges = graph.GetNumEdges();
+
+    auto arrays = FootprintByName(graph.GetMemoryFootprint());
+    REQUIRE(arrays.size() == 9);
+    REQUIRE(arrays.count("e_to_e_col") == 0);
+    REQUIRE(arrays.count("edge_index") == 0);
+    REQUIRE(arrays["v_to_v_row_ptr"].bytes ==
+            (num_vertices + 1) * sizeof(TestType));
+    REQUIRE(arrays["v_to_v_col"].bytes == 2 * num_edges * sizeof(TestType));
+    REQUIRE(arrays["e_to_v"].bytes == 2 * num_edges * sizeof(TestType));
+    REQUIRE(arrays["edge_weights"].bytes == num_edges * sizeof(EdgeWeight));
+    REQUIRE(arrays["vertex_boundary_type"].bytes == num_vertices);
+    REQUIRE(arrays["global_to_local_edge_map"].bytes ==
+            2 * num_edges * sizeof(TestType));
+    for (const auto &[name, array] : arrays) {
+        REQUIRE(array.capacity_bytes >= array.bytes);
+        REQUIRE_FALSE(array.external);
+    }
+
+    graph.GetEdgesTouchingEdge(0);
+    graph.BuildEdgeIndex();
+    auto footprint = graph.GetMemoryFootprint();
+    arrays = FootprintByName(footprint);
+    REQUIRE(arrays["e_to_e_row_ptr"].bytes ==
+            (num_edges + 1) * sizeof(TestType));
+    REQUIRE(arrays["e_to_e_col"].bytes ==
+            graph.GetEdgeToEdgeCol().size() * sizeof(TestType));
+    REQUIRE(arrays["edge_index"].bytes >= num_edges * sizeof(TestType));
+    size_t total = 0;
+    for (const auto &[name, array] : arrays) {
+        total += array.bytes;
+    }
+    REQUIRE(footprint.GetTotalBytes() == total);
+    REQUIRE(footprint.GetTotalCapacityBytes() >= total);
+
+    // External arrays are not allocated by the graph
+    auto row_ptr = std::make_shared<std::vector<TestType>>(
+        std::vector<TestType>{0, 0});
+    SparseGraphArrays<TestType> external;
+    external.v_to_v_row_ptr =
+        ArrayBuffer<TestType>(row_ptr->data(), row_ptr->size(), row_ptr);
+    auto loaded = SparseGraph<TestType>::FromArrays(1, std::move(external));
+    arrays = FootprintByName(loaded.GetMemoryFootprint());
+    REQUIRE(arrays["v_to_v_row_ptr"].external);
+    REQUIRE(arrays["v_to_v_row_ptr"].bytes == 2 * sizeof(TestType));
+    REQUIRE(arrays["v_to_v_row_ptr"].capacity_bytes == 0);
+
+    CompressedSparseGraph<TestType> compressed(graph, EdgeToEdgeMode::Eager);
+    footprint = compressed.GetMemoryFootprint();
+    arrays = FootprintByName(footprint);
+    REQUIRE(arrays.size() == 6);
+    REQUIRE(arrays["v_to_v_data"].bytes + arrays["v_to_v_offsets"].bytes +
+                arrays["e_to_e_data"].bytes + arrays["e_to_e_offsets"].bytes ==
+            compressed.GetCompressedBytes());
+}
+
+TEST_CASE("Graphs count their queries", "[Instrumentation]") {
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}, {1, 2}, {2, 0}};
+    SparseGraph graph(4, edges);
+    graph.GetEdgesTouchingVertex(0);
+    graph.GetVerticesTouchingVertex(1);
+    graph.GetEdgesTouchingEdge(0);
+    graph.GetEdgesTouchingEdgeImplicit(1);
+    graph.GetVerticesConnectedByEdge(2);
+    graph.GetEdgeFromVertexPair({0, 1});
+    graph.GetEdgeFromVertexPair({0, 3});
+
+    std::vector<size_t> vertices = {0, 1, 2};
+    graph.GetEdgesTouchingVertices(vertices);
+    std::vector<size_t> pairs = {1, 2, 3, 1}, found(2);
+    graph.GetEdgesFromVertexPairs(pairs, found);
+
+    auto counts = graph.GetQueryCounts();
+    if constexpr (kQueryCountersEnabled) {
+        REQUIRE(counts.vertex_rows == 5);
+        REQUIRE(counts.edge_rows == 2);
+        REQUIRE(counts.edge_endpoints == 1);
+        REQUIRE(counts.vertex_pairs == 4);
+        REQUIRE(counts.vertex_pair_misses == 2);
+
+        // Copies and moves start from zero
+        SparseGraph copy = graph;
+        REQUIRE(copy.GetQueryCounts().vertex_rows == 0);
+        copy.GetEdgesTouchingVertex(0);
+        SparseGraph moved = std::move(copy);
+        REQUIRE(moved.GetQueryCounts().vertex_rows == 0);
+        REQUIRE(copy.GetQueryCounts().vertex_rows == 0);
+    } else {
+        REQUIRE(std::is_empty_v<QueryCounters<>>);
+        REQUIRE(counts.vertex_rows == 0);
+        REQUIRE(counts.vertex_pairs == 0);
+    }
+
+    graph.ResetQueryCounts();
+    counts = graph.GetQueryCounts();
+    REQUIRE(counts.vertex_rows == 0);
+    REQUIRE(counts.edge_rows == 0);
+    REQUIRE(counts.vertex_pair_misses == 0);
+
+    // Construction does not count as queries
+    DecodingGraph decoding_graph(4, edges, std::vector<bool>(4, false),
+                                 {.edge_to_edge = EdgeToEdgeMode::Eager});
+    REQUIRE(decoding_graph.GetQueryCounts().vertex_rows == 0);
+    REQUIRE(decoding_graph.GetQueryCounts().edge_endpoints == 0);
+}
@@ -11,14 +11,21 @@
 #include <catch2/catch.hpp>
 
 #include "MultiGraph.hpp"
+#include "TestHelpers.hpp"
+
+using namespace Plaquette;
+
 TEST_CASE("GetEdgesTouchingVertex returns correct edges", "[MultiGraph]") {
     std::vector<std::pair<size_t, size_t>> edges{{0, 1}, {0, 2}, {1, 2}};
     std::vector<size_t> weights{1, 2, 3};
     MultiGraph g(edges, weights);
 
-    REQUIRE(g.GetEdgesTouchingVertex(0) == std::vector<size_t>{0, 1});
-    REQUIRE(g.GetEdgesTouchingVertex(1) == std::vector<size_t>{0, 2});
-    REQUIRE(g.GetEdgesTouchingVertex(2) == std::vector<size_t>{1, 2});
+    REQUIRE(RowToVector(g.GetEdgesTouchingVertex(0)) ==
+            std::vector<size_t>{0, 1});
+    REQUIRE(RowToVector(g.GetEdgesTouchingVertex(1)) ==
+            std::vector<size_t>{0, 2});
+    REQUIRE(RowToVector(g.GetEdgesTouchingVertex(2)) ==
+            std::vector<size_t>{1, 2});
 }
 
 TEST_CASE("GetVerticesTouchingVertex returns correct vertices",
@@ -27,9 +34,12 @@ TEST_CASE("GetVerticesTouchingVertex returns correct vertices",
     std::vector<size_t> weights{1, 2, 3};
     MultiGraph g(edges, weights);
 
-    REQUIRE(g.GetVerticesTouchingVertex(0) == std::vector<size_t>{1, 2});
-    REQUIRE(g.GetVerticesTouchingVertex(1) == std::vector<size_t>{0, 2});
-    REQUIRE(g.GetVerticesTouchingVertex(2) == std::vector<size_t>{0, 1});
+    REQUIRE(RowToVector(g.GetVerticesTouchingVertex(0)) ==
+            std::vector<size_t>{1, 2});
+    REQUIRE(RowToVector(g.GetVerticesTouchingVertex(1)) ==
+            std::vector<size_t>{0, 2});
+    REQUIRE(RowToVector(g.GetVerticesTouchingVertex(2)) ==
+            std::vector<size_t>{0, 1});
 }
 
 TEST_CASE("GetWeight returns correct weight", "[MultiGraph]") {
@@ -70,5 +80,195 @@ TEST_CASE(
     std::vector<size_t> weights{1, 2, 3};
     MultiGraph g(edges, weights);
 
-    REQUIRE(g.GetVerticesTouchingVertex(3) == std::vector<size_t>{});
+    REQUIRE(RowToVector(g.GetVerticesTouchingVertex(3)) ==
+            std::vector<size_t>{});
+}
+
+TEST_CASE("MultiGraph rows of parallel edges and self-loops", "[MultiGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges{{0, 1}, {1, 0}, {1, 1}};
+    std::vector<size_t> weights{1, 2, 3};
+    MultiGraph g(edges, weights);
+
+    REQUIRE(RowToVector(g.GetEdgesTouchingVertex(0)) ==
+            std::vector<size_t>{0, 1});
+    REQUIRE(RowToVector(g.GetEdgesTouchingVertex(1)) ==
+            std::vector<size_t>{0, 1, 2, 2});
+    REQUIRE(RowToVector(g.GetVerticesTouchingVertex(1)) ==
+            std::vector<size_t>{0, 0, 1, 1});
+    REQUIRE(g.GetEdgeConnectingVertices(1, 1) == 2);
+    REQUIRE(g.GetEdgeConnectingVertices(0, 2) == 3);
+}
+
+TEST_CASE("MultiGraph rejects mismatched weights", "[MultiGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges{{0, 1}, {0, 2}};
+    std::vector<size_t> weights{1};
+    REQUIRE_THROWS_AS(MultiGraph(edges, weights), std::invalid_argument);
+}
+
+TEST_CASE("GetEdgesTouchingEdge handles parallel edges and self-loops",
+          "[MultiGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges{
+        {0, 1}, {1, 0}, {1, 1}, {1, 2}, {3, 4}, {2, 2}, {0, 1}};
+    std::vector<size_t> weights(edges.size(), 1);
+    MultiGraph g(edges, weights);
+
+    for (size_t e = 0; e < edges.size(); e++) {
+        std::vector<size_t> expected;
+        for (size_t f = 0; f < edges.size(); f++) {
+            if (f != e && (edges[f].first == edges[e].first ||
+                           edges[f].first == edges[e].second ||
+                           edges[f].second == edges[e].first ||
+                           edges[f].second == edges[e].second)) {
+                expected.push_back(f);
+            }
+        }
+        REQUIRE(g.GetEdgesTouchingEdge(e) == expected);
+    }
+    REQUIRE(g.GetEdgesTouchingEdge(edges.size()).empty());
+}
+
+TEST_CASE("GetEdgesTouchingEdgeRow matches GetEdgesTouchingEdge",
+          "[MultiGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges{
+        {0, 1}, {1, 0}, {1, 1}, {1, 2}, {3, 4}, {2, 2}, {0, 1}};
+    std::vector<size_t> weights(edges.size(), 1);
+    MultiGraph g(edges, weights);
+
+    REQUIRE_FALSE(g.IsEdgeToEdgeMatrixConstructed());
+    for (size_t e = 0; e < edges.size(); e++) {
+        REQUIRE(RowToVector(g.GetEdgesTouchingEdgeRow(e)) ==
+                g.GetEdgesTouchingEdge(e));
+    }
+    REQUIRE(g.IsEdgeToEdgeMatrixConstructed());
+    REQUIRE_THROWS_AS(g.GetEdgesTouchingEdgeRow(edges.size()),
+                      std::out_of_range);
+    REQUIRE_THROWS_AS(MultiGraph({}, {}).GetEdgesTouchingEdgeRow(0),
+                      std::out_of_range);
+}
+
+TEST_CASE("MultiGraph sorted rows and edge index lookups", "[MultiGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {3, 0}, {0, 1}, {2, 0}, {1, 0}, {1, 1}, {0, 3}, {2, 3}};
+    std::vector<size_t> weights(edges.size(), 1);
+    MultiGraph reference(edges, weights);
+    MultiGraph sorted(edges, weights, true);
+    MultiGraph indexed(edges, weights);
+    indexed.BuildEdgeIndex();
+    REQUIRE(sorted.AreRowsSorted());
+    REQUIRE(indexed.HasEdgeIndex());
+
+    REQUIRE(RowToVector(sorted.GetVerticesTouchingVertex(0)) ==
+            std::vector<size_t>{1, 1, 2, 3, 3});
+    REQUIRE(RowToVector(sorted.GetEdgesTouchingVertex(0)) ==
+            std::vector<size_t>{1, 3, 2, 0, 5});
+
+    for (size_t u = 0; u <= 4; u++) {
+        for (size_t v = 0; v <= 4; v++) {
+            auto expected = reference.GetEdgeConnectingVertices(u, v);
+            REQUIRE(sorted.GetEdgeConnectingVertices(u, v) == expected);
+            REQUIRE(indexed.GetEdgeConnectingVertices(u, v) == expected);
+        }
+    }
+    REQUIRE(sorted.GetEdgeConnectingVertices(0, 3) == 0);
+    REQUIRE(indexed.GetEdgeConnectingVertices(1, 1) == 4);
+    REQUIRE(indexed.GetEdgeConnectingVertices(1, 2) == edges.size());
+}
+
+TEST_CASE("MultiGraph assembled from external arrays", "[MultiGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {3, 0}, {0, 1}, {2, 0}, {1, 0}, {1, 1}, {0, 3}, {2, 3}};
+    std::vector<size_t> weights{1, 2, 3, 4, 5, 6, 7};
+    MultiGraph reference(edges, weights, true);
+
+    // The arrays view memory kept alive by a shared owner
+    auto copy = [](auto span) {
+        using T = typename decltype(span)::value_type;
+        auto owner = std::make_shared<std::vector<T>>(span.begin(), span.end());
+        return ArrayBuffer<T>(owner->data(), owner->size(), owner);
+    };
+    MultiGraphArrays arrays;
+    arrays.v_to_v_row_ptr = copy(reference.GetVertexToVertexRowPtr());
+    arrays.v_to_v_col = copy(reference.GetVertexToVertexCol());
+    arrays.v_to_v_edges = copy(reference.GetVertexToVertexEdges());
+    arrays.edges = copy(reference.GetEdges());
+    arrays.weights = copy(reference.GetWeights());
+    arrays.sorted_rows = true;
+    MultiGraph graph = MultiGraph::FromArrays(arrays);
+
+    REQUIRE(graph.GetNumVertices() == reference.GetNumVertices());
+    REQUIRE(graph.GetNumEdges() == reference.GetNumEdges());
+    REQUIRE(graph.AreRowsSorted());
+    for (size_t v = 0; v < graph.GetNumVertices(); v++) {
+        REQUIRE(RowToVector(graph.GetEdgesTouchingVertex(v)) ==
+                RowToVector(reference.GetEdgesTouchingVertex(v)));
+        REQUIRE(graph.GetEdgeConnectingVertices(v, 0) ==
+                reference.GetEdgeConnectingVertices(v, 0));
+    }
+    for (size_t e = 0; e < edges.size(); e++) {
+        REQUIRE(graph.GetWeight(e) == weights[e]);
+        REQUIRE(RowToVector(graph.GetEdgesTouchingEdgeRow(e)) ==
+                reference.GetEdgesTouchingEdge(e));
+    }
+
+    // Corrupted indices are rejected
+    auto corrupted = [&](auto member, size_t index, auto value) {
+        MultiGraphArrays copied = arrays;
+        auto values = std::vector((copied.*member).begin(),
+                                  (copied.*member).end());
+        values[index] = value;
+        copied.*member = ArrayBuffer(values);
+        return copied;
+    };
+    const size_t num_vertices = reference.GetNumVertices();
+    const size_t num_edges = reference.GetNumEdges();
+    const std::pair<size_t, size_t> bad_edge{0, num_vertices};
+    for (auto &bad :
+         {corrupted(&MultiGraphArrays::v_to_v_row_ptr, 1, 2 * num_edges),
+          corrupted(&MultiGraphArrays::v_to_v_col, 0, num_vertices),
+          corrupted(&MultiGraphArrays::v_to_v_edges, 1, num_edges),
+          corrupted(&MultiGraphArrays::edges, 2, bad_edge)}) {
+        REQUIRE_THROWS_AS(MultiGraph::FromArrays(bad), std::invalid_argument);
+    }
+
+    arrays.weights = ArrayBuffer<size_t>(std::vector<size_t>{1});
+    REQUIRE_THROWS_AS(MultiGraph::FromArrays(std::move(arrays)),
+                      std::invalid_argument);
+}
+
+TEST_CASE("A moved-from MultiGraph is an empty multi-graph", "[MultiGraph]") {
+    static_assert(std::is_nothrow_move_constructible_v<MultiGraph>);
+    static_assert(std::is_nothrow_move_assignable_v<MultiGraph>);
+    std::vector<std::pair<size_t, size_t>> edges{{0, 1}, {1, 2}, {1, 2}};
+    MultiGraph graph(edges, {1, 2, 3});
+    graph.GetEdgesTouchingEdgeRow(0);
+
+    auto require_empty = [](const MultiGraph &g) {
+        REQUIRE(g.GetNumVertices() == 0);
+        REQUIRE(g.GetNumEdges() == 0);
+        REQUIRE_FALSE(g.IsEdgeToEdgeMatrixConstructed());
+        REQUIRE_NOTHROW(g.ConstructEdgeToEdgeMatrix());
+        REQUIRE_THROWS_AS(g.GetEdgesTouchingEdgeRow(0), std::out_of_range);
+        REQUIRE(g.GetEdges().empty());
+        REQUIRE(RowToVector(g.GetVertexToVertexRowPtr()) ==
+                std::vector<size_t>{0});
+
+        // The arrays of an empty multi-graph assemble back into one
+        MultiGraphArrays arrays;
+        arrays.v_to_v_row_ptr = ArrayBuffer<size_t>(std::vector<size_t>(
+            g.GetVertexToVertexRowPtr().begin(),
+            g.GetVertexToVertexRowPtr().end()));
+        REQUIRE(MultiGraph::FromArrays(std::move(arrays)).GetNumVertices() ==
+                0);
+    };
+
+    MultiGraph moved(std::move(graph));
+    require_empty(graph);
+    REQUIRE(moved.IsEdgeToEdgeMatrixConstructed());
+    MultiGraph copy = graph;
+    require_empty(copy);
+
+    graph = std::move(moved);
+    require_empty(moved);
+    REQUIRE(RowToVector(graph.GetEdgesTouchingEdgeRow(0)) ==
+            std::vector<size_t>{1, 2});
 }
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "DecodingGraph.hpp"
+#include "Generators.hpp"
+#include "Reordering.hpp"
+#include "ShortestPaths.hpp"
+
+using namespace Plaquette;
+using namespace Plaquette::Reordering;
+
+namespace {
+// The largest difference between the IDs of neighbouring vertices
+template <typename IndexT> size_t Bandwidth(const SparseGraph<IndexT> &graph) {
+    size_t bandwidth = 0;
+    for (size_t e = 0; e < graph.GetNumEdges(); e++) {
+        auto [u, v] = graph.GetVerticesConnectedByEdge(e);
+        bandwidth = std::max<size_t>(bandwidth, u > v ? u - v : v - u);
+    }
+    return bandwidth;
+}
+
+// A rows x cols grid whose vertex labels are shuffled, with a boundary vertex
+// connected to the first column, and the coordinates of every vertex
+template <typename IndexT>
+std::pair<DecodingGraph<IndexT>, std::vector<double>>
+ShuffledGrid(size_t rows, size_t cols, unsigned seed) {
+    const size_t n = rows * cols;
+    std::vector<size_t> label(n + 1);
+    std::iota(label.begin(), label.end(), 0);
+    std::mt19937 rng(seed);
+    std::shuffle(label.begin(), label.end(), rng);
+
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<EdgeWeight> weights;
+    std::vector<double> coordinates(2 * (n + 1), -1.0);
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < cols; c++) {
+            const size_t v = r * cols + c;
+            coordinates[2 * label[v]] = static_cast<double>(c);
+            coordinates[2 * label[v] + 1] = static_cast<double>(r);
+            if (c + 1 < cols) {
+                edges.emplace_back(label[v], label[v + 1]);
+            }
+            if (r + 1 < rows) {
+                edges.emplace_back(label[v], label[v + cols]);
+            }
+            if (c == 0) {
+                edges.emplace_back(label[n], label[v]);
+            }
+        }
+    }
+    for (size_t e = 0; e < edges.size(); e++) {
+        weights.push_back(1 + e % 5);
+    }
+    std::vector<bool> boundary(n + 1, false);
+    boundary[label[n]] = true;
+    return {DecodingGraph<IndexT>(n + 1, edges, weights, boundary),
+            coordinates};
+}
+
+template <typename IndexT>
+void RequireSameGraphUpToLabels(
+    const DecodingGraph<IndexT> &graph,
+    const ReorderedGraph<DecodingGraph<IndexT>> &reordered) {
+    const auto &g = reordered.graph;
+    const auto &vf = reordered.vertices.forward;
+    const auto &ef = reordered.edges.forward;
+    REQUIRE(g.GetNumVertices() == graph.GetNumVertices());
+    REQUIRE(g.GetNumEdges() == graph.GetNumEdges());
+    for (size_t v = 0; v < vf.size(); v++) {
+        REQUIRE(reordered.vertices.inverse[vf[v]] == v);
+    }
+    for (size_t e = 0; e < ef.size(); e++) {
+        REQUIRE(reordered.edges.inverse[ef[e]] == e);
+        auto [u, v] = graph.GetVerticesConnectedByEdge(e);
+        REQUIRE(g.GetVerticesConnectedByEdge(ef[e]) ==
+                std::make_pair(vf[u], vf[v]));
+        REQUIRE(g.GetEdgeWeight(ef[e]) == graph.GetEdgeWeight(e));
+    }
+    for (size_t v = 0; v < vf.size(); v++) {
+        REQUIRE(g.IsVertexOnBoundary(vf[v]) == graph.IsVertexOnBoundary(v));
+        std::vector<std::pair<size_t, size_t>> expected, actual;
+        auto vertices = graph.GetVerticesTouchingVertex(v);
+        auto edges = graph.GetEdgesTouchingVertex(v);
+        for (size_t k = 0; k < edges.size(); k++) {
+            expected.emplace_back(vf[vertices[k]], ef[edges[k]]);
+        }
+        auto new_vertices = g.GetVerticesTouchingVertex(vf[v]);
+        auto new_edges = g.GetEdgesTouchingVertex(vf[v]);
+        for (size_t k = 0; k < new_edges.size(); k++) {
+            actual.emplace_back(new_vertices[k], new_edges[k]);
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        REQUIRE(actual == expected);
+    }
+    // The local edge maps are rebuilt for the new rows
+    for (size_t e = 0; e < g.GetNumEdges(); e++) {
+        for (size_t side : {0, 1}) {
+            REQUIRE(g.GetGlobalEdgeFromLocalEdge(
+                        g.GetLocalEdgeFromGlobalEdge(e, side)) == e);
+        }
+    }
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("Reordering relabels vertices and edges consistently",
+                   "[Reordering]", size_t, uint32_t) {
+    auto [graph, coordinates] = ShuffledGrid<TestType>(9, 7, 3);
+    const size_t shuffled_bandwidth = Bandwidth(graph);
+
+    for (auto order :
+         {VertexOrder::ReverseCuthillMcKee, VertexOrder::BreadthFirst,
+          VertexOrder::Morton}) {
+        auto reordered = Reorder(graph, order, coordinates, 2);
+        RequireSameGraphUpToLabels(graph, reordered);
+        REQUIRE(Bandwidth(reordered.graph) < shuffled_bandwidth);
+
+        // Distances are preserved
+        ShortestPaths paths(graph);
+        ShortestPaths new_paths(reordered.graph);
+        const auto &vf = reordered.vertices.forward;
+        for (size_t v = 0; v < graph.GetNumVertices(); v += 5) {
+            REQUIRE(new_paths.GetDistanceToBoundary(vf[v]).first ==
+                    paths.GetDistanceToBoundary(v).first);
+            REQUIRE(new_paths.GetDistance(vf[v], vf[0]) ==
+                    paths.GetDistance(v, 0));
+        }
+    }
+}
+
+TEST_CASE("Vertex orders", "[Reordering]") {
+    // A 6 x 20 grid with shuffled labels
+    const size_t rows = 6, cols = 20;
+    std::vector<size_t> label(rows * cols);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), std::mt19937(7));
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<double> coordinates(2 * rows * cols);
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < cols; c++) {
+            const size_t v = r * cols + c;
+            coordinates[2 * label[v]] = static_cast<double>(c);
+            coordinates[2 * label[v] + 1] = static_cast<double>(r);
+            if (c + 1 < cols) {
+                edges.emplace_back(label[v], label[v + 1]);
+            }
+            if (r + 1 < rows) {
+                edges.emplace_back(label[v], label[v + cols]);
+            }
+        }
+    }
+    SparseGraph graph(rows * cols, edges);
+
+    SECTION("Reverse Cuthill-McKee") {
+        auto order = ReverseCuthillMcKeeOrder(graph);
+        auto reordered = Reorder(graph, Permutation(order));
+        // The search starts from a corner and its levels are anti-diagonals
+        REQUIRE(Bandwidth(reordered.graph) <= 2 * rows);
+        REQUIRE(graph.GetVerticesTouchingVertex(order.back()).size() == 2);
+    }
+
+    SECTION("Breadth-first") {
+        auto order = BreadthFirstOrder(graph);
+        REQUIRE(order.front() == 0);
+        DecodingGraph unit_graph(rows * cols, edges,
+                                 std::vector<bool>(rows * cols, false));
+        ShortestPaths paths(unit_graph);
+        for (size_t i = 1; i < order.size(); i++) {
+            REQUIRE(paths.GetDistance(0, order[i - 1]) <=
+                    paths.GetDistance(0, order[i]));
+        }
+    }
+
+    SECTION("Morton") {
+        auto order = MortonOrder<size_t>(coordinates, 2);
+        // The first 2 x 2 block of the grid comes first, in Z order
+        REQUIRE(std::vector<size_t>(order.begin(), order.begin() + 4) ==
+                std::vector<size_t>{label[0], label[1], label[cols],
+                                    label[cols + 1]});
+        REQUIRE_THROWS_AS(MortonOrder<size_t>(coordinates, 4),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(
+            ComputeVertexOrder(graph, VertexOrder::Morton, {}, 2),
+            std::invalid_argument);
+
+        // Non-finite coordinates have no cell, but the widest finite spread
+        // still orders the points
+        for (double bad : {std::numeric_limits<double>::quiet_NaN(),
+                           std::numeric_limits<double>::infinity(),
+                           -std::numeric_limits<double>::infinity()}) {
+            std::vector<double> corrupted = coordinates;
+            corrupted[3] = bad;
+            REQUIRE_THROWS_AS(MortonOrder<size_t>(corrupted, 2),
+                              std::invalid_argument);
+        }
+        const double largest = std::numeric_limits<double>::max();
+        REQUIRE(MortonOrder<size_t>(std::vector<double>{largest, 0, -largest},
+                                    1) == std::vector<size_t>{2, 1, 0});
+    }
+
+    SECTION("Invalid permutations") {
+        REQUIRE_THROWS_AS(Permutation<size_t>({0, 2, 2}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(Permutation<size_t>({0, 3, 1}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(Reorder(graph, Permutation<size_t>({1, 0})),
+                          std::invalid_argument);
+    }
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "ArrayBuffer.hpp"
+#include "DecodingGraph.hpp"
+#include "ScratchArena.hpp"
+#include "SparseGraph.hpp"
+
+using namespace Plaquette;
+
+namespace {
+// A memory resource counting the allocations it forwards to the heap
+class CountingResource : public std::pmr::memory_resource {
+  public:
+    size_t num_allocations = 0;
+
+  private:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        num_allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *data, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(data, bytes, alignment);
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// A memory resource whose allocations always fail
+class ThrowingResource : public std::pmr::memory_resource {
+  private:
+    void *do_allocate(size_t, size_t) override { throw std::bad_alloc(); }
+
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+template <typename T>
+void RequireEqualArrays(std::span<const T> a, std::span<const T> b) {
+    REQUIRE(std::vector<T>(a.begin(), a.end()) ==
+            std::vector<T>(b.begin(), b.end()));
+}
+
+template <typename IndexT>
+void RequireEqualGraphs(const DecodingGraph<IndexT> &a,
+                        const DecodingGraph<IndexT> &b) {
+    REQUIRE(a.GetNumVertices() == b.GetNumVertices());
+    REQUIRE(a.GetNumEdges() == b.GetNumEdges());
+    REQUIRE(a.AreRowsSorted() == b.AreRowsSorted());
+    RequireEqualArrays(a.GetVertexToVertexRowPtr(),
+                       b.GetVertexToVertexRowPtr());
+    RequireEqualArrays(a.GetVertexToVertexCol(), b.GetVertexToVertexCol());
+    RequireEqualArrays(a.GetVertexToVertexEdges(), b.GetVertexToVertexEdges());
+    RequireEqualArrays(a.GetEdgeToVertex(), b.GetEdgeToVertex());
+    RequireEqualArrays(a.GetEdgeWeights(), b.GetEdgeWeights());
+    RequireEqualArrays(a.GetEdgeToEdgeRowPtr(), b.GetEdgeToEdgeRowPtr());
+    RequireEqualArrays(a.GetEdgeToEdgeCol(), b.GetEdgeToEdgeCol());
+    RequireEqualArrays(a.GetVertexBoundaryTypes(), b.GetVertexBoundaryTypes());
+    RequireEqualArrays(a.GetLocalEdgeStrides(), b.GetLocalEdgeStrides());
+    RequireEqualArrays(a.GetLocalToGlobalEdgeMap(),
+                       b.GetLocalToGlobalEdgeMap());
+    RequireEqualArrays(a.GetGlobalToLocalEdgeMap(),
+                       b.GetGlobalToLocalEdgeMap());
+}
+
+// A random graph with duplicate edges and self-loops
+std::vector<std::pair<size_t, size_t>> RandomEdges(size_t num_vertices,
+                                                   size_t num_edges,
+                                                   size_t seed) {
+    std::vector<std::pair<size_t, size_t>> edges;
+    size_t state = seed;
+    auto next = [&] {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (state >> 33) % num_vertices;
+    };
+    for (size_t i = 0; i < num_edges; i++) {
+        size_t u = next();
+        edges.emplace_back(u, next());
+    }
+    return edges;
+}
+} // namespace
+
+TEST_CASE("ScratchArena reuses its buffer once it has grown",
+          "[ScratchArena]") {
+    CountingResource upstream;
+    ScratchArena arena(&upstream);
+    REQUIRE(arena.capacity() == 0);
+    {
+        ScratchArena::Scope scope(arena);
+        std::pmr::vector<uint32_t> a(1000, 1, &arena);
+        {
+            ScratchArena::Scope inner(arena);
+            std::pmr::vector<uint64_t> b(500, 2, &arena);
+            REQUIRE(b[499] == 2);
+        }
+        REQUIRE(a[999] == 1);
+        REQUIRE(arena.capacity() == 0);
+    }
+    const size_t capacity = arena.capacity();
+    REQUIRE(capacity >= 1000 * sizeof(uint32_t) + 500 * sizeof(uint64_t));
+
+    const size_t num_allocations = upstream.num_allocations;
+    for (size_t i = 0; i < 3; i++) {
+        ScratchArena::Scope scope(arena);
+        std::pmr::vector<uint32_t> a(1000, 1, &arena);
+        std::pmr::vector<uint64_t> b(500, 2, &arena);
+        REQUIRE(static_cast<const void *>(b.data()) >=
+                static_cast<const void *>(a.data() + a.size()));
+    }
+    REQUIRE(upstream.num_allocations == num_allocations);
+    REQUIRE(arena.capacity() == capacity);
+}
+
+TEMPLATE_TEST_CASE("Rebuilt graphs match newly constructed graphs",
+                   "[ScratchArena]", size_t, uint32_t) {
+    SparseGraphOptions options;
+    options.sort_rows = GENERATE(false, true);
+    options.edge_to_edge = EdgeToEdgeMode::Eager;
+
+    DecodingGraph<TestType> graph;
+    for (auto [num_vertices, num_edges] :
+         {std::pair<size_t, size_t>{50, 200}, {80, 400}, {10, 20}, {0, 0}}) {
+        auto edges = RandomEdges(std::max<size_t>(num_vertices, 1), num_edges,
+                                 num_vertices);
+        std::vector<EdgeWeight> weights(edges.size());
+        for (size_t i = 0; i < weights.size(); i++) {
+            weights[i] = static_cast<EdgeWeight>(i % 7);
+        }
+        std::vector<bool> boundary(num_vertices, false);
+        for (size_t v = 0; v < num_vertices; v += 9) {
+            boundary[v] = true;
+        }
+
+        graph.Rebuild(num_vertices, edges, weights, boundary, options);
+        RequireEqualGraphs(graph,
+                           DecodingGraph<TestType>(num_vertices, edges,
+                                                   weights, boundary, options));
+
+        // Lazily constructed edge-edge matrices are reset as well
+        graph.Rebuild(num_vertices, edges, boundary);
+        REQUIRE_FALSE(graph.IsEdgeToEdgeMatrixConstructed());
+        REQUIRE_FALSE(graph.HasEdgeWeights());
+        RequireEqualGraphs(
+            graph, DecodingGraph<TestType>(num_vertices, edges, boundary));
+    }
+}
+
+TEST_CASE("Rebuilding a graph does not allocate once it has grown",
+          "[ScratchArena]") {
+    CountingResource resource;
+    SparseGraphOptions options;
+    options.memory_resource = &resource;
+    options.sort_rows = true;
+    options.edge_to_edge = EdgeToEdgeMode::Eager;
+
+    auto largest = RandomEdges(100, 500, 1);
+    std::vector<bool> boundary(100, false);
+    boundary[0] = true;
+    DecodingGraph<uint32_t> graph(100, largest, boundary, options);
+    REQUIRE(graph.GetMemoryResource() == &resource);
+    graph.Rebuild(100, largest, boundary, options);
+
+    const size_t num_allocations = resource.num_allocations;
+    const size_t capacity = ScratchArena::ForThisThread().capacity();
+    for (size_t seed = 2; seed < 10; seed++) {
+        auto edges = RandomEdges(100, 100 + 40 * seed, seed);
+        graph.Rebuild(100, edges, boundary, options);
+        REQUIRE(graph.GetNumEdges() > 0);
+    }
+    REQUIRE(resource.num_allocations == num_allocations);
+    REQUIRE(ScratchArena::ForThisThread().capacity() == capacity);
+
+    // The resource is kept by later rebuilds
+    graph.Rebuild(100, largest, boundary);
+    REQUIRE(graph.GetMemoryResource() == &resource);
+}
+
+TEST_CASE("Graphs are allocated from a caller-provided arena",
+          "[ScratchArena]") {
+    std::pmr::monotonic_buffer_resource arena;
+    SparseGraphOptions options;
+    options.memory_resource = &arena;
+    auto edges = RandomEdges(30, 60, 3);
+    SparseGraph<uint32_t> graph(30, edges, options);
+    REQUIRE(graph.GetMemoryResource() == &arena);
+    REQUIRE(graph.GetEdgesTouchingEdge(0).size() ==
+            SparseGraph<uint32_t>(30, edges).GetEdgesTouchingEdge(0).size());
+
+    // Copies allocate from the default resource
+    SparseGraph<uint32_t> copy = graph;
+    REQUIRE(copy.GetMemoryResource() == std::pmr::get_default_resource());
+    REQUIRE(copy.GetNumEdges() == graph.GetNumEdges());
+
+    // Moved graphs keep their arena
+    SparseGraph<uint32_t> moved = std::move(graph);
+    REQUIRE(moved.GetMemoryResource() == &arena);
+}
+
+TEST_CASE("A failed array copy leaves the target unchanged",
+          "[ScratchArena]") {
+    ArrayBuffer<uint32_t> source(std::vector<uint32_t>{1, 2, 3});
+    ArrayBuffer<uint32_t> target(std::vector<uint32_t>{4, 5});
+
+    ThrowingResource throwing;
+    auto *previous = std::pmr::set_default_resource(&throwing);
+    REQUIRE_THROWS_AS(target = source, std::bad_alloc);
+    std::pmr::set_default_resource(previous);
+
+    RequireEqualArrays<uint32_t>(target, std::vector<uint32_t>{4, 5});
+    target = source;
+    RequireEqualArrays<uint32_t>(target, source);
+}
+
+TEST_CASE("Rebuilding a graph keeps the matrices shared with copies",
+          "[ScratchArena]") {
+    auto edges = RandomEdges(20, 50, 4);
+    SparseGraph<uint32_t> graph(20, edges);
+    SparseGraph<uint32_t> copy = graph;
+    auto e_to_e_col = copy.GetEdgeToEdgeCol();
+    std::vector<uint32_t> expected(e_to_e_col.begin(), e_to_e_col.end());
+
+    graph.Rebuild(20, RandomEdges(20, 70, 5),
+                  {.edge_to_edge = EdgeToEdgeMode::Eager});
+    REQUIRE(graph.GetNumEdges() != copy.GetNumEdges());
+    e_to_e_col = copy.GetEdgeToEdgeCol();
+    REQUIRE(std::vector<uint32_t>(e_to_e_col.begin(), e_to_e_col.end()) ==
+            expected);
+}
+
+TEST_CASE("A failed rebuild leaves the graph empty", "[ScratchArena]") {
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}, {1, 2}};
+    DecodingGraph<size_t> graph(3, edges, std::vector<bool>(3, false));
+    REQUIRE_THROWS_AS(graph.Rebuild(2, edges, std::vector<bool>(2, false)),
+                      std::invalid_argument);
+    REQUIRE(graph.GetNumVertices() == 0);
+    REQUIRE(graph.GetNumEdges() == 0);
+    REQUIRE(graph.GetNumLocalEdges() == 0);
+    REQUIRE(graph.GetVertexToVertexRowPtr().size() == 1);
+
+    // The emptied graph can be rebuilt
+    graph.Rebuild(3, edges, std::vector<bool>(3, false));
+    REQUIRE(graph.GetEdgesTouchingEdge(0).size() == 1);
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "DecodingGraph.hpp"
+#include "Serialization.hpp"
+#include "SparseGraph.hpp"
+
+using namespace Plaquette;
+
+namespace {
+std::string TemporaryGraphPath(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+template <typename T>
+bool SpansEqual(std::span<const T> lhs, std::span<const T> rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename IndexT>
+void RequireSameGraph(const SparseGraph<IndexT> &lhs,
+                      const SparseGraph<IndexT> &rhs) {
+    REQUIRE(lhs.GetNumVertices() == rhs.GetNumVertices());
+    REQUIRE(lhs.GetNumEdges() == rhs.GetNumEdges());
+    REQUIRE(SpansEqual(lhs.GetVertexToVertexRowPtr(),
+                       rhs.GetVertexToVertexRowPtr()));
+    REQUIRE(SpansEqual(lhs.GetVertexToVertexCol(), rhs.GetVertexToVertexCol()));
+    REQUIRE(SpansEqual(lhs.GetVertexToVertexEdges(),
+                       rhs.GetVertexToVertexEdges()));
+    REQUIRE(SpansEqual(lhs.GetEdgeToVertex(), rhs.GetEdgeToVertex()));
+    REQUIRE(SpansEqual(lhs.GetEdgeToEdgeRowPtr(), rhs.GetEdgeToEdgeRowPtr()));
+    REQUIRE(SpansEqual(lhs.GetEdgeToEdgeCol(), rhs.GetEdgeToEdgeCol()));
+    REQUIRE(SpansEqual(lhs.GetEdgeWeights(), rhs.GetEdgeWeights()));
+}
+} // namespace
+
+TEST_CASE("SparseGraph save and load", "[Serialization]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 0}, {2, 2}, {2, 3}};
+    SparseGraph<uint32_t> graph(5, edges);
+    auto path = TemporaryGraphPath("plaquette_sparse_graph.bin");
+
+    SECTION("Without the edge-edge matrix") {
+        Serialization::SaveGraph(graph, path);
+        for (bool memory_map : {true, false}) {
+            auto loaded =
+                Serialization::LoadSparseGraph<uint32_t>(path, memory_map);
+            REQUIRE_FALSE(loaded.IsEdgeToEdgeMatrixConstructed());
+            RequireSameGraph(loaded, graph);
+        }
+    }
+
+    SECTION("With the edge-edge matrix") {
+        graph.GetEdgesTouchingEdge(0);
+        Serialization::SaveGraph(graph, path);
+        auto loaded = Serialization::LoadSparseGraph<uint32_t>(path);
+        REQUIRE(loaded.IsEdgeToEdgeMatrixConstructed());
+        RequireSameGraph(loaded, graph);
+
+        // The loaded arrays outlive the file mapping of a destroyed copy
+        SparseGraph<uint32_t> copy = loaded;
+        loaded = SparseGraph<uint32_t>();
+        RequireSameGraph(copy, graph);
+    }
+
+    SECTION("With edge weights") {
+        std::vector<EdgeWeight> weights = {5, 1, 4, 2, 3};
+        SparseGraph<uint32_t> weighted(5, edges, weights);
+        Serialization::SaveGraph(weighted, path);
+        auto loaded = Serialization::LoadSparseGraph<uint32_t>(path);
+        REQUIRE(loaded.HasEdgeWeights());
+        RequireSameGraph(loaded, weighted);
+        REQUIRE(loaded.GetEdgeWeight(2) == 4);
+    }
+
+    SECTION("With sorted rows") {
+        SparseGraphOptions options;
+        options.sort_rows = true;
+        SparseGraph<uint32_t> sorted(5, edges, options);
+        Serialization::SaveGraph(sorted, path);
+        auto loaded = Serialization::LoadSparseGraph<uint32_t>(path);
+        REQUIRE(loaded.AreRowsSorted());
+        RequireSameGraph(loaded, sorted);
+        REQUIRE(loaded.GetEdgeFromVertexPair({3, 2}) == 4);
+
+        Serialization::SaveGraph(graph, path);
+        REQUIRE_FALSE(Serialization::LoadSparseGraph<uint32_t>(path)
+                          .AreRowsSorted());
+    }
+
+    SECTION("With the wrong index type") {
+        Serialization::SaveGraph(graph, path);
+        REQUIRE_THROWS_AS(Serialization::LoadSparseGraph<uint64_t>(path),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(Serialization::LoadDecodingGraph<uint32_t>(path),
+                          std::runtime_error);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Empty graphs save and load", "[Serialization]") {
+    auto path = TemporaryGraphPath("plaquette_empty_graph.bin");
+
+    SECTION("Default-constructed") {
+        SparseGraph<uint32_t> graph;
+        Serialization::SaveGraph(graph, path);
+        RequireSameGraph(Serialization::LoadSparseGraph<uint32_t>(path), graph);
+
+        DecodingGraph<> decoding;
+        Serialization::SaveGraph(decoding, path);
+        auto loaded = Serialization::LoadDecodingGraph(path);
+        RequireSameGraph<size_t>(loaded, decoding);
+        REQUIRE(loaded.GetNumLocalEdges() == 0);
+    }
+
+    SECTION("Moved-from") {
+        SparseGraph<uint32_t> graph(3, {{0, 1}, {1, 2}});
+        graph.GetEdgesTouchingEdge(0);
+        SparseGraph<uint32_t> moved = std::move(graph);
+        Serialization::SaveGraph(graph, path);
+        RequireSameGraph(Serialization::LoadSparseGraph<uint32_t>(path),
+                         SparseGraph<uint32_t>());
+
+        DecodingGraph<> decoding(2, {{0, 1}}, {true, false});
+        DecodingGraph<> moved_decoding = std::move(decoding);
+        Serialization::SaveGraph(decoding, path);
+        auto loaded = Serialization::LoadDecodingGraph(path);
+        RequireSameGraph<size_t>(loaded, DecodingGraph<>());
+        REQUIRE(loaded.GetNumLocalEdges() == 0);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("DecodingGraph save and load", "[Serialization]") {
+    DecodingGraph graph(4, {{0, 1}, {1, 2}, {2, 3}, {3, 0}},
+                        {true, false, false, true});
+    auto path = TemporaryGraphPath("plaquette_decoding_graph.bin");
+    Serialization::SaveGraph(graph, path);
+
+    auto header = Serialization::ReadHeader(path);
+    REQUIRE(header.kind ==
+            static_cast<uint32_t>(Serialization::GraphKind::Decoding));
+    REQUIRE(header.index_size == sizeof(size_t));
+    REQUIRE(header.num_vertices == 4);
+    REQUIRE(header.num_edges == 4);
+
+    for (bool memory_map : {true, false}) {
+        auto loaded = Serialization::LoadDecodingGraph(path, memory_map);
+        RequireSameGraph<size_t>(loaded, graph);
+        REQUIRE(loaded.GetNumLocalEdges() == graph.GetNumLocalEdges());
+        for (size_t v = 0; v < 4; v++) {
+            REQUIRE(loaded.IsVertexOnBoundary(v) ==
+                    graph.IsVertexOnBoundary(v));
+            REQUIRE(loaded.GetLocalEdgeStride(v) ==
+                    graph.GetLocalEdgeStride(v));
+        }
+        for (size_t e = 0; e < 4; e++) {
+            REQUIRE(loaded.GetLocalEdgeFromGlobalEdge(e, 1) ==
+                    graph.GetLocalEdgeFromGlobalEdge(e, 1));
+        }
+        for (size_t l = 0; l < graph.GetNumLocalEdges(); l++) {
+            REQUIRE(loaded.GetGlobalEdgeFromLocalEdge(l) ==
+                    graph.GetGlobalEdgeFromLocalEdge(l));
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Loading rejects invalid graph files", "[Serialization]") {
+    auto path = TemporaryGraphPath("plaquette_invalid_graph.bin");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a graph file, but long enough to hold a header........";
+    }
+    REQUIRE_THROWS_AS(Serialization::LoadSparseGraph(path), std::runtime_error);
+    REQUIRE_THROWS_AS(Serialization::LoadSparseGraph(path, false),
+                      std::runtime_error);
+    std::filesystem::remove(path);
+
+    REQUIRE_THROWS_AS(Serialization::LoadSparseGraph(path), std::runtime_error);
+}
+
+TEST_CASE("Loading rejects truncated and corrupted graph files",
+          "[Serialization]") {
+    std::vector<EdgeWeight> weights{5, 4, 3, 2, 1};
+    DecodingGraph<uint32_t> graph(5, {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}},
+                                  weights, {true, false, false, false, true});
+    graph.GetEdgesTouchingEdge(0);
+    auto path = TemporaryGraphPath("plaquette_corrupted_graph.bin");
+    Serialization::SaveGraph(graph, path);
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    auto write = [&](const std::string &data) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    };
+
+    for (size_t size = 0; size < bytes.size(); size++) {
+        write(bytes.substr(0, size));
+        for (bool memory_map : {true, false}) {
+            REQUIRE_THROWS(
+                Serialization::LoadDecodingGraph<uint32_t>(path, memory_map));
+        }
+    }
+
+    // A header whose edge count does not match the edge sections
+    for (uint64_t num_edges : {uint64_t{4}, uint64_t{6}}) {
+        std::string corrupted = bytes;
+        std::memcpy(corrupted.data() +
+                        offsetof(Serialization::FileHeader, num_edges),
+                    &num_edges, sizeof(num_edges));
+        write(corrupted);
+        REQUIRE_THROWS_AS(Serialization::LoadSparseGraph<uint32_t>(path),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(Serialization::LoadDecodingGraph<uint32_t>(path),
+                          std::runtime_error);
+    }
+
+    // A flipped bit is either rejected, or lands in a value that leaves the
+    // graph valid, such as a weight or padding. The loaded graph is walked
+    // so that any out-of-range index shows up under the sanitizers.
+    size_t num_rejected = 0;
+    for (size_t i = 0; i < bytes.size(); i++) {
+        for (char mask : {'\x01', '\x80'}) {
+            std::string corrupted = bytes;
+            corrupted[i] ^= mask;
+            write(corrupted);
+            try {
+                auto loaded = Serialization::LoadDecodingGraph<uint32_t>(path);
+                for (size_t e = 0; e < loaded.GetNumEdges(); e++) {
+                    for (size_t f : loaded.GetEdgesTouchingEdge(e)) {
+                        REQUIRE(f < loaded.GetNumEdges());
+                    }
+                    for (size_t j : {0, 1}) {
+                        REQUIRE(loaded.GetGlobalEdgeFromLocalEdge(
+                                    loaded.GetLocalEdgeFromGlobalEdge(e, j)) ==
+                                e);
+                    }
+                }
+                for (size_t v = 0; v < loaded.GetNumVertices(); v++) {
+                    for (size_t u : loaded.GetVerticesTouchingVertex(v)) {
+                        REQUIRE(u < loaded.GetNumVertices());
+                    }
+                }
+            } catch (const std::exception &) {
+                num_rejected++;
+            }
+        }
+    }
+    REQUIRE(num_rejected > bytes.size());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Saving over a loaded graph file leaves the loaded graph intact",
+          "[Serialization]") {
+    SparseGraph<uint32_t> graph(4, {{0, 1}, {1, 2}, {2, 3}});
+    SparseGraph<uint32_t> other(6, {{0, 5}, {1, 4}, {2, 3}, {0, 1}, {4, 5}});
+    auto path = TemporaryGraphPath("plaquette_overwritten_graph.bin");
+    Serialization::SaveGraph(graph, path);
+
+    auto loaded = Serialization::LoadSparseGraph<uint32_t>(path);
+    REQUIRE(loaded.GetMemoryFootprint().arrays[0].external);
+    Serialization::SaveGraph(other, path);
+
+    // The mapped pages still hold the first graph, and the file the second.
+    // No temporary file is left behind.
+    RequireSameGraph<uint32_t>(loaded, graph);
+    RequireSameGraph<uint32_t>(Serialization::LoadSparseGraph<uint32_t>(path),
+                               other);
+    REQUIRE_FALSE(
+        std::filesystem::exists(path + ".tmp." + std::to_string(getpid())));
+    std::filesystem::remove(path);
+}
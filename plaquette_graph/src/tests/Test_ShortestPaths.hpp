@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "DecodingGraph.hpp"
+#include "ShortestPaths.hpp"
+
+using namespace Plaquette;
+
+namespace {
+// All-pairs distances by Floyd-Warshall, the reference for Dijkstra
+std::vector<std::vector<uint64_t>>
+AllPairsDistances(size_t num_vertices,
+                  const std::vector<std::pair<size_t, size_t>> &edges,
+                  const std::vector<EdgeWeight> &weights) {
+    constexpr uint64_t inf = std::numeric_limits<uint64_t>::max() / 4;
+    std::vector<std::vector<uint64_t>> d(
+        num_vertices, std::vector<uint64_t>(num_vertices, inf));
+    for (size_t v = 0; v < num_vertices; v++) {
+        d[v][v] = 0;
+    }
+    for (size_t e = 0; e < edges.size(); e++) {
+        auto [u, v] = edges[e];
+        d[u][v] = std::min<uint64_t>(d[u][v], weights[e]);
+        d[v][u] = std::min<uint64_t>(d[v][u], weights[e]);
+    }
+    for (size_t k = 0; k < num_vertices; k++) {
+        for (size_t i = 0; i < num_vertices; i++) {
+            for (size_t j = 0; j < num_vertices; j++) {
+                d[i][j] = std::min(d[i][j], d[i][k] + d[k][j]);
+            }
+        }
+    }
+    for (auto &row : d) {
+        std::replace(row.begin(), row.end(), inf,
+                     std::numeric_limits<uint64_t>::max());
+    }
+    return d;
+}
+
+// Check that a path is a walk from source to its target of the given length
+template <typename GraphT, typename PathT>
+void RequireValidPath(const GraphT &graph, size_t source, const PathT &path) {
+    uint64_t length = 0;
+    size_t v = source;
+    for (auto e : path.edges) {
+        auto [a, b] = graph.GetVerticesConnectedByEdge(e);
+        REQUIRE((a == v || b == v));
+        v = a == v ? b : a;
+        length += graph.GetEdgeWeight(e);
+    }
+    REQUIRE(v == path.target);
+    REQUIRE(length == path.distance);
+}
+} // namespace
+
+TEST_CASE("RadixHeap pops keys in increasing order", "[ShortestPaths]") {
+    RadixHeap<size_t> heap;
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> popped;
+    uint64_t last = 0;
+    for (size_t round = 0; round < 50; round++) {
+        for (size_t i = 0; i < 20; i++) {
+            heap.push(last + rng() % 1000, i);
+        }
+        for (size_t i = 0; i < 10; i++) {
+            last = heap.pop().first;
+            popped.push_back(last);
+        }
+    }
+    while (!heap.empty()) {
+        popped.push_back(heap.pop().first);
+    }
+
+    REQUIRE(popped.size() == 1000);
+    REQUIRE(std::is_sorted(popped.begin(), popped.end()));
+}
+
+TEMPLATE_TEST_CASE("ShortestPaths matches all-pairs distances",
+                   "[ShortestPaths]", size_t, uint32_t) {
+    const size_t num_vertices = 30;
+    std::mt19937 rng(3);
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<EdgeWeight> weights;
+    for (size_t e = 0; e < 60; e++) {
+        edges.emplace_back(rng() % num_vertices, rng() % num_vertices);
+        weights.push_back(rng() % 20);
+    }
+    // Vertex 29 is isolated
+    for (auto &[u, v] : edges) {
+        u = std::min<size_t>(u, num_vertices - 2);
+        v = std::min<size_t>(v, num_vertices - 2);
+    }
+
+    SparseGraphOptions options;
+    options.assume_unique_edges = true;
+    std::vector<bool> boundary(num_vertices, false);
+    DecodingGraph<TestType> graph(num_vertices, edges, weights, boundary,
+                                  options);
+    auto expected = AllPairsDistances(num_vertices, edges, weights);
+
+    for (size_t cache_capacity : {size_t{0}, size_t{16}}) {
+        ShortestPaths paths(graph, cache_capacity);
+        typename decltype(paths)::Workspace workspace;
+        for (size_t s = 0; s < num_vertices; s++) {
+            for (size_t t = 0; t < num_vertices; t++) {
+                REQUIRE(paths.GetDistance(s, t, workspace) == expected[s][t]);
+                auto path = paths.GetPath(s, t);
+                REQUIRE(path.distance == expected[s][t]);
+                if (path.distance != paths.kInfinity) {
+                    RequireValidPath(graph, s, path);
+                } else {
+                    REQUIRE(path.edges.empty());
+                }
+            }
+        }
+        REQUIRE(paths.GetCacheSize() <= cache_capacity);
+    }
+
+    SECTION("Distances to several targets") {
+        ShortestPaths paths(graph);
+        std::vector<TestType> targets = {5, 29, 0, 5, 17};
+        std::vector<uint64_t> out(targets.size());
+        paths.GetDistances(3, targets, out);
+        for (size_t i = 0; i < targets.size(); i++) {
+            REQUIRE(out[i] == expected[3][targets[i]]);
+        }
+    }
+}
+
+TEST_CASE("ShortestPaths distance to the boundary", "[ShortestPaths]") {
+    // 0 - 1 - 2 - 3 - 4 with boundary vertices 0 and 4
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 4}, {5, 6}};
+    std::vector<EdgeWeight> weights = {10, 1, 1, 3, 1};
+    std::vector<bool> boundary = {true, false, false, false, true, false,
+                                  false};
+    DecodingGraph graph(7, edges, weights, boundary);
+
+    for (size_t cache_capacity : {size_t{0}, size_t{4}}) {
+        ShortestPaths paths(graph, cache_capacity);
+        REQUIRE(paths.GetDistanceToBoundary(1) == std::make_pair(5ul, 4ul));
+        REQUIRE(paths.GetDistanceToBoundary(0) == std::make_pair(0ul, 0ul));
+        REQUIRE(paths.GetDistanceToBoundary(5) ==
+                std::make_pair(paths.kInfinity, paths.kNoVertex));
+
+        auto path = paths.GetPathToBoundary(2);
+        REQUIRE(path.target == 4);
+        REQUIRE(path.edges == std::vector<size_t>{2, 3});
+        RequireValidPath(graph, 2, path);
+        REQUIRE(paths.GetPathToBoundary(6).edges.empty());
+    }
+}
+
+TEST_CASE("ShortestPaths cache", "[ShortestPaths]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}};
+    DecodingGraph graph(4, edges, {false, false, false, true});
+    ShortestPaths paths(graph, 2);
+
+    SECTION("Paths are returned from the source to the target") {
+        auto forward = paths.GetPath(0, 2);
+        auto backward = paths.GetPath(2, 0);
+        REQUIRE(paths.GetCacheSize() == 1);
+        REQUIRE(forward.distance == 2);
+        REQUIRE(backward.target == 0);
+        REQUIRE(std::equal(forward.edges.begin(), forward.edges.end(),
+                           backward.edges.rbegin(), backward.edges.rend()));
+        RequireValidPath(graph, 2, backward);
+    }
+
+    SECTION("The least recently used paths are evicted") {
+        paths.GetDistance(0, 1);
+        paths.GetDistance(0, 2);
+        paths.GetDistanceToBoundary(1);
+        REQUIRE(paths.GetCacheSize() == 2);
+        REQUIRE(paths.GetDistance(0, 1) == 1);
+        paths.ClearCache();
+        REQUIRE(paths.GetCacheSize() == 0);
+        REQUIRE(paths.GetCacheCapacity() == 2);
+    }
+}
+
+TEST_CASE("ShortestPaths workspaces are reusable across graphs",
+          "[ShortestPaths]") {
+    DecodingGraph small(3, {{0, 1}, {1, 2}}, {false, false, true});
+    DecodingGraph large(6, {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}},
+                        {true, false, false, false, false, false});
+    ShortestPaths small_paths(small);
+    ShortestPaths large_paths(large);
+    ShortestPathWorkspace<size_t> workspace;
+
+    REQUIRE(small_paths.GetDistance(0, 2, workspace) == 2);
+    REQUIRE(large_paths.GetDistance(0, 5, workspace) == 5);
+    REQUIRE(small_paths.GetDistance(2, 1, workspace) == 1);
+    REQUIRE(large_paths.GetDistanceToBoundary(4, workspace).first == 4);
+    REQUIRE(small_paths.GetDistanceToBoundary(0, workspace).first == 2);
+}
+
+TEST_CASE("ShortestPaths rejects out of range vertices", "[ShortestPaths]") {
+    DecodingGraph graph(2, {{0, 1}}, {false, true});
+    ShortestPaths paths(graph);
+    REQUIRE_THROWS_AS(paths.GetDistance(0, 2), std::out_of_range);
+    REQUIRE_THROWS_AS(paths.GetPath(2, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(paths.GetDistanceToBoundary(2), std::out_of_range);
+}
@@ -11,6 +11,7 @@
 #include <catch2/catch.hpp>
 
 #include "SparseGraph.hpp"
+#include "TestHelpers.hpp"
 
 using namespace std;
 using namespace Plaquette;
@@ -85,4 +86,473 @@ TEST_CASE("SparseGraph GetEdgeFromVertexPair", "[SparseGraph]") {
     REQUIRE(g.GetEdgeFromVertexPair(std::make_pair<size_t, size_t>(1, 2)) == 1);
     REQUIRE(g.GetEdgeFromVertexPair(std::make_pair<size_t, size_t>(2, 3)) == 2);
     REQUIRE(g.GetEdgeFromVertexPair(std::make_pair<size_t, size_t>(3, 0)) == 3);
+    REQUIRE(g.GetEdgeFromVertexPair(std::make_pair<size_t, size_t>(0, 2)) ==
+            g.kInvalidIndex);
+    REQUIRE(g.GetEdgeFromVertexPair(std::make_pair<size_t, size_t>(4, 0)) ==
+            g.kInvalidIndex);
+}
+
+TEMPLATE_TEST_CASE("SparseGraph sorted rows and edge index lookups",
+                   "[SparseGraph]", size_t, uint32_t) {
+    const size_t num_vertices = 30;
+    std::vector<std::pair<size_t, size_t>> edges;
+    size_t state = 777;
+    for (size_t i = 0; i < 150; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t u = (state >> 33) % num_vertices;
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t v = (state >> 33) % num_vertices;
+        edges.emplace_back(u, v);
+    }
+    SparseGraph<TestType> reference(num_vertices, edges);
+    REQUIRE_FALSE(reference.AreRowsSorted());
+    REQUIRE_FALSE(reference.HasEdgeIndex());
+
+    SparseGraphOptions sorted_options;
+    sorted_options.sort_rows = true;
+    SparseGraph<TestType> sorted(num_vertices, edges, sorted_options);
+    REQUIRE(sorted.AreRowsSorted());
+
+    SparseGraphOptions index_options;
+    index_options.edge_index = true;
+    SparseGraph<TestType> indexed(num_vertices, edges, index_options);
+    REQUIRE(indexed.HasEdgeIndex());
+
+    for (size_t v = 0; v < num_vertices; v++) {
+        auto cols = sorted.GetVerticesTouchingVertex(v);
+        auto row = sorted.GetEdgesTouchingVertex(v);
+        auto reference_row = reference.GetEdgesTouchingVertex(v);
+        REQUIRE(std::is_sorted(cols.begin(), cols.end()));
+        std::vector<TestType> expected(reference_row.begin(),
+                                       reference_row.end());
+        std::vector<TestType> actual(row.begin(), row.end());
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        REQUIRE(actual == expected);
+    }
+
+    // Every pair of vertices, including unconnected and out of range ones
+    for (size_t u = 0; u <= num_vertices; u++) {
+        for (size_t v = 0; v <= num_vertices; v++) {
+            auto expected = reference.GetEdgeFromVertexPair({u, v});
+            REQUIRE(sorted.GetEdgeFromVertexPair({u, v}) == expected);
+            REQUIRE(indexed.GetEdgeFromVertexPair({u, v}) == expected);
+        }
+    }
+
+    reference.BuildEdgeIndex();
+    REQUIRE(reference.HasEdgeIndex());
+    auto copy = reference;
+    REQUIRE(copy.HasEdgeIndex());
+    for (size_t e = 0; e < copy.GetNumEdges(); e++) {
+        REQUIRE(copy.GetEdgeFromVertexPair(copy.GetVerticesConnectedByEdge(
+                    e)) == e);
+    }
+}
+
+TEST_CASE("SparseGraph with 32-bit indices", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}};
+    SparseGraph<uint32_t> g(4, edges);
+
+    static_assert(
+        std::is_same_v<decltype(g.GetEdgesTouchingVertex(0)[0]), uint32_t>);
+    REQUIRE(g.GetNumVertices() == 4);
+    REQUIRE(g.GetNumEdges() == 4);
+    REQUIRE(g.GetVerticesConnectedByEdge(3) ==
+            std::make_pair<uint32_t, uint32_t>(3, 0));
+    REQUIRE(g.GetEdgeFromVertexPair(std::make_pair<size_t, size_t>(2, 3)) == 2);
+
+    SparseGraph<size_t> reference(4, edges);
+    for (size_t e = 0; e < g.GetNumEdges(); e++) {
+        auto row = g.GetEdgesTouchingEdge(e);
+        auto ref_row = reference.GetEdgesTouchingEdge(e);
+        REQUIRE(row.size() == ref_row.size());
+        for (size_t k = 0; k < row.size(); k++) {
+            REQUIRE(row[k] == ref_row[k]);
+        }
+    }
+}
+
+TEST_CASE("SparseGraph rejects graphs exceeding the index type",
+          "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}};
+    REQUIRE_THROWS_AS(SparseGraph<uint8_t>(300, edges), std::overflow_error);
+}
+
+TEST_CASE("SparseGraph removes duplicate edges", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {2, 1}, {1, 0}, {1, 2}, {0, 1}, {3, 3}, {2, 3}, {3, 3}};
+    SparseGraph g(4, edges);
+
+    REQUIRE(g.GetNumEdges() == 4);
+    REQUIRE(g.GetVerticesConnectedByEdge(0) ==
+            std::make_pair<size_t, size_t>(0, 1));
+    REQUIRE(g.GetVerticesConnectedByEdge(1) ==
+            std::make_pair<size_t, size_t>(2, 1));
+    REQUIRE(g.GetVerticesConnectedByEdge(2) ==
+            std::make_pair<size_t, size_t>(3, 3));
+    REQUIRE(g.GetVerticesConnectedByEdge(3) ==
+            std::make_pair<size_t, size_t>(2, 3));
+}
+
+TEST_CASE("SparseGraph skips deduplication for unique edges",
+          "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}, {1, 0}, {1, 2}};
+    SparseGraphOptions options;
+    options.assume_unique_edges = true;
+    SparseGraph g(3, edges, options);
+
+    REQUIRE(g.GetNumEdges() == 3);
+    REQUIRE(g.GetVerticesConnectedByEdge(1) ==
+            std::make_pair<size_t, size_t>(1, 0));
+}
+
+TEST_CASE("SparseGraph edge weights", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 1}, {2, 3}};
+    std::vector<EdgeWeight> weights = {4, 7, 9, 2};
+
+    SECTION("Unweighted graphs have unit weights") {
+        SparseGraph g(4, edges);
+        REQUIRE_FALSE(g.HasEdgeWeights());
+        REQUIRE(g.GetEdgeWeights().empty());
+        REQUIRE(g.GetEdgeWeight(1) == 1);
+    }
+
+    SECTION("Duplicate edges keep the weight of their first occurrence") {
+        SparseGraph<uint32_t> g(4, edges, weights);
+        REQUIRE(g.HasEdgeWeights());
+        REQUIRE(g.GetNumEdges() == 3);
+        REQUIRE(g.GetEdgeWeight(0) == 4);
+        REQUIRE(g.GetEdgeWeight(1) == 7);
+        REQUIRE(g.GetEdgeWeight(2) == 2);
+    }
+
+    SECTION("Weights of unique edges are kept as given") {
+        SparseGraphOptions options;
+        options.assume_unique_edges = true;
+        SparseGraph g(4, edges, weights, options);
+        REQUIRE(std::equal(g.GetEdgeWeights().begin(),
+                           g.GetEdgeWeights().end(), weights.begin(),
+                           weights.end()));
+    }
+
+    SECTION("The number of weights must match the number of edges") {
+        std::vector<EdgeWeight> too_few = {1, 2};
+        REQUIRE_THROWS_AS(SparseGraph(4, edges, too_few),
+                          std::invalid_argument);
+    }
+}
+
+TEST_CASE("SparseGraph rejects out of range vertices", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}, {1, 4}};
+    REQUIRE_THROWS_AS(SparseGraph(4, edges), std::invalid_argument);
+}
+
+TEST_CASE("SparseGraph GetEdgesTouchingEdge matches brute force",
+          "[SparseGraph]") {
+    const size_t num_vertices = 40;
+    std::vector<std::pair<size_t, size_t>> edges;
+    size_t state = 12345;
+    for (size_t i = 0; i < 200; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t u = (state >> 33) % num_vertices;
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t v = (state >> 33) % num_vertices;
+        edges.emplace_back(u, v);
+    }
+    SparseGraph g(num_vertices, edges);
+
+    for (size_t e = 0; e < g.GetNumEdges(); e++) {
+        const auto &ends = g.GetVerticesConnectedByEdge(e);
+        std::vector<size_t> expected;
+        for (size_t f = 0; f < g.GetNumEdges(); f++) {
+            const auto &other = g.GetVerticesConnectedByEdge(f);
+            if (f != e &&
+                (other.first == ends.first || other.first == ends.second ||
+                 other.second == ends.first || other.second == ends.second)) {
+                expected.push_back(f);
+            }
+        }
+
+        auto row = g.GetEdgesTouchingEdge(e);
+        std::vector<size_t> actual;
+        for (size_t k = 0; k < row.size(); k++) {
+            actual.push_back(row[k]);
+        }
+        std::sort(actual.begin(), actual.end());
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST_CASE("SparseGraph GetEdgesTouchingEdge ordering", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 0}, {2, 2}, {2, 3}};
+    SparseGraph g(4, edges);
+
+    auto check = [&](size_t edge, std::vector<size_t> expected) {
+        auto row = g.GetEdgesTouchingEdge(edge);
+        REQUIRE(row.size() == expected.size());
+        for (size_t k = 0; k < row.size(); k++) {
+            REQUIRE(row[k] == expected[k]);
+        }
+    };
+    check(0, {2, 1});
+    check(1, {0, 2, 3, 4});
+    check(2, {0, 1, 3, 4});
+    check(3, {1, 2, 4});
+    check(4, {1, 2, 3});
+}
+
+TEST_CASE("SparseGraph edge-edge matrix construction modes", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}};
+
+    SECTION("Lazy") {
+        SparseGraph g(4, edges);
+        REQUIRE_FALSE(g.IsEdgeToEdgeMatrixConstructed());
+
+        SparseGraph copy = g;
+        REQUIRE(g.GetEdgesTouchingEdge(0).size() == 2);
+        REQUIRE(g.IsEdgeToEdgeMatrixConstructed());
+        REQUIRE(copy.IsEdgeToEdgeMatrixConstructed());
+    }
+
+    SECTION("Eager") {
+        SparseGraphOptions options;
+        options.edge_to_edge = EdgeToEdgeMode::Eager;
+        SparseGraph g(4, edges, options);
+        REQUIRE(g.IsEdgeToEdgeMatrixConstructed());
+        REQUIRE(g.GetEdgesTouchingEdge(0).size() == 2);
+    }
+}
+
+TEST_CASE("SparseGraph GetEdgesTouchingEdgeImplicit", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 0}, {2, 2}, {2, 3}, {3, 3}};
+    SparseGraph g(4, edges);
+
+    for (size_t e = 0; e < g.GetNumEdges(); e++) {
+        auto implicit = g.GetEdgesTouchingEdgeImplicit(e);
+        std::vector<size_t> actual(implicit.begin(), implicit.end());
+        REQUIRE(implicit.size() == actual.size());
+        for (size_t k = 0; k < actual.size(); k++) {
+            REQUIRE(implicit[k] == actual[k]);
+        }
+
+        auto row = g.GetEdgesTouchingEdge(e);
+        std::vector<size_t> expected(row.begin(), row.end());
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(actual == expected);
+    }
+
+    // Parallel self-loops, which only adopted arrays can hold, skip more
+    // entries than are recorded for constant time indexing
+    SparseGraphArrays<> arrays;
+    arrays.v_to_v_row_ptr = std::vector<size_t>{0, 7, 8};
+    arrays.v_to_v_col = std::vector<size_t>{1, 0, 0, 0, 0, 0, 0, 0};
+    arrays.v_to_v_edges = std::vector<size_t>{0, 1, 1, 2, 2, 3, 3, 0};
+    arrays.e_to_v =
+        std::vector<std::pair<size_t, size_t>>{{0, 1}, {0, 0}, {0, 0}, {0, 0}};
+    auto loops = SparseGraph<>::FromArrays(2, std::move(arrays));
+    auto implicit = loops.GetEdgesTouchingEdgeImplicit(0);
+    REQUIRE(std::vector<size_t>(implicit.begin(), implicit.end()) ==
+            std::vector<size_t>{1, 2, 3});
+    REQUIRE(implicit.size() == 3);
+    REQUIRE(implicit[2] == 3);
+    REQUIRE(RowToVector(loops.GetEdgesTouchingEdgeImplicit(2)) ==
+            std::vector<size_t>{0, 1, 3});
+}
+
+TEST_CASE("SparseGraph construction from a flat edge array",
+          "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 0}, {1, 0}, {2, 3}};
+    std::vector<int64_t> flat = {0, 1, 1, 2, 2, 0, 1, 0, 2, 3};
+
+    SparseGraph expected(4, edges);
+    SparseGraph<uint32_t> g(4, FlatEdgeList<int64_t>(flat.data(), 5));
+
+    REQUIRE(g.GetNumEdges() == expected.GetNumEdges());
+    for (size_t e = 0; e < g.GetNumEdges(); e++) {
+        REQUIRE(g.GetVerticesConnectedByEdge(e).first ==
+                expected.GetVerticesConnectedByEdge(e).first);
+        REQUIRE(g.GetVerticesConnectedByEdge(e).second ==
+                expected.GetVerticesConnectedByEdge(e).second);
+    }
+
+    std::vector<int64_t> negative = {0, 1, -1, 2};
+    FlatEdgeList<int64_t> negative_edges(negative.data(), 2);
+    REQUIRE_THROWS_AS(SparseGraph(4, negative_edges), std::invalid_argument);
+}
+
+TEST_CASE("SparseGraph raw CSR arrays", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}};
+    SparseGraph g(4, edges);
+
+    auto row_ptr = g.GetVertexToVertexRowPtr();
+    auto col = g.GetVertexToVertexCol();
+    auto ids = g.GetVertexToVertexEdges();
+    REQUIRE(row_ptr.size() == 5);
+    REQUIRE(col.size() == 8);
+    REQUIRE(ids.size() == 8);
+    for (size_t v = 0; v < 4; v++) {
+        auto row = g.GetVerticesTouchingVertex(v);
+        REQUIRE(row.begin() == col.data() + row_ptr[v]);
+        REQUIRE(row.size() == row_ptr[v + 1] - row_ptr[v]);
+    }
+
+    auto e_to_v = g.GetEdgeToVertex();
+    REQUIRE(e_to_v.size() == 4);
+    REQUIRE(e_to_v[2] == std::pair<size_t, size_t>{2, 3});
+
+    REQUIRE_FALSE(g.IsEdgeToEdgeMatrixConstructed());
+    REQUIRE(g.GetEdgeToEdgeRowPtr().size() == 5);
+    REQUIRE(g.GetEdgeToEdgeCol().size() == 8);
+    REQUIRE(g.IsEdgeToEdgeMatrixConstructed());
+}
+
+TEST_CASE("SparseGraph batch queries", "[SparseGraph]") {
+    std::vector<std::pair<size_t, size_t>> edges = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}, {1, 3}};
+    SparseGraph<uint32_t> g(5, edges);
+
+    std::vector<uint32_t> vertices = {1, 4, 0, 1};
+    auto rows = g.GetEdgesTouchingVertices(vertices);
+    REQUIRE(rows.offsets == std::vector<size_t>{0, 3, 3, 5, 8});
+    for (size_t i = 0; i < vertices.size(); i++) {
+        auto row = g.GetEdgesTouchingVertex(vertices[i]);
+        REQUIRE(std::equal(row.begin(), row.end(),
+                           rows.values.begin() + rows.offsets[i],
+                           rows.values.begin() + rows.offsets[i + 1]));
+    }
+    auto neighbours = g.GetVerticesTouchingVertices(vertices);
+    REQUIRE(neighbours.offsets == rows.offsets);
+    REQUIRE(std::vector<uint32_t>(neighbours.values.begin(),
+                                  neighbours.values.begin() + 3) ==
+            std::vector<uint32_t>{0, 2, 3});
+
+    std::vector<uint32_t> edge_ids = {4, 0};
+    std::vector<uint32_t> endpoints(4);
+    g.GetVerticesConnectedByEdges(edge_ids, endpoints);
+    REQUIRE(endpoints == std::vector<uint32_t>{1, 3, 0, 1});
+
+    std::vector<uint32_t> pairs = {3, 1, 0, 2, 9, 0, 3, 0};
+    std::vector<uint32_t> found(4);
+    g.GetEdgesFromVertexPairs(pairs, found);
+    constexpr uint32_t missing = std::numeric_limits<uint32_t>::max();
+    REQUIRE(found == std::vector<uint32_t>{4, missing, missing, 3});
+
+    std::vector<uint32_t> invalid = {5};
+    REQUIRE_THROWS_AS(g.GetEdgesTouchingVertices(invalid), std::out_of_range);
+    REQUIRE_THROWS_AS(g.GetVerticesConnectedByEdges(invalid, endpoints),
+                      std::invalid_argument);
+}
+
+TEST_CASE("A moved-from SparseGraph is an empty graph", "[SparseGraph]") {
+    static_assert(std::is_nothrow_move_constructible_v<SparseGraph<>>);
+    static_assert(std::is_nothrow_move_assignable_v<SparseGraph<>>);
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}, {1, 2}, {2, 0}};
+    SparseGraph<> graph(3, edges);
+    graph.GetEdgesTouchingEdge(0);
+
+    auto require_empty = [](const SparseGraph<> &g) {
+        REQUIRE(g.GetNumVertices() == 0);
+        REQUIRE(g.GetNumEdges() == 0);
+        REQUIRE_FALSE(g.IsEdgeToEdgeMatrixConstructed());
+        // The row pointers are those of a default-constructed graph
+        REQUIRE(std::ranges::equal(g.GetVertexToVertexRowPtr(),
+                                   std::vector<size_t>{0}));
+        REQUIRE(std::ranges::equal(g.GetEdgeToEdgeRowPtr(),
+                                   SparseGraph<>().GetEdgeToEdgeRowPtr()));
+        REQUIRE(g.GetEdgeToEdgeCol().empty());
+        REQUIRE(g.GetMemoryFootprint().arrays.size() == 5);
+        REQUIRE(g.GetConstructionTimings().edge_to_edge == 0);
+    };
+
+    SparseGraph<> moved(std::move(graph));
+    require_empty(graph);
+    REQUIRE(moved.IsEdgeToEdgeMatrixConstructed());
+    SparseGraph<> copy = graph;
+    require_empty(copy);
+
+    SparseGraph<> assigned;
+    assigned = std::move(moved);
+    require_empty(moved);
+    REQUIRE(assigned.GetEdgesTouchingEdge(0).size() == 2);
+
+    // Moved-from graphs can be rebuilt
+    moved.Rebuild(3, edges);
+    REQUIRE(moved.GetNumEdges() == 3);
+    REQUIRE(moved.GetEdgesTouchingEdge(1).size() == 2);
+    REQUIRE(moved.IsEdgeToEdgeMatrixConstructed());
+}
+
+TEST_CASE("Empty graphs are assembled back from their arrays",
+          "[SparseGraph]") {
+    // Rebuild a graph from copies of its arrays, as unpickling does
+    auto round_trip = [](const SparseGraph<> &g) {
+        auto copy = [](std::span<const size_t> values) {
+            return ArrayBuffer<size_t>(
+                std::vector<size_t>(values.begin(), values.end()));
+        };
+        SparseGraphArrays<> arrays;
+        arrays.v_to_v_row_ptr = copy(g.GetVertexToVertexRowPtr());
+        arrays.v_to_v_col = copy(g.GetVertexToVertexCol());
+        arrays.v_to_v_edges = copy(g.GetVertexToVertexEdges());
+        arrays.e_to_e_row_ptr = copy(g.GetEdgeToEdgeRowPtr());
+        arrays.e_to_e_col = copy(g.GetEdgeToEdgeCol());
+        return SparseGraph<>::FromArrays(g.GetNumVertices(), std::move(arrays));
+    };
+
+    SparseGraph<> graph;
+    REQUIRE(round_trip(graph).GetNumVertices() == 0);
+
+    SparseGraph<> moved(3, {{0, 1}, {1, 2}});
+    SparseGraph<> other = std::move(moved);
+    auto loaded = round_trip(moved);
+    REQUIRE(loaded.GetNumEdges() == 0);
+    REQUIRE(std::ranges::equal(loaded.GetEdgeToEdgeRowPtr(),
+                               graph.GetEdgeToEdgeRowPtr()));
+}
+
+TEST_CASE("FromArrays rejects rows that do not match the edges",
+          "[SparseGraph]") {
+    // The arrays of the graph with edges {0, 1}, {1, 2} and {2, 2}
+    auto make_arrays = [](std::vector<size_t> col, std::vector<size_t> edges) {
+        SparseGraphArrays<> arrays;
+        arrays.v_to_v_row_ptr = std::vector<size_t>{0, 1, 3, 6};
+        arrays.v_to_v_col = std::move(col);
+        arrays.v_to_v_edges = std::move(edges);
+        arrays.e_to_v =
+            std::vector<std::pair<size_t, size_t>>{{0, 1}, {1, 2}, {2, 2}};
+        return arrays;
+    };
+    auto from_arrays = [](SparseGraphArrays<> arrays) {
+        return SparseGraph<>::FromArrays(3, std::move(arrays));
+    };
+
+    REQUIRE(from_arrays(make_arrays({1, 0, 2, 1, 2, 2}, {0, 0, 1, 1, 2, 2}))
+                .GetEdgesTouchingEdge(1)
+                .size() == 2);
+    auto unsorted = make_arrays({1, 0, 2, 2, 2, 1}, {0, 0, 1, 2, 2, 1});
+    REQUIRE(from_arrays(unsorted).GetEdgeFromVertexPair({2, 1}) == 1);
+
+    unsorted.sorted_rows = true;
+    REQUIRE_THROWS_AS(from_arrays(std::move(unsorted)), std::invalid_argument);
+    // A column that is not the other endpoint of the edge
+    REQUIRE_THROWS_AS(
+        from_arrays(make_arrays({1, 0, 2, 0, 2, 2}, {0, 0, 1, 1, 2, 2})),
+        std::invalid_argument);
+    // An edge listed twice in the row of one endpoint
+    REQUIRE_THROWS_AS(
+        from_arrays(make_arrays({1, 0, 0, 1, 2, 2}, {0, 0, 0, 1, 2, 2})),
+        std::invalid_argument);
+    // The two half-edges of a self-loop apart in its row
+    REQUIRE_THROWS_AS(
+        from_arrays(make_arrays({1, 0, 2, 2, 1, 2}, {0, 0, 1, 2, 1, 2})),
+        std::invalid_argument);
 }
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "DecodingGraph.hpp"
+#include "SyndromeBatch.hpp"
+
+using namespace Plaquette;
+
+namespace {
+// A chain of n vertices whose first and last vertices are on the boundary
+template <typename IndexT> DecodingGraph<IndexT> BoundaryChain(size_t n) {
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t v = 0; v + 1 < n; v++) {
+        edges.emplace_back(v, v + 1);
+    }
+    std::vector<bool> boundary(n, false);
+    boundary.front() = boundary.back() = true;
+    return DecodingGraph<IndexT>(n, edges, boundary);
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("SyndromeBatch extracts the defects of every shot",
+                   "[SyndromeBatch]", size_t, uint32_t) {
+    // Sizes around word and four-word block boundaries
+    for (size_t num_detectors : {3ul, 64ul, 130ul, 300ul}) {
+        auto graph = BoundaryChain<TestType>(num_detectors);
+        const size_t num_shots = 70;
+        std::mt19937 rng(static_cast<unsigned>(num_detectors));
+        std::vector<std::vector<bool>> bits(
+            num_shots, std::vector<bool>(num_detectors, false));
+        for (auto &row : bits) {
+            for (size_t d = 0; d < num_detectors; d++) {
+                row[d] = rng() % 7 == 0;
+            }
+        }
+
+        for (auto layout :
+             {SyndromeLayout::ShotMajor, SyndromeLayout::DetectorMajor}) {
+            SyndromeBatch<TestType> batch(graph, num_shots, layout);
+            REQUIRE(batch.GetNumDetectors() == num_detectors);
+            for (size_t s = 0; s < num_shots; s++) {
+                for (size_t d = 0; d < num_detectors; d++) {
+                    batch.SetDetector(s, d, bits[s][d]);
+                }
+            }
+
+            for (bool exclude_boundary : {true, false}) {
+                auto defects = batch.ExtractDefects(exclude_boundary);
+                std::vector<size_t> counts(num_shots);
+                batch.CountDefects(counts, exclude_boundary);
+                std::vector<TestType> shot_defects;
+                for (size_t s = 0; s < num_shots; s++) {
+                    std::vector<TestType> expected;
+                    for (size_t d = 0; d < num_detectors; d++) {
+                        if (bits[s][d] && !(exclude_boundary &&
+                                            graph.IsVertexOnBoundary(d))) {
+                            expected.push_back(static_cast<TestType>(d));
+                        }
+                    }
+                    REQUIRE(batch.GetDetector(s, 0) == bits[s][0]);
+                    REQUIRE(std::vector<TestType>(
+                                defects.values.begin() + defects.offsets[s],
+                                defects.values.begin() +
+                                    defects.offsets[s + 1]) == expected);
+                    REQUIRE(counts[s] == expected.size());
+                    batch.GetDefects(s, shot_defects, exclude_boundary);
+                    REQUIRE(shot_defects == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("SyndromeBatch from bit-packed bytes", "[SyndromeBatch]") {
+    auto graph = BoundaryChain<size_t>(10);
+
+    SECTION("Shot-major rows") {
+        // Rows of 3 bytes, wider than the 2 bytes needed for 10 detectors
+        std::vector<uint8_t> data = {0b00000110, 0b00000010, 0xff,
+                                     0b10000001, 0b11111100, 0xff};
+        SyndromeBatch batch(graph, 2, data.data(), 3);
+        REQUIRE(batch.GetWordsPerRow() == 1);
+        auto defects = batch.ExtractDefects();
+        REQUIRE(defects.offsets == std::vector<size_t>{0, 2, 3});
+        REQUIRE(defects.values == std::vector<size_t>{1, 2, 7});
+        // Bits past the last detector are dropped
+        REQUIRE(batch.GetWords()[0] == 0b1000000110);
+    }
+
+    SECTION("Detector-major rows") {
+        std::vector<uint8_t> data(10, 0);
+        data[4] = 0b101;
+        data[9] = 0b010;
+        SyndromeBatch batch(graph, 3, data.data(), 1,
+                            SyndromeLayout::DetectorMajor);
+        REQUIRE(batch.GetNumRows() == 10);
+        std::vector<size_t> counts(3);
+        batch.CountDefects(counts, false);
+        REQUIRE(counts == std::vector<size_t>{1, 1, 1});
+        batch.CountDefects(counts);
+        REQUIRE(counts == std::vector<size_t>{1, 0, 1});
+    }
+
+    SECTION("Rows that are too short") {
+        std::vector<uint8_t> data(2, 0);
+        REQUIRE_THROWS_AS(SyndromeBatch(graph, 2, data.data(), 1),
+                          std::invalid_argument);
+    }
+}
+
+TEST_CASE("SyndromeBatch rejects out of range indices", "[SyndromeBatch]") {
+    auto graph = BoundaryChain<size_t>(4);
+    SyndromeBatch batch(graph, 2);
+    std::vector<size_t> defects;
+    std::vector<size_t> counts(3);
+    REQUIRE_THROWS_AS(batch.SetDetector(2, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(batch.GetDetector(0, 4), std::out_of_range);
+    REQUIRE_THROWS_AS(batch.GetDefects(2, defects), std::out_of_range);
+    REQUIRE_THROWS_AS(batch.CountDefects(counts), std::invalid_argument);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "Utils.hpp"
+
+using namespace Plaquette;
+
+TEST_CASE("ConvertEdgeListToCSR", "[Utils]") {
+    std::vector<std::pair<size_t, size_t>> edges = {{0, 1}, {1, 2}, {2, 2}};
+    std::tuple<std::vector<size_t>, std::vector<size_t>> csr =
+        Utils::ConvertEdgeListToCSR(3, edges);
+    auto &[row_ptr, col] = csr;
+
+    REQUIRE(row_ptr == std::vector<size_t>{0, 1, 3, 6});
+    REQUIRE(col == std::vector<size_t>{1, 0, 2, 1, 2, 2});
+}
+
+TEST_CASE("Parallel BuildCSR matches the serial construction", "[Utils]") {
+    const size_t num_vertices = 3000;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    size_t state = 42;
+    for (size_t i = 0; i < 100000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t u = (state >> 33) % num_vertices;
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t v = (state >> 33) % num_vertices;
+        edges.emplace_back(u, v);
+    }
+
+    auto serial = Utils::BuildCSR(num_vertices, edges, true, 1);
+    for (size_t num_threads : {2, 3, 4}) {
+        auto parallel = Utils::BuildCSR(num_vertices, edges, true, num_threads);
+        REQUIRE(parallel.row_ptr == serial.row_ptr);
+        REQUIRE(parallel.col == serial.col);
+        REQUIRE(parallel.ids == serial.ids);
+    }
+    REQUIRE(serial.row_ptr.back() == 2 * edges.size());
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "DecodingGraph.hpp"
+#include "ShortestPaths.hpp"
+#include "WindowedDecodingGraph.hpp"
+
+using namespace Plaquette;
+
+namespace {
+struct TestLayer {
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<EdgeWeight> weights;
+    std::vector<bool> boundary;
+};
+
+// A random layer of n vertices, with edges to the previous layer if any but
+// no self-loops or parallel edges
+TestLayer RandomLayer(size_t n, bool has_previous, std::mt19937 &rng) {
+    TestLayer layer;
+    const size_t num_edges = 1 + rng() % 8;
+    while (layer.edges.size() < num_edges) {
+        size_t u = rng() % (2 * n);
+        size_t v = n + rng() % n;
+        if (u == v || (u < n && !has_previous) ||
+            std::find(layer.edges.begin(), layer.edges.end(),
+                      std::make_pair(u, v)) != layer.edges.end() ||
+            std::find(layer.edges.begin(), layer.edges.end(),
+                      std::make_pair(v, u)) != layer.edges.end()) {
+            continue;
+        }
+        layer.edges.emplace_back(u, v);
+        layer.weights.push_back(1 + rng() % 9);
+    }
+    for (size_t i = 0; i < n; i++) {
+        layer.boundary.push_back(rng() % 4 == 0);
+    }
+    return layer;
+}
+
+// The decoding graph of the layers in the window, whose vertex `i` of the
+// `l`-th layer is `l * n + i`
+DecodingGraph<size_t> ReferenceGraph(const std::deque<TestLayer> &layers,
+                                     size_t n) {
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<EdgeWeight> weights;
+    std::vector<bool> boundary;
+    for (size_t l = 0; l < layers.size(); l++) {
+        for (size_t k = 0; k < layers[l].edges.size(); k++) {
+            auto [u, v] = layers[l].edges[k];
+            if (l == 0 && (u < n || v < n)) {
+                continue;
+            }
+            edges.emplace_back(l * n + u - n, l * n + v - n);
+            weights.push_back(layers[l].weights[k]);
+        }
+        boundary.insert(boundary.end(), layers[l].boundary.begin(),
+                        layers[l].boundary.end());
+    }
+    SparseGraphOptions options;
+    options.assume_unique_edges = true;
+    return DecodingGraph<size_t>(layers.size() * n, edges, weights, boundary,
+                                 options);
+}
+
+template <typename IndexT>
+void RequireSameAsReference(const WindowedDecodingGraph<IndexT> &window,
+                            const DecodingGraph<size_t> &reference) {
+    const size_t n = window.GetVerticesPerLayer();
+    auto compact = [&](size_t v) {
+        return (window.GetLayerOfVertex(v) - window.GetFirstLayer()) * n +
+               v % n;
+    };
+
+    size_t num_active_edges = 0;
+    for (size_t e = 0; e < window.GetNumEdges(); e++) {
+        if (!window.IsEdgeActive(e)) {
+            continue;
+        }
+        num_active_edges++;
+        auto [a, b] = window.GetVerticesConnectedByEdge(e);
+        REQUIRE(window.IsVertexActive(a));
+        REQUIRE(window.IsVertexActive(b));
+        for (size_t which : {0, 1}) {
+            auto local = window.GetLocalEdgeFromGlobalEdge(e, which);
+            auto owner = which == 0 ? a : b;
+            REQUIRE(window.GetGlobalEdgeFromLocalEdge(local) == e);
+            REQUIRE(local >= window.GetLocalEdgeStride(owner));
+            REQUIRE(local < window.GetLocalEdgeStride(owner) +
+                                window.GetEdgesTouchingVertex(owner).size());
+        }
+    }
+    REQUIRE(num_active_edges == reference.GetNumEdges());
+
+    for (size_t v = 0; v < window.GetNumVertices(); v++) {
+        if (!window.IsVertexActive(v)) {
+            REQUIRE(window.GetEdgesTouchingVertex(v).size() == 0);
+            REQUIRE_FALSE(window.IsVertexOnBoundary(v));
+            continue;
+        }
+        const size_t c = compact(v);
+        REQUIRE(window.GetVertex(window.GetLayerOfVertex(v), v % n) == v);
+        REQUIRE(window.IsVertexOnBoundary(v) ==
+                reference.IsVertexOnBoundary(c));
+
+        std::vector<std::tuple<size_t, EdgeWeight>> actual, expected;
+        auto neighbours = window.GetVerticesTouchingVertex(v);
+        auto edges = window.GetEdgesTouchingVertex(v);
+        for (size_t k = 0; k < edges.size(); k++) {
+            actual.emplace_back(compact(neighbours[k]),
+                                window.GetEdgeWeight(edges[k]));
+        }
+        auto reference_neighbours = reference.GetVerticesTouchingVertex(c);
+        auto reference_edges = reference.GetEdgesTouchingVertex(c);
+        for (size_t k = 0; k < reference_edges.size(); k++) {
+            expected.emplace_back(reference_neighbours[k],
+                                  reference.GetEdgeWeight(reference_edges[k]));
+        }
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(actual == expected);
+    }
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("WindowedDecodingGraph matches a rebuilt decoding graph",
+                   "[WindowedDecodingGraph]", size_t, uint32_t) {
+    const size_t n = 5;
+    WindowedDecodingGraph<TestType> window(n, 3, 8, 32);
+    std::deque<TestLayer> layers;
+    std::mt19937 rng(21);
+
+    for (size_t t = 0; t < 12; t++) {
+        if (window.IsFull()) {
+            window.RetireLayer();
+            layers.pop_front();
+            RequireSameAsReference(window, ReferenceGraph(layers, n));
+        }
+        auto layer = RandomLayer(n, !layers.empty(), rng);
+        REQUIRE(window.AppendLayer(layer.edges, layer.weights,
+                                   layer.boundary) == t);
+        layers.push_back(layer);
+        REQUIRE(window.GetFirstLayer() + window.GetNumLayers() == t + 1);
+        RequireSameAsReference(window, ReferenceGraph(layers, n));
+    }
+
+    while (window.GetNumLayers() > 0) {
+        window.RetireLayer();
+        layers.pop_front();
+        RequireSameAsReference(window, ReferenceGraph(layers, n));
+    }
+    REQUIRE_THROWS_AS(window.RetireLayer(), std::logic_error);
+}
+
+TEST_CASE("WindowedDecodingGraph shortest paths", "[WindowedDecodingGraph]") {
+    // Repetition code rounds: detectors 0 and 1 and a boundary vertex 2
+    const size_t n = 3;
+    const std::vector<std::pair<size_t, size_t>> first = {
+        {3, 4}, {4, 5}, {5, 3}};
+    const std::vector<std::pair<size_t, size_t>> next = {
+        {3, 4}, {4, 5}, {5, 3}, {0, 3}, {1, 4}};
+    const std::vector<EdgeWeight> first_weights = {2, 2, 5};
+    const std::vector<EdgeWeight> next_weights = {2, 2, 5, 1, 1};
+    const std::vector<bool> boundary = {false, false, true};
+
+    WindowedDecodingGraph window(n, 4, next.size(), 8);
+    window.AppendLayer(first, first_weights, boundary);
+    for (size_t t = 1; t < 10; t++) {
+        if (window.IsFull()) {
+            window.RetireLayer();
+        }
+        window.AppendLayer(next, next_weights, boundary);
+
+        ShortestPaths paths(window);
+        const size_t last = window.GetFirstLayer() + window.GetNumLayers() - 1;
+        auto oldest = window.GetVertex(window.GetFirstLayer(), 0);
+        auto newest = window.GetVertex(last, 0);
+        REQUIRE(paths.GetDistance(oldest, newest) ==
+                window.GetNumLayers() - 1);
+        REQUIRE(paths.GetDistanceToBoundary(window.GetVertex(last, 1)).first ==
+                2);
+        auto path = paths.GetPath(newest, window.GetVertex(last, 1));
+        REQUIRE(path.distance == 2);
+        REQUIRE(path.edges ==
+                std::vector<size_t>{window.GetEdgeFromVertexPair(
+                    {newest, window.GetVertex(last, 1)})});
+    }
+}
+
+TEST_CASE("WindowedDecodingGraph rejects invalid layers",
+          "[WindowedDecodingGraph]") {
+    WindowedDecodingGraph window(2, 2, 3, 2);
+    const std::vector<bool> boundary = {false, true};
+
+    // The first layer has no previous layer
+    REQUIRE_THROWS_AS(window.AppendLayer(
+                          std::vector<std::pair<size_t, size_t>>{{0, 2}},
+                          boundary),
+                      std::invalid_argument);
+    window.AppendLayer(std::vector<std::pair<size_t, size_t>>{{2, 3}},
+                       boundary);
+
+    // Edges within the previous layer, out of range or too many
+    REQUIRE_THROWS_AS(window.AppendLayer(
+                          std::vector<std::pair<size_t, size_t>>{{0, 1}},
+                          boundary),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(window.AppendLayer(
+                          std::vector<std::pair<size_t, size_t>>{{2, 4}},
+                          boundary),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        window.AppendLayer(std::vector<std::pair<size_t, size_t>>(4, {2, 3}),
+                           boundary),
+        std::length_error);
+    REQUIRE_THROWS_AS(window.AppendLayer(
+                          std::vector<std::pair<size_t, size_t>>{{2, 3}},
+                          std::vector<bool>{false}),
+                      std::invalid_argument);
+
+    // Vertex 0 of the previous layer already has one edge
+    REQUIRE_THROWS_AS(window.AppendLayer(
+                          std::vector<std::pair<size_t, size_t>>{{0, 2},
+                                                                 {0, 3}},
+                          boundary),
+                      std::length_error);
+    REQUIRE(window.GetNumLayers() == 1);
+    REQUIRE(window.GetEdgesTouchingVertex(0).size() == 1);
+
+    window.AppendLayer(std::vector<std::pair<size_t, size_t>>{{0, 2}},
+                       boundary);
+    REQUIRE(window.IsFull());
+    REQUIRE_THROWS_AS(window.AppendLayer(
+                          std::vector<std::pair<size_t, size_t>>{{2, 3}},
+                          boundary),
+                      std::length_error);
+    REQUIRE_THROWS_AS(window.GetVertex(2, 0), std::out_of_range);
+    REQUIRE(window.GetLayerOfVertex(7) == window.kNoLayer);
+}
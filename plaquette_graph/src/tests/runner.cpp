@@ -1,9 +1,23 @@
 #define CATCH_CONFIG_RUNNER
 #include <catch2/catch.hpp>
 
+#include "Test_ClusterGrowth.hpp"
+#include "Test_CompressedSparseGraph.hpp"
+#include "Test_Concurrency.hpp"
 #include "Test_DecodingGraph.hpp"
+#include "Test_DetectorErrorModel.hpp"
+#include "Test_Generators.hpp"
+#include "Test_Hypergraph.hpp"
+#include "Test_Instrumentation.hpp"
 #include "Test_MultiGraph.hpp"
+#include "Test_Reordering.hpp"
+#include "Test_ScratchArena.hpp"
+#include "Test_Serialization.hpp"
+#include "Test_ShortestPaths.hpp"
 #include "Test_SparseGraph.hpp"
+#include "Test_SyndromeBatch.hpp"
+#include "Test_Utils.hpp"
+#include "Test_WindowedDecodingGraph.hpp"
 
 int main(int argc, char *argv[]) {
     int result;
@@ -0,0 +1,64 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+@pytest.mark.parametrize(
+    "graph_cls, growth_cls",
+    [(pcg.DecodingGraph, pcg.ClusterGrowth), (pcg.DecodingGraph32, pcg.ClusterGrowth32)],
+)
+def test_ClusterGrowth(graph_cls, growth_cls):
+    # The chain 0 - 1 - 2 - 3 - 4 with boundary vertices 0 and 4
+    graph = graph_cls(5, [(0, 1), (1, 2), (2, 3), (3, 4)], [True, False, False, False, True])
+    growth = growth_cls(graph)
+
+    growth.load_defects(np.array([1, 2]))
+    np.testing.assert_array_equal(np.sort(growth.get_active_clusters()), [1, 2])
+    assert growth.grow()
+    assert len(growth.get_active_clusters()) == 0
+    np.testing.assert_array_equal(growth.get_grown_edges(), [1])
+    assert growth.find_root(1) == growth.find_root(2)
+    assert not growth.is_cluster_odd(growth.find_root(1))
+
+    growth.load_defects([1])
+    assert growth.grow_until_neutral()
+    root = growth.find_root(1)
+    assert growth.is_cluster_on_boundary(root)
+    assert growth.get_cluster_size(root) == 3
+    assert growth.is_edge_grown(0)
+    assert not growth.is_vertex_in_cluster(4)
+
+
+def test_ClusterGrowth_odd_cluster_without_boundary():
+    graph = pcg.DecodingGraph(3, [(0, 1), (1, 2), (2, 0)], [False, False, False])
+    growth = pcg.ClusterGrowth(graph)
+    growth.load_defects([0])
+    assert not growth.grow_until_neutral()
+    with pytest.raises(IndexError):
+        growth.load_defects([3])
+
+
+@pytest.mark.parametrize(
+    "graph_cls, growth_cls",
+    [(pcg.DecodingGraph, pcg.ClusterGrowth), (pcg.DecodingGraph32, pcg.ClusterGrowth32)],
+)
+def test_ClusterGrowth_queries_are_range_checked(graph_cls, growth_cls):
+    graph = graph_cls(3, [(0, 1), (1, 2)], [True, False, True])
+    growth = growth_cls(graph)
+    growth.load_defects([1])
+    for query in [
+        growth.find_root,
+        growth.is_vertex_in_cluster,
+        growth.is_cluster_odd,
+        growth.is_cluster_on_boundary,
+        growth.get_cluster_size,
+    ]:
+        query(2)
+        with pytest.raises(IndexError):
+            query(3)
+    assert growth.get_half_edge_growth(3) == 0
+    with pytest.raises(IndexError):
+        growth.get_half_edge_growth(4)
+    assert not growth.is_edge_grown(1)
+    with pytest.raises(IndexError):
+        growth.is_edge_grown(2)
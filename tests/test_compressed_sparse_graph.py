@@ -0,0 +1,81 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+@pytest.mark.parametrize(
+    "graph_cls, cls",
+    [
+        (pcg.SparseGraph, pcg.CompressedSparseGraph),
+        (pcg.SparseGraph32, pcg.CompressedSparseGraph32),
+    ],
+)
+def test_compressed_graph_matches_sorted_graph(graph_cls, cls):
+    rng = np.random.default_rng(3)
+    edges = rng.integers(0, 50, size=(200, 2))
+    weights = rng.integers(0, 100, size=200, dtype=np.uint32)
+    graph = graph_cls(50, edges, weights=weights, sort_rows=True)
+    compressed = cls(graph)
+
+    assert compressed.get_num_vertices() == 50
+    assert compressed.get_num_edges() == graph.get_num_edges()
+    assert not compressed.is_edge_to_edge_matrix_constructed()
+    for v in range(50):
+        assert list(compressed.get_vertices_touching_vertex(v)) == list(
+            graph.get_vertices_touching_vertex(v)
+        )
+        row = compressed.get_edges_touching_vertex(v)
+        assert len(row) == len(graph.get_edges_touching_vertex(v))
+        assert list(row) == list(graph.get_edges_touching_vertex(v))
+    for e in range(graph.get_num_edges()):
+        assert list(compressed.get_edges_touching_edge(e)) == sorted(
+            graph.get_edges_touching_edge(e)
+        )
+        endpoints = graph.get_vertices_connected_by_edge(e)
+        assert compressed.get_vertices_connected_by_edge(e) == endpoints
+        assert compressed.get_edge_weight(e) == graph.get_edge_weight(e)
+    assert compressed.is_edge_to_edge_matrix_constructed()
+
+    vertices = np.arange(50)[::-1]
+    for actual, expected in zip(
+        compressed.get_edges_touching_vertices(vertices),
+        graph.get_edges_touching_vertices(vertices),
+    ):
+        np.testing.assert_array_equal(actual, expected)
+    pairs = rng.integers(0, 50, size=(100, 2))
+    np.testing.assert_array_equal(
+        compressed.get_edges_from_vertex_pairs(pairs), graph.get_edges_from_vertex_pairs(pairs)
+    )
+    np.testing.assert_array_equal(compressed.decompress().v_to_v_col, graph.v_to_v_col)
+
+
+def test_compressed_graph_from_edges():
+    graph = pcg.DecodingGraph.rotated_surface_code(7, 7, diagonal_edges=True)
+    edges = graph.e_to_v
+    compressed = pcg.CompressedSparseGraph(
+        graph.get_num_vertices(), edges, assume_unique_edges=True
+    )
+    row = compressed.get_vertices_touching_vertex(0)
+    with pytest.raises(IndexError):
+        row[len(row)]
+    assert list(row) == sorted(graph.get_vertices_touching_vertex(0))
+    uncompressed_bytes = graph.v_to_v_col.nbytes + graph.v_to_v_edges.nbytes
+    assert compressed.get_compressed_bytes() < uncompressed_bytes / 2
+
+
+@pytest.mark.parametrize("cls", [pcg.CompressedSparseGraph, pcg.CompressedSparseGraph32])
+def test_compressed_graph_rejects_out_of_range_indices(cls):
+    compressed = cls(3, np.array([(0, 1), (1, 2)]))
+    for query in (
+        compressed.get_edges_touching_vertex,
+        compressed.get_vertices_touching_vertex,
+    ):
+        with pytest.raises(IndexError):
+            query(3)
+    for query in (
+        compressed.get_edges_touching_edge,
+        compressed.get_vertices_connected_by_edge,
+        compressed.get_edge_weight,
+    ):
+        with pytest.raises(IndexError):
+            query(2)
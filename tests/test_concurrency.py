@@ -0,0 +1,62 @@
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+NUM_THREADS = 8
+
+
+def run_in_threads(fn, num_tasks):
+    with ThreadPoolExecutor(max_workers=NUM_THREADS) as executor:
+        return list(executor.map(fn, range(num_tasks)))
+
+
+@pytest.mark.parametrize("cls", [pcg.DecodingGraph, pcg.DecodingGraph32])
+def test_shared_graph_queries(cls):
+    reference = pcg.DecodingGraph.surface_code(5, 5, diagonal_edges=True)
+    boundary = [reference.is_vertex_on_boundary(v) for v in range(reference.get_num_vertices())]
+    graph = cls(reference.get_num_vertices(), reference.e_to_v, boundary)
+    assert not graph.is_edge_to_edge_matrix_constructed()
+
+    def query(edge):
+        # The first queries race to construct the edge-edge matrix
+        return (
+            sorted(graph.get_edges_touching_edge(edge)),
+            graph.get_vertices_connected_by_edges(np.array([edge])).tolist(),
+        )
+
+    num_edges = graph.get_num_edges()
+    results = run_in_threads(query, num_edges)
+    for edge, (touching, vertices) in enumerate(results):
+        assert touching == sorted(reference.get_edges_touching_edge(edge))
+        assert vertices == [list(reference.get_vertices_connected_by_edge(edge))]
+    np.testing.assert_array_equal(graph.e_to_e_row_ptr, reference.e_to_e_row_ptr)
+
+
+def test_concurrent_construction():
+    code = pcg.DecodingGraph.rotated_surface_code(5, 5)
+    num_vertices = code.get_num_vertices()
+    edges = code.e_to_v
+    boundary = [code.is_vertex_on_boundary(v) for v in range(num_vertices)]
+    reference = pcg.DecodingGraph(num_vertices, edges, boundary)
+
+    def build(_):
+        return pcg.DecodingGraph(num_vertices, edges, boundary).v_to_v_col.copy()
+
+    for col in run_in_threads(build, 2 * NUM_THREADS):
+        np.testing.assert_array_equal(col, reference.v_to_v_col)
+
+
+def test_shared_shortest_paths():
+    graph = pcg.DecodingGraph.surface_code(5, 5)
+    paths = pcg.ShortestPaths(graph, cache_capacity=16)
+    serial = pcg.ShortestPaths(graph)
+    num_vertices = graph.get_num_vertices()
+
+    def distances(source):
+        return [paths.get_distance(source, target) for target in range(0, num_vertices, 7)]
+
+    results = run_in_threads(distances, num_vertices)
+    for source, row in enumerate(results):
+        assert row == [serial.get_distance(source, target) for target in range(0, num_vertices, 7)]
@@ -1,3 +1,4 @@
+import numpy as np
 import pytest
 import plaquette_graph as pcg
 
@@ -12,3 +13,37 @@ def test_DecodingGraph():
     assert graph.is_vertex_on_boundary(0) == False
     assert graph.is_vertex_on_boundary(1) == True
     assert graph.is_vertex_on_boundary(2) == True
+
+
+def test_DecodingGraph32():
+    edges = [(0, 1), (0, 2), (1, 2)]
+    graph = pcg.DecodingGraph32(3, edges, [False, True, True])
+    assert graph.get_num_vertices() == 3
+    assert graph.get_num_edges() == 3
+    assert graph.is_vertex_on_boundary(0) == False
+    assert graph.is_vertex_on_boundary(1) == True
+
+
+def test_DecodingGraph_from_numpy():
+    edges = np.array([(0, 1), (0, 2), (1, 2)], dtype=np.uint32)
+    graph = pcg.DecodingGraph32(3, edges, np.array([False, True, True]))
+    assert graph.get_num_edges() == 3
+    assert graph.is_vertex_on_boundary(1) == True
+    assert graph.get_vertices_connected_by_edge(2) == (1, 2)
+
+
+def test_DecodingGraph_are_vertices_on_boundary():
+    graph = pcg.DecodingGraph(3, [(0, 1), (1, 2)], [True, False, True])
+    np.testing.assert_array_equal(
+        graph.are_vertices_on_boundary(np.array([2, 1, 0])),
+        [True, False, True],
+    )
+    with pytest.raises(IndexError):
+        graph.are_vertices_on_boundary([3])
+
+
+def test_DecodingGraph_rejects_mismatched_boundary():
+    with pytest.raises(ValueError):
+        pcg.DecodingGraph(3, [(0, 1), (1, 2)], [True, False])
+    with pytest.raises(ValueError):
+        pcg.DecodingGraph32(2, [(0, 1)], [True, False, True])
@@ -0,0 +1,59 @@
+import math
+
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+DEM = """# A small model
+error(0.1) D0 D1
+error(0.2) D1 L0
+error(0.01) D0 D1 D2 ^ D3
+repeat 2 {
+    error(0.1) D4
+    shift_detectors 1
+}
+detector(2, 0) D5
+"""
+
+
+def weight(p, scale=1000.0):
+    return round(scale * math.log((1 - p) / p))
+
+
+@pytest.mark.parametrize("cls", [pcg.DecodingGraph, pcg.DecodingGraph32])
+def test_from_dem(cls):
+    graph = cls.from_dem(DEM)
+    # The detector declaration is shifted by the repeat block, to detector 7
+    boundary = 8
+    assert graph.get_num_vertices() == 9
+    assert [graph.is_vertex_on_boundary(v) for v in range(9)] == [False] * 8 + [True]
+    edges = {tuple(e): w for e, w in zip(graph.e_to_v.tolist(), graph.edge_weights)}
+    assert edges == {
+        (0, 1): weight(0.1 * 0.99 + 0.01 * 0.9),
+        (1, boundary): weight(0.2),
+        (2, boundary): weight(0.01),
+        (3, boundary): weight(0.01),
+        (4, boundary): weight(0.1),
+        (5, boundary): weight(0.1),
+    }
+
+    clique = cls.from_dem(DEM, decomposition=pcg.HyperedgeDecomposition.Clique, sort_rows=True)
+    assert clique.get_num_edges() == 7
+    assert clique.are_rows_sorted()
+
+
+@pytest.mark.parametrize("mmap", [True, False])
+def test_load_dem(tmp_path, mmap):
+    path = tmp_path / "model.dem"
+    path.write_text(DEM)
+    loaded = pcg.DecodingGraph.load_dem(path, weight_scale=10.0, mmap=mmap)
+    expected = pcg.DecodingGraph.from_dem(DEM, weight_scale=10.0)
+    np.testing.assert_array_equal(loaded.e_to_v, expected.e_to_v)
+    np.testing.assert_array_equal(loaded.edge_weights, expected.edge_weights)
+
+
+def test_invalid_dem():
+    with pytest.raises(RuntimeError, match="line 2"):
+        pcg.DecodingGraph.from_dem("error(0.1) D0\nrepeat {\n}\n")
+    with pytest.raises(RuntimeError):
+        pcg.DecodingGraph.load_dem("/nonexistent/model.dem")
@@ -0,0 +1,58 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+def space_time_edges(detectors_per_round, space_edges, rounds):
+    """The edges of a space-time graph in the order of the generators."""
+    boundary = rounds * detectors_per_round
+
+    def vertex(r, d):
+        return boundary if d == detectors_per_round else r * detectors_per_round + d
+
+    edges = []
+    for r in range(rounds):
+        edges += [(vertex(r, u), vertex(r, v)) for u, v in space_edges]
+        if r + 1 < rounds:
+            edges += [(vertex(r, d), vertex(r + 1, d)) for d in range(detectors_per_round)]
+    return boundary + 1, edges
+
+
+@pytest.mark.parametrize("cls", [pcg.DecodingGraph, pcg.DecodingGraph32])
+def test_space_time_matches_constructor(cls):
+    space_edges = [(3, 0), (0, 1), (1, 2), (2, 3)]
+    graph = cls.space_time(3, space_edges, 4)
+    num_vertices, edges = space_time_edges(3, space_edges, 4)
+    boundary = [v == num_vertices - 1 for v in range(num_vertices)]
+    expected = cls(num_vertices, edges, boundary)
+
+    assert graph.get_num_vertices() == num_vertices
+    assert graph.get_num_edges() == len(edges)
+    for v in range(num_vertices):
+        np.testing.assert_array_equal(
+            np.asarray(graph.get_vertices_touching_vertex(v)),
+            np.asarray(expected.get_vertices_touching_vertex(v)),
+        )
+        assert graph.is_vertex_on_boundary(v) == boundary[v]
+    for e in range(len(edges)):
+        assert graph.get_vertices_connected_by_edge(e) == edges[e]
+    assert cls.repetition_code(4, 4).get_num_edges() == len(edges)
+
+
+def test_code_families():
+    d, rounds = 5, 3
+    graph = pcg.DecodingGraph.rotated_surface_code(d, rounds)
+    detectors = (d * d - 1) // 2
+    assert graph.get_num_vertices() == rounds * detectors + 1
+    assert graph.get_num_edges() == rounds * d * d + (rounds - 1) * detectors
+
+    graph = pcg.DecodingGraph.surface_code(d, diagonal_edges=True, time_weight=2)
+    assert graph.get_num_vertices() == d * (d - 1) + 1
+
+    graph = pcg.DecodingGraph32.repetition_code(d, 2, diagonal_edges=True, time_weight=3)
+    time_edge, diagonal_edge = graph.get_edges_from_vertex_pairs(np.array([[0, d - 1], [0, d]]))
+    assert graph.get_edge_weight(time_edge) == 3
+    assert graph.get_edge_weight(diagonal_edge) == 1
+
+    with pytest.raises(ValueError):
+        pcg.DecodingGraph.repetition_code(1)
@@ -0,0 +1,86 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+HYPEREDGES = [[2, 0, 1], [3], [0, 1, 2, 3], [], [1, 2]]
+
+
+@pytest.mark.parametrize("cls", [pcg.Hypergraph, pcg.Hypergraph32])
+def test_hypergraph_incidence(cls):
+    hypergraph = cls(5, HYPEREDGES, weights=[10, 20, 30, 40, 50])
+    assert hypergraph.get_num_vertices() == 5
+    assert hypergraph.get_num_hyperedges() == 5
+    assert hypergraph.get_num_incidences() == 10
+    assert list(hypergraph.get_vertices_of_hyperedge(0)) == [0, 1, 2]
+    assert len(hypergraph.get_vertices_of_hyperedge(3)) == 0
+    assert list(hypergraph.get_hyperedges_touching_vertex(1)) == [0, 2, 4]
+    assert len(hypergraph.get_hyperedges_touching_vertex(4)) == 0
+    assert hypergraph.get_hyperedge_weight(2) == 30
+    np.testing.assert_array_equal(hypergraph.e_to_v_row_ptr, [0, 3, 4, 8, 8, 10])
+    np.testing.assert_array_equal(hypergraph.v_to_e_row_ptr, [0, 2, 5, 8, 10, 10])
+    np.testing.assert_array_equal(hypergraph.hyperedge_weights, [10, 20, 30, 40, 50])
+    with pytest.raises(IndexError):
+        hypergraph.get_vertices_of_hyperedge(5)
+
+    offsets = np.array([0, 3, 4, 8, 8, 10])
+    vertices = np.concatenate([np.array(h, dtype=np.int64) for h in HYPEREDGES])
+    flat = cls(5, offsets, vertices)
+    assert flat.hyperedge_weights is None
+    np.testing.assert_array_equal(flat.e_to_v_col, hypergraph.e_to_v_col)
+    np.testing.assert_array_equal(flat.v_to_e_col, hypergraph.v_to_e_col)
+
+
+def test_hypergraph_rejects_invalid_hyperedges():
+    with pytest.raises(ValueError):
+        pcg.Hypergraph(3, [[0, 3]])
+    with pytest.raises(ValueError):
+        pcg.Hypergraph(3, [[1, 1]])
+    with pytest.raises(ValueError):
+        pcg.Hypergraph(3, [[0], [1]], weights=[1])
+    with pytest.raises(ValueError):
+        pcg.Hypergraph(3, np.array([0, 2, 1]), np.array([0, 1]))
+
+
+@pytest.mark.parametrize("cls", [pcg.Hypergraph, pcg.Hypergraph32])
+def test_hypergraph_to_decoding_graph(cls):
+    hypergraph = cls(4, HYPEREDGES, weights=[10, 20, 30, 40, 50])
+    boundary = hypergraph.get_num_vertices()
+
+    graph = hypergraph.to_decoding_graph()
+    assert graph.get_num_vertices() == 5
+    assert [graph.is_vertex_on_boundary(v) for v in range(5)] == [False] * 4 + [True]
+    edges = {tuple(sorted(e)): w for e, w in zip(graph.e_to_v.tolist(), graph.edge_weights)}
+    assert edges == {(0, 1): 10, (2, boundary): 10, (3, boundary): 20, (2, 3): 30, (1, 2): 50}
+
+    clique = hypergraph.to_decoding_graph(pcg.HyperedgeDecomposition.Clique, sort_rows=True)
+    assert clique.get_num_edges() == 7
+    assert clique.are_rows_sorted()
+
+
+@pytest.mark.parametrize(
+    "cls, graph_cls",
+    [(pcg.Hypergraph, pcg.DecodingGraph), (pcg.Hypergraph32, pcg.DecodingGraph32)],
+)
+@pytest.mark.parametrize(
+    "decomposition", [pcg.HyperedgeDecomposition.Pairs, pcg.HyperedgeDecomposition.Clique]
+)
+def test_hypergraph_probabilities_match_dem(cls, graph_cls, decomposition):
+    probabilities = [0.1, 0.2, 0.05, 0.3, 0.1]
+    text = "".join(
+        f"error({p}) " + " ".join(f"D{v}" for v in h) + "\n"
+        for p, h in zip(probabilities, HYPEREDGES)
+        if h
+    )
+    # No mechanism flips vertex 4, which is only declared
+    text += "detector D4\n"
+    hypergraph = cls(5, HYPEREDGES, weights=[10, 20, 30, 40, 50])
+    built = hypergraph.to_decoding_graph(decomposition, probabilities=probabilities)
+    parsed = graph_cls.from_dem(text, decomposition=decomposition)
+
+    def weighted_edges(graph):
+        return {tuple(sorted(e)): w for e, w in zip(graph.e_to_v.tolist(), graph.edge_weights)}
+
+    assert built.get_num_vertices() == parsed.get_num_vertices()
+    assert weighted_edges(built) == weighted_edges(parsed)
+    with pytest.raises(ValueError):
+        hypergraph.to_decoding_graph(probabilities=[0.1])
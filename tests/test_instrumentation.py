@@ -0,0 +1,90 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+def chain(num_vertices):
+    return [(v, v + 1) for v in range(num_vertices - 1)]
+
+
+@pytest.mark.parametrize("cls", [pcg.SparseGraph, pcg.SparseGraph32])
+def test_construction_timings(cls):
+    graph = cls(1000, chain(1000), edge_index=True)
+    timings = graph.get_construction_timings()
+    assert set(timings) == {
+        "deduplicate_edges",
+        "vertex_to_vertex",
+        "edge_index",
+        "edge_to_edge",
+        "local_edge_maps",
+    }
+    assert timings["vertex_to_vertex"] > 0
+    assert timings["edge_index"] > 0
+    assert timings["edge_to_edge"] == 0
+    assert timings["local_edge_maps"] == 0
+
+    graph.get_edges_touching_edge(0)
+    assert graph.get_construction_timings()["edge_to_edge"] > 0
+
+
+def test_decoding_graph_timings():
+    graph = pcg.DecodingGraph(100, chain(100), [False] * 100)
+    assert graph.get_construction_timings()["local_edge_maps"] > 0
+
+
+@pytest.mark.parametrize("cls, itemsize", [(pcg.DecodingGraph, 8), (pcg.DecodingGraph32, 4)])
+def test_memory_footprint(cls, itemsize):
+    num_vertices = 20
+    edges = chain(num_vertices)
+    weights = np.ones(len(edges), dtype=np.uint32)
+    graph = cls(num_vertices, edges, [True] + [False] * (num_vertices - 1), weights=weights)
+
+    footprint = graph.get_memory_footprint()
+    assert "e_to_e_col" not in footprint
+    assert footprint["v_to_v_col"]["bytes"] == graph.v_to_v_col.nbytes
+    assert footprint["v_to_v_row_ptr"]["bytes"] == (num_vertices + 1) * itemsize
+    assert footprint["edge_weights"]["bytes"] == 4 * len(edges)
+    assert footprint["vertex_boundary_type"]["bytes"] == num_vertices
+    assert footprint["local_to_global_edge_map"]["bytes"] == 2 * len(edges) * itemsize
+    for array in footprint.values():
+        assert array["capacity_bytes"] >= array["bytes"]
+        assert not array["external"]
+
+    graph.get_edges_touching_edge(0)
+    assert graph.get_memory_footprint()["e_to_e_col"]["bytes"] == graph.e_to_e_col.nbytes
+
+
+def test_loaded_graph_footprint(tmp_path):
+    path = tmp_path / "graph.bin"
+    pcg.SparseGraph(10, chain(10)).save(path)
+    footprint = pcg.load_graph(path, mmap=True).get_memory_footprint()
+    assert footprint["v_to_v_col"]["external"]
+    assert footprint["v_to_v_col"]["capacity_bytes"] == 0
+
+
+def test_compressed_footprint():
+    graph = pcg.CompressedSparseGraph(pcg.SparseGraph(10, chain(10)))
+    footprint = graph.get_memory_footprint()
+    assert (
+        footprint["v_to_v_offsets"]["bytes"] + footprint["v_to_v_data"]["bytes"]
+        == graph.get_compressed_bytes()
+    )
+
+
+def test_query_counts():
+    graph = pcg.SparseGraph(4, [(0, 1), (1, 2), (2, 0)])
+    graph.get_edges_touching_vertex(0)
+    graph.get_edges_touching_edge(0)
+    graph.get_edges_from_vertex_pairs(np.array([[0, 1], [0, 3]]))
+
+    counts = graph.get_query_counts()
+    if pcg.query_counters_enabled:
+        assert counts["vertex_rows"] == 1
+        assert counts["edge_rows"] == 1
+        assert counts["vertex_pairs"] == 2
+        assert counts["vertex_pair_misses"] == 1
+    else:
+        assert all(count == 0 for count in counts.values())
+
+    graph.reset_query_counts()
+    assert all(count == 0 for count in graph.get_query_counts().values())
@@ -68,3 +68,32 @@ def test_create_graph_with_duplicate_edges():
     g = plaquette_graph.MultiGraph(edges, weights)
     assert g.get_num_vertices() == 3
     assert g.get_num_edges()
+
+
+def test_get_edges_touching_edge_parallel_edges():
+    edges = [(0, 1), (1, 0), (1, 1), (1, 2), (3, 4)]
+    weights = [1, 1, 1, 1, 1]
+    g = plaquette_graph.MultiGraph(edges, weights)
+    assert g.get_edges_touching_edge(0) == [1, 2, 3]
+    assert g.get_edges_touching_edge(2) == [0, 1, 3]
+    assert g.get_edges_touching_edge(4) == []
+    assert list(g.get_edges_touching_edge_row(0)) == [1, 2, 3]
+    with pytest.raises(IndexError):
+        g.get_edges_touching_edge_row(5)
+
+
+def test_edge_lookup_with_sorted_rows_and_edge_index():
+    edges = [(3, 0), (0, 1), (2, 0), (1, 0), (1, 1)]
+    weights = [1] * len(edges)
+    sorted_graph = plaquette_graph.MultiGraph(edges, weights, sort_rows=True)
+    assert sorted_graph.are_rows_sorted()
+    assert sorted_graph.get_vertices_touching_vertex(0) == [1, 1, 2, 3]
+    assert sorted_graph.get_edges_touching_vertex(0) == [1, 3, 2, 0]
+
+    indexed = plaquette_graph.MultiGraph(edges, weights)
+    indexed.build_edge_index()
+    assert indexed.has_edge_index()
+    for g in (sorted_graph, indexed):
+        assert g.get_edge_connecting_vertices(1, 0) == 1
+        assert g.get_edge_connecting_vertices(1, 1) == 4
+        assert g.get_edge_connecting_vertices(2, 3) == len(edges)
@@ -0,0 +1,175 @@
+import multiprocessing
+import pickle
+
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+from plaquette_graph.shared import SharedGraph
+
+
+def assert_same_arrays(a, b):
+    arrays_a = a.get_arrays()
+    arrays_b = b.get_arrays()
+    assert set(arrays_a) == set(arrays_b)
+    for key, array in arrays_a.items():
+        np.testing.assert_array_equal(array, arrays_b[key])
+
+
+@pytest.mark.parametrize("cls", [pcg.SparseGraph, pcg.SparseGraph32])
+@pytest.mark.parametrize("protocol", [2, 4, 5])
+def test_pickle_sparse_graph(cls, protocol):
+    graph = cls(4, [(0, 1), (1, 2), (2, 3), (3, 0)], weights=[1, 2, 3, 4], sort_rows=True)
+    loaded = pickle.loads(pickle.dumps(graph, protocol=protocol))
+    assert type(loaded) is cls
+    assert loaded.get_num_vertices() == 4
+    assert loaded.are_rows_sorted()
+    assert loaded.get_edge_weight(3) == 4
+    assert not loaded.is_edge_to_edge_matrix_constructed()
+    assert_same_arrays(loaded, graph)
+    assert list(loaded.get_edges_touching_edge(0)) == list(graph.get_edges_touching_edge(0))
+
+
+@pytest.mark.parametrize(
+    "make",
+    [
+        lambda: pcg.SparseGraph(0, []),
+        lambda: pcg.SparseGraph32(0, []),
+        lambda: pcg.DecodingGraph(0, [], []),
+        lambda: pcg.DecodingGraph32(0, [], []),
+    ],
+)
+@pytest.mark.parametrize("protocol", [2, 5])
+def test_pickle_empty_graph(make, protocol):
+    graph = make()
+    np.testing.assert_array_equal(graph.get_arrays()["v_to_v_row_ptr"], [0])
+    loaded = pickle.loads(pickle.dumps(graph, protocol=protocol))
+    assert loaded.get_num_vertices() == 0
+    assert loaded.get_num_edges() == 0
+    assert_same_arrays(loaded, graph)
+
+
+@pytest.mark.parametrize("cls", [pcg.DecodingGraph, pcg.DecodingGraph32])
+def test_pickle_out_of_band(cls):
+    graph = cls.surface_code(3, 3)
+    graph.get_edges_touching_edge(0)
+    graph.build_edge_index()
+
+    buffers = []
+    data = pickle.dumps(graph, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == len(graph.get_arrays())
+
+    loaded = pickle.loads(data, buffers=buffers)
+    assert type(loaded) is cls
+    assert loaded.is_edge_to_edge_matrix_constructed()
+    assert loaded.has_edge_index()
+    assert_same_arrays(loaded, graph)
+    for v in range(graph.get_num_vertices()):
+        assert loaded.is_vertex_on_boundary(v) == graph.is_vertex_on_boundary(v)
+
+    # The arrays are adopted without being copied
+    footprint = loaded.get_memory_footprint()
+    assert all(footprint[key]["external"] for key in graph.get_arrays())
+
+
+def test_from_arrays_rejects_inconsistent_arrays():
+    arrays = dict(pcg.SparseGraph(3, [(0, 1), (1, 2)]).get_arrays())
+    with pytest.raises(ValueError):
+        pcg.SparseGraph.from_arrays(4, arrays)
+    del arrays["v_to_v_col"]
+    with pytest.raises(ValueError):
+        pcg.SparseGraph.from_arrays(3, arrays)
+
+
+@pytest.mark.parametrize("cls", [pcg.DecodingGraph, pcg.DecodingGraph32])
+@pytest.mark.parametrize(
+    "key, index, value",
+    [
+        ("v_to_v_row_ptr", 1, 100),
+        ("v_to_v_col", 0, 10**6),
+        ("v_to_v_edges", 2, 10**6),
+        ("e_to_v", (0, 1), 10**6),
+        ("e_to_e_col", 0, 10**6),
+        ("local_edge_strides", 1, 0),
+        ("local_to_global_edge_map", 0, 10**6),
+        ("global_to_local_edge_map", 3, 10**6),
+    ],
+)
+def test_setstate_rejects_corrupted_arrays(cls, key, index, value):
+    graph = cls.surface_code(3, 3)
+    graph.get_edges_touching_edge(0)
+    state = graph.__getstate__()
+    arrays = {name: np.array(array) for name, array in state[4].items()}
+
+    truncated = dict(arrays, **{key: arrays[key][:-1]})
+    with pytest.raises(ValueError):
+        cls.__new__(cls).__setstate__((*state[:4], truncated))
+    arrays[key][index] = value
+    with pytest.raises(ValueError):
+        cls.__new__(cls).__setstate__((*state[:4], arrays))
+
+
+def test_pickle_multigraph():
+    edges = [(0, 1), (1, 0), (1, 1), (1, 2)]
+    graph = pcg.MultiGraph(edges, [1, 2, 3, 4], sort_rows=True)
+    graph.build_edge_index()
+    loaded = pickle.loads(pickle.dumps(graph, protocol=5))
+    assert loaded.get_num_vertices() == 3
+    assert loaded.are_rows_sorted()
+    assert loaded.has_edge_index()
+    assert_same_arrays(loaded, graph)
+    for e in range(len(edges)):
+        assert loaded.get_weight(e) == e + 1
+        assert loaded.get_edges_touching_edge(e) == graph.get_edges_touching_edge(e)
+    assert pickle.loads(pickle.dumps(pcg.MultiGraph([], []))).get_num_edges() == 0
+
+
+@pytest.mark.parametrize(
+    "key, index, value",
+    [
+        ("v_to_v_row_ptr", 1, 100),
+        ("v_to_v_col", 0, 10**6),
+        ("v_to_v_edges", 2, 10**6),
+        ("edges", (0, 1), 10**6),
+    ],
+)
+def test_multigraph_setstate_rejects_corrupted_arrays(key, index, value):
+    graph = pcg.MultiGraph([(0, 1), (1, 0), (1, 1), (1, 2)], [1, 2, 3, 4])
+    state = graph.__getstate__()
+    arrays = {name: np.array(array) for name, array in state[4].items()}
+
+    truncated = dict(arrays, **{key: arrays[key][:-1]})
+    with pytest.raises(ValueError):
+        pcg.MultiGraph.__new__(pcg.MultiGraph).__setstate__((*state[:4], truncated))
+    arrays[key][index] = value
+    with pytest.raises(ValueError):
+        pcg.MultiGraph.__new__(pcg.MultiGraph).__setstate__((*state[:4], arrays))
+
+
+def worker_graph_info(shared, edge):
+    graph = shared.graph
+    footprint = graph.get_memory_footprint()
+    return sorted(graph.get_edges_touching_edge(edge)), footprint["v_to_v_col"]["external"]
+
+
+@pytest.mark.skipif(
+    "fork" not in multiprocessing.get_all_start_methods(), reason="needs the fork start method"
+)
+def test_shared_graph_in_workers():
+    graph = pcg.DecodingGraph.rotated_surface_code(5, 5)
+    with SharedGraph(graph) as shared:
+        assert_same_arrays(shared.graph, graph)
+        assert pickle.loads(pickle.dumps(shared)) is shared
+
+        num_edges = graph.get_num_edges()
+        with multiprocessing.get_context("fork").Pool(2) as pool:
+            results = pool.starmap(worker_graph_info, [(shared, e) for e in range(num_edges)])
+    for edge, (touching, external) in enumerate(results):
+        assert touching == sorted(graph.get_edges_touching_edge(edge))
+        assert external
+
+
+def test_shared_multigraph():
+    graph = pcg.MultiGraph([(0, 1), (1, 2), (2, 0)], [1, 2, 3])
+    with SharedGraph(graph) as shared:
+        assert shared.graph.get_edge_connecting_vertices(2, 0) == 2
+        assert shared.graph.get_weight(1) == 2
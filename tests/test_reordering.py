@@ -0,0 +1,78 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+def grid(rows, cols, seed):
+    """A grid with shuffled vertex labels and the coordinates of its vertices."""
+    label = np.random.default_rng(seed).permutation(rows * cols)
+    edges = []
+    coordinates = np.zeros((rows * cols, 2))
+    for r in range(rows):
+        for c in range(cols):
+            v = r * cols + c
+            coordinates[label[v]] = (c, r)
+            if c + 1 < cols:
+                edges.append((label[v], label[v + 1]))
+            if r + 1 < rows:
+                edges.append((label[v], label[v + cols]))
+    return np.array(edges, dtype=np.int64), coordinates
+
+
+def bandwidth(graph):
+    e_to_v = graph.e_to_v.astype(np.int64)
+    return int(np.abs(e_to_v[:, 0] - e_to_v[:, 1]).max())
+
+
+@pytest.mark.parametrize("cls", [pcg.SparseGraph, pcg.SparseGraph32])
+@pytest.mark.parametrize(
+    "order",
+    [pcg.VertexOrder.ReverseCuthillMcKee, pcg.VertexOrder.BreadthFirst, pcg.VertexOrder.Morton],
+)
+def test_reordered_graph(cls, order):
+    edges, coordinates = grid(8, 12, 1)
+    weights = np.arange(len(edges), dtype=np.uint32)
+    graph = cls(96, edges, weights=weights)
+    reordered, (vertex_forward, vertex_inverse), (edge_forward, edge_inverse) = graph.reordered(
+        order, coordinates=coordinates
+    )
+
+    assert isinstance(reordered, cls)
+    np.testing.assert_array_equal(vertex_forward[vertex_inverse], np.arange(96))
+    np.testing.assert_array_equal(edge_forward[edge_inverse], np.arange(len(edges)))
+    np.testing.assert_array_equal(reordered.e_to_v[edge_forward], vertex_forward[edges])
+    np.testing.assert_array_equal(reordered.edge_weights[edge_forward], weights)
+    assert bandwidth(reordered) < bandwidth(graph)
+
+
+def test_reordered_decoding_graph():
+    graph = pcg.DecodingGraph.rotated_surface_code(5, 5)
+    boundary = graph.get_num_vertices() - 1
+    reordered, (vertex_forward, _), (edge_forward, _) = graph.reordered()
+
+    assert isinstance(reordered, pcg.DecodingGraph)
+    assert reordered.is_vertex_on_boundary(vertex_forward[boundary])
+    assert reordered.are_vertices_on_boundary(vertex_forward).sum() == 1
+    paths = pcg.ShortestPaths(graph)
+    new_paths = pcg.ShortestPaths(reordered)
+    for v in range(0, boundary, 7):
+        assert (
+            new_paths.get_distance_to_boundary(vertex_forward[v])[0]
+            == paths.get_distance_to_boundary(v)[0]
+        )
+
+
+def test_reordered_errors():
+    edges, coordinates = grid(3, 3, 2)
+    graph = pcg.SparseGraph(9, edges)
+    with pytest.raises(ValueError):
+        graph.reordered(pcg.VertexOrder.Morton)
+    with pytest.raises(ValueError):
+        graph.reordered(pcg.VertexOrder.Morton, coordinates=coordinates[:4])
+    with pytest.raises(ValueError):
+        graph.reordered(pcg.VertexOrder.Morton, coordinates=coordinates.ravel())
+    for bad in (np.nan, np.inf):
+        corrupted = coordinates.astype(float)
+        corrupted[4, 0] = bad
+        with pytest.raises(ValueError):
+            graph.reordered(pcg.VertexOrder.Morton, coordinates=corrupted)
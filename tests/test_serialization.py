@@ -0,0 +1,41 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+@pytest.mark.parametrize("cls", [pcg.SparseGraph, pcg.SparseGraph32])
+@pytest.mark.parametrize("mmap", [True, False])
+def test_SparseGraph_save_load(tmp_path, cls, mmap):
+    graph = cls(4, [(0, 1), (1, 2), (2, 3), (3, 0)])
+    path = tmp_path / "graph.bin"
+    graph.save(path)
+
+    loaded = pcg.load_graph(path, mmap=mmap)
+    assert type(loaded) is cls
+    assert loaded.get_num_vertices() == 4
+    assert not loaded.is_edge_to_edge_matrix_constructed()
+    np.testing.assert_array_equal(loaded.v_to_v_col, graph.v_to_v_col)
+    np.testing.assert_array_equal(loaded.e_to_v, graph.e_to_v)
+    np.testing.assert_array_equal(loaded.e_to_e_col, graph.e_to_e_col)
+
+
+def test_DecodingGraph_save_load(tmp_path):
+    graph = pcg.DecodingGraph32(3, [(0, 1), (1, 2)], [True, False, True])
+    path = tmp_path / "graph.bin"
+    graph.save(str(path))
+
+    loaded = pcg.load_graph(path)
+    assert type(loaded) is pcg.DecodingGraph32
+    assert [loaded.is_vertex_on_boundary(v) for v in range(3)] == [
+        True,
+        False,
+        True,
+    ]
+    assert list(loaded.get_edges_touching_vertex(1)) == [0, 1]
+
+
+def test_load_graph_invalid(tmp_path):
+    path = tmp_path / "graph.bin"
+    path.write_bytes(b"\0" * 128)
+    with pytest.raises(RuntimeError):
+        pcg.load_graph(path)
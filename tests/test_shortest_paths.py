@@ -0,0 +1,57 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+@pytest.fixture(
+    params=[(pcg.DecodingGraph, pcg.ShortestPaths), (pcg.DecodingGraph32, pcg.ShortestPaths32)]
+)
+def chain(request):
+    """The chain 0 - 1 - 2 - 3 - 4 with boundary vertices 0 and 4."""
+    graph_cls, paths_cls = request.param
+    graph = graph_cls(
+        5,
+        [(0, 1), (1, 2), (2, 3), (3, 4)],
+        [True, False, False, False, True],
+        weights=[10, 1, 1, 3],
+    )
+    return graph, paths_cls
+
+
+def test_edge_weights(chain):
+    graph, _ = chain
+    assert graph.has_edge_weights()
+    assert graph.get_edge_weight(0) == 10
+    np.testing.assert_array_equal(graph.edge_weights, [10, 1, 1, 3])
+    assert pcg.DecodingGraph(2, [(0, 1)], [True, False]).edge_weights is None
+
+
+def test_edge_weights_size_mismatch():
+    with pytest.raises(ValueError):
+        pcg.SparseGraph(3, [(0, 1), (1, 2)], weights=[1])
+
+
+@pytest.mark.parametrize("cache_capacity", [0, 8])
+def test_shortest_paths(chain, cache_capacity):
+    graph, paths_cls = chain
+    paths = paths_cls(graph, cache_capacity=cache_capacity)
+    assert paths.get_distance(0, 4) == 15
+    np.testing.assert_array_equal(paths.get_distances(1, np.array([0, 4, 1])), [10, 5, 0])
+
+    distance, target, edges = paths.get_path(4, 1)
+    assert (distance, target) == (5, 1)
+    np.testing.assert_array_equal(edges, [3, 2, 1])
+
+    assert paths.get_distance_to_boundary(1) == (5, 4)
+    distance, vertex, edges = paths.get_path_to_boundary(2)
+    assert (distance, vertex) == (4, 4)
+    np.testing.assert_array_equal(edges, [2, 3])
+    assert paths.get_cache_size() <= cache_capacity
+
+
+def test_shortest_paths_unreachable():
+    graph = pcg.DecodingGraph(3, [(0, 1)], [False, False, True])
+    paths = pcg.ShortestPaths(graph)
+    assert paths.get_distance(0, 2) == pcg.ShortestPaths.INFINITY
+    with pytest.raises(IndexError):
+        paths.get_distance(0, 3)
@@ -1,3 +1,6 @@
+import gc
+
+import numpy as np
 import pytest
 import plaquette_graph as pcg
 
@@ -40,3 +43,176 @@ def test_SparseGraph():
     assert graph.get_vertices_connected_by_edge(0) == (0, 1)
     assert graph.get_vertices_connected_by_edge(1) == (0, 2)
     assert graph.get_vertices_connected_by_edge(2) == (1, 2)
+
+
+def test_SparseGraph32():
+    edges = [(0, 1), (0, 2), (1, 2)]
+    graph = pcg.SparseGraph32(3, edges)
+    reference = pcg.SparseGraph(3, edges)
+
+    assert graph.get_num_vertices() == 3
+    assert graph.get_num_edges() == 3
+    for v in range(3):
+        assert list(graph.get_edges_touching_vertex(v)) == list(
+            reference.get_edges_touching_vertex(v)
+        )
+        assert list(graph.get_vertices_touching_vertex(v)) == list(
+            reference.get_vertices_touching_vertex(v)
+        )
+    for e in range(3):
+        assert list(graph.get_edges_touching_edge(e)) == list(
+            reference.get_edges_touching_edge(e)
+        )
+        assert graph.get_vertices_connected_by_edge(e) == (
+            reference.get_vertices_connected_by_edge(e)
+        )
+
+
+def test_SparseGraph32_overflow():
+    with pytest.raises(OverflowError):
+        pcg.SparseGraph32(2**32 + 1, [(0, 1)])
+
+
+def test_SparseGraph_duplicate_edges():
+    edges = [(0, 1), (1, 0), (1, 2), (0, 1)]
+    assert pcg.SparseGraph(3, edges).get_num_edges() == 2
+    assert pcg.SparseGraph(3, edges, assume_unique_edges=True).get_num_edges() == 4
+
+
+def test_SparseGraph_edge_to_edge_modes():
+    edges = [(0, 1), (0, 2), (1, 2), (2, 3)]
+    lazy = pcg.SparseGraph(4, edges)
+    assert not lazy.is_edge_to_edge_matrix_constructed()
+    assert sorted(lazy.get_edges_touching_edge_implicit(3)) == [1, 2]
+    assert not lazy.is_edge_to_edge_matrix_constructed()
+    assert list(lazy.get_edges_touching_edge(3)) == [1, 2]
+    assert lazy.is_edge_to_edge_matrix_constructed()
+
+    eager = pcg.SparseGraph(4, edges, edge_to_edge=pcg.EdgeToEdgeMode.Eager)
+    assert eager.is_edge_to_edge_matrix_constructed()
+
+
+def test_SparseGraph_num_threads():
+    edges = [(i % 97, (7 * i + 3) % 97) for i in range(20000)]
+    serial = pcg.SparseGraph(97, edges)
+    parallel = pcg.SparseGraph(97, edges, num_threads=4)
+    assert parallel.get_num_edges() == serial.get_num_edges()
+    for v in range(97):
+        assert list(parallel.get_edges_touching_vertex(v)) == list(
+            serial.get_edges_touching_vertex(v)
+        )
+
+
+@pytest.mark.parametrize("dtype", [np.int64, np.int32, np.uint32, np.uint64])
+def test_SparseGraph_from_numpy(dtype):
+    edges = [(0, 1), (0, 2), (1, 2), (2, 0)]
+    reference = pcg.SparseGraph(3, edges)
+    graph = pcg.SparseGraph(3, np.array(edges, dtype=dtype))
+
+    assert graph.get_num_edges() == reference.get_num_edges()
+    for v in range(3):
+        assert list(graph.get_edges_touching_vertex(v)) == list(
+            reference.get_edges_touching_vertex(v)
+        )
+
+
+def test_SparseGraph_from_numpy_invalid():
+    with pytest.raises(ValueError):
+        pcg.SparseGraph(3, np.array([0, 1, 2]))
+    with pytest.raises(ValueError):
+        pcg.SparseGraph(3, np.array([(0, -1)]))
+    with pytest.raises(TypeError):
+        pcg.SparseGraph(3, np.array([(0.0, 1.0)]))
+
+
+@pytest.mark.parametrize("cls", [pcg.SparseGraph, pcg.SparseGraph32])
+def test_SparseGraph_numpy_views(cls):
+    edges = np.array([(0, 1), (0, 2), (1, 2)])
+    graph = cls(3, edges)
+
+    np.testing.assert_array_equal(graph.v_to_v_row_ptr, [0, 2, 4, 6])
+    np.testing.assert_array_equal(graph.v_to_v_col, [1, 2, 0, 2, 0, 1])
+    np.testing.assert_array_equal(graph.v_to_v_edges, [0, 1, 0, 2, 1, 2])
+    np.testing.assert_array_equal(graph.e_to_v, edges)
+    np.testing.assert_array_equal(graph.e_to_e_row_ptr, [0, 2, 4, 6])
+    assert graph.is_edge_to_edge_matrix_constructed()
+
+    col = graph.v_to_v_col
+    assert not col.flags.writeable
+    with pytest.raises(ValueError):
+        col[0] = 5
+
+    row = np.asarray(graph.get_vertices_touching_vertex(1))
+    np.testing.assert_array_equal(row, [0, 2])
+    assert not row.flags.writeable
+
+    # The views keep the graph alive
+    del graph
+    gc.collect()
+    np.testing.assert_array_equal(col, [1, 2, 0, 2, 0, 1])
+    np.testing.assert_array_equal(row, [0, 2])
+
+
+@pytest.mark.parametrize("cls", [pcg.SparseGraph, pcg.SparseGraph32])
+def test_SparseGraph_batch_queries(cls):
+    graph = cls(5, [(0, 1), (1, 2), (2, 3), (3, 0), (1, 3)])
+
+    vertices = np.array([1, 4, 0, 1])
+    offsets, values = graph.get_edges_touching_vertices(vertices)
+    np.testing.assert_array_equal(offsets, [0, 3, 3, 5, 8])
+    for i, v in enumerate(vertices):
+        np.testing.assert_array_equal(
+            values[offsets[i] : offsets[i + 1]],
+            list(graph.get_edges_touching_vertex(v)),
+        )
+
+    offsets, values = graph.get_vertices_touching_vertices([1])
+    np.testing.assert_array_equal(values, [0, 2, 3])
+
+    np.testing.assert_array_equal(
+        graph.get_vertices_connected_by_edges([4, 0]), [[1, 3], [0, 1]]
+    )
+
+    found = graph.get_edges_from_vertex_pairs([(3, 1), (0, 2), (9, 0)])
+    missing = np.iinfo(found.dtype).max
+    np.testing.assert_array_equal(found, [4, missing, missing])
+
+    with pytest.raises(IndexError):
+        graph.get_edges_touching_vertices([5])
+
+    # Indices that do not fit the index type are out of range rather than
+    # wrapped around, e.g. 2**32 + 1 to vertex 1 of a 32-bit graph
+    for bad in (-1, 2**32 + 1):
+        for query in (
+            graph.get_edges_touching_vertices,
+            graph.get_vertices_touching_vertices,
+            graph.get_vertices_connected_by_edges,
+        ):
+            with pytest.raises(IndexError):
+                query(np.array([bad], dtype=np.int64))
+        found = graph.get_edges_from_vertex_pairs(np.array([(bad, 1), (1, bad)]))
+        np.testing.assert_array_equal(found, [missing, missing])
+
+
+@pytest.mark.parametrize("cls", [pcg.SparseGraph, pcg.SparseGraph32])
+def test_SparseGraph_sorted_rows_and_edge_index(cls):
+    edges = [(0, 3), (0, 1), (2, 0), (1, 2), (3, 1)]
+    pairs = [(3, 0), (0, 2), (1, 3), (2, 3), (9, 0)]
+    reference = cls(4, edges).get_edges_from_vertex_pairs(pairs)
+    missing = np.iinfo(reference.dtype).max
+    np.testing.assert_array_equal(reference, [0, 2, 4, missing, missing])
+
+    sorted_graph = cls(4, edges, sort_rows=True)
+    assert sorted_graph.are_rows_sorted()
+    assert list(sorted_graph.get_vertices_touching_vertex(0)) == [1, 2, 3]
+    np.testing.assert_array_equal(sorted_graph.get_edges_from_vertex_pairs(pairs), reference)
+
+    indexed = cls(4, edges, edge_index=True)
+    assert indexed.has_edge_index()
+    np.testing.assert_array_equal(indexed.get_edges_from_vertex_pairs(pairs), reference)
+
+    graph = cls(4, edges)
+    assert not graph.has_edge_index()
+    graph.build_edge_index()
+    assert graph.has_edge_index()
+    np.testing.assert_array_equal(graph.get_edges_from_vertex_pairs(pairs), reference)
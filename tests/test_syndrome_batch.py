@@ -0,0 +1,65 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+
+def chain(graph_cls, n):
+    """A chain of n vertices whose first and last vertices are on the boundary."""
+    boundary = [v in (0, n - 1) for v in range(n)]
+    return graph_cls(n, [(v, v + 1) for v in range(n - 1)], boundary)
+
+
+@pytest.mark.parametrize(
+    "graph_cls, batch_cls",
+    [(pcg.DecodingGraph, pcg.SyndromeBatch), (pcg.DecodingGraph32, pcg.SyndromeBatch32)],
+)
+@pytest.mark.parametrize("layout", [pcg.SyndromeLayout.ShotMajor, pcg.SyndromeLayout.DetectorMajor])
+def test_SyndromeBatch(graph_cls, batch_cls, layout):
+    num_detectors, num_shots = 150, 20
+    graph = chain(graph_cls, num_detectors)
+    rng = np.random.default_rng(5)
+    bits = rng.random((num_shots, num_detectors)) < 0.1
+
+    rows = bits if layout == pcg.SyndromeLayout.ShotMajor else bits.T
+    packed = np.packbits(rows, axis=1, bitorder="little")
+    batch = batch_cls.from_packed(graph, packed, layout, num_shots=num_shots)
+    assert batch.num_shots == num_shots
+    assert batch.num_detectors == num_detectors
+    assert batch.layout == layout
+    assert batch.words.dtype == np.uint64
+    np.testing.assert_array_equal(batch.bytes[:, : packed.shape[1]], packed)
+
+    bits[:, [0, num_detectors - 1]] = False
+    offsets, values = batch.extract_defects()
+    np.testing.assert_array_equal(batch.count_defects(), bits.sum(axis=1))
+    np.testing.assert_array_equal(np.diff(offsets), bits.sum(axis=1))
+    for s in range(num_shots):
+        expected = np.flatnonzero(bits[s])
+        np.testing.assert_array_equal(values[offsets[s] : offsets[s + 1]], expected)
+        np.testing.assert_array_equal(batch.get_defects(s), expected)
+
+
+def test_SyndromeBatch_views_are_writable():
+    graph = chain(pcg.DecodingGraph, 10)
+    batch = pcg.SyndromeBatch(graph, 3)
+    np.testing.assert_array_equal(batch.count_defects(), [0, 0, 0])
+
+    batch.bytes[1, 0] = 0b00000110
+    batch.set_detector(2, 9)
+    assert batch.get_detector(1, 2)
+    np.testing.assert_array_equal(batch.count_defects(), [0, 2, 0])
+    np.testing.assert_array_equal(batch.count_defects(exclude_boundary=False), [0, 2, 1])
+    np.testing.assert_array_equal(batch.get_defects(2, exclude_boundary=False), [9])
+
+
+def test_SyndromeBatch_errors():
+    graph = chain(pcg.DecodingGraph, 10)
+    with pytest.raises(ValueError):
+        pcg.SyndromeBatch.from_packed(graph, np.zeros((2, 1), dtype=np.uint8))
+    with pytest.raises(ValueError):
+        pcg.SyndromeBatch.from_packed(
+            graph, np.zeros((3, 1), dtype=np.uint8), pcg.SyndromeLayout.DetectorMajor
+        )
+    batch = pcg.SyndromeBatch(graph, 2)
+    with pytest.raises(IndexError):
+        batch.get_detector(2, 0)
@@ -0,0 +1,71 @@
+import numpy as np
+import pytest
+import plaquette_graph as pcg
+
+# Repetition code rounds: detectors 0 and 1 and a boundary vertex 2, with edges
+# to the same detectors of the previous round
+SPACE_EDGES = [(3, 4), (4, 5), (5, 3)]
+TIME_EDGES = [(0, 3), (1, 4)]
+BOUNDARY = [False, False, True]
+
+
+@pytest.mark.parametrize("cls", [pcg.WindowedDecodingGraph, pcg.WindowedDecodingGraph32])
+def test_WindowedDecodingGraph_stream(cls):
+    window = cls(3, 2, 5, 8)
+    assert window.append_layer(SPACE_EDGES, BOUNDARY, weights=[2, 2, 5]) == 0
+    edges = np.array(SPACE_EDGES + TIME_EDGES, dtype=np.int32)
+    for t in range(1, 6):
+        if window.is_full():
+            window.retire_layer()
+        assert window.append_layer(edges, BOUNDARY) == t
+        assert window.first_layer == t - 1
+        assert window.num_layers == 2
+
+        old, new = window.get_vertex(t - 1, 0), window.get_vertex(t, 0)
+        assert window.get_layer_of_vertex(new) == t
+        assert window.is_vertex_on_boundary(window.get_vertex(t, 2))
+        e = window.get_edge_from_vertex_pair((old, new))
+        assert e is not None
+        assert sorted(window.get_vertices_connected_by_edge(e)) == sorted((old, new))
+        assert window.get_edge_weight(e) == 1
+        assert new in list(window.get_vertices_touching_vertex(old))
+
+    # IDs are reused: layer 5 is stored in the slot of layer 3
+    assert window.get_vertex(5, 0) == 3
+    window.retire_layer()
+    assert window.get_layer_of_vertex(window.get_vertex(5, 0) - 3) is None
+    assert len(window.get_edges_touching_vertex(window.get_vertex(5, 0))) == 2
+
+
+def test_WindowedDecodingGraph_errors():
+    window = pcg.WindowedDecodingGraph(3, 1, 5, 8)
+    with pytest.raises(ValueError):
+        window.append_layer(TIME_EDGES, BOUNDARY)
+    with pytest.raises(ValueError):
+        window.append_layer(SPACE_EDGES, BOUNDARY[:2])
+    with pytest.raises(RuntimeError):
+        window.retire_layer()
+    window.append_layer(SPACE_EDGES, BOUNDARY)
+    with pytest.raises(ValueError):
+        window.append_layer(SPACE_EDGES, BOUNDARY)
+    with pytest.raises(IndexError):
+        window.get_vertex(1, 0)
+
+
+@pytest.mark.parametrize("cls", [pcg.WindowedDecodingGraph, pcg.WindowedDecodingGraph32])
+def test_WindowedDecodingGraph_rejects_out_of_range_ids(cls):
+    window = cls(3, 2, 5, 8)
+    window.append_layer(SPACE_EDGES, BOUNDARY)
+    num_vertices = window.get_num_vertices()
+    num_edges = window.get_num_edges()
+    for query in (
+        window.get_edges_touching_vertex,
+        window.get_vertices_touching_vertex,
+        window.is_vertex_on_boundary,
+    ):
+        with pytest.raises(IndexError):
+            query(num_vertices)
+    for query in (window.get_vertices_connected_by_edge, window.get_edge_weight):
+        with pytest.raises(IndexError):
+            query(num_edges)
+    assert len(window.get_edges_touching_vertex(num_vertices - 1)) == 0